@@ -0,0 +1,74 @@
+
+#include <vector>
+#include <algorithm>
+#include <glload/gl_3_3.h>
+#include <glimg/glimg.h>
+#include <glimg/ImageCreator.h>
+#include "../framework/Clock.h"
+#include "BenchUtil.h"
+
+double ElapsedMs(GLuint64 startNs)
+{
+	return (Framework::GetMonotonicTimeNs() - startNs) / 1000000.0;
+}
+
+glimg::Dimensions GetMipmapDims(int imageSize, int mipmapLevel)
+{
+	glimg::Dimensions dims;
+	dims.numDimensions = 2;
+	dims.width = std::max(imageSize >> mipmapLevel, 1);
+	dims.height = std::max(imageSize >> mipmapLevel, 1);
+	dims.depth = 0;
+	return dims;
+}
+
+size_t GetImageSetByteSize(const glimg::ImageSet &imageSet)
+{
+	size_t byteCount = 0;
+	for(int mipmapLevel = 0; mipmapLevel < imageSet.GetMipmapCount(); ++mipmapLevel)
+		byteCount += imageSet.GetImage(mipmapLevel).GetImageByteSize();
+	return byteCount * imageSet.GetArrayCount() * imageSet.GetFaceCount();
+}
+
+glimg::ImageSet *CreateNoiseImageSet(const glimg::ImageFormat &format, int imageSize, int numMipmaps)
+{
+	glimg::ImageCreator creator(format, GetMipmapDims(imageSize, 0), numMipmaps, 1, 1);
+
+	//16 bytes per texel is enough for any format, including a 4x4 block for a 1x1 mipmap.
+	unsigned int seed = 1;
+	std::vector<unsigned char> pixels;
+	for(int mipmapLevel = 0; mipmapLevel < numMipmaps; ++mipmapLevel)
+	{
+		glimg::Dimensions dims = GetMipmapDims(imageSize, mipmapLevel);
+		pixels.resize((size_t)dims.width * dims.height * 16);
+		for(size_t byteIx = 0; byteIx < pixels.size(); ++byteIx)
+		{
+			seed = seed * 1664525 + 1013904223;
+			pixels[byteIx] = (unsigned char)(seed >> 24);
+		}
+
+		creator.SetImageData(&pixels[0], false, mipmapLevel);
+	}
+
+	return creator.CreateImage();
+}
+
+double GetGBPerSec(size_t byteCount, double ms)
+{
+	return (byteCount / 1.0e9) / (ms / 1000.0);
+}
+
+double TimeFastestRun(TimedOperation &operation, int numRuns)
+{
+	double bestMs = 1.0e30;
+	for(int runIx = 0; runIx < numRuns; ++runIx)
+	{
+		operation.Prepare();
+
+		GLuint64 startNs = Framework::GetMonotonicTimeNs();
+		operation.Run();
+		bestMs = std::min(bestMs, ElapsedMs(startNs));
+	}
+
+	return bestMs;
+}
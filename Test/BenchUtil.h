@@ -0,0 +1,38 @@
+
+#ifndef TEST_BENCH_UTIL_H
+#define TEST_BENCH_UTIL_H
+
+#include <glload/gl_3_3.h>
+#include <glimg/glimg.h>
+
+//Helpers shared by the benchmarks that time glimg.
+
+//The milliseconds since startNs, a time from Framework::GetMonotonicTimeNs.
+double ElapsedMs(GLuint64 startNs);
+
+//The size of a mipmap level of a square 2D image.
+glimg::Dimensions GetMipmapDims(int imageSize, int mipmapLevel);
+
+//The bytes of every image in the set: all mipmaps, array layers and faces.
+size_t GetImageSetByteSize(const glimg::ImageSet &imageSet);
+
+//A square 2D image with the given number of mipmaps, each filled with noise. For benchmarks
+//that the contents do not matter to.
+glimg::ImageSet *CreateNoiseImageSet(const glimg::ImageFormat &format, int imageSize, int numMipmaps);
+
+double GetGBPerSec(size_t byteCount, double ms);
+
+//Something to time. Prepare is called before each run, and is not timed.
+class TimedOperation
+{
+public:
+	virtual ~TimedOperation() {}
+
+	virtual void Prepare() {}
+	virtual void Run() = 0;
+};
+
+//Runs the operation numRuns times, and returns the fastest run in milliseconds.
+double TimeFastestRun(TimedOperation &operation, int numRuns);
+
+#endif //TEST_BENCH_UTIL_H
@@ -0,0 +1,247 @@
+/***********************************************************************
+Measures the cost of binding uniform state for a scene with many nodes,
+each with many binders. Two copies of the scene are rendered with
+Scene::Render, so that everything but the binding is the same. One
+binds from the scene's uniform tables, which skip uploads of unchanged
+values. The other hides the binders' uniform entries, so the scene calls
+every binder's BindState for every node, which is what scenes used to do.
+
+Runs a fixed number of frames of each, prints the results and exits.
+***********************************************************************/
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <glload/gl_3_3.h>
+#include <GL/freeglut.h>
+#include "../framework/framework_all.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+const int g_gridSize = 48;
+const int g_numNodes = g_gridSize * g_gridSize;
+const int g_warmupFrames = 10;
+const int g_timedFrames = 200;
+
+const char *g_sceneFilename = "BinderBench_scene.xml";
+
+//Binds from uniform tables.
+Framework::Scene *g_pTableScene = NULL;
+GLuint g_tableProgram = 0;
+
+//Calls BindState for every draw.
+Framework::Scene *g_pPerDrawScene = NULL;
+GLuint g_perDrawProgram = 0;
+
+//Shared by every node; these never change, so only the first node uploads them.
+Framework::UniformVec4Binder g_baseColorBinder;
+Framework::UniformVec4Binder g_tintBinder;
+Framework::UniformVec3Binder g_offsetBinder;
+Framework::UniformVec2Binder g_scaleBinder;
+Framework::UniformFloatBinder g_intensityBinder;
+Framework::UniformFloatBinder g_fadeBinder;
+Framework::UniformIntBinder g_modeBinder;
+Framework::UniformMat4Binder g_extraMatBinder;
+
+//One per node, each with a different value, so these are uploaded for every node.
+std::vector<Framework::UniformVec4Binder> g_nodeColorBinders;
+
+std::vector<Framework::StateBinder *> g_nodeBinders;
+
+//Forwards to another binder, but does not give the scene its uniform entry. So the scene
+//calls BindState and UnbindState on every draw.
+class PerDrawBinder : public Framework::StateBinder
+{
+public:
+	PerDrawBinder() : m_pBinder(NULL) {}
+	explicit PerDrawBinder(Framework::StateBinder *pBinder) : m_pBinder(pBinder) {}
+
+	virtual void BindState(GLuint prog) const {m_pBinder->BindState(prog);}
+	virtual void UnbindState(GLuint prog) const {m_pBinder->UnbindState(prog);}
+
+private:
+	Framework::StateBinder *m_pBinder;
+};
+
+std::vector<PerDrawBinder> g_perDrawBinders;
+std::vector<PerDrawBinder> g_perDrawNodeColorBinders;
+
+void AssociateBinders(GLuint program)
+{
+	g_baseColorBinder.AssociateWithProgram(program, "baseColor");
+	g_tintBinder.AssociateWithProgram(program, "tint");
+	g_offsetBinder.AssociateWithProgram(program, "offset");
+	g_scaleBinder.AssociateWithProgram(program, "scale");
+	g_intensityBinder.AssociateWithProgram(program, "intensity");
+	g_fadeBinder.AssociateWithProgram(program, "fade");
+	g_modeBinder.AssociateWithProgram(program, "mode");
+	g_extraMatBinder.AssociateWithProgram(program, "extraMatrix");
+
+	for(int nodeIx = 0; nodeIx < g_numNodes; ++nodeIx)
+		g_nodeColorBinders[nodeIx].AssociateWithProgram(program, "nodeColor");
+}
+
+Framework::NodeRef FindBenchNode(Framework::Scene &scene, int nodeIx)
+{
+	std::ostringstream nodeName;
+	nodeName << "n" << nodeIx;
+	return scene.FindNode(nodeName.str());
+}
+
+void WriteSceneFile()
+{
+	std::ofstream sceneFile((std::string("data/") + g_sceneFilename).c_str());
+	sceneFile << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+	sceneFile << "<scene xmlns=\"http://www.arcsynthesis.com/gltut/scene\">\n";
+	sceneFile << "\t<mesh xml:id=\"m_cube\" file=\"UnitCube.xml\"/>\n";
+	sceneFile << "\t<prog xml:id=\"p_bench\" vert=\"BinderBench.vert\" frag=\"BinderBench.frag\" "
+		"model-to-camera=\"modelToCameraMatrix\"/>\n";
+
+	for(int nodeIx = 0; nodeIx < g_numNodes; ++nodeIx)
+	{
+		float xPos = (float)(nodeIx % g_gridSize) - (g_gridSize / 2.0f);
+		float yPos = (float)(nodeIx / g_gridSize) - (g_gridSize / 2.0f);
+		sceneFile << "\t<node name=\"n" << nodeIx << "\" mesh=\"m_cube\" prog=\"p_bench\" pos=\""
+			<< xPos << " " << yPos << " 0\" scale=\"0.5\"/>\n";
+	}
+
+	sceneFile << "</scene>\n";
+}
+
+void init()
+{
+	WriteSceneFile();
+
+	g_pTableScene = new Framework::Scene(g_sceneFilename);
+	g_tableProgram = g_pTableScene->FindProgram("p_bench");
+	g_pPerDrawScene = new Framework::Scene(g_sceneFilename);
+	g_perDrawProgram = g_pPerDrawScene->FindProgram("p_bench");
+
+	g_baseColorBinder.SetValue(glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
+	g_tintBinder.SetValue(glm::vec4(1.0f, 0.9f, 0.8f, 1.0f));
+	g_offsetBinder.SetValue(glm::vec3(0.0f, 0.0f, 0.0f));
+	g_scaleBinder.SetValue(glm::vec2(1.0f, 1.0f));
+	g_intensityBinder.SetValue(1.0f);
+	g_fadeBinder.SetValue(0.25f);
+	g_modeBinder.SetValue(1);
+
+	g_nodeBinders.push_back(&g_baseColorBinder);
+	g_nodeBinders.push_back(&g_tintBinder);
+	g_nodeBinders.push_back(&g_offsetBinder);
+	g_nodeBinders.push_back(&g_scaleBinder);
+	g_nodeBinders.push_back(&g_intensityBinder);
+	g_nodeBinders.push_back(&g_fadeBinder);
+	g_nodeBinders.push_back(&g_modeBinder);
+	g_nodeBinders.push_back(&g_extraMatBinder);
+
+	g_nodeColorBinders.resize(g_numNodes);
+	for(int nodeIx = 0; nodeIx < g_numNodes; ++nodeIx)
+	{
+		g_nodeColorBinders[nodeIx].SetValue(
+			glm::vec4((nodeIx % 7) / 7.0f, (nodeIx % 5) / 5.0f, 0.5f, 1.0f));
+	}
+
+	AssociateBinders(g_tableProgram);
+	AssociateBinders(g_perDrawProgram);
+
+	for(size_t binderIx = 0; binderIx < g_nodeBinders.size(); ++binderIx)
+		g_perDrawBinders.push_back(PerDrawBinder(g_nodeBinders[binderIx]));
+	for(int nodeIx = 0; nodeIx < g_numNodes; ++nodeIx)
+		g_perDrawNodeColorBinders.push_back(PerDrawBinder(&g_nodeColorBinders[nodeIx]));
+
+	for(int nodeIx = 0; nodeIx < g_numNodes; ++nodeIx)
+	{
+		Framework::NodeRef tableNode = FindBenchNode(*g_pTableScene, nodeIx);
+		Framework::NodeRef perDrawNode = FindBenchNode(*g_pPerDrawScene, nodeIx);
+		for(size_t binderIx = 0; binderIx < g_nodeBinders.size(); ++binderIx)
+		{
+			tableNode.SetStateBinder(g_nodeBinders[binderIx]);
+			perDrawNode.SetStateBinder(&g_perDrawBinders[binderIx]);
+		}
+		tableNode.SetStateBinder(&g_nodeColorBinders[nodeIx]);
+		perDrawNode.SetStateBinder(&g_perDrawNodeColorBinders[nodeIx]);
+	}
+}
+
+glm::mat4 CalcCameraMatrix()
+{
+	return glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -60.0f));
+}
+
+void SetCameraToClip(GLuint program, const glm::mat4 &cameraToClip)
+{
+	glUseProgram(program);
+	glUniformMatrix4fv(glGetUniformLocation(program, "cameraToClipMatrix"), 1, GL_FALSE,
+		glm::value_ptr(cameraToClip));
+	glUseProgram(0);
+}
+
+int g_frameIx = 0;
+GLuint64 g_startNs = 0;
+GLuint64 g_perDrawNs = 0;
+
+void display()
+{
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glm::mat4 cameraToClip = glm::perspective(60.0f, 1.0f, 1.0f, 1000.0f);
+	SetCameraToClip(g_tableProgram, cameraToClip);
+	SetCameraToClip(g_perDrawProgram, cameraToClip);
+
+	const int framesPerMode = g_warmupFrames + g_timedFrames;
+	bool isPerDrawMode = g_frameIx < framesPerMode;
+	int modeFrameIx = g_frameIx % framesPerMode;
+
+	//So that GPU work queued up by one mode is not billed to the other.
+	glFinish();
+	if(modeFrameIx == g_warmupFrames)
+		g_startNs = Framework::GetMonotonicTimeNs();
+
+	if(isPerDrawMode)
+		g_pPerDrawScene->Render(CalcCameraMatrix());
+	else
+		g_pTableScene->Render(CalcCameraMatrix());
+
+	glFinish();
+	++g_frameIx;
+
+	if(g_frameIx == framesPerMode)
+		g_perDrawNs = Framework::GetMonotonicTimeNs() - g_startNs;
+
+	Framework::SwapBuffers();
+
+	if(g_frameIx == framesPerMode * 2)
+	{
+		GLuint64 tableNs = Framework::GetMonotonicTimeNs() - g_startNs;
+		printf("%i nodes, %i binders each, %i frames.\n", g_numNodes,
+			(int)g_nodeBinders.size() + 1, g_timedFrames);
+		printf("BindState per draw:\t%.3f ms/frame\n", g_perDrawNs / (1000000.0 * g_timedFrames));
+		printf("Uniform tables:\t\t%.3f ms/frame\n", tableNs / (1000000.0 * g_timedFrames));
+		Framework::LeaveMainLoop();
+		return;
+	}
+
+	Framework::PostRedisplay();
+}
+
+void reshape (int w, int h)
+{
+	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
+	Framework::PostRedisplay();
+}
+
+void keyboard(unsigned char key, int x, int y)
+{
+	switch (key)
+	{
+	case 27:
+		Framework::LeaveMainLoop();
+		return;
+	}
+}
+
+unsigned int defaults(unsigned int displayMode, int &width, int &height) {return displayMode;}
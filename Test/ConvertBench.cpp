@@ -0,0 +1,148 @@
+/***********************************************************************
+Measures how fast glimg::ConvertImage turns images into the formats
+that OpenGL stores them in: a 4096x4096 image with all of its mipmaps,
+converted between several pairs of formats. The 8-bit reorders and RGB
+to RGBA expansions take the vectorized path; the packed and float ones
+go through floats. Each is timed on one thread and on the shared pool,
+a few times, and the fastest is kept.
+
+Runs once, prints the results and exits.
+***********************************************************************/
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <stdio.h>
+#include <glload/gl_3_3.h>
+#include <glimg/glimg.h>
+#include <glimg/FormatConverter.h>
+#include <glimg/TextureGenerator.h>
+#include <glimg/ThreadPool.h>
+#include <GL/freeglut.h>
+#include "../framework/framework.h"
+#include "BenchUtil.h"
+
+const int g_imageSize = 4096;
+const int g_numRuns = 5;
+const int g_numMipmaps = 13;
+
+class ConvertOperation : public TimedOperation
+{
+public:
+	ConvertOperation(const glimg::ImageSet &imageSet, const glimg::ImageFormat &dstFormat, int numThreads)
+		: m_imageSet(imageSet)
+		, m_dstFormat(dstFormat)
+		, m_numThreads(numThreads)
+	{}
+
+	virtual void Run()
+	{
+		std::auto_ptr<glimg::ImageSet> pConverted(glimg::ConvertImage(m_imageSet, m_dstFormat, m_numThreads));
+	}
+
+private:
+	const glimg::ImageSet &m_imageSet;
+	const glimg::ImageFormat &m_dstFormat;
+	int m_numThreads;
+};
+
+//RGB float formats cannot be rendered to, so asking for a renderable format must give RGBA.
+void CheckRenderableFormat(const char *name, const glimg::ImageFormat &format, GLenum expectedFormat)
+{
+	GLenum internalFormat = glimg::GetInternalFormat(format, glimg::FORCE_COLOR_RENDERABLE_FMT);
+	if(internalFormat != expectedFormat)
+		printf("FAILED: the renderable format of %s is 0x%04X, not 0x%04X.\n", name, internalFormat, expectedFormat);
+}
+
+struct Conversion
+{
+	const char *name;
+	glimg::ImageFormat srcFormat;
+	glimg::ImageFormat dstFormat;
+};
+
+void init()
+{
+	const glimg::ImageFormat rgb8(glimg::DT_NORM_UNSIGNED_INTEGER, glimg::FMT_COLOR_RGB,
+		glimg::ORDER_RGBA, glimg::BD_PER_COMP_8, 1);
+	const glimg::ImageFormat bgr8(glimg::DT_NORM_UNSIGNED_INTEGER, glimg::FMT_COLOR_RGB,
+		glimg::ORDER_BGRA, glimg::BD_PER_COMP_8, 1);
+	const glimg::ImageFormat rgba8(glimg::DT_NORM_UNSIGNED_INTEGER, glimg::FMT_COLOR_RGBA,
+		glimg::ORDER_RGBA, glimg::BD_PER_COMP_8, 4);
+	const glimg::ImageFormat bgra8(glimg::DT_NORM_UNSIGNED_INTEGER, glimg::FMT_COLOR_RGBA,
+		glimg::ORDER_BGRA, glimg::BD_PER_COMP_8, 4);
+	const glimg::ImageFormat rgb565(glimg::DT_NORM_UNSIGNED_INTEGER, glimg::FMT_COLOR_RGB,
+		glimg::ORDER_RGBA, glimg::BD_PACKED_16_BIT_565, 1);
+	const glimg::ImageFormat rgba16f(glimg::DT_FLOAT, glimg::FMT_COLOR_RGBA,
+		glimg::ORDER_RGBA, glimg::BD_PER_COMP_16, 1);
+	const glimg::ImageFormat rgb16f(glimg::DT_FLOAT, glimg::FMT_COLOR_RGB,
+		glimg::ORDER_RGBA, glimg::BD_PER_COMP_16, 1);
+	const glimg::ImageFormat rgb32f(glimg::DT_FLOAT, glimg::FMT_COLOR_RGB,
+		glimg::ORDER_RGBA, glimg::BD_PER_COMP_32, 1);
+
+	CheckRenderableFormat("RGB16F", rgb16f, GL_RGBA16F);
+	CheckRenderableFormat("RGB32F", rgb32f, GL_RGBA32F);
+
+	const Conversion conversions[] =
+	{
+		{"RGB8 to native", rgb8, glimg::GetNativeFormat(rgb8)},
+		{"BGR8 to RGBA8", bgr8, rgba8},
+		{"RGBA8 to BGRA8", rgba8, bgra8},
+		{"565 to native", rgb565, glimg::GetNativeFormat(rgb565)},
+		{"RGBA8 to RGBA16F", rgba8, rgba16f},
+		{"RGB32F to RGBA16F", rgb32f, rgba16f},
+	};
+
+	printf("%ix%i with %i mipmaps, best of %i runs, %i hardware threads.\n", g_imageSize, g_imageSize,
+		g_numMipmaps, g_numRuns, glimg::GetHardwareThreadCount());
+	printf("%-18s %10s %20s %20s\n", "", "MB", "1 thread ms (GB/s)", "pool ms (GB/s)");
+
+	for(int convIx = 0; convIx < (int)(sizeof(conversions) / sizeof(conversions[0])); ++convIx)
+	{
+		const Conversion &conversion = conversions[convIx];
+		std::auto_ptr<glimg::ImageSet> pImageSet(CreateNoiseImageSet(conversion.srcFormat,
+			g_imageSize, g_numMipmaps));
+
+		//Counted as both read and written.
+		std::auto_ptr<glimg::ImageSet> pConverted(glimg::ConvertImage(*pImageSet, conversion.dstFormat));
+		size_t byteCount = GetImageSetByteSize(*pImageSet) + GetImageSetByteSize(*pConverted);
+
+		ConvertOperation singleConversion(*pImageSet, conversion.dstFormat, 1);
+		ConvertOperation pooledConversion(*pImageSet, conversion.dstFormat, 0);
+		double singleMs = TimeFastestRun(singleConversion, g_numRuns);
+		double pooledMs = TimeFastestRun(pooledConversion, g_numRuns);
+
+		printf("%-18s %10.1f %9.1f (%7.2f) %9.1f (%7.2f)\n", conversion.name,
+			byteCount / (1024.0 * 1024.0),
+			singleMs, GetGBPerSec(byteCount, singleMs),
+			pooledMs, GetGBPerSec(byteCount, pooledMs));
+	}
+}
+
+void display()
+{
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	Framework::SwapBuffers();
+	Framework::LeaveMainLoop();
+}
+
+void reshape (int w, int h)
+{
+	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
+	Framework::PostRedisplay();
+}
+
+void keyboard(unsigned char key, int x, int y)
+{
+	switch (key)
+	{
+	case 27:
+		Framework::LeaveMainLoop();
+		return;
+	}
+}
+
+unsigned int defaults(unsigned int displayMode, int &width, int &height) {return displayMode;}
@@ -0,0 +1,461 @@
+/***********************************************************************
+Measures how fast glimg decodes image files, in images per second and
+in MB per second of both file and decoded data. PNG, JPEG and TGA files
+are loaded with stb::LoadFromFile and stb::LoadFromMemory; DDS files
+with dds::LoadFromFile and dds::LoadFromMemory. The memory loaders are
+given files that were read beforehand, so they show the cost of the
+decoding alone. Then every file is loaded at once with LoadBatch, on
+one thread and on the shared pool. Each is run a few times, and the
+fastest is kept; after the first run, the files are in the OS cache.
+
+The files are written by the benchmark, from photograph-like images:
+8 of each format at 1024x1024. The DDS files are mipmapped and BC1
+compressed, as textures usually are. They are deleted afterwards.
+To measure other files, such as an application's own, set
+DECODE_BENCH_DIR to the directory they are in. Its PNG, JPEG, TGA and
+DDS files are used instead.
+
+Runs once, prints the results and exits.
+***********************************************************************/
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <ctype.h>
+#include <glload/gl_3_3.h>
+#include <glimg/glimg.h>
+#include <glimg/ImageCreator.h>
+#include <glimg/MipmapGenerator.h>
+#include <glimg/BlockCompressor.h>
+#include <glimg/DdsWriter.h>
+#include <glimg/ThreadPool.h>
+#include <GL/freeglut.h>
+#include "../framework/framework.h"
+#include "BenchUtil.h"
+#include "ImageEncoders.h"
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif //WIN32
+
+#ifdef LOAD_X11
+#include <dirent.h>
+#endif //LOAD_X11
+
+const int g_imageSize = 1024;
+const int g_numImagesPerFormat = 8;
+const int g_jpegQuality = 90;
+const int g_numRuns = 3;
+
+enum FileFormat
+{
+	FORMAT_PNG,
+	FORMAT_JPEG,
+	FORMAT_TGA,
+	FORMAT_DDS,
+
+	NUM_FILE_FORMATS,
+	FORMAT_UNKNOWN = NUM_FILE_FORMATS,
+};
+
+const char *g_formatNames[NUM_FILE_FORMATS] = {"PNG", "JPEG", "TGA", "DDS"};
+const char *g_formatExtensions[NUM_FILE_FORMATS] = {".png", ".jpg", ".tga", ".dds"};
+
+FileFormat GetFileFormat(const std::string &filename)
+{
+	size_t dotIx = filename.find_last_of('.');
+	if(dotIx == std::string::npos)
+		return FORMAT_UNKNOWN;
+
+	std::string extension = filename.substr(dotIx);
+	for(size_t charIx = 0; charIx < extension.size(); ++charIx)
+		extension[charIx] = (char)tolower((unsigned char)extension[charIx]);
+
+	if(extension == ".jpeg")
+		return FORMAT_JPEG;
+
+	for(int formatIx = 0; formatIx < NUM_FILE_FORMATS; ++formatIx)
+	{
+		if(extension == g_formatExtensions[formatIx])
+			return (FileFormat)formatIx;
+	}
+
+	return FORMAT_UNKNOWN;
+}
+
+struct InputFile
+{
+	std::string filename;
+	FileFormat format;
+	std::vector<unsigned char> contents;
+	size_t decodedByteSize;
+};
+
+//Smooth gradients and waves, with a little noise, so that the files compress about as well
+//as photographs do.
+std::vector<unsigned char> CreatePixels(unsigned int seed)
+{
+	std::vector<unsigned char> pixels((size_t)g_imageSize * g_imageSize * 3);
+
+	float waveFreqs[3];
+	for(int compIx = 0; compIx < 3; ++compIx)
+	{
+		seed = seed * 1664525 + 1013904223;
+		waveFreqs[compIx] = 0.005f + (seed >> 24) / 8192.0f;
+	}
+
+	for(int row = 0; row < g_imageSize; ++row)
+	{
+		for(int col = 0; col < g_imageSize; ++col)
+		{
+			for(int compIx = 0; compIx < 3; ++compIx)
+			{
+				seed = seed * 1664525 + 1013904223;
+				float noise = ((seed >> 24) & 0x3) - 1.5f;
+				float detail = 12.0f * sinf(0.35f * col + 0.9f * sinf(0.2f * row)) *
+					sinf(0.25f * row + compIx);
+				float value = 40.0f + 100.0f * row / g_imageSize + 60.0f * col / g_imageSize +
+					40.0f * sinf(waveFreqs[compIx] * col + 0.03f * row) *
+					cosf(waveFreqs[(compIx + 1) % 3] * row) + detail + noise;
+
+				pixels[((size_t)row * g_imageSize + col) * 3 + compIx] =
+					(unsigned char)std::min(std::max(value, 0.0f), 255.0f);
+			}
+		}
+	}
+
+	return pixels;
+}
+
+bool WriteDds(const std::string &filename, const std::vector<unsigned char> &pixels)
+{
+	glimg::ImageFormat format(glimg::DT_NORM_UNSIGNED_INTEGER, glimg::FMT_COLOR_RGB,
+		glimg::ORDER_RGBA, glimg::BD_PER_COMP_8, 1);
+	glimg::ImageCreator creator(format, GetMipmapDims(g_imageSize, 0), 1, 1, 1);
+	creator.SetImageData(&pixels[0], true, 0);
+	std::auto_ptr<glimg::ImageSet> pImageSet(creator.CreateImage());
+
+	std::auto_ptr<glimg::ImageSet> pMipmapped(glimg::GenerateMipmaps(*pImageSet));
+	std::auto_ptr<glimg::ImageSet> pCompressed(glimg::CompressImage(*pMipmapped,
+		glimg::DT_COMPRESSED_BC1, glimg::COMPRESSION_QUALITY_FAST));
+
+	try
+	{
+		glimg::writers::dds::SaveToFile(pCompressed.get(), filename);
+	}
+	catch(glimg::writers::dds::DdsWriterException &)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+std::vector<std::string> WriteInputFiles()
+{
+	std::vector<std::string> filenames;
+	for(int imageIx = 0; imageIx < g_numImagesPerFormat; ++imageIx)
+	{
+		std::vector<unsigned char> pixels = CreatePixels(imageIx + 1);
+		for(int formatIx = 0; formatIx < NUM_FILE_FORMATS; ++formatIx)
+		{
+			char filename[64];
+			sprintf(filename, "DecodeBench_%i%s", imageIx, g_formatExtensions[formatIx]);
+
+			bool isWritten = false;
+			switch(formatIx)
+			{
+			case FORMAT_PNG:
+				isWritten = WritePng(filename, pixels, g_imageSize, g_imageSize);
+				break;
+			case FORMAT_JPEG:
+				isWritten = WriteJpeg(filename, pixels, g_imageSize, g_imageSize, g_jpegQuality);
+				break;
+			case FORMAT_TGA:
+				isWritten = WriteTga(filename, pixels, g_imageSize, g_imageSize);
+				break;
+			case FORMAT_DDS:
+				isWritten = WriteDds(filename, pixels);
+				break;
+			}
+
+			if(!isWritten)
+				printf("Could not write %s.\n", filename);
+			else
+				filenames.push_back(filename);
+		}
+	}
+
+	return filenames;
+}
+
+std::vector<std::string> ListInputFiles(const std::string &dirName)
+{
+	std::vector<std::string> filenames;
+
+#ifdef WIN32
+	WIN32_FIND_DATAA findData;
+	HANDLE hFind = FindFirstFileA((dirName + "\\*").c_str(), &findData);
+	if(hFind != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			if(!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+				filenames.push_back(dirName + "\\" + findData.cFileName);
+		} while(FindNextFileA(hFind, &findData));
+
+		FindClose(hFind);
+	}
+#endif //WIN32
+
+#ifdef LOAD_X11
+	if(DIR *pDir = opendir(dirName.c_str()))
+	{
+		while(dirent *pEntry = readdir(pDir))
+		{
+			if(pEntry->d_type != DT_DIR)
+				filenames.push_back(dirName + "/" + pEntry->d_name);
+		}
+
+		closedir(pDir);
+	}
+#endif //LOAD_X11
+
+	std::sort(filenames.begin(), filenames.end());
+	return filenames;
+}
+
+bool ReadFile(const std::string &filename, std::vector<unsigned char> &contents)
+{
+	FILE *pFile = fopen(filename.c_str(), "rb");
+	if(!pFile)
+		return false;
+
+	fseek(pFile, 0, SEEK_END);
+	contents.resize(ftell(pFile));
+	fseek(pFile, 0, SEEK_SET);
+	bool isRead = contents.empty() || fread(&contents[0], 1, contents.size(), pFile) == contents.size();
+	fclose(pFile);
+	return isRead;
+}
+
+enum LoaderFunc
+{
+	LOADER_FROM_FILE,
+	LOADER_FROM_MEMORY,
+};
+
+glimg::ImageSet *LoadFile(const InputFile &file, LoaderFunc loader)
+{
+	if(file.format == FORMAT_DDS)
+	{
+		if(loader == LOADER_FROM_FILE)
+			return glimg::loaders::dds::LoadFromFile(file.filename);
+		return glimg::loaders::dds::LoadFromMemory(&file.contents[0], file.contents.size());
+	}
+
+	if(loader == LOADER_FROM_FILE)
+		return glimg::loaders::stb::LoadFromFile(file.filename);
+	return glimg::loaders::stb::LoadFromMemory(&file.contents[0], file.contents.size());
+}
+
+//Loads the files of one format, one at a time.
+class LoadOperation : public TimedOperation
+{
+public:
+	LoadOperation(const std::vector<InputFile> &files, FileFormat format, LoaderFunc loader)
+		: m_files(files)
+		, m_format(format)
+		, m_loader(loader)
+	{}
+
+	virtual void Run()
+	{
+		for(size_t fileIx = 0; fileIx < m_files.size(); ++fileIx)
+		{
+			if(m_files[fileIx].format == m_format)
+				delete LoadFile(m_files[fileIx], m_loader);
+		}
+	}
+
+private:
+	const std::vector<InputFile> &m_files;
+	FileFormat m_format;
+	LoaderFunc m_loader;
+};
+
+class BatchOperation : public TimedOperation
+{
+public:
+	BatchOperation(const std::vector<std::string> &filenames, int numThreads)
+		: m_filenames(filenames)
+		, m_numThreads(numThreads)
+	{}
+
+	virtual void Run()
+	{
+		std::vector<glimg::ImageSet *> imageSets = glimg::loaders::LoadBatch(m_filenames, 0, m_numThreads);
+		for(size_t imageIx = 0; imageIx < imageSets.size(); ++imageIx)
+			delete imageSets[imageIx];
+	}
+
+private:
+	const std::vector<std::string> &m_filenames;
+	int m_numThreads;
+};
+
+double TimeLoads(const std::vector<InputFile> &files, FileFormat format, LoaderFunc loader)
+{
+	LoadOperation operation(files, format, loader);
+	return TimeFastestRun(operation, g_numRuns);
+}
+
+double TimeBatch(const std::vector<std::string> &filenames, int numThreads)
+{
+	BatchOperation operation(filenames, numThreads);
+	return TimeFastestRun(operation, g_numRuns);
+}
+
+void PrintResult(const char *name, const char *loaderName, int numFiles, size_t fileBytes,
+	size_t decodedBytes, double ms)
+{
+	const double megabyte = 1024.0 * 1024.0;
+	double seconds = ms / 1000.0;
+	printf("%-6s %-22s %5i %8.1f %8.1f %9.1f %9.1f %9.1f %9.1f\n", name, loaderName, numFiles,
+		fileBytes / megabyte, decodedBytes / megabyte, ms, numFiles / seconds,
+		fileBytes / megabyte / seconds, decodedBytes / megabyte / seconds);
+}
+
+void RunBenchmark(const std::vector<std::string> &filenames)
+{
+	std::vector<InputFile> files;
+	std::vector<std::string> batchFilenames;
+	for(size_t fileIx = 0; fileIx < filenames.size(); ++fileIx)
+	{
+		InputFile file;
+		file.filename = filenames[fileIx];
+		file.format = GetFileFormat(file.filename);
+		if(file.format == FORMAT_UNKNOWN)
+			continue;
+
+		if(!ReadFile(file.filename, file.contents) || file.contents.empty())
+		{
+			printf("Could not read %s.\n", file.filename.c_str());
+			continue;
+		}
+
+		std::auto_ptr<glimg::ImageSet> pImageSet(LoadFile(file, LOADER_FROM_MEMORY));
+		file.decodedByteSize = GetImageSetByteSize(*pImageSet);
+
+		files.push_back(file);
+		batchFilenames.push_back(file.filename);
+	}
+
+	printf("Best of %i runs, %i hardware threads.\n", g_numRuns, glimg::GetHardwareThreadCount());
+	printf("%-6s %-22s %5s %8s %8s %9s %9s %9s %9s\n", "", "", "files", "file MB", "data MB",
+		"ms", "images/s", "file MB/s", "data MB/s");
+
+	size_t totalFileBytes = 0;
+	size_t totalDecodedBytes = 0;
+	for(int formatIx = 0; formatIx < NUM_FILE_FORMATS; ++formatIx)
+	{
+		FileFormat format = (FileFormat)formatIx;
+		int numFiles = 0;
+		size_t fileBytes = 0;
+		size_t decodedBytes = 0;
+		for(size_t fileIx = 0; fileIx < files.size(); ++fileIx)
+		{
+			if(files[fileIx].format == format)
+			{
+				++numFiles;
+				fileBytes += files[fileIx].contents.size();
+				decodedBytes += files[fileIx].decodedByteSize;
+			}
+		}
+
+		if(!numFiles)
+		{
+			printf("%-6s no files\n", g_formatNames[formatIx]);
+			continue;
+		}
+
+		totalFileBytes += fileBytes;
+		totalDecodedBytes += decodedBytes;
+
+		const bool isDds = format == FORMAT_DDS;
+		PrintResult(g_formatNames[formatIx], isDds ? "dds::LoadFromFile" : "stb::LoadFromFile",
+			numFiles, fileBytes, decodedBytes, TimeLoads(files, format, LOADER_FROM_FILE));
+		PrintResult("", isDds ? "dds::LoadFromMemory" : "stb::LoadFromMemory",
+			numFiles, fileBytes, decodedBytes, TimeLoads(files, format, LOADER_FROM_MEMORY));
+	}
+
+	if(!files.empty())
+	{
+		const int numFiles = (int)files.size();
+		PrintResult("All", "LoadBatch, 1 thread", numFiles, totalFileBytes, totalDecodedBytes,
+			TimeBatch(batchFilenames, 1));
+		PrintResult("", "LoadBatch, shared pool", numFiles, totalFileBytes, totalDecodedBytes,
+			TimeBatch(batchFilenames, 0));
+	}
+}
+
+void init()
+{
+	std::vector<std::string> filenames;
+	bool isGenerated = false;
+	if(const char *dirName = getenv("DECODE_BENCH_DIR"))
+		filenames = ListInputFiles(dirName);
+	else
+	{
+		printf("Writing the input files...\n");
+		filenames = WriteInputFiles();
+		isGenerated = true;
+	}
+
+	try
+	{
+		RunBenchmark(filenames);
+	}
+	catch(std::exception &e)
+	{
+		printf("%s\n", e.what());
+	}
+
+	if(isGenerated)
+	{
+		for(size_t fileIx = 0; fileIx < filenames.size(); ++fileIx)
+			remove(filenames[fileIx].c_str());
+	}
+}
+
+void display()
+{
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	Framework::SwapBuffers();
+	Framework::LeaveMainLoop();
+}
+
+void reshape (int w, int h)
+{
+	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
+	Framework::PostRedisplay();
+}
+
+void keyboard(unsigned char key, int x, int y)
+{
+	switch (key)
+	{
+	case 27:
+		Framework::LeaveMainLoop();
+		return;
+	}
+}
+
+unsigned int defaults(unsigned int displayMode, int &width, int &height) {return displayMode;}
@@ -0,0 +1,157 @@
+/***********************************************************************
+Measures how fast glimg turns top-down image data into its bottom-up
+layout, for large DDS sets: a 4096x4096 image with all of its mipmaps,
+in several formats. Each set is written to memory with the DDS writer,
+then loaded back with LoadFromMemory, which flips every image. The
+flip itself is also timed through ImageCreator::SetImageDataBatch, on
+one thread and on the shared pool. Each is run a few times, and the
+fastest is kept.
+
+Runs once, prints the results and exits.
+***********************************************************************/
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <stdio.h>
+#include <glload/gl_3_3.h>
+#include <glimg/glimg.h>
+#include <glimg/ImageCreator.h>
+#include <glimg/DdsWriter.h>
+#include <glimg/ThreadPool.h>
+#include <GL/freeglut.h>
+#include "../framework/framework.h"
+#include "BenchUtil.h"
+
+const int g_imageSize = 4096;
+const int g_numRuns = 5;
+const int g_numMipmaps = 13;
+
+class LoadOperation : public TimedOperation
+{
+public:
+	explicit LoadOperation(const std::vector<unsigned char> &ddsData)
+		: m_ddsData(ddsData)
+	{}
+
+	virtual void Run()
+	{
+		std::auto_ptr<glimg::ImageSet> pImageSet(
+			glimg::loaders::dds::LoadFromMemory(&m_ddsData[0], m_ddsData.size()));
+	}
+
+private:
+	const std::vector<unsigned char> &m_ddsData;
+};
+
+class FlipOperation : public TimedOperation
+{
+public:
+	FlipOperation(const glimg::ImageSet &imageSet, int numThreads)
+		: m_imageSet(imageSet)
+		, m_numThreads(numThreads)
+		, m_images(g_numMipmaps)
+	{
+		for(int mipmapLevel = 0; mipmapLevel < g_numMipmaps; ++mipmapLevel)
+		{
+			m_images[mipmapLevel].pixelData = imageSet.GetImageArray(mipmapLevel);
+			m_images[mipmapLevel].mipmapLevel = mipmapLevel;
+			m_images[mipmapLevel].arrayIx = 0;
+			m_images[mipmapLevel].faceIx = 0;
+		}
+	}
+
+	virtual void Prepare()
+	{
+		m_pCreator.reset(new glimg::ImageCreator(m_imageSet.GetFormat(), m_imageSet.GetDimensions(),
+			g_numMipmaps, 1, 1));
+	}
+
+	virtual void Run()
+	{
+		m_pCreator->SetImageDataBatch(&m_images[0], g_numMipmaps, true, m_numThreads);
+	}
+
+private:
+	const glimg::ImageSet &m_imageSet;
+	int m_numThreads;
+	std::vector<glimg::ImageDataSource> m_images;
+	std::auto_ptr<glimg::ImageCreator> m_pCreator;
+};
+
+struct FormatInfo
+{
+	const char *name;
+	glimg::ImageFormat format;
+};
+
+void init()
+{
+	const FormatInfo formats[] =
+	{
+		{"RGBA8", glimg::ImageFormat(glimg::DT_NORM_UNSIGNED_INTEGER, glimg::FMT_COLOR_RGBA,
+			glimg::ORDER_RGBA, glimg::BD_PER_COMP_8, 1)},
+		{"BC1", glimg::ImageFormat(glimg::DT_COMPRESSED_BC1, glimg::FMT_COLOR_RGB,
+			glimg::ORDER_COMPRESSED, glimg::BD_COMPRESSED, 1)},
+		{"BC3", glimg::ImageFormat(glimg::DT_COMPRESSED_BC3, glimg::FMT_COLOR_RGBA,
+			glimg::ORDER_COMPRESSED, glimg::BD_COMPRESSED, 1)},
+		{"BC5", glimg::ImageFormat(glimg::DT_COMPRESSED_UNSIGNED_BC5, glimg::FMT_COLOR_RG,
+			glimg::ORDER_COMPRESSED, glimg::BD_COMPRESSED, 1)},
+	};
+
+	printf("%ix%i with %i mipmaps, best of %i runs, %i hardware threads.\n", g_imageSize, g_imageSize,
+		g_numMipmaps, g_numRuns, glimg::GetHardwareThreadCount());
+	printf("%-8s %10s %20s %20s %20s\n", "", "MB", "load ms (GB/s)", "flip 1 thread", "flip pool");
+
+	for(int formatIx = 0; formatIx < (int)(sizeof(formats) / sizeof(formats[0])); ++formatIx)
+	{
+		std::auto_ptr<glimg::ImageSet> pImageSet(CreateNoiseImageSet(formats[formatIx].format,
+			g_imageSize, g_numMipmaps));
+
+		std::vector<unsigned char> ddsData;
+		glimg::writers::dds::SaveToMemory(pImageSet.get(), ddsData);
+
+		size_t byteCount = GetImageSetByteSize(*pImageSet);
+
+		LoadOperation load(ddsData);
+		FlipOperation singleFlip(*pImageSet, 1);
+		FlipOperation pooledFlip(*pImageSet, 0);
+		double loadMs = TimeFastestRun(load, g_numRuns);
+		double singleMs = TimeFastestRun(singleFlip, g_numRuns);
+		double pooledMs = TimeFastestRun(pooledFlip, g_numRuns);
+
+		printf("%-8s %10.1f %9.1f (%7.2f) %9.1f (%7.2f) %9.1f (%7.2f)\n", formats[formatIx].name,
+			byteCount / (1024.0 * 1024.0),
+			loadMs, GetGBPerSec(byteCount, loadMs),
+			singleMs, GetGBPerSec(byteCount, singleMs),
+			pooledMs, GetGBPerSec(byteCount, pooledMs));
+	}
+}
+
+void display()
+{
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	Framework::SwapBuffers();
+	Framework::LeaveMainLoop();
+}
+
+void reshape (int w, int h)
+{
+	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
+	Framework::PostRedisplay();
+}
+
+void keyboard(unsigned char key, int x, int y)
+{
+	switch (key)
+	{
+	case 27:
+		Framework::LeaveMainLoop();
+		return;
+	}
+}
+
+unsigned int defaults(unsigned int displayMode, int &width, int &height) {return displayMode;}
@@ -0,0 +1,671 @@
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "ImageEncoders.h"
+
+typedef std::vector<unsigned char> ByteVector;
+
+namespace
+{
+	bool WriteFile(const std::string &filename, const ByteVector &bytes)
+	{
+		FILE *pFile = fopen(filename.c_str(), "wb");
+		if(!pFile)
+			return false;
+
+		bool isWritten = fwrite(&bytes[0], 1, bytes.size(), pFile) == bytes.size();
+		return (fclose(pFile) == 0) && isWritten;
+	}
+
+	void PutUint16LE(ByteVector &bytes, unsigned int value)
+	{
+		bytes.push_back((unsigned char)(value & 0xFF));
+		bytes.push_back((unsigned char)((value >> 8) & 0xFF));
+	}
+
+	void PutUint16BE(ByteVector &bytes, unsigned int value)
+	{
+		bytes.push_back((unsigned char)((value >> 8) & 0xFF));
+		bytes.push_back((unsigned char)(value & 0xFF));
+	}
+
+	void PutUint32BE(ByteVector &bytes, unsigned int value)
+	{
+		PutUint16BE(bytes, value >> 16);
+		PutUint16BE(bytes, value & 0xFFFF);
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	//PNG
+
+	unsigned int g_crcTable[256];
+
+	void InitCrcTable()
+	{
+		for(unsigned int entryIx = 0; entryIx < 256; ++entryIx)
+		{
+			unsigned int crc = entryIx;
+			for(int bitIx = 0; bitIx < 8; ++bitIx)
+				crc = (crc & 1) ? 0xEDB88320 ^ (crc >> 1) : crc >> 1;
+			g_crcTable[entryIx] = crc;
+		}
+	}
+
+	unsigned int CalcCrc(const unsigned char *pData, size_t byteCount)
+	{
+		if(!g_crcTable[1])
+			InitCrcTable();
+
+		unsigned int crc = 0xFFFFFFFF;
+		for(size_t byteIx = 0; byteIx < byteCount; ++byteIx)
+			crc = g_crcTable[(crc ^ pData[byteIx]) & 0xFF] ^ (crc >> 8);
+		return crc ^ 0xFFFFFFFF;
+	}
+
+	unsigned int CalcAdler32(const ByteVector &bytes)
+	{
+		unsigned int sumA = 1;
+		unsigned int sumB = 0;
+		for(size_t byteIx = 0; byteIx < bytes.size(); ++byteIx)
+		{
+			sumA = (sumA + bytes[byteIx]) % 65521;
+			sumB = (sumB + sumA) % 65521;
+		}
+		return (sumB << 16) | sumA;
+	}
+
+	void PutPngChunk(ByteVector &png, const char *type, const ByteVector &data)
+	{
+		PutUint32BE(png, (unsigned int)data.size());
+		size_t typeIx = png.size();
+		png.insert(png.end(), type, type + 4);
+		png.insert(png.end(), data.begin(), data.end());
+		PutUint32BE(png, CalcCrc(&png[typeIx], png.size() - typeIx));
+	}
+
+	//Deflate writes bits from the least significant end, but Huffman codes from the most.
+	class DeflateBitWriter
+	{
+	public:
+		explicit DeflateBitWriter(ByteVector &bytes) : m_bytes(bytes), m_bitBuffer(0), m_bitCount(0) {}
+
+		void PutBits(unsigned int bits, int bitCount)
+		{
+			m_bitBuffer |= bits << m_bitCount;
+			m_bitCount += bitCount;
+			while(m_bitCount >= 8)
+			{
+				m_bytes.push_back((unsigned char)(m_bitBuffer & 0xFF));
+				m_bitBuffer >>= 8;
+				m_bitCount -= 8;
+			}
+		}
+
+		void PutCode(unsigned int code, int bitCount)
+		{
+			unsigned int reversed = 0;
+			for(int bitIx = 0; bitIx < bitCount; ++bitIx)
+				reversed |= ((code >> bitIx) & 1) << (bitCount - 1 - bitIx);
+			PutBits(reversed, bitCount);
+		}
+
+		void Flush()
+		{
+			if(m_bitCount > 0)
+				PutBits(0, 8 - m_bitCount);
+		}
+
+	private:
+		ByteVector &m_bytes;
+		unsigned int m_bitBuffer;
+		int m_bitCount;
+	};
+
+	void PutFixedLiteral(DeflateBitWriter &writer, int symbol)
+	{
+		if(symbol < 144)
+			writer.PutCode(0x30 + symbol, 8);
+		else if(symbol < 256)
+			writer.PutCode(0x190 + symbol - 144, 9);
+		else if(symbol < 280)
+			writer.PutCode(symbol - 256, 7);
+		else
+			writer.PutCode(0xC0 + symbol - 280, 8);
+	}
+
+	const int g_lengthBases[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+	const int g_lengthExtraBits[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+	const int g_distanceBases[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+	const int g_distanceExtraBits[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+	void PutMatch(DeflateBitWriter &writer, int length, int distance)
+	{
+		int lengthIx = 28;
+		while(g_lengthBases[lengthIx] > length)
+			--lengthIx;
+		PutFixedLiteral(writer, 257 + lengthIx);
+		writer.PutBits(length - g_lengthBases[lengthIx], g_lengthExtraBits[lengthIx]);
+
+		int distanceIx = 29;
+		while(g_distanceBases[distanceIx] > distance)
+			--distanceIx;
+		writer.PutCode(distanceIx, 5);
+		writer.PutBits(distance - g_distanceBases[distanceIx], g_distanceExtraBits[distanceIx]);
+	}
+
+	const int MIN_MATCH = 3;
+	const int MAX_MATCH = 258;
+	const int WINDOW_SIZE = 32768;
+	const int HASH_BITS = 15;
+
+	int HashAt(const ByteVector &data, size_t pos)
+	{
+		unsigned int key = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16);
+		return (int)((key * 2654435761u) >> (32 - HASH_BITS));
+	}
+
+	//A zlib stream with one fixed Huffman block. Matches are found greedily, with one
+	//candidate per hash.
+	ByteVector Deflate(const ByteVector &data)
+	{
+		ByteVector zlib;
+		zlib.push_back(0x78);
+		zlib.push_back(0x01);
+
+		DeflateBitWriter writer(zlib);
+		writer.PutBits(1, 1);	//Final block.
+		writer.PutBits(1, 2);	//Fixed codes.
+
+		std::vector<int> hashHeads(1 << HASH_BITS, -1);
+		size_t pos = 0;
+		while(pos < data.size())
+		{
+			int matchLength = 0;
+			int matchDistance = 0;
+			if(pos + MIN_MATCH <= data.size())
+			{
+				int hash = HashAt(data, pos);
+				int candidate = hashHeads[hash];
+				hashHeads[hash] = (int)pos;
+
+				if(candidate >= 0 && (int)pos - candidate <= WINDOW_SIZE)
+				{
+					int maxLength = (int)std::min<size_t>(MAX_MATCH, data.size() - pos);
+					while(matchLength < maxLength && data[candidate + matchLength] == data[pos + matchLength])
+						++matchLength;
+					matchDistance = (int)pos - candidate;
+				}
+			}
+
+			if(matchLength >= MIN_MATCH)
+			{
+				PutMatch(writer, matchLength, matchDistance);
+				for(size_t skipPos = pos + 1; skipPos < pos + matchLength; ++skipPos)
+				{
+					if(skipPos + MIN_MATCH <= data.size())
+						hashHeads[HashAt(data, skipPos)] = (int)skipPos;
+				}
+				pos += matchLength;
+			}
+			else
+			{
+				PutFixedLiteral(writer, data[pos]);
+				++pos;
+			}
+		}
+
+		PutFixedLiteral(writer, 256);
+		writer.Flush();
+
+		PutUint32BE(zlib, CalcAdler32(data));
+		return zlib;
+	}
+
+	int Paeth(int left, int up, int upLeft)
+	{
+		int estimate = left + up - upLeft;
+		int leftDist = abs(estimate - left);
+		int upDist = abs(estimate - up);
+		int upLeftDist = abs(estimate - upLeft);
+		if(leftDist <= upDist && leftDist <= upLeftDist)
+			return left;
+		if(upDist <= upLeftDist)
+			return up;
+		return upLeft;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	//JPEG
+
+	const int g_zigzag[64] =
+	{
+		0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+		12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+		35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+		58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+	};
+
+	const int g_lumaQuant[64] =
+	{
+		16, 11, 10, 16, 24, 40, 51, 61,
+		12, 12, 14, 19, 26, 58, 60, 55,
+		14, 13, 16, 24, 40, 57, 69, 56,
+		14, 17, 22, 29, 51, 87, 80, 62,
+		18, 22, 37, 56, 68, 109, 103, 77,
+		24, 35, 55, 64, 81, 104, 113, 92,
+		49, 64, 78, 87, 103, 121, 120, 101,
+		72, 92, 95, 98, 112, 100, 103, 99,
+	};
+
+	const int g_chromaQuant[64] =
+	{
+		17, 18, 24, 47, 99, 99, 99, 99,
+		18, 21, 26, 66, 99, 99, 99, 99,
+		24, 26, 56, 99, 99, 99, 99, 99,
+		47, 66, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+		99, 99, 99, 99, 99, 99, 99, 99,
+	};
+
+	//The number of codes of each length from 1 to 16, then the values they stand for.
+	const unsigned char g_lumaDcBits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+	const unsigned char g_chromaDcBits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+	const unsigned char g_dcValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+	const unsigned char g_lumaAcBits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D};
+	const unsigned char g_lumaAcValues[162] =
+	{
+		0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+		0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+		0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+		0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+		0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+		0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+		0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+		0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+		0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+		0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+		0xF9, 0xFA,
+	};
+
+	const unsigned char g_chromaAcBits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+	const unsigned char g_chromaAcValues[162] =
+	{
+		0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+		0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0,
+		0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+		0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+		0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+		0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+		0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+		0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+		0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+		0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+		0xF9, 0xFA,
+	};
+
+	struct HuffmanTable
+	{
+		const unsigned char *bits;
+		const unsigned char *values;
+		unsigned short codes[256];
+		unsigned char lengths[256];
+
+		HuffmanTable(const unsigned char *tableBits, const unsigned char *tableValues)
+			: bits(tableBits), values(tableValues)
+		{
+			unsigned int code = 0;
+			int valueIx = 0;
+			for(int length = 1; length <= 16; ++length)
+			{
+				for(int codeIx = 0; codeIx < bits[length - 1]; ++codeIx)
+				{
+					codes[values[valueIx]] = (unsigned short)code;
+					lengths[values[valueIx]] = (unsigned char)length;
+					++code;
+					++valueIx;
+				}
+				code <<= 1;
+			}
+		}
+
+		int GetValueCount() const
+		{
+			int valueCount = 0;
+			for(int length = 0; length < 16; ++length)
+				valueCount += bits[length];
+			return valueCount;
+		}
+	};
+
+	//JPEG writes bits from the most significant end, and follows every 0xFF byte with a 0.
+	class JpegBitWriter
+	{
+	public:
+		explicit JpegBitWriter(ByteVector &bytes) : m_bytes(bytes), m_bitBuffer(0), m_bitCount(0) {}
+
+		void PutBits(unsigned int bits, int bitCount)
+		{
+			m_bitBuffer = (m_bitBuffer << bitCount) | (bits & ((1u << bitCount) - 1));
+			m_bitCount += bitCount;
+			while(m_bitCount >= 8)
+			{
+				unsigned char byte = (unsigned char)((m_bitBuffer >> (m_bitCount - 8)) & 0xFF);
+				m_bytes.push_back(byte);
+				if(byte == 0xFF)
+					m_bytes.push_back(0);
+				m_bitCount -= 8;
+			}
+		}
+
+		void PutCode(const HuffmanTable &table, int value)
+		{
+			PutBits(table.codes[value], table.lengths[value]);
+		}
+
+		//Pads with 1 bits.
+		void Flush()
+		{
+			if(m_bitCount > 0)
+				PutBits(0x7F, 8 - m_bitCount);
+		}
+
+	private:
+		ByteVector &m_bytes;
+		unsigned int m_bitBuffer;
+		int m_bitCount;
+	};
+
+	int GetBitLength(int value)
+	{
+		value = abs(value);
+		int bitLength = 0;
+		while(value)
+		{
+			++bitLength;
+			value >>= 1;
+		}
+		return bitLength;
+	}
+
+	class JpegEncoder
+	{
+	public:
+		JpegEncoder(ByteVector &jpeg, int quality)
+			: m_writer(jpeg)
+			, m_lumaDc(g_lumaDcBits, g_dcValues)
+			, m_lumaAc(g_lumaAcBits, g_lumaAcValues)
+			, m_chromaDc(g_chromaDcBits, g_dcValues)
+			, m_chromaAc(g_chromaAcBits, g_chromaAcValues)
+		{
+			quality = std::min(std::max(quality, 1), 100);
+			int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+			for(int coefIx = 0; coefIx < 64; ++coefIx)
+			{
+				m_lumaQuant[coefIx] = std::min(std::max((g_lumaQuant[coefIx] * scale + 50) / 100, 1), 255);
+				m_chromaQuant[coefIx] = std::min(std::max((g_chromaQuant[coefIx] * scale + 50) / 100, 1), 255);
+			}
+
+			for(int freq = 0; freq < 8; ++freq)
+			{
+				float norm = freq == 0 ? sqrtf(0.125f) : 0.5f;
+				for(int pos = 0; pos < 8; ++pos)
+					m_cosines[freq][pos] = norm * cosf((2 * pos + 1) * freq * 3.14159265f / 16.0f);
+			}
+		}
+
+		void PutTables(ByteVector &jpeg) const
+		{
+			jpeg.push_back(0xFF);
+			jpeg.push_back(0xDB);
+			PutUint16BE(jpeg, 2 + 2 * 65);
+			jpeg.push_back(0);
+			for(int coefIx = 0; coefIx < 64; ++coefIx)
+				jpeg.push_back((unsigned char)m_lumaQuant[g_zigzag[coefIx]]);
+			jpeg.push_back(1);
+			for(int coefIx = 0; coefIx < 64; ++coefIx)
+				jpeg.push_back((unsigned char)m_chromaQuant[g_zigzag[coefIx]]);
+
+			const HuffmanTable *tables[] = {&m_lumaDc, &m_lumaAc, &m_chromaDc, &m_chromaAc};
+			const unsigned char tableIds[] = {0x00, 0x10, 0x01, 0x11};
+			int segmentLength = 2;
+			for(int tableIx = 0; tableIx < 4; ++tableIx)
+				segmentLength += 17 + tables[tableIx]->GetValueCount();
+
+			jpeg.push_back(0xFF);
+			jpeg.push_back(0xC4);
+			PutUint16BE(jpeg, segmentLength);
+			for(int tableIx = 0; tableIx < 4; ++tableIx)
+			{
+				const HuffmanTable &table = *tables[tableIx];
+				jpeg.push_back(tableIds[tableIx]);
+				jpeg.insert(jpeg.end(), table.bits, table.bits + 16);
+				jpeg.insert(jpeg.end(), table.values, table.values + table.GetValueCount());
+			}
+		}
+
+		//samples are level-shifted, in rows.
+		void EncodeBlock(const float *samples, bool isLuma, int &prevDc)
+		{
+			float rowPass[64];
+			for(int row = 0; row < 8; ++row)
+			{
+				for(int freq = 0; freq < 8; ++freq)
+				{
+					float sum = 0.0f;
+					for(int col = 0; col < 8; ++col)
+						sum += m_cosines[freq][col] * samples[row * 8 + col];
+					rowPass[row * 8 + freq] = sum;
+				}
+			}
+
+			const int *quant = isLuma ? m_lumaQuant : m_chromaQuant;
+			int coefs[64];
+			for(int colFreq = 0; colFreq < 8; ++colFreq)
+			{
+				for(int rowFreq = 0; rowFreq < 8; ++rowFreq)
+				{
+					float sum = 0.0f;
+					for(int row = 0; row < 8; ++row)
+						sum += m_cosines[rowFreq][row] * rowPass[row * 8 + colFreq];
+					int coefIx = rowFreq * 8 + colFreq;
+					float quantized = sum / quant[coefIx];
+					coefs[coefIx] = (int)(quantized < 0.0f ? quantized - 0.5f : quantized + 0.5f);
+				}
+			}
+
+			const HuffmanTable &dcTable = isLuma ? m_lumaDc : m_chromaDc;
+			const HuffmanTable &acTable = isLuma ? m_lumaAc : m_chromaAc;
+
+			int dcDiff = coefs[0] - prevDc;
+			prevDc = coefs[0];
+			PutValue(dcTable, 0, dcDiff);
+
+			int zeroRun = 0;
+			for(int zigzagIx = 1; zigzagIx < 64; ++zigzagIx)
+			{
+				int coef = coefs[g_zigzag[zigzagIx]];
+				if(coef == 0)
+				{
+					++zeroRun;
+					continue;
+				}
+
+				while(zeroRun >= 16)
+				{
+					m_writer.PutCode(acTable, 0xF0);
+					zeroRun -= 16;
+				}
+				PutValue(acTable, zeroRun, coef);
+				zeroRun = 0;
+			}
+
+			if(zeroRun > 0)
+				m_writer.PutCode(acTable, 0x00);
+		}
+
+		void Flush() {m_writer.Flush();}
+
+	private:
+		JpegBitWriter m_writer;
+		HuffmanTable m_lumaDc;
+		HuffmanTable m_lumaAc;
+		HuffmanTable m_chromaDc;
+		HuffmanTable m_chromaAc;
+		int m_lumaQuant[64];
+		int m_chromaQuant[64];
+		float m_cosines[8][8];
+
+		void PutValue(const HuffmanTable &table, int zeroRun, int value)
+		{
+			int bitLength = GetBitLength(value);
+			m_writer.PutCode(table, (zeroRun << 4) | bitLength);
+			if(bitLength)
+				m_writer.PutBits(value < 0 ? value - 1 : value, bitLength);
+		}
+	};
+}
+
+bool WritePng( const std::string &filename, const std::vector<unsigned char> &pixels,
+	int width, int height )
+{
+	const int rowByteSize = width * 3;
+
+	ByteVector filtered;
+	filtered.reserve((rowByteSize + 1) * height);
+	for(int row = 0; row < height; ++row)
+	{
+		const unsigned char *pRow = &pixels[row * rowByteSize];
+		const unsigned char *pPrevRow = row > 0 ? pRow - rowByteSize : NULL;
+
+		filtered.push_back(4);
+		for(int byteIx = 0; byteIx < rowByteSize; ++byteIx)
+		{
+			int left = byteIx >= 3 ? pRow[byteIx - 3] : 0;
+			int up = pPrevRow ? pPrevRow[byteIx] : 0;
+			int upLeft = (pPrevRow && byteIx >= 3) ? pPrevRow[byteIx - 3] : 0;
+			filtered.push_back((unsigned char)(pRow[byteIx] - Paeth(left, up, upLeft)));
+		}
+	}
+
+	ByteVector png;
+	const unsigned char signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	png.insert(png.end(), signature, signature + sizeof(signature));
+
+	ByteVector header;
+	PutUint32BE(header, width);
+	PutUint32BE(header, height);
+	header.push_back(8);	//Bits per component.
+	header.push_back(2);	//RGB.
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+	PutPngChunk(png, "IHDR", header);
+	PutPngChunk(png, "IDAT", Deflate(filtered));
+	PutPngChunk(png, "IEND", ByteVector());
+
+	return WriteFile(filename, png);
+}
+
+bool WriteJpeg( const std::string &filename, const std::vector<unsigned char> &pixels,
+	int width, int height, int quality )
+{
+	ByteVector jpeg;
+	JpegEncoder encoder(jpeg, quality);
+
+	const unsigned char startOfImage[] = {0xFF, 0xD8};
+	jpeg.insert(jpeg.end(), startOfImage, startOfImage + 2);
+	encoder.PutTables(jpeg);
+
+	const unsigned char frameHeader[] = {0xFF, 0xC0, 0, 17, 8};
+	jpeg.insert(jpeg.end(), frameHeader, frameHeader + sizeof(frameHeader));
+	PutUint16BE(jpeg, height);
+	PutUint16BE(jpeg, width);
+	const unsigned char frameComponents[] = {3, 1, 0x22, 0, 2, 0x11, 1, 3, 0x11, 1};
+	jpeg.insert(jpeg.end(), frameComponents, frameComponents + sizeof(frameComponents));
+
+	const unsigned char scanHeader[] = {0xFF, 0xDA, 0, 12, 3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0};
+	jpeg.insert(jpeg.end(), scanHeader, scanHeader + sizeof(scanHeader));
+
+	//Each MCU is 16x16 pixels: four luma blocks, then one block each of Cb and Cr.
+	float lumaBlocks[4][64];
+	float cbBlock[64];
+	float crBlock[64];
+	int prevDcs[3] = {0, 0, 0};
+	for(int mcuY = 0; mcuY < height; mcuY += 16)
+	{
+		for(int mcuX = 0; mcuX < width; mcuX += 16)
+		{
+			std::fill(cbBlock, cbBlock + 64, 0.0f);
+			std::fill(crBlock, crBlock + 64, 0.0f);
+
+			for(int y = 0; y < 16; ++y)
+			{
+				int row = std::min(mcuY + y, height - 1);
+				for(int x = 0; x < 16; ++x)
+				{
+					int col = std::min(mcuX + x, width - 1);
+					const unsigned char *pPixel = &pixels[(row * width + col) * 3];
+					float red = pPixel[0];
+					float green = pPixel[1];
+					float blue = pPixel[2];
+
+					int blockIx = (y / 8) * 2 + (x / 8);
+					lumaBlocks[blockIx][(y % 8) * 8 + (x % 8)] =
+						0.299f * red + 0.587f * green + 0.114f * blue - 128.0f;
+
+					int chromaIx = (y / 2) * 8 + (x / 2);
+					cbBlock[chromaIx] += 0.25f * (-0.168736f * red - 0.331264f * green + 0.5f * blue);
+					crBlock[chromaIx] += 0.25f * (0.5f * red - 0.418688f * green - 0.081312f * blue);
+				}
+			}
+
+			for(int blockIx = 0; blockIx < 4; ++blockIx)
+				encoder.EncodeBlock(lumaBlocks[blockIx], true, prevDcs[0]);
+			encoder.EncodeBlock(cbBlock, false, prevDcs[1]);
+			encoder.EncodeBlock(crBlock, false, prevDcs[2]);
+		}
+	}
+
+	encoder.Flush();
+	jpeg.push_back(0xFF);
+	jpeg.push_back(0xD9);
+
+	return WriteFile(filename, jpeg);
+}
+
+bool WriteTga( const std::string &filename, const std::vector<unsigned char> &pixels,
+	int width, int height )
+{
+	ByteVector tga;
+	tga.push_back(0);	//No image ID.
+	tga.push_back(0);	//No color map.
+	tga.push_back(2);	//Uncompressed true-color.
+	tga.insert(tga.end(), 5, 0);
+	PutUint16LE(tga, 0);
+	PutUint16LE(tga, 0);
+	PutUint16LE(tga, width);
+	PutUint16LE(tga, height);
+	tga.push_back(24);
+	tga.push_back(0x20);	//Rows are stored from the top.
+
+	tga.reserve(tga.size() + pixels.size());
+	for(size_t pixelIx = 0; pixelIx < pixels.size(); pixelIx += 3)
+	{
+		tga.push_back(pixels[pixelIx + 2]);
+		tga.push_back(pixels[pixelIx + 1]);
+		tga.push_back(pixels[pixelIx]);
+	}
+
+	return WriteFile(filename, tga);
+}
@@ -0,0 +1,27 @@
+
+#ifndef TEST_IMAGE_ENCODERS_H
+#define TEST_IMAGE_ENCODERS_H
+
+#include <string>
+#include <vector>
+
+//Writers for the formats that glimg can only read, so that benchmarks can make their own input
+//files. They aim to produce files like those real encoders do, not small ones: PNGs use the
+//Paeth filter and fixed Huffman codes, and JPEGs are baseline, with 4:2:0 chroma subsampling
+//and the standard tables.
+//
+//Pixels are 8-bit RGB, with rows stored from top to bottom. Each returns false if the file
+//could not be written.
+
+bool WritePng(const std::string &filename, const std::vector<unsigned char> &pixels,
+	int width, int height);
+
+//quality is from 1 to 100, as for libjpeg.
+bool WriteJpeg(const std::string &filename, const std::vector<unsigned char> &pixels,
+	int width, int height, int quality);
+
+//Uncompressed.
+bool WriteTga(const std::string &filename, const std::vector<unsigned char> &pixels,
+	int width, int height);
+
+#endif //TEST_IMAGE_ENCODERS_H
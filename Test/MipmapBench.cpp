@@ -0,0 +1,177 @@
+/***********************************************************************
+Measures glimg::GenerateMipmaps against glGenerateMipmap for a 4096x4096
+sRGB texture. For each filter, the CPU path generates the mipmaps and
+uploads every level; the GPU path uploads the base level and has the
+driver generate the rest. Each is run a few times, and the fastest is
+kept.
+
+Runs once, prints the results and exits.
+***********************************************************************/
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <stdio.h>
+#include <glload/gl_3_3.h>
+#include <glimg/glimg.h>
+#include <glimg/ImageCreator.h>
+#include <glimg/MipmapGenerator.h>
+#include <glimg/ThreadPool.h>
+#include <GL/freeglut.h>
+#include "../framework/framework.h"
+#include "../framework/Clock.h"
+#include "BenchUtil.h"
+
+const int g_imageSize = 4096;
+const int g_numRuns = 3;
+const int g_numMipmaps = 13;
+
+glimg::ImageSet *CreateBaseImage()
+{
+	glimg::ImageFormat format(glimg::DT_NORM_UNSIGNED_INTEGER, glimg::FMT_COLOR_RGBA_sRGB,
+		glimg::ORDER_RGBA, glimg::BD_PER_COMP_8, 1);
+
+	//Fine checks over a gradient, so that the filters have detail to work on.
+	std::vector<unsigned char> pixels(g_imageSize * g_imageSize * 4);
+	for(int y = 0; y < g_imageSize; ++y)
+	{
+		for(int x = 0; x < g_imageSize; ++x)
+		{
+			unsigned char *pTexel = &pixels[(y * g_imageSize + x) * 4];
+			bool isLight = ((x / 3) + (y / 5)) % 2 == 0;
+			pTexel[0] = isLight ? 255 : (unsigned char)(x * 255 / g_imageSize);
+			pTexel[1] = isLight ? 255 : (unsigned char)(y * 255 / g_imageSize);
+			pTexel[2] = isLight ? 255 : 0;
+			pTexel[3] = (unsigned char)((x ^ y) & 0xFF);
+		}
+	}
+
+	glimg::ImageCreator creator(format, GetMipmapDims(g_imageSize, 0), 1, 1, 1);
+	creator.SetImageData(&pixels[0], false, 0);
+	return creator.CreateImage();
+}
+
+struct CpuTimes
+{
+	double generateMs;
+	double uploadMs;
+};
+
+CpuTimes TimeCpuMipmaps(const glimg::ImageSet &baseImage, glimg::MipmapFilter filter, int numThreads)
+{
+	CpuTimes bestTimes = {1.0e30, 1.0e30};
+	for(int runIx = 0; runIx < g_numRuns; ++runIx)
+	{
+		GLuint64 startNs = Framework::GetMonotonicTimeNs();
+		std::auto_ptr<glimg::ImageSet> pMipmapped(glimg::GenerateMipmaps(baseImage, filter, 0, numThreads));
+		double generateMs = ElapsedMs(startNs);
+
+		startNs = Framework::GetMonotonicTimeNs();
+		GLuint texture = glimg::CreateTexture(pMipmapped.get(), 0);
+		glFinish();
+		double uploadMs = ElapsedMs(startNs);
+		glDeleteTextures(1, &texture);
+
+		bestTimes.generateMs = std::min(bestTimes.generateMs, generateMs);
+		bestTimes.uploadMs = std::min(bestTimes.uploadMs, uploadMs);
+	}
+
+	return bestTimes;
+}
+
+struct GpuTimes
+{
+	double uploadMs;
+	double callMs;			//How long glGenerateMipmap blocks the calling thread.
+	double generateMs;		//Including waiting for it to finish.
+};
+
+GpuTimes TimeGpuMipmaps(const glimg::ImageSet &baseImage)
+{
+	GpuTimes bestTimes = {1.0e30, 1.0e30, 1.0e30};
+	for(int runIx = 0; runIx < g_numRuns; ++runIx)
+	{
+		GLuint64 startNs = Framework::GetMonotonicTimeNs();
+		GLuint texture = glimg::CreateTexture(&baseImage, 0);
+		glFinish();
+		double uploadMs = ElapsedMs(startNs);
+
+		//CreateTexture limits the texture to the mipmaps the image has.
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, g_numMipmaps - 1);
+		startNs = Framework::GetMonotonicTimeNs();
+		glGenerateMipmap(GL_TEXTURE_2D);
+		double callMs = ElapsedMs(startNs);
+
+		//Some drivers only generate the mipmaps when they are first used.
+		GLubyte smallestTexel[4];
+		glGetTexImage(GL_TEXTURE_2D, g_numMipmaps - 1, GL_RGBA, GL_UNSIGNED_BYTE, smallestTexel);
+		double generateMs = ElapsedMs(startNs);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glDeleteTextures(1, &texture);
+
+		bestTimes.uploadMs = std::min(bestTimes.uploadMs, uploadMs);
+		bestTimes.callMs = std::min(bestTimes.callMs, callMs);
+		bestTimes.generateMs = std::min(bestTimes.generateMs, generateMs);
+	}
+
+	return bestTimes;
+}
+
+void init()
+{
+	std::auto_ptr<glimg::ImageSet> pBaseImage(CreateBaseImage());
+
+	printf("%ix%i RGBA8 sRGB, best of %i runs, %i hardware threads.\n", g_imageSize, g_imageSize,
+		g_numRuns, glimg::GetHardwareThreadCount());
+	printf("%-28s %12s %12s %12s\n", "", "generate ms", "upload ms", "total ms");
+
+	const char *filterNames[] = {"box", "Kaiser", "Lanczos"};
+	for(int filterIx = 0; filterIx < 3; ++filterIx)
+	{
+		glimg::MipmapFilter filter = (glimg::MipmapFilter)filterIx;
+
+		CpuTimes threaded = TimeCpuMipmaps(*pBaseImage, filter, 0);
+		std::string name = std::string("glimg, ") + filterNames[filterIx];
+		printf("%-28s %12.1f %12.1f %12.1f\n", name.c_str(), threaded.generateMs,
+			threaded.uploadMs, threaded.generateMs + threaded.uploadMs);
+
+		CpuTimes singleThread = TimeCpuMipmaps(*pBaseImage, filter, 1);
+		name += ", 1 thread";
+		printf("%-28s %12.1f %12.1f %12.1f\n", name.c_str(), singleThread.generateMs,
+			singleThread.uploadMs, singleThread.generateMs + singleThread.uploadMs);
+	}
+
+	GpuTimes gpu = TimeGpuMipmaps(*pBaseImage);
+	printf("%-28s %12.1f %12.1f %12.1f\n", "glGenerateMipmap", gpu.generateMs, gpu.uploadMs,
+		gpu.generateMs + gpu.uploadMs);
+	printf("glGenerateMipmap blocked the calling thread for %.1f ms.\n", gpu.callMs);
+}
+
+void display()
+{
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	Framework::SwapBuffers();
+	Framework::LeaveMainLoop();
+}
+
+void reshape (int w, int h)
+{
+	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
+	Framework::PostRedisplay();
+}
+
+void keyboard(unsigned char key, int x, int y)
+{
+	switch (key)
+	{
+	case 27:
+		Framework::LeaveMainLoop();
+		return;
+	}
+}
+
+unsigned int defaults(unsigned int displayMode, int &width, int &height) {return displayMode;}
@@ -0,0 +1,530 @@
+/***********************************************************************
+Runs every tutorial headless and checks it for performance regressions.
+
+The tutorials are found from the "Tut *" directories and the projects
+their tutorials.lua files set up; each must already be built. Each runs
+for a fixed number of frames at a fixed size, on the fixed-step clock,
+and writes a report of its CPU and GPU frame-time percentiles and a
+checksum of its final frame (see framework/PerfReport.h). These are
+compared against a baseline file. The checksum must match exactly; the
+times may be slower than the baseline by the given tolerances.
+
+Baselines are specific to a machine and its OpenGL implementation, so
+none is shipped. Make one with --update-baseline.
+
+Usage: "Perf Runner" [options] [name filters...]
+  --root=dir             Where the "Tut *" directories are. Default "..".
+  --baseline=file        Default "perf_baseline.txt".
+  --update-baseline      Write the results into the baseline file.
+  --frames=N             Frames to run each tutorial for. Default 200.
+  --warmup=N             Frames left out of the percentiles. Default 10.
+  --size=WxH             Default 500x500.
+  --cpu-tolerance=F      Allowed slowdown, as a fraction. Default 0.25.
+  --gpu-tolerance=F      Default 0.25.
+  --min-delta-ms=F       Slowdowns smaller than this are ignored. Default 0.1.
+  --no-checksum          Do not compare the final frames.
+  --software             Ask Mesa for its software renderer.
+  --debug                Run the Debug builds.
+
+Only tutorials whose names contain one of the filters run, if any are
+given. Exits with 1 if a tutorial failed or regressed.
+***********************************************************************/
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif //WIN32
+
+#ifdef LOAD_X11
+#include <dirent.h>
+#endif //LOAD_X11
+
+struct Options
+{
+	std::string rootDir;
+	std::string baselineFilename;
+	bool shouldUpdateBaseline;
+	int numFrames;
+	int numWarmupFrames;
+	std::string size;
+	double cpuTolerance;
+	double gpuTolerance;
+	double minDeltaMs;
+	bool shouldCompareChecksums;
+	bool isSoftware;
+	bool isDebug;
+	std::vector<std::string> filters;
+};
+
+struct Tutorial
+{
+	std::string dirName;
+	std::string projName;
+};
+
+const int NUM_PERCENTILES = 3;
+const char *g_percentileNames[NUM_PERCENTILES] = {"p50", "p95", "p99"};
+
+struct PerfResult
+{
+	int numFrames;
+	std::string size;
+	std::string checksum;
+	double cpuMs[NUM_PERCENTILES];
+	double gpuMs[NUM_PERCENTILES];
+};
+
+typedef std::map<std::string, PerfResult> ResultMap;
+
+const char *g_reportFilename = "perf_report.txt";
+const char *g_logFilename = "perf_run.log";
+
+bool StartsWith(const std::string &str, const std::string &prefix)
+{
+	return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool ParseOptions(int argc, char **argv, Options &options)
+{
+	options.rootDir = "..";
+	options.baselineFilename = "perf_baseline.txt";
+	options.shouldUpdateBaseline = false;
+	options.numFrames = 200;
+	options.numWarmupFrames = 10;
+	options.size = "500x500";
+	options.cpuTolerance = 0.25;
+	options.gpuTolerance = 0.25;
+	options.minDeltaMs = 0.1;
+	options.shouldCompareChecksums = true;
+	options.isSoftware = false;
+	options.isDebug = false;
+
+	for(int argIx = 1; argIx < argc; ++argIx)
+	{
+		std::string arg = argv[argIx];
+		std::string value = arg.substr(arg.find('=') + 1);
+
+		if(StartsWith(arg, "--root="))
+			options.rootDir = value;
+		else if(StartsWith(arg, "--baseline="))
+			options.baselineFilename = value;
+		else if(arg == "--update-baseline")
+			options.shouldUpdateBaseline = true;
+		else if(StartsWith(arg, "--frames="))
+			options.numFrames = atoi(value.c_str());
+		else if(StartsWith(arg, "--warmup="))
+			options.numWarmupFrames = atoi(value.c_str());
+		else if(StartsWith(arg, "--size="))
+			options.size = value;
+		else if(StartsWith(arg, "--cpu-tolerance="))
+			options.cpuTolerance = atof(value.c_str());
+		else if(StartsWith(arg, "--gpu-tolerance="))
+			options.gpuTolerance = atof(value.c_str());
+		else if(StartsWith(arg, "--min-delta-ms="))
+			options.minDeltaMs = atof(value.c_str());
+		else if(arg == "--no-checksum")
+			options.shouldCompareChecksums = false;
+		else if(arg == "--software")
+			options.isSoftware = true;
+		else if(arg == "--debug")
+			options.isDebug = true;
+		else if(StartsWith(arg, "--"))
+		{
+			fprintf(stderr, "Unknown option %s\n", arg.c_str());
+			return false;
+		}
+		else
+			options.filters.push_back(arg);
+	}
+
+	if(options.numFrames <= options.numWarmupFrames)
+	{
+		fprintf(stderr, "--frames must be more than --warmup.\n");
+		return false;
+	}
+
+	return true;
+}
+
+std::vector<std::string> ListDirectories(const std::string &dirName)
+{
+	std::vector<std::string> dirNames;
+
+#ifdef WIN32
+	WIN32_FIND_DATAA findData;
+	HANDLE hFind = FindFirstFileA((dirName + "\\*").c_str(), &findData);
+	if(hFind != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			if(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+				dirNames.push_back(findData.cFileName);
+		} while(FindNextFileA(hFind, &findData));
+
+		FindClose(hFind);
+	}
+#endif //WIN32
+
+#ifdef LOAD_X11
+	if(DIR *pDir = opendir(dirName.c_str()))
+	{
+		while(dirent *pEntry = readdir(pDir))
+		{
+			if(pEntry->d_type == DT_DIR || pEntry->d_type == DT_UNKNOWN)
+				dirNames.push_back(pEntry->d_name);
+		}
+
+		closedir(pDir);
+	}
+#endif //LOAD_X11
+
+	std::sort(dirNames.begin(), dirNames.end());
+	return dirNames;
+}
+
+//Every SetupProject("name", ...) in the tutorial's tutorials.lua.
+std::vector<std::string> GetProjectNames(const std::string &luaFilename)
+{
+	std::vector<std::string> projNames;
+
+	std::ifstream luaFile(luaFilename.c_str());
+	std::stringstream text;
+	text << luaFile.rdbuf();
+	std::string luaText = text.str();
+
+	const std::string setupCall = "SetupProject(";
+	for(size_t callIx = luaText.find(setupCall); callIx != std::string::npos;
+		callIx = luaText.find(setupCall, callIx + 1))
+	{
+		size_t openIx = luaText.find('"', callIx);
+		size_t closeIx = openIx == std::string::npos ? openIx : luaText.find('"', openIx + 1);
+		if(closeIx != std::string::npos)
+			projNames.push_back(luaText.substr(openIx + 1, closeIx - openIx - 1));
+	}
+
+	return projNames;
+}
+
+bool MatchesFilters(const std::string &projName, const std::vector<std::string> &filters)
+{
+	if(filters.empty())
+		return true;
+
+	for(size_t filterIx = 0; filterIx < filters.size(); ++filterIx)
+	{
+		if(projName.find(filters[filterIx]) != std::string::npos)
+			return true;
+	}
+
+	return false;
+}
+
+std::vector<Tutorial> FindTutorials(const Options &options)
+{
+	std::vector<Tutorial> tutorials;
+
+	std::vector<std::string> dirNames = ListDirectories(options.rootDir);
+	for(size_t dirIx = 0; dirIx < dirNames.size(); ++dirIx)
+	{
+		if(!StartsWith(dirNames[dirIx], "Tut "))
+			continue;
+
+		std::vector<std::string> projNames =
+			GetProjectNames(options.rootDir + "/" + dirNames[dirIx] + "/tutorials.lua");
+		for(size_t projIx = 0; projIx < projNames.size(); ++projIx)
+		{
+			if(!MatchesFilters(projNames[projIx], options.filters))
+				continue;
+
+			Tutorial tutorial;
+			tutorial.dirName = dirNames[dirIx];
+			tutorial.projName = projNames[projIx];
+			tutorials.push_back(tutorial);
+		}
+	}
+
+	return tutorials;
+}
+
+void SetEnv(const char *name, const std::string &value)
+{
+#ifdef WIN32
+	_putenv_s(name, value.c_str());
+#endif //WIN32
+#ifdef LOAD_X11
+	setenv(name, value.c_str(), 1);
+#endif //LOAD_X11
+}
+
+bool FileExists(const std::string &filename)
+{
+	FILE *pFile = fopen(filename.c_str(), "rb");
+	if(!pFile)
+		return false;
+
+	fclose(pFile);
+	return true;
+}
+
+bool ReadReport(const std::string &filename, PerfResult &result)
+{
+	std::ifstream reportFile(filename.c_str());
+	if(!reportFile)
+		return false;
+
+	std::map<std::string, std::string> values;
+	std::string key;
+	std::string value;
+	while(reportFile >> key >> value)
+		values[key] = value;
+
+	if(values.find("checksum") == values.end())
+		return false;
+
+	result.numFrames = atoi(values["frames"].c_str());
+	result.size = values["width"] + "x" + values["height"];
+	result.checksum = values["checksum"];
+	for(int pctIx = 0; pctIx < NUM_PERCENTILES; ++pctIx)
+	{
+		std::string suffix = std::string("_") + g_percentileNames[pctIx] + "_ms";
+		result.cpuMs[pctIx] = atof(values["cpu" + suffix].c_str());
+		result.gpuMs[pctIx] = atof(values["gpu" + suffix].c_str());
+	}
+
+	return true;
+}
+
+//Returns false if the tutorial is not built, or did not write a report.
+bool RunTutorial(const Options &options, const Tutorial &tutorial, PerfResult &result,
+				 std::string &error)
+{
+	std::string dirPath = options.rootDir + "/" + tutorial.dirName;
+	std::string exeName = tutorial.projName + (options.isDebug ? "D" : "");
+
+	std::ostringstream command;
+#ifdef WIN32
+	exeName += ".exe";
+	command << "cd /d \"" << dirPath << "\" && \"" << exeName << "\"";
+#endif //WIN32
+#ifdef LOAD_X11
+	command << "cd \"" << dirPath << "\" && \"./" << exeName << "\"";
+#endif //LOAD_X11
+	command << " --headless=" << options.numFrames << " > " << g_logFilename << " 2>&1";
+
+	if(!FileExists(dirPath + "/" + exeName))
+	{
+		error = "not built";
+		return false;
+	}
+
+	std::string reportPath = dirPath + "/" + g_reportFilename;
+	remove(reportPath.c_str());
+
+	fflush(stdout);
+	int exitCode = system(command.str().c_str());
+
+	if(exitCode != 0 || !ReadReport(reportPath, result))
+	{
+		error = "failed; see " + dirPath + "/" + g_logFilename;
+		return false;
+	}
+
+	remove(reportPath.c_str());
+	remove((dirPath + "/" + g_logFilename).c_str());
+	return true;
+}
+
+ResultMap ReadBaseline(const std::string &filename)
+{
+	ResultMap baseline;
+
+	std::ifstream baselineFile(filename.c_str());
+	std::string line;
+	while(std::getline(baselineFile, line))
+	{
+		if(line.empty() || line[0] == '#')
+			continue;
+
+		std::istringstream fields(line);
+		std::string projName;
+		std::getline(fields, projName, '\t');
+
+		PerfResult result;
+		fields >> result.numFrames >> result.size >> result.checksum;
+		for(int pctIx = 0; pctIx < NUM_PERCENTILES; ++pctIx)
+			fields >> result.cpuMs[pctIx];
+		for(int pctIx = 0; pctIx < NUM_PERCENTILES; ++pctIx)
+			fields >> result.gpuMs[pctIx];
+
+		if(fields)
+			baseline[projName] = result;
+	}
+
+	return baseline;
+}
+
+bool WriteBaseline(const std::string &filename, const ResultMap &baseline)
+{
+	FILE *pFile = fopen(filename.c_str(), "w");
+	if(!pFile)
+		return false;
+
+	fprintf(pFile, "#name\tframes\tsize\tchecksum\tcpu p50/p95/p99 ms\tgpu p50/p95/p99 ms\n");
+	for(ResultMap::const_iterator resultIt = baseline.begin(); resultIt != baseline.end(); ++resultIt)
+	{
+		const PerfResult &result = resultIt->second;
+		fprintf(pFile, "%s\t%d\t%s\t%s", resultIt->first.c_str(), result.numFrames,
+			result.size.c_str(), result.checksum.c_str());
+		for(int pctIx = 0; pctIx < NUM_PERCENTILES; ++pctIx)
+			fprintf(pFile, "\t%f", result.cpuMs[pctIx]);
+		for(int pctIx = 0; pctIx < NUM_PERCENTILES; ++pctIx)
+			fprintf(pFile, "\t%f", result.gpuMs[pctIx]);
+		fprintf(pFile, "\n");
+	}
+
+	fclose(pFile);
+	return true;
+}
+
+//p99 is too noisy over a few hundred frames to fail a run on.
+const int NUM_COMPARED_PERCENTILES = 2;
+
+void CompareTimes(const char *name, const double *times, const double *baseTimes,
+				  double tolerance, double minDeltaMs, std::vector<std::string> &problems)
+{
+	for(int pctIx = 0; pctIx < NUM_COMPARED_PERCENTILES; ++pctIx)
+	{
+		double deltaMs = times[pctIx] - baseTimes[pctIx];
+		if(deltaMs > minDeltaMs && times[pctIx] > baseTimes[pctIx] * (1.0 + tolerance))
+		{
+			char problem[128];
+			sprintf(problem, "%s %s %.3fms, was %.3fms", name, g_percentileNames[pctIx],
+				times[pctIx], baseTimes[pctIx]);
+			problems.push_back(problem);
+		}
+	}
+}
+
+std::vector<std::string> Compare(const Options &options, const PerfResult &result,
+								 const PerfResult &baseResult)
+{
+	std::vector<std::string> problems;
+
+	if(result.numFrames != baseResult.numFrames || result.size != baseResult.size)
+	{
+		problems.push_back("the baseline was run with different --frames or --size");
+		return problems;
+	}
+
+	if(options.shouldCompareChecksums && result.checksum != baseResult.checksum)
+		problems.push_back("final frame differs, was " + baseResult.checksum);
+
+	CompareTimes("cpu", result.cpuMs, baseResult.cpuMs, options.cpuTolerance,
+		options.minDeltaMs, problems);
+	CompareTimes("gpu", result.gpuMs, baseResult.gpuMs, options.gpuTolerance,
+		options.minDeltaMs, problems);
+	return problems;
+}
+
+int main(int argc, char **argv)
+{
+	Options options;
+	if(!ParseOptions(argc, argv, options))
+		return 1;
+
+	std::vector<Tutorial> tutorials = FindTutorials(options);
+	if(tutorials.empty())
+	{
+		fprintf(stderr, "No tutorials found in %s\n", options.rootDir.c_str());
+		return 1;
+	}
+
+	std::ostringstream warmupStr;
+	warmupStr << options.numWarmupFrames;
+	SetEnv("GLTUT_PERF_REPORT", g_reportFilename);
+	SetEnv("GLTUT_PERF_WARMUP", warmupStr.str());
+	SetEnv("GLTUT_WINDOW_SIZE", options.size);
+	SetEnv("GLTUT_FIXED_STEP", "0.0166666666666667");
+	if(options.isSoftware)
+	{
+		SetEnv("LIBGL_ALWAYS_SOFTWARE", "1");
+		SetEnv("GALLIUM_DRIVER", "llvmpipe");
+	}
+
+	ResultMap baseline = ReadBaseline(options.baselineFilename);
+	if(baseline.empty() && !options.shouldUpdateBaseline)
+		printf("No baseline in %s; only reporting times.\n", options.baselineFilename.c_str());
+
+	int numFailed = 0;
+	int numRegressed = 0;
+	int numSkipped = 0;
+
+	printf("%-40s %-26s %-26s %s\n", "Tutorial", "CPU p50/p95/p99 ms", "GPU p50/p95/p99 ms",
+		"Result");
+	for(size_t tutIx = 0; tutIx < tutorials.size(); ++tutIx)
+	{
+		const Tutorial &tutorial = tutorials[tutIx];
+
+		PerfResult result;
+		std::string error;
+		if(!RunTutorial(options, tutorial, result, error))
+		{
+			printf("%-40s %s\n", tutorial.projName.c_str(), error.c_str());
+			if(error == "not built")
+				++numSkipped;
+			else
+				++numFailed;
+			continue;
+		}
+
+		char cpuStr[64];
+		char gpuStr[64];
+		sprintf(cpuStr, "%.3f/%.3f/%.3f", result.cpuMs[0], result.cpuMs[1], result.cpuMs[2]);
+		sprintf(gpuStr, "%.3f/%.3f/%.3f", result.gpuMs[0], result.gpuMs[1], result.gpuMs[2]);
+		printf("%-40s %-26s %-26s ", tutorial.projName.c_str(), cpuStr, gpuStr);
+
+		ResultMap::const_iterator baseIt = baseline.find(tutorial.projName);
+		if(options.shouldUpdateBaseline)
+		{
+			baseline[tutorial.projName] = result;
+			printf("recorded\n");
+		}
+		else if(baseIt == baseline.end())
+		{
+			printf("no baseline\n");
+		}
+		else
+		{
+			std::vector<std::string> problems = Compare(options, result, baseIt->second);
+			if(problems.empty())
+				printf("ok\n");
+			else
+			{
+				printf("REGRESSED\n");
+				for(size_t problemIx = 0; problemIx < problems.size(); ++problemIx)
+					printf("    %s\n", problems[problemIx].c_str());
+				++numRegressed;
+			}
+		}
+	}
+
+	if(options.shouldUpdateBaseline && !WriteBaseline(options.baselineFilename, baseline))
+	{
+		fprintf(stderr, "Could not write %s\n", options.baselineFilename.c_str());
+		return 1;
+	}
+
+	printf("%d run, %d regressed, %d failed, %d not built.\n",
+		(int)tutorials.size() - numFailed - numSkipped, numRegressed, numFailed, numSkipped);
+	return (numFailed || numRegressed) ? 1 : 0;
+}
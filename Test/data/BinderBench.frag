@@ -0,0 +1,16 @@
+#version 330
+
+uniform vec4 baseColor;
+uniform vec4 tint;
+uniform vec4 nodeColor;
+uniform float intensity;
+uniform float fade;
+uniform int mode;
+
+out vec4 outputColor;
+
+void main()
+{
+	vec4 color = mode == 1 ? nodeColor * tint : baseColor;
+	outputColor = mix(color * intensity, baseColor, fade);
+}
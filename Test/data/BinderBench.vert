@@ -0,0 +1,15 @@
+#version 330
+
+layout(location = 0) in vec3 position;
+
+uniform mat4 cameraToClipMatrix;
+uniform mat4 modelToCameraMatrix;
+uniform mat4 extraMatrix;
+uniform vec3 offset;
+uniform vec2 scale;
+
+void main()
+{
+	vec4 modelPos = extraMatrix * vec4(position * vec3(scale, 1.0) + offset, 1.0);
+	gl_Position = cameraToClipMatrix * (modelToCameraMatrix * modelPos);
+}
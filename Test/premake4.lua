@@ -3,3 +3,9 @@ dofile("../framework/framework.lua")
 
 SetupSolution("Test")
 SetupProject("Test", "test.cpp")
+SetupProject("Binder Bench", "BinderBench.cpp")
+SetupProject("Perf Runner", "PerfRunner.cpp")
+SetupProject("Mipmap Bench", "MipmapBench.cpp", "BenchUtil.cpp", "BenchUtil.h")
+SetupProject("Flip Bench", "FlipBench.cpp", "BenchUtil.cpp", "BenchUtil.h")
+SetupProject("Convert Bench", "ConvertBench.cpp", "BenchUtil.cpp", "BenchUtil.h")
+SetupProject("Decode Bench", "DecodeBench.cpp", "BenchUtil.cpp", "BenchUtil.h", "ImageEncoders.cpp", "ImageEncoders.h")
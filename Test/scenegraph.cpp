@@ -13,6 +13,7 @@
 #include "../framework/Timer.h"
 #include "../framework/UniformBlockArray.h"
 #include "../framework/directories.h"
+#include "../framework/ResourceFS.h"
 #include "../framework/MousePole.h"
 #include "../framework/Interpolators.h"
 #include "../framework/Scene.h"
@@ -139,9 +140,7 @@ void LoadTextures()
 {
 	try
 	{
-		std::string filename(Framework::FindFileOrThrow("terrain_tex.dds"));
-
-		std::auto_ptr<glimg::ImageSet> pImageSet(glimg::loaders::dds::LoadFromFile(filename.c_str()));
+		std::auto_ptr<glimg::ImageSet> pImageSet(Framework::LoadImageResource("terrain_tex.dds"));
 
 		glGenTextures(1, &g_linearTexture);
 		glBindTexture(GL_TEXTURE_2D, g_linearTexture);
@@ -246,9 +245,9 @@ void LoadAndSetupScene()
 //Called after the window and OpenGL are initialized. Called exactly once, before the main loop.
 void init()
 {
-	glutMouseFunc(MouseButton);
-	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+	Framework::SetMouseFunc(MouseButton);
+	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -305,8 +304,8 @@ int g_currSampler = 0;
 bool g_bDrawCameraPos = false;
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	if(!g_pScene)
@@ -424,8 +423,8 @@ void display()
 
 	*/
 
-    glutPostRedisplay();
-	glutSwapBuffers();
+    Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -443,13 +442,13 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -458,7 +457,7 @@ void keyboard(unsigned char key, int x, int y)
 	case 27:
 		delete g_pScene;
 		g_pScene = NULL;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 	case 32:
 		g_nodes[0].NodeSetTrans(glm::vec3(0.0f, 0.0f, 0.0f));
@@ -15,12 +15,12 @@ void init()
 }
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 
-	glutSwapBuffers();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -32,7 +32,7 @@ void reshape (int w, int h)
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -7,6 +7,7 @@
 #include <glload/gl_3_3.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/Clock.h"
 
 GLuint theProgram;
 GLuint elapsedTimeUniform;
@@ -62,8 +63,8 @@ void init()
 }
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
@@ -71,7 +72,7 @@ void display()
 
 	glUseProgram(theProgram);
 
-	glUniform1f(elapsedTimeUniform, glutGet(GLUT_ELAPSED_TIME) / 1000.0f);
+	glUniform1f(elapsedTimeUniform, (float)Framework::GetClock().GetTime());
 
 	glBindBuffer(GL_ARRAY_BUFFER, positionBufferObject);
 	glEnableVertexAttribArray(0);
@@ -82,8 +83,8 @@ void display()
 	glDisableVertexAttribArray(0);
 	glUseProgram(0);
 
-	glutSwapBuffers();
-	glutPostRedisplay();
+	Framework::SwapBuffers();
+	Framework::PostRedisplay();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -95,14 +96,14 @@ void reshape (int w, int h)
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
 	switch (key)
 	{
 	case 27:
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 	}
 }
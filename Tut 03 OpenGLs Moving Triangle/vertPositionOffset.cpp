@@ -7,6 +7,7 @@
 #include <glload/gl_3_3.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/Clock.h"
 
 GLuint theProgram;
 GLuint offsetLocation;
@@ -58,7 +59,7 @@ void ComputePositionOffsets(float &fXOffset, float &fYOffset)
 	const float fLoopDuration = 5.0f;
 	const float fScale = 3.14159f * 2.0f / fLoopDuration;
 
-	float fElapsedTime = glutGet(GLUT_ELAPSED_TIME) / 1000.0f;
+	float fElapsedTime = (float)Framework::GetClock().GetTime();
 
 	float fCurrTimeThroughLoop = fmodf(fElapsedTime, fLoopDuration);
 
@@ -67,8 +68,8 @@ void ComputePositionOffsets(float &fXOffset, float &fYOffset)
 }
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	float fXOffset = 0.0f, fYOffset = 0.0f;
@@ -90,8 +91,8 @@ void display()
 	glDisableVertexAttribArray(0);
 	glUseProgram(0);
 
-	glutSwapBuffers();
-	glutPostRedisplay();
+	Framework::SwapBuffers();
+	Framework::PostRedisplay();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -103,14 +104,14 @@ void reshape (int w, int h)
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
 	switch (key)
 	{
 	case 27:
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 	}
 }
@@ -13,6 +13,7 @@
 #include <glload/gl_3_3.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/Clock.h"
 
 #define ARRAY_COUNT( array ) (sizeof( array ) / (sizeof( array[0] ) * (sizeof( array ) != sizeof(void*) || sizeof( array[0] ) <= sizeof(void*))))
 
@@ -152,7 +153,7 @@ float CalcZOFfset()
 	const float fLoopDuration = 5.0f;
 	const float fScale = 3.14159f * 2.0f / fLoopDuration;
 
-	float fElapsedTime = glutGet(GLUT_ELAPSED_TIME) / 1000.0f;
+	float fElapsedTime = (float)Framework::GetClock().GetTime();
 
 	float fCurrTimeThroughLoop = fmodf(fElapsedTime, fLoopDuration);
 
@@ -165,8 +166,8 @@ float CalcZOFfset()
 volatile bool bReadBuffer = false;
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
@@ -183,7 +184,7 @@ void display()
 	glBindVertexArray(0);
 	glUseProgram(0);
 
-	glutSwapBuffers();
+	Framework::SwapBuffers();
 
 	//Read the backbuffer.
 	if(bReadBuffer)
@@ -271,14 +272,14 @@ void reshape (int w, int h)
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
 	switch (key)
 	{
 	case 27:
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 	case 32:
 		{
@@ -339,7 +340,7 @@ void keyboard(unsigned char key, int x, int y)
 	}
 
 	printf("%f\n", fDelta);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 unsigned int defaults(unsigned int displayMode, int &width, int &height) {return displayMode;}
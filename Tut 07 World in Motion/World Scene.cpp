@@ -457,8 +457,8 @@ glm::vec3 ResolveCamPosition()
 }
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
@@ -526,7 +526,7 @@ void display()
 		}
 	}
 
-	glutSwapBuffers();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -545,12 +545,12 @@ void reshape (int w, int h)
 	glUseProgram(0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -567,7 +567,7 @@ void keyboard(unsigned char key, int x, int y)
 		g_pCubeColorMesh = NULL;
 		delete g_pPlaneMesh;
 		g_pPlaneMesh = NULL;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 	case 'w': g_camTarget.z -= 4.0f; break;
 	case 's': g_camTarget.z += 4.0f; break;
@@ -605,7 +605,7 @@ void keyboard(unsigned char key, int x, int y)
 	g_camTarget.y = g_camTarget.y > 0.0f ? g_camTarget.y : 0.0f;
 	g_sphereCamRelPos.z = g_sphereCamRelPos.z > 5.0f ? g_sphereCamRelPos.z : 5.0f;
 
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
@@ -103,21 +103,21 @@ namespace
 	{
 		Framework::ForwardMouseMotion(g_viewPole, x, y);
 		Framework::ForwardMouseMotion(g_objtPole, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseButton(int button, int state, int x, int y)
 	{
 		Framework::ForwardMouseButton(g_viewPole, button, state, x, y);
 		Framework::ForwardMouseButton(g_objtPole, button, state, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseWheel(int wheel, int direction, int x, int y)
 	{
 		Framework::ForwardMouseWheel(g_viewPole, wheel, direction, x, y);
 		Framework::ForwardMouseWheel(g_objtPole, wheel, direction, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 }
 
@@ -145,9 +145,9 @@ void init()
 		throw;
 	}
 
- 	glutMouseFunc(MouseButton);
- 	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+ 	Framework::SetMouseFunc(MouseButton);
+ 	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -176,8 +176,8 @@ static bool g_bDrawColoredCyl = true;
 static bool g_bShowAmbient = false; 
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 
 void display()
 {
@@ -260,7 +260,7 @@ void display()
 		}
 	}
 
-	glutSwapBuffers();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -278,12 +278,12 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -292,7 +292,7 @@ void keyboard(unsigned char key, int x, int y)
 	case 27:
 		delete g_pPlaneMesh;
 		delete g_pCylinderMesh;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 
 	case 32:
@@ -310,7 +310,7 @@ void keyboard(unsigned char key, int x, int y)
 		break;
 	}
 
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
@@ -7,6 +7,7 @@
 #include <glutil/glutil.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/ProgramBatch.h"
 #include "../framework/Mesh.h"
 #include "../framework/MousePole.h"
 #include "../framework/Timer.h"
@@ -51,15 +52,10 @@ const int g_projectionBlockIndex = 2;
 const int g_unprojectionBlockIndex = 1;
 
 
-UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+UnlitProgData LoadUnlitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	UnlitProgData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.objectColorUnif = glGetUniformLocation(data.theProgram, "objectColor");
 
@@ -69,15 +65,10 @@ UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::st
 	return data;
 }
 
-ProgramData LoadLitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+ProgramData LoadLitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.lightIntensityUnif = glGetUniformLocation(data.theProgram, "lightIntensity");
 	data.ambientIntensityUnif = glGetUniformLocation(data.theProgram, "ambientIntensity");
@@ -98,10 +89,17 @@ ProgramData LoadLitProgram(const std::string &strVertexShader, const std::string
 
 void InitializePrograms()
 {
-	g_FragWhiteDiffuseColor = LoadLitProgram("FragLightAtten_PN.vert", "FragLightAtten.frag");
-	g_FragVertexDiffuseColor = LoadLitProgram("FragLightAtten_PCN.vert", "FragLightAtten.frag");
+	Framework::ProgramBatch programBatch;
+	GLuint fragWhiteDiffuseColor = programBatch.CreateProgram("FragLightAtten_PN.vert", "FragLightAtten.frag");
+	GLuint fragVertexDiffuseColor = programBatch.CreateProgram("FragLightAtten_PCN.vert", "FragLightAtten.frag");
+
+	GLuint unlit = programBatch.CreateProgram("PosTransform.vert", "UniformColor.frag");
+	programBatch.Finish();
+
+	g_FragWhiteDiffuseColor = LoadLitProgram(fragWhiteDiffuseColor);
+	g_FragVertexDiffuseColor = LoadLitProgram(fragVertexDiffuseColor);
 
-	g_Unlit = LoadUnlitProgram("PosTransform.vert", "UniformColor.frag");
+	g_Unlit = LoadUnlitProgram(unlit);
 }
 
 Framework::Mesh *g_pCylinderMesh = NULL;
@@ -143,21 +141,21 @@ namespace
 	{
 		Framework::ForwardMouseMotion(g_viewPole, x, y);
 		Framework::ForwardMouseMotion(g_objtPole, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseButton(int button, int state, int x, int y)
 	{
 		Framework::ForwardMouseButton(g_viewPole, button, state, x, y);
 		Framework::ForwardMouseButton(g_objtPole, button, state, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseWheel(int wheel, int direction, int x, int y)
 	{
 		Framework::ForwardMouseWheel(g_viewPole, wheel, direction, x, y);
 		Framework::ForwardMouseWheel(g_objtPole, wheel, direction, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 }
 
@@ -192,9 +190,9 @@ void init()
 		throw;
 	}
 
- 	glutMouseFunc(MouseButton);
- 	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+ 	Framework::SetMouseFunc(MouseButton);
+ 	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -255,8 +253,8 @@ static bool g_bUseRSquare = false;
 static float g_fLightAttenuation = 1.0f;
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 
 void display()
 {
@@ -361,8 +359,8 @@ void display()
 		}
 	}
 
-	glutPostRedisplay();
-	glutSwapBuffers();
+	Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -386,12 +384,12 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -403,7 +401,7 @@ void keyboard(unsigned char key, int x, int y)
 		delete g_pPlaneMesh;
 		delete g_pCylinderMesh;
 		delete g_pCubeMesh;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 		
 	case 32:
@@ -7,6 +7,7 @@
 #include <glutil/glutil.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/ProgramBatch.h"
 #include "../framework/Mesh.h"
 #include "../framework/MousePole.h"
 #include "../framework/Timer.h"
@@ -46,15 +47,10 @@ UnlitProgData g_Unlit;
 
 const int g_projectionBlockIndex = 2;
 
-UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+UnlitProgData LoadUnlitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	UnlitProgData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.objectColorUnif = glGetUniformLocation(data.theProgram, "objectColor");
 
@@ -64,15 +60,10 @@ UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::st
 	return data;
 }
 
-ProgramData LoadLitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+ProgramData LoadLitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.modelSpaceLightPosUnif = glGetUniformLocation(data.theProgram, "modelSpaceLightPos");
 	data.lightIntensityUnif = glGetUniformLocation(data.theProgram, "lightIntensity");
@@ -86,12 +77,21 @@ ProgramData LoadLitProgram(const std::string &strVertexShader, const std::string
 
 void InitializePrograms()
 {
-	g_WhiteDiffuseColor = LoadLitProgram("ModelPosVertexLighting_PN.vert", "ColorPassthrough.frag");
-	g_VertexDiffuseColor = LoadLitProgram("ModelPosVertexLighting_PCN.vert", "ColorPassthrough.frag");
-	g_FragWhiteDiffuseColor = LoadLitProgram("FragmentLighting_PN.vert", "FragmentLighting.frag");
-	g_FragVertexDiffuseColor = LoadLitProgram("FragmentLighting_PCN.vert", "FragmentLighting.frag");
+	Framework::ProgramBatch programBatch;
+	GLuint whiteDiffuseColor = programBatch.CreateProgram("ModelPosVertexLighting_PN.vert", "ColorPassthrough.frag");
+	GLuint vertexDiffuseColor = programBatch.CreateProgram("ModelPosVertexLighting_PCN.vert", "ColorPassthrough.frag");
+	GLuint fragWhiteDiffuseColor = programBatch.CreateProgram("FragmentLighting_PN.vert", "FragmentLighting.frag");
+	GLuint fragVertexDiffuseColor = programBatch.CreateProgram("FragmentLighting_PCN.vert", "FragmentLighting.frag");
+
+	GLuint unlit = programBatch.CreateProgram("PosTransform.vert", "UniformColor.frag");
+	programBatch.Finish();
+
+	g_WhiteDiffuseColor = LoadLitProgram(whiteDiffuseColor);
+	g_VertexDiffuseColor = LoadLitProgram(vertexDiffuseColor);
+	g_FragWhiteDiffuseColor = LoadLitProgram(fragWhiteDiffuseColor);
+	g_FragVertexDiffuseColor = LoadLitProgram(fragVertexDiffuseColor);
 
-	g_Unlit = LoadUnlitProgram("PosTransform.vert", "UniformColor.frag");
+	g_Unlit = LoadUnlitProgram(unlit);
 }
 
 Framework::Mesh *g_pCylinderMesh = NULL;
@@ -133,21 +133,21 @@ namespace
 	{
 		Framework::ForwardMouseMotion(g_viewPole, x, y);
 		Framework::ForwardMouseMotion(g_objtPole, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseButton(int button, int state, int x, int y)
 	{
 		Framework::ForwardMouseButton(g_viewPole, button, state, x, y);
 		Framework::ForwardMouseButton(g_objtPole, button, state, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseWheel(int wheel, int direction, int x, int y)
 	{
 		Framework::ForwardMouseWheel(g_viewPole, wheel, direction, x, y);
 		Framework::ForwardMouseWheel(g_objtPole, wheel, direction, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 }
 
@@ -175,9 +175,9 @@ void init()
 		throw;
 	}
 
- 	glutMouseFunc(MouseButton);
- 	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+ 	Framework::SetMouseFunc(MouseButton);
+ 	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -224,8 +224,8 @@ static bool g_bDrawLight = false;
 static bool g_bScaleCyl = false;
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 
 void display()
 {
@@ -337,8 +337,8 @@ void display()
 		}
 	}
 
-	glutPostRedisplay();
-	glutSwapBuffers();
+	Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -356,12 +356,12 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -371,7 +371,7 @@ void keyboard(unsigned char key, int x, int y)
 		delete g_pPlaneMesh;
 		delete g_pCylinderMesh;
 		delete g_pCubeMesh;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 		
 	case 32:
@@ -397,7 +397,7 @@ void keyboard(unsigned char key, int x, int y)
 	if(g_fLightRadius < 0.2f)
 		g_fLightRadius = 0.2f;
 
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
@@ -7,6 +7,7 @@
 #include <glutil/glutil.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/ProgramBatch.h"
 #include "../framework/Mesh.h"
 #include "../framework/MousePole.h"
 #include "../framework/Timer.h"
@@ -78,15 +79,10 @@ UnlitProgData g_Unlit;
 
 const int g_projectionBlockIndex = 2;
 
-UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+UnlitProgData LoadUnlitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	UnlitProgData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.objectColorUnif = glGetUniformLocation(data.theProgram, "objectColor");
 
@@ -96,15 +92,10 @@ UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::st
 	return data;
 }
 
-ProgramData LoadLitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+ProgramData LoadLitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.lightIntensityUnif = glGetUniformLocation(data.theProgram, "lightIntensity");
 	data.ambientIntensityUnif = glGetUniformLocation(data.theProgram, "ambientIntensity");
@@ -123,15 +114,27 @@ ProgramData LoadLitProgram(const std::string &strVertexShader, const std::string
 
 void InitializePrograms()
 {
+	Framework::ProgramBatch programBatch;
+	GLuint whitePrograms[LM_MAX_LIGHTING_MODEL];
+	GLuint colorPrograms[LM_MAX_LIGHTING_MODEL];
 	for(int iProg = 0; iProg < LM_MAX_LIGHTING_MODEL; iProg++)
 	{
-		g_Programs[iProg].whiteProg = LoadLitProgram(
+		whitePrograms[iProg] = programBatch.CreateProgram(
 			g_ShaderFiles[iProg].strWhiteVertShader, g_ShaderFiles[iProg].strFragmentShader);
-		g_Programs[iProg].colorProg = LoadLitProgram(
+		colorPrograms[iProg] = programBatch.CreateProgram(
 			g_ShaderFiles[iProg].strColorVertShader, g_ShaderFiles[iProg].strFragmentShader);
 	}
 
-	g_Unlit = LoadUnlitProgram("PosTransform.vert", "UniformColor.frag");
+	GLuint unlit = programBatch.CreateProgram("PosTransform.vert", "UniformColor.frag");
+	programBatch.Finish();
+
+	for(int iProg = 0; iProg < LM_MAX_LIGHTING_MODEL; iProg++)
+	{
+		g_Programs[iProg].whiteProg = LoadLitProgram(whitePrograms[iProg]);
+		g_Programs[iProg].colorProg = LoadLitProgram(colorPrograms[iProg]);
+	}
+
+	g_Unlit = LoadUnlitProgram(unlit);
 }
 
 Framework::Mesh *g_pCylinderMesh = NULL;
@@ -173,21 +176,21 @@ namespace
 	{
 		Framework::ForwardMouseMotion(g_viewPole, x, y);
 		Framework::ForwardMouseMotion(g_objtPole, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseButton(int button, int state, int x, int y)
 	{
 		Framework::ForwardMouseButton(g_viewPole, button, state, x, y);
 		Framework::ForwardMouseButton(g_objtPole, button, state, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseWheel(int wheel, int direction, int x, int y)
 	{
 		Framework::ForwardMouseWheel(g_viewPole, wheel, direction, x, y);
 		Framework::ForwardMouseWheel(g_objtPole, wheel, direction, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 }
 
@@ -216,9 +219,9 @@ void init()
 		throw;
 	}
 
-	glutMouseFunc(MouseButton);
-	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+	Framework::SetMouseFunc(MouseButton);
+	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -359,8 +362,8 @@ private:
 static MaterialParams g_matParams;
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 
 void display()
 {
@@ -463,8 +466,8 @@ void display()
 		}
 	}
 
-	glutPostRedisplay();
-	glutSwapBuffers();
+	Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 
@@ -483,7 +486,7 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 static const char *strLightModelNames[] =
@@ -497,7 +500,7 @@ static const char *strLightModelNames[] =
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -509,7 +512,7 @@ void keyboard(unsigned char key, int x, int y)
 		delete g_pPlaneMesh;
 		delete g_pCylinderMesh;
 		delete g_pCubeMesh;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 
 	case 32:
@@ -558,7 +561,7 @@ void keyboard(unsigned char key, int x, int y)
 	if(bChangedLightModel)
 		printf("%s\n", strLightModelNames[g_eLightModel]);
 
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
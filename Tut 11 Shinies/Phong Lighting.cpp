@@ -7,6 +7,7 @@
 #include <glutil/glutil.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/ProgramBatch.h"
 #include "../framework/Mesh.h"
 #include "../framework/MousePole.h"
 #include "../framework/Timer.h"
@@ -55,15 +56,10 @@ UnlitProgData g_Unlit;
 
 const int g_projectionBlockIndex = 2;
 
-UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+UnlitProgData LoadUnlitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	UnlitProgData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.objectColorUnif = glGetUniformLocation(data.theProgram, "objectColor");
 
@@ -73,15 +69,10 @@ UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::st
 	return data;
 }
 
-ProgramData LoadLitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+ProgramData LoadLitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.lightIntensityUnif = glGetUniformLocation(data.theProgram, "lightIntensity");
 	data.ambientIntensityUnif = glGetUniformLocation(data.theProgram, "ambientIntensity");
@@ -100,16 +91,29 @@ ProgramData LoadLitProgram(const std::string &strVertexShader, const std::string
 
 void InitializePrograms()
 {
-	g_WhiteNoPhong = LoadLitProgram("PN.vert", "NoPhong.frag");
-	g_ColorNoPhong = LoadLitProgram("PCN.vert", "NoPhong.frag");
+	Framework::ProgramBatch programBatch;
+	GLuint whiteNoPhong = programBatch.CreateProgram("PN.vert", "NoPhong.frag");
+	GLuint colorNoPhong = programBatch.CreateProgram("PCN.vert", "NoPhong.frag");
+
+	GLuint whitePhong = programBatch.CreateProgram("PN.vert", "PhongLighting.frag");
+	GLuint colorPhong = programBatch.CreateProgram("PCN.vert", "PhongLighting.frag");
+
+	GLuint whitePhongOnly = programBatch.CreateProgram("PN.vert", "PhongOnly.frag");
+	GLuint colorPhongOnly = programBatch.CreateProgram("PCN.vert", "PhongOnly.frag");
+
+	GLuint unlit = programBatch.CreateProgram("PosTransform.vert", "UniformColor.frag");
+	programBatch.Finish();
+
+	g_WhiteNoPhong = LoadLitProgram(whiteNoPhong);
+	g_ColorNoPhong = LoadLitProgram(colorNoPhong);
 
-	g_WhitePhong = LoadLitProgram("PN.vert", "PhongLighting.frag");
-	g_ColorPhong = LoadLitProgram("PCN.vert", "PhongLighting.frag");
+	g_WhitePhong = LoadLitProgram(whitePhong);
+	g_ColorPhong = LoadLitProgram(colorPhong);
 
-	g_WhitePhongOnly = LoadLitProgram("PN.vert", "PhongOnly.frag");
-	g_ColorPhongOnly = LoadLitProgram("PCN.vert", "PhongOnly.frag");
+	g_WhitePhongOnly = LoadLitProgram(whitePhongOnly);
+	g_ColorPhongOnly = LoadLitProgram(colorPhongOnly);
 
-	g_Unlit = LoadUnlitProgram("PosTransform.vert", "UniformColor.frag");
+	g_Unlit = LoadUnlitProgram(unlit);
 }
 
 Framework::Mesh *g_pCylinderMesh = NULL;
@@ -151,21 +155,21 @@ namespace
 	{
 		Framework::ForwardMouseMotion(g_viewPole, x, y);
 		Framework::ForwardMouseMotion(g_objtPole, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseButton(int button, int state, int x, int y)
 	{
 		Framework::ForwardMouseButton(g_viewPole, button, state, x, y);
 		Framework::ForwardMouseButton(g_objtPole, button, state, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseWheel(int wheel, int direction, int x, int y)
 	{
 		Framework::ForwardMouseWheel(g_viewPole, wheel, direction, x, y);
 		Framework::ForwardMouseWheel(g_objtPole, wheel, direction, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 }
 
@@ -193,9 +197,9 @@ void init()
 		throw;
 	}
 
- 	glutMouseFunc(MouseButton);
- 	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+ 	Framework::SetMouseFunc(MouseButton);
+ 	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -262,8 +266,8 @@ const glm::vec4 g_darkColor(0.2f, 0.2f, 0.2f, 1.0f);
 const glm::vec4 g_lightColor(1.0f);
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 
 void display()
 {
@@ -382,8 +386,8 @@ void display()
 		}
 	}
 
-	glutPostRedisplay();
-	glutSwapBuffers();
+	Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -401,7 +405,7 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 static const char *strLightModelNames[] =
@@ -414,7 +418,7 @@ static const char *strLightModelNames[] =
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -426,7 +430,7 @@ void keyboard(unsigned char key, int x, int y)
 		delete g_pPlaneMesh;
 		delete g_pCylinderMesh;
 		delete g_pCubeMesh;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 		
 	case 32:
@@ -485,7 +489,7 @@ void keyboard(unsigned char key, int x, int y)
 	if(bChangedLightModel)
 		printf("%s\n", strLightModelNames[g_eLightModel]);
 
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
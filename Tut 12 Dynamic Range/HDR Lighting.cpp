@@ -8,6 +8,7 @@
 #include <glutil/glutil.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/ProgramBatch.h"
 #include "../framework/Mesh.h"
 #include "../framework/MousePole.h"
 #include "../framework/Timer.h"
@@ -43,16 +44,18 @@ struct Shaders
 {
 	const char *fileVertexShader;
 	const char *fileFragmentShader;
+	bool hasVertexColor;
+	bool hasSpecular;
 };
 
 ProgramData g_Programs[LP_MAX_LIGHTING_PROGRAM_TYPES];
 Shaders g_ShaderFiles[LP_MAX_LIGHTING_PROGRAM_TYPES] =
 {
-	{"PCN.vert", "DiffuseSpecularHDR.frag"},
-	{"PCN.vert", "DiffuseOnlyHDR.frag"},
+	{"PCN.vert", "Lighting.frag", true, true},
+	{"PCN.vert", "Lighting.frag", true, false},
 
-	{"PN.vert", "DiffuseSpecularMtlHDR.frag"},
-	{"PN.vert", "DiffuseOnlyMtlHDR.frag"},
+	{"PN.vert", "Lighting.frag", false, true},
+	{"PN.vert", "Lighting.frag", false, false},
 };
 
 UnlitProgData g_Unlit;
@@ -61,15 +64,10 @@ const int g_materialBlockIndex = 0;
 const int g_lightBlockIndex = 1;
 const int g_projectionBlockIndex = 2;
 
-UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+UnlitProgData LoadUnlitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	UnlitProgData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.objectColorUnif = glGetUniformLocation(data.theProgram, "objectColor");
 
@@ -79,15 +77,10 @@ UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::st
 	return data;
 }
 
-ProgramData LoadLitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+ProgramData LoadLitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 
 	data.normalModelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "normalModelToCameraMatrix");
@@ -106,13 +99,32 @@ ProgramData LoadLitProgram(const std::string &strVertexShader, const std::string
 
 void InitializePrograms()
 {
+	Framework::ProgramBatch programBatch;
+	GLuint litPrograms[LP_MAX_LIGHTING_PROGRAM_TYPES];
 	for(int iProg = 0; iProg < LP_MAX_LIGHTING_PROGRAM_TYPES; iProg++)
 	{
-		g_Programs[iProg] = LoadLitProgram(
-			g_ShaderFiles[iProg].fileVertexShader, g_ShaderFiles[iProg].fileFragmentShader);
+		Framework::ShaderDefines fragmentDefines;
+		fragmentDefines["HDR"] = "";
+		if(g_ShaderFiles[iProg].hasVertexColor)
+			fragmentDefines["VERTEX_COLOR"] = "";
+		if(g_ShaderFiles[iProg].hasSpecular)
+			fragmentDefines["SPECULAR"] = "";
+
+		std::vector<GLuint> shaderList;
+		shaderList.push_back(programBatch.LoadShader(GL_VERTEX_SHADER,
+			g_ShaderFiles[iProg].fileVertexShader));
+		shaderList.push_back(programBatch.LoadShader(GL_FRAGMENT_SHADER,
+			g_ShaderFiles[iProg].fileFragmentShader, fragmentDefines));
+		litPrograms[iProg] = programBatch.CreateProgram(shaderList);
 	}
 
-	g_Unlit = LoadUnlitProgram("PosTransform.vert", "UniformColor.frag");
+	GLuint unlit = programBatch.CreateProgram("PosTransform.vert", "UniformColor.frag");
+	programBatch.Finish();
+
+	for(int iProg = 0; iProg < LP_MAX_LIGHTING_PROGRAM_TYPES; iProg++)
+		g_Programs[iProg] = LoadLitProgram(litPrograms[iProg]);
+
+	g_Unlit = LoadUnlitProgram(unlit);
 }
 
 const ProgramData &GetProgram(LightingProgramTypes eType)
@@ -149,19 +161,19 @@ namespace
 	void MouseMotion(int x, int y)
 	{
 		Framework::ForwardMouseMotion(g_viewPole, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseButton(int button, int state, int x, int y)
 	{
 		Framework::ForwardMouseButton(g_viewPole, button, state, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseWheel(int wheel, int direction, int x, int y)
 	{
 		Framework::ForwardMouseWheel(g_viewPole, wheel, direction, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 }
 
@@ -257,9 +269,9 @@ void init()
 
 	g_lights.CreateTimer("tetra", Framework::Timer::TT_LOOP, 2.5f);
 
-	glutMouseFunc(MouseButton);
- 	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+	Framework::SetMouseFunc(MouseButton);
+ 	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -297,8 +309,8 @@ bool g_bDrawCameraPos = false;
 bool g_bDrawLights = true;
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	g_lights.UpdateTime();
@@ -385,8 +397,8 @@ void display()
 		}
 	}
 
-	glutPostRedisplay();
-	glutSwapBuffers();
+	Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 
@@ -405,7 +417,7 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
@@ -413,7 +425,7 @@ TimerTypes g_eTimerMode = TIMER_ALL;
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -424,7 +436,7 @@ void keyboard(unsigned char key, int x, int y)
 	case 27:
 		delete g_pScene;
 		g_pScene = NULL;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 		
 	case 'p': g_lights.TogglePause(g_eTimerMode); break;
@@ -2,21 +2,18 @@
 SetupProject("Tut 12 Scene Lighting", "Scene Lighting.cpp",
 	"Lights.h", "Lights.cpp", "Scene.h", "Scene.cpp",
 	"data/PNC.vert", "data/PN.vert",
-	"data/DiffuseSpecular.frag", "data/DiffuseOnly.frag",
-	"data/DiffuseSpecularMtl.frag", "data/DiffuseOnlyMtl.frag"
+	"data/Lighting.frag"
 )
 
 SetupProject("Tut 12 HDR Lighting", "HDR Lighting.cpp",
 	"Lights.h", "Lights.cpp", "Scene.h", "Scene.cpp",
 	"data/PNC.vert", "data/PN.vert",
-	"data/DiffuseSpecular.frag", "data/DiffuseOnly.frag",
-	"data/DiffuseSpecularMtl.frag", "data/DiffuseOnlyMtl.frag"
+	"data/Lighting.frag"
 )
 
 SetupProject("Tut 12 Gamma Correction", "Gamma Correction.cpp",
 	"Lights.h", "Lights.cpp", "Scene.h", "Scene.cpp",
 	"data/PNC.vert", "data/PN.vert",
-	"data/DiffuseSpecular.frag", "data/DiffuseOnly.frag",
-	"data/DiffuseSpecularMtl.frag", "data/DiffuseOnlyMtl.frag"
+	"data/Lighting.frag"
 )
 
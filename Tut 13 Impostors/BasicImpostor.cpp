@@ -7,6 +7,7 @@
 #include <glutil/glutil.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/ProgramBatch.h"
 #include "../framework/Mesh.h"
 #include "../framework/MousePole.h"
 #include "../framework/Timer.h"
@@ -60,15 +61,10 @@ const int g_materialBlockIndex = 0;
 const int g_lightBlockIndex = 1;
 const int g_projectionBlockIndex = 2;
 
-UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+UnlitProgData LoadUnlitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	UnlitProgData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.objectColorUnif = glGetUniformLocation(data.theProgram, "objectColor");
 
@@ -78,15 +74,10 @@ UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::st
 	return data;
 }
 
-ProgramMeshData LoadLitMeshProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+ProgramMeshData LoadLitMeshProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramMeshData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 
 	data.normalModelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "normalModelToCameraMatrix");
@@ -102,15 +93,10 @@ ProgramMeshData LoadLitMeshProgram(const std::string &strVertexShader, const std
 	return data;
 }
 
-ProgramImposData LoadLitImposProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+ProgramImposData LoadLitImposProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramImposData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.sphereRadiusUnif = glGetUniformLocation(data.theProgram, "sphereRadius");
 	data.cameraSpherePosUnif = glGetUniformLocation(data.theProgram, "cameraSpherePos");
 
@@ -134,15 +120,25 @@ const char *g_impShaderNames[IMP_NUM_IMPOSTORS * 2] =
 
 void InitializePrograms()
 {
-	g_litMeshProg = LoadLitMeshProgram("PN.vert", "Lighting.frag");
+	Framework::ProgramBatch programBatch;
+	GLuint litMeshProg = programBatch.CreateProgram("PN.vert", "Lighting.frag");
 
+	GLuint litImpProgs[IMP_NUM_IMPOSTORS];
 	for(int iLoop = 0; iLoop < IMP_NUM_IMPOSTORS; iLoop++)
 	{
-		g_litImpProgs[iLoop] = LoadLitImposProgram(
+		litImpProgs[iLoop] = programBatch.CreateProgram(
 			g_impShaderNames[iLoop * 2], g_impShaderNames[iLoop * 2 + 1]);
 	}
 
-	g_Unlit = LoadUnlitProgram("Unlit.vert", "Unlit.frag");
+	GLuint unlit = programBatch.CreateProgram("Unlit.vert", "Unlit.frag");
+	programBatch.Finish();
+
+	g_litMeshProg = LoadLitMeshProgram(litMeshProg);
+
+	for(int iLoop = 0; iLoop < IMP_NUM_IMPOSTORS; iLoop++)
+		g_litImpProgs[iLoop] = LoadLitImposProgram(litImpProgs[iLoop]);
+
+	g_Unlit = LoadUnlitProgram(unlit);
 }
 
 ///////////////////////////////////////////////
@@ -171,19 +167,19 @@ namespace
 	void MouseMotion(int x, int y)
 	{
 		Framework::ForwardMouseMotion(g_viewPole, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseButton(int button, int state, int x, int y)
 	{
 		Framework::ForwardMouseButton(g_viewPole, button, state, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseWheel(int wheel, int direction, int x, int y)
 	{
 		Framework::ForwardMouseWheel(g_viewPole, wheel, direction, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 }
 
@@ -290,9 +286,9 @@ void init()
 		throw;
 	}
 
-	glutMouseFunc(MouseButton);
-	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+	Framework::SetMouseFunc(MouseButton);
+	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -426,8 +422,8 @@ const float g_fLightAttenuation = 1.0f / (g_fHalfLightDistance * g_fHalfLightDis
 bool g_drawImposter[4] = { false, false, false, false };
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	g_sphereTimer.Update();
@@ -522,8 +518,8 @@ void display()
 		}
 	}
 
-	glutPostRedisplay();
-	glutSwapBuffers();
+	Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -541,12 +537,12 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -557,7 +553,7 @@ void keyboard(unsigned char key, int x, int y)
 		delete g_pSphereMesh;
 		g_pPlaneMesh = NULL;
 		g_pSphereMesh = NULL;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 
 	case 'p': g_sphereTimer.TogglePause(); break;
@@ -7,6 +7,7 @@
 #include <glutil/glutil.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/ProgramBatch.h"
 #include "../framework/Mesh.h"
 #include "../framework/MousePole.h"
 #include "../framework/Timer.h"
@@ -48,15 +49,10 @@ const int g_materialBlockIndex = 0;
 const int g_lightBlockIndex = 1;
 const int g_projectionBlockIndex = 2;
 
-UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+UnlitProgData LoadUnlitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	UnlitProgData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.objectColorUnif = glGetUniformLocation(data.theProgram, "objectColor");
 
@@ -66,15 +62,10 @@ UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::st
 	return data;
 }
 
-ProgramMeshData LoadLitMeshProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+ProgramMeshData LoadLitMeshProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramMeshData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 
 	data.normalModelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "normalModelToCameraMatrix");
@@ -90,18 +81,10 @@ ProgramMeshData LoadLitMeshProgram(const std::string &strVertexShader, const std
 	return data;
 }
 
-ProgramImposData LoadLitImposProgram(const std::string &strVertexShader,
-									 const std::string &strGeometryShader,
-									 const std::string &strFragmentShader)
+ProgramImposData LoadLitImposProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_GEOMETRY_SHADER, strGeometryShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramImposData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 
 	GLuint materialBlock = glGetUniformBlockIndex(data.theProgram, "Material");
 	GLuint lightBlock = glGetUniformBlockIndex(data.theProgram, "Light");
@@ -116,12 +99,23 @@ ProgramImposData LoadLitImposProgram(const std::string &strVertexShader,
 
 void InitializePrograms()
 {
-	g_litMeshProg = LoadLitMeshProgram("PN.vert", "Lighting.frag");
+	Framework::ProgramBatch programBatch;
+	GLuint litMeshProg = programBatch.CreateProgram("PN.vert", "Lighting.frag");
+
+	std::vector<GLuint> shaderList;
+	shaderList.push_back(programBatch.LoadShader(GL_VERTEX_SHADER, "GeomImpostor.vert"));
+	shaderList.push_back(programBatch.LoadShader(GL_GEOMETRY_SHADER, "GeomImpostor.geom"));
+	shaderList.push_back(programBatch.LoadShader(GL_FRAGMENT_SHADER, "GeomImpostor.frag"));
+	GLuint litImpProg = programBatch.CreateProgram(shaderList);
+
+	GLuint unlit = programBatch.CreateProgram("Unlit.vert", "Unlit.frag");
+	programBatch.Finish();
+
+	g_litMeshProg = LoadLitMeshProgram(litMeshProg);
 
-	g_litImpProg = LoadLitImposProgram("GeomImpostor.vert", "GeomImpostor.geom",
-		"GeomImpostor.frag");
+	g_litImpProg = LoadLitImposProgram(litImpProg);
 
-	g_Unlit = LoadUnlitProgram("Unlit.vert", "Unlit.frag");
+	g_Unlit = LoadUnlitProgram(unlit);
 }
 
 ///////////////////////////////////////////////
@@ -150,19 +144,19 @@ namespace
 	void MouseMotion(int x, int y)
 	{
 		Framework::ForwardMouseMotion(g_viewPole, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseButton(int button, int state, int x, int y)
 	{
 		Framework::ForwardMouseButton(g_viewPole, button, state, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseWheel(int wheel, int direction, int x, int y)
 	{
 		Framework::ForwardMouseWheel(g_viewPole, wheel, direction, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 }
 
@@ -261,9 +255,9 @@ void init()
 		throw;
 	}
 
-	glutMouseFunc(MouseButton);
-	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+	Framework::SetMouseFunc(MouseButton);
+	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -367,8 +361,8 @@ struct VertexData
 };
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	g_sphereTimer.Update();
@@ -494,8 +488,8 @@ void display()
 		}
 	}
 
-	glutPostRedisplay();
-	glutSwapBuffers();
+	Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -513,12 +507,12 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -529,7 +523,7 @@ void keyboard(unsigned char key, int x, int y)
 		delete g_pSphereMesh;
 		g_pPlaneMesh = NULL;
 		g_pSphereMesh = NULL;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 
 	case 'p': g_sphereTimer.TogglePause(); break;
@@ -10,11 +10,13 @@
 #include <glimg/ImageCreatorExceptions.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/ProgramBatch.h"
 #include "../framework/Mesh.h"
 #include "../framework/MousePole.h"
 #include "../framework/Timer.h"
 #include "../framework/UniformBlockArray.h"
 #include "../framework/directories.h"
+#include "../framework/ResourceFS.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
@@ -59,15 +61,10 @@ const int g_projectionBlockIndex = 2;
 const int g_gaussTexUnit = 0;
 const int g_shineTexUnit = 1;
 
-UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+UnlitProgData LoadUnlitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	UnlitProgData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.objectColorUnif = glGetUniformLocation(data.theProgram, "objectColor");
 
@@ -77,15 +74,10 @@ UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::st
 	return data;
 }
 
-ProgramData LoadStandardProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+ProgramData LoadStandardProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.normalModelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "normalModelToCameraMatrix");
 
@@ -122,13 +114,21 @@ ShaderPairs g_shaderPairs[NUM_SHADER_MODES] =
 
 void InitializePrograms()
 {
+	Framework::ProgramBatch programBatch;
+	GLuint programs[NUM_SHADER_MODES];
 	for(int prog = 0; prog < NUM_SHADER_MODES; prog++)
 	{
-		g_Programs[prog] = LoadStandardProgram(g_shaderPairs[prog].vertShader,
+		programs[prog] = programBatch.CreateProgram(g_shaderPairs[prog].vertShader,
 			g_shaderPairs[prog].fragShader);
 	}
 
-	g_Unlit = LoadUnlitProgram("Unlit.vert", "Unlit.frag");
+	GLuint unlit = programBatch.CreateProgram("Unlit.vert", "Unlit.frag");
+	programBatch.Finish();
+
+	for(int prog = 0; prog < NUM_SHADER_MODES; prog++)
+		g_Programs[prog] = LoadStandardProgram(programs[prog]);
+
+	g_Unlit = LoadUnlitProgram(unlit);
 }
 
 ///////////////////////////////////////////////
@@ -166,21 +166,21 @@ namespace
 	{
 		Framework::ForwardMouseMotion(g_viewPole, x, y);
 		Framework::ForwardMouseMotion(g_objtPole, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseButton(int button, int state, int x, int y)
 	{
 		Framework::ForwardMouseButton(g_viewPole, button, state, x, y);
 		Framework::ForwardMouseButton(g_objtPole, button, state, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 
 	void MouseWheel(int wheel, int direction, int x, int y)
 	{
 		Framework::ForwardMouseWheel(g_viewPole, wheel, direction, x, y);
 		Framework::ForwardMouseWheel(g_objtPole, wheel, direction, x, y);
-		glutPostRedisplay();
+		Framework::PostRedisplay();
 	}
 }
 
@@ -300,10 +300,7 @@ void CreateShininessTexture()
 
 	try
 	{
-	    std::string filename(LOCAL_FILE_DIR);
-	    filename.append("main.dds");
-	    
-		pImageSet.reset(glimg::loaders::dds::LoadFromFile(filename.c_str()));
+		pImageSet.reset(Framework::LoadImageResource("main.dds"));
 		glimg::SingleImage image = pImageSet->GetImage(0, 0, 0);
 
 		glimg::Dimensions dims = image.GetDimensions();
@@ -362,9 +359,9 @@ void init()
 		throw;
 	}
 
-	glutMouseFunc(MouseButton);
-	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+	Framework::SetMouseFunc(MouseButton);
+	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -440,8 +437,8 @@ const float g_fHalfLightDistance = 25.0f;
 const float g_fLightAttenuation = 1.0f / (g_fHalfLightDistance * g_fHalfLightDistance);
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	g_lightTimer.Update();
@@ -563,8 +560,8 @@ void display()
 		}
 	}
 
-	glutPostRedisplay();
-	glutSwapBuffers();
+	Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -582,7 +579,7 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 const char *g_shaderModeNames[NUM_SHADER_MODES] =
@@ -594,7 +591,7 @@ const char *g_shaderModeNames[NUM_SHADER_MODES] =
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -607,7 +604,7 @@ void keyboard(unsigned char key, int x, int y)
 		g_pObjectMesh = NULL;
 		g_pCubeMesh = NULL;
 		g_pPlaneMesh = NULL;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 
 	case 'p': g_lightTimer.TogglePause(); break;
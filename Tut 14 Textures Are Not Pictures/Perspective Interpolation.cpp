@@ -7,6 +7,7 @@
 #include <glutil/glutil.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/ProgramBatch.h"
 #include "../framework/Mesh.h"
 #include "../framework/MousePole.h"
 #include <glm/glm.hpp>
@@ -27,15 +28,10 @@ float g_fzFar = 1000.0f;
 ProgramData g_SmoothInterp;
 ProgramData g_LinearInterp;
 
-ProgramData LoadProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+ProgramData LoadProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.cameraToClipMatrixUnif = glGetUniformLocation(data.theProgram, "cameraToClipMatrix");
 
 	return data;
@@ -43,8 +39,13 @@ ProgramData LoadProgram(const std::string &strVertexShader, const std::string &s
 
 void InitializePrograms()
 {
-	g_SmoothInterp = LoadProgram("SmoothVertexColors.vert", "SmoothVertexColors.frag");
-	g_LinearInterp = LoadProgram("NoCorrectVertexColors.vert", "NoCorrectVertexColors.frag");
+	Framework::ProgramBatch programBatch;
+	GLuint smoothInterp = programBatch.CreateProgram("SmoothVertexColors.vert", "SmoothVertexColors.frag");
+	GLuint linearInterp = programBatch.CreateProgram("NoCorrectVertexColors.vert", "NoCorrectVertexColors.frag");
+	programBatch.Finish();
+
+	g_SmoothInterp = LoadProgram(smoothInterp);
+	g_LinearInterp = LoadProgram(linearInterp);
 
 	glutil::MatrixStack persMatrix;
 	persMatrix.Perspective(60.0f, 1.0f, g_fzNear, g_fzFar);
@@ -82,8 +83,8 @@ static bool g_bUseFakeHallway = false;
 static bool g_bUseSmoothInterpolation = true;
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 
 void display()
 {
@@ -106,7 +107,7 @@ void display()
 		glUseProgram(0);
 	}
 
-	glutSwapBuffers();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -114,12 +115,12 @@ void display()
 void reshape (int w, int h)
 {
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -128,7 +129,7 @@ void keyboard(unsigned char key, int x, int y)
 	case 27:
 		delete g_pRealHallway;
 		delete g_pFauxHallway;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 
 	case 's':
@@ -158,7 +159,7 @@ void keyboard(unsigned char key, int x, int y)
 		break;
 	}
 
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
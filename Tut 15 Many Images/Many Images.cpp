@@ -16,6 +16,7 @@
 #include "../framework/Timer.h"
 #include "../framework/UniformBlockArray.h"
 #include "../framework/directories.h"
+#include "../framework/ResourceFS.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -180,10 +181,7 @@ void LoadCheckerTexture()
 {
 	try
 	{
-		std::string filename(LOCAL_FILE_DIR);
-		filename += "checker.dds";
-
-		std::auto_ptr<glimg::ImageSet> pImageSet(glimg::loaders::dds::LoadFromFile(filename.c_str()));
+		std::auto_ptr<glimg::ImageSet> pImageSet(Framework::LoadImageResource("checker.dds"));
 
 		glGenTextures(1, &g_checkerTexture);
 		glBindTexture(GL_TEXTURE_2D, g_checkerTexture);
@@ -264,8 +262,8 @@ bool g_useMipmapTexture = false;
 bool g_drawCorridor = false;
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	glClearColor(0.75f, 0.75f, 1.0f, 1.0f);
@@ -311,8 +309,8 @@ void display()
 		glUseProgram(0);
 	}
 
-	glutPostRedisplay();
-	glutSwapBuffers();
+	Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -330,7 +328,7 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 const char *g_samplerNames[NUM_SAMPLERS] =
@@ -345,7 +343,7 @@ const char *g_samplerNames[NUM_SAMPLERS] =
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -356,7 +354,7 @@ void keyboard(unsigned char key, int x, int y)
 		delete g_pCorridor;
 		g_pPlane = NULL;
 		g_pCorridor = NULL;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 	case 32:
 		g_useMipmapTexture = !g_useMipmapTexture;
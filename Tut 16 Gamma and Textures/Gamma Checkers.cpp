@@ -10,11 +10,13 @@
 #include <glutil/glutil.h>
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
+#include "../framework/ProgramBatch.h"
 #include "../framework/Mesh.h"
 #include "../framework/MousePole.h"
 #include "../framework/Timer.h"
 #include "../framework/UniformBlockArray.h"
 #include "../framework/directories.h"
+#include "../framework/ResourceFS.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -37,15 +39,10 @@ ProgramData g_progGamma;
 const int g_projectionBlockIndex = 0;
 const int g_colorTexUnit = 0;
 
-ProgramData LoadProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+ProgramData LoadProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 
 	GLuint projectionBlock = glGetUniformBlockIndex(data.theProgram, "Projection");
@@ -62,8 +59,13 @@ ProgramData LoadProgram(const std::string &strVertexShader, const std::string &s
 
 void InitializePrograms()
 {
-	g_progNoGamma = LoadProgram("PT.vert", "textureNoGamma.frag");
-	g_progGamma = LoadProgram("PT.vert", "textureGamma.frag");
+	Framework::ProgramBatch programBatch;
+	GLuint progNoGamma = programBatch.CreateProgram("PT.vert", "textureNoGamma.frag");
+	GLuint progGamma = programBatch.CreateProgram("PT.vert", "textureGamma.frag");
+	programBatch.Finish();
+
+	g_progNoGamma = LoadProgram(progNoGamma);
+	g_progGamma = LoadProgram(progGamma);
 }
 
 struct ProjectionBlock
@@ -105,10 +107,7 @@ void LoadCheckerTextures()
 {
 	try
 	{
-		std::string filename(LOCAL_FILE_DIR);
-		filename += "checker_linear.dds";
-
-		std::auto_ptr<glimg::ImageSet> pImageSet(glimg::loaders::dds::LoadFromFile(filename.c_str()));
+		std::auto_ptr<glimg::ImageSet> pImageSet(Framework::LoadImageResource("checker_linear.dds"));
 
 		glGenTextures(1, &g_linearTexture);
 		glBindTexture(GL_TEXTURE_2D, g_linearTexture);
@@ -125,9 +124,7 @@ void LoadCheckerTextures()
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, pImageSet->GetMipmapCount() - 1);
 
-		filename = std::string(LOCAL_FILE_DIR) + "checker_gamma.dds";
-
-		pImageSet.reset(glimg::loaders::dds::LoadFromFile(filename.c_str()));
+		pImageSet.reset(Framework::LoadImageResource("checker_gamma.dds"));
 
 		glGenTextures(1, &g_gammaTexture);
 		glBindTexture(GL_TEXTURE_2D, g_gammaTexture);
@@ -208,8 +205,8 @@ bool g_drawGammaTexture = false;
 bool g_drawGammaProgram = false;
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	glClearColor(0.75f, 0.75f, 1.0f, 1.0f);
@@ -253,8 +250,8 @@ void display()
 		glUseProgram(0);
 	}
 
-	glutPostRedisplay();
-	glutSwapBuffers();
+	Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -269,13 +266,13 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to 
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to 
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -286,7 +283,7 @@ void keyboard(unsigned char key, int x, int y)
 		delete g_pCorridor;
 		g_pPlane = NULL;
 		g_pCorridor = NULL;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 	case 'a':
 		g_drawGammaProgram = !g_drawGammaProgram;
@@ -13,10 +13,12 @@
 #include <glutil/MousePoles.h>
 #include <glutil/Shader.h>
 #include "../framework/framework.h"
+#include "../framework/ProgramBatch.h"
 #include "../framework/Mesh.h"
 #include "../framework/Timer.h"
 #include "../framework/UniformBlockArray.h"
 #include "../framework/directories.h"
+#include "../framework/ResourceFS.h"
 #include "../framework/MousePole.h"
 #include "../framework/Interpolators.h"
 #include "LightEnv.h"
@@ -52,15 +54,10 @@ const int g_projectionBlockIndex = 0;
 const int g_lightBlockIndex = 1;
 const int g_colorTexUnit = 0;
 
-ProgramData LoadProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+ProgramData LoadProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	ProgramData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.numberOfLightsUnif = glGetUniformLocation(data.theProgram, "numberOfLights");
 
@@ -78,15 +75,10 @@ ProgramData LoadProgram(const std::string &strVertexShader, const std::string &s
 	return data;
 }
 
-UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::string &strFragmentShader)
+UnlitProgData LoadUnlitProgram(GLuint theProgram)
 {
-	std::vector<GLuint> shaderList;
-
-	shaderList.push_back(Framework::LoadShader(GL_VERTEX_SHADER, strVertexShader));
-	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
-
 	UnlitProgData data;
-	data.theProgram = Framework::CreateProgram(shaderList);
+	data.theProgram = theProgram;
 	data.modelToCameraMatrixUnif = glGetUniformLocation(data.theProgram, "modelToCameraMatrix");
 	data.objectColorUnif = glGetUniformLocation(data.theProgram, "objectColor");
 
@@ -98,8 +90,13 @@ UnlitProgData LoadUnlitProgram(const std::string &strVertexShader, const std::st
 
 void InitializePrograms()
 {
-	g_progStandard = LoadProgram("PNT.vert", "litTexture.frag");
-	g_progUnlit = LoadUnlitProgram("Unlit.vert", "Unlit.frag");
+	Framework::ProgramBatch programBatch;
+	GLuint progStandard = programBatch.CreateProgram("PNT.vert", "litTexture.frag");
+	GLuint progUnlit = programBatch.CreateProgram("Unlit.vert", "Unlit.frag");
+	programBatch.Finish();
+
+	g_progStandard = LoadProgram(progStandard);
+	g_progUnlit = LoadUnlitProgram(progUnlit);
 }
 
 struct ProjectionBlock
@@ -142,9 +139,7 @@ void LoadTextures()
 {
 	try
 	{
-		std::string filename(Framework::FindFileOrThrow("terrain_tex.dds"));
-
-		std::auto_ptr<glimg::ImageSet> pImageSet(glimg::loaders::dds::LoadFromFile(filename.c_str()));
+		std::auto_ptr<glimg::ImageSet> pImageSet(Framework::LoadImageResource("terrain_tex.dds"));
 
 		glGenTextures(1, &g_linearTexture);
 		glBindTexture(GL_TEXTURE_2D, g_linearTexture);
@@ -222,9 +217,9 @@ void init()
 		throw;
 	}
 
-	glutMouseFunc(MouseButton);
-	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+	Framework::SetMouseFunc(MouseButton);
+	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -269,8 +264,8 @@ bool g_bDrawCameraPos = false;
 bool g_useGammaDisplay = true;
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
     if(!g_pLightEnv)
@@ -376,8 +371,8 @@ void display()
 
 	}
 
-	glutPostRedisplay();
-	glutSwapBuffers();
+	Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -395,13 +390,13 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -414,7 +409,7 @@ void keyboard(unsigned char key, int x, int y)
 		g_pSphere = NULL;
 		g_pTerrain = NULL;
 		g_pLightEnv = NULL;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 	case 32:
 		g_useGammaDisplay = !g_useGammaDisplay;
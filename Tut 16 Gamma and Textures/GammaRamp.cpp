@@ -12,6 +12,7 @@
 #include <GL/freeglut.h>
 #include "../framework/framework.h"
 #include "../framework/directories.h"
+#include "../framework/ResourceFS.h"
 
 const int g_projectionBlockIndex = 0;
 const int g_gammaRampTextureUnit = 0;
@@ -28,14 +29,11 @@ void InitializeProgram()
 	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, "textureNoGamma.frag"));
 
 	g_noGammaProgram = Framework::CreateProgram(shaderList);
-	glDeleteShader(shaderList.back());
 
 	shaderList.pop_back();
 	shaderList.push_back(Framework::LoadShader(GL_FRAGMENT_SHADER, "textureGamma.frag"));
 
 	g_gammaProgram = Framework::CreateProgram(shaderList);
-	glDeleteShader(shaderList.back());
-	glDeleteShader(vertexShader);
 
 	GLuint projectionBlock = glGetUniformBlockIndex(g_noGammaProgram, "Projection");
 	glUniformBlockBinding(g_noGammaProgram, projectionBlock, g_projectionBlockIndex);
@@ -103,12 +101,9 @@ void LoadTextures()
 {
 	glGenTextures(2, g_textures);
 
-	std::string filename(LOCAL_FILE_DIR);
-	filename += "gamma_ramp.png";
-
 	try
 	{
-		std::auto_ptr<glimg::ImageSet> pImageSet(glimg::loaders::stb::LoadFromFile(filename.c_str()));
+		std::auto_ptr<glimg::ImageSet> pImageSet(Framework::LoadImageResource("gamma_ramp.png"));
 
 		glimg::SingleImage image = pImageSet->GetImage(0, 0, 0);
 		glimg::Dimensions dims = image.GetDimensions();
@@ -164,8 +159,8 @@ void init()
 bool g_useGammaCorrect[2] = {false, false};
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	glClearColor(0.0f, 0.5f, 0.3f, 0.0f);
@@ -192,7 +187,7 @@ void display()
 	glBindTexture(GL_TEXTURE_2D, 0);
 	glBindSampler(g_gammaRampTextureUnit, 0);
 
-	glutSwapBuffers();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -211,19 +206,19 @@ void reshape (int w, int h)
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 	glViewport(0, 0, (GLsizei) w, (GLsizei) h);
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
 	switch (key)
 	{
 	case 27:
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 	case '1':
 		g_useGammaCorrect[0] = !g_useGammaCorrect[0];
@@ -244,7 +239,7 @@ void keyboard(unsigned char key, int x, int y)
 		break;
 	}
 
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
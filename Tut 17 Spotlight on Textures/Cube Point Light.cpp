@@ -69,8 +69,7 @@ void LoadTextures()
 
 		for(int tex = 0; tex < NUM_LIGHT_TEXTURES; ++tex)
 		{
-			std::string filename(Framework::FindFileOrThrow(g_texDefs[tex].filename));
-			std::auto_ptr<glimg::ImageSet> pImageSet(glimg::loaders::dds::LoadFromFile(filename.c_str()));
+			std::auto_ptr<glimg::ImageSet> pImageSet(Framework::LoadImageResource(g_texDefs[tex].filename));
 
 			glBindTexture(GL_TEXTURE_CUBE_MAP, g_lightTextures[tex]);
 			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
@@ -232,9 +231,9 @@ struct LightBlock
 //Called after the window and OpenGL are initialized. Called exactly once, before the main loop.
 void init()
 {
-	glutMouseFunc(MouseButton);
-	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+	Framework::SetMouseFunc(MouseButton);
+	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -317,8 +316,8 @@ void BuildLights( const glm::mat4 &camMatrix )
 }
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	if(!g_pScene)
@@ -413,8 +412,8 @@ void display()
 	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 	glBindSampler(g_lightProjTexUnit, 0);
 
-    glutPostRedisplay();
-	glutSwapBuffers();
+    Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -423,13 +422,13 @@ void reshape (int w, int h)
 {
 	g_displayWidth = w;
 	g_displayHeight = h;
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -438,7 +437,7 @@ void keyboard(unsigned char key, int x, int y)
 	case 27:
 		delete g_pScene;
 		g_pScene = NULL;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 	case 32:
 		g_lightPole.Reset();
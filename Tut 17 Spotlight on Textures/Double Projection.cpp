@@ -155,9 +155,9 @@ struct LightBlock
 //Called after the window and OpenGL are initialized. Called exactly once, before the main loop.
 void init()
 {
-	glutMouseFunc(MouseButton);
-	glutMotionFunc(MouseMotion);
-	glutMouseWheelFunc(MouseWheel);
+	Framework::SetMouseFunc(MouseButton);
+	Framework::SetMotionFunc(MouseMotion);
+	Framework::SetMouseWheelFunc(MouseWheel);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
@@ -231,8 +231,8 @@ void BuildLights( const glm::mat4 &camMatrix )
 }
 
 //Called to update the display.
-//You should call glutSwapBuffers after all of your rendering to display what you rendered.
-//If you need continuous updates of the screen, call glutPostRedisplay() at the end of the function.
+//You should call Framework::SwapBuffers after all of your rendering to display what you rendered.
+//If you need continuous updates of the screen, call Framework::PostRedisplay() at the end of the function.
 void display()
 {
 	if(!g_pScene)
@@ -313,8 +313,8 @@ void display()
 	g_pScene->Render(modelMatrix.Top());
 	glEnable(GL_DEPTH_CLAMP);
 
-    glutPostRedisplay();
-	glutSwapBuffers();
+    Framework::PostRedisplay();
+	Framework::SwapBuffers();
 }
 
 //Called whenever the window is resized. The new window size is given, in pixels.
@@ -323,13 +323,13 @@ void reshape (int w, int h)
 {
 	g_displayWidth = w;
 	g_displayHeight = h;
-	glutPostRedisplay();
+	Framework::PostRedisplay();
 }
 
 
 //Called whenever a key on the keyboard was pressed.
 //The key is given by the ''key'' parameter, which is in ASCII.
-//It's often a good idea to have the escape key (ASCII value 27) call glutLeaveMainLoop() to
+//It's often a good idea to have the escape key (ASCII value 27) call Framework::LeaveMainLoop() to
 //exit the program.
 void keyboard(unsigned char key, int x, int y)
 {
@@ -338,7 +338,7 @@ void keyboard(unsigned char key, int x, int y)
 	case 27:
 		delete g_pScene;
 		g_pScene = NULL;
-		glutLeaveMainLoop();
+		Framework::LeaveMainLoop();
 		return;
 	case 32:
 		g_persViewPole.Reset();
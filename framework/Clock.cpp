@@ -0,0 +1,80 @@
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif //WIN32
+
+#ifdef LOAD_X11
+#include <time.h>
+#endif //LOAD_X11
+
+#include <glload/gl_3_3.h>
+#include "Clock.h"
+
+namespace Framework
+{
+#ifdef WIN32
+	GLuint64 GetMonotonicTimeNs()
+	{
+		static LARGE_INTEGER frequency = {0};
+		if(!frequency.QuadPart)
+			QueryPerformanceFrequency(&frequency);
+
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		GLuint64 seconds = counter.QuadPart / frequency.QuadPart;
+		GLuint64 remainder = counter.QuadPart % frequency.QuadPart;
+		return seconds * 1000000000 + (remainder * 1000000000) / frequency.QuadPart;
+	}
+#endif //WIN32
+
+#ifdef LOAD_X11
+	GLuint64 GetMonotonicTimeNs()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return (GLuint64)now.tv_sec * 1000000000 + now.tv_nsec;
+	}
+#endif //LOAD_X11
+
+	MonotonicClock::MonotonicClock()
+		: m_startNs(GetMonotonicTimeNs())
+	{}
+
+	double MonotonicClock::GetTime() const
+	{
+		return (GetMonotonicTimeNs() - m_startNs) / 1000000000.0;
+	}
+
+	FixedStepClock::FixedStepClock( double secPerFrame )
+		: m_secPerFrame(secPerFrame)
+		, m_frameCount(0)
+	{}
+
+	double FixedStepClock::GetTime() const
+	{
+		//Multiplied rather than accumulated, so that no error builds up.
+		return m_frameCount * m_secPerFrame;
+	}
+
+	void FixedStepClock::EndFrame()
+	{
+		++m_frameCount;
+	}
+
+	namespace
+	{
+		Clock *g_pClock = NULL;
+	}
+
+	Clock &GetClock()
+	{
+		static MonotonicClock defaultClock;
+		return g_pClock ? *g_pClock : defaultClock;
+	}
+
+	void SetClock( Clock *pClock )
+	{
+		g_pClock = pClock;
+	}
+}
@@ -0,0 +1,64 @@
+
+#ifndef FRAMEWORK_CLOCK_H
+#define FRAMEWORK_CLOCK_H
+
+#include <glload/gl_3_3.h>
+
+namespace Framework
+{
+	//Nanoseconds from a monotonic, high-resolution clock with an arbitrary starting point.
+	GLuint64 GetMonotonicTimeNs();
+
+	//A source of time for Timer and for animation. Times are in seconds since the
+	//clock started.
+	class Clock
+	{
+	public:
+		virtual ~Clock() {}
+
+		virtual double GetTime() const = 0;
+
+		//The framework calls this after every display().
+		virtual void EndFrame() {}
+	};
+
+	//Real time.
+	class MonotonicClock : public Clock
+	{
+	public:
+		MonotonicClock();
+
+		virtual double GetTime() const;
+
+	private:
+		GLuint64 m_startNs;
+	};
+
+	//Advances by the same step every frame, no matter how long frames really take. Every
+	//frame of an animation is then the same from run to run and from build to build.
+	class FixedStepClock : public Clock
+	{
+	public:
+		explicit FixedStepClock(double secPerFrame = 1.0 / 60.0);
+
+		virtual double GetTime() const;
+		virtual void EndFrame();
+
+		unsigned int GetFrameCount() const {return m_frameCount;}
+
+	private:
+		double m_secPerFrame;
+		unsigned int m_frameCount;
+	};
+
+	//The clock that timers and the tutorials use. It is a MonotonicClock unless the
+	//GLTUT_FIXED_STEP environment variable gives a step in seconds, or the program runs
+	//headless; the framework then installs a FixedStepClock (1/60 of a second by default
+	//when headless; GLTUT_FIXED_STEP=0 keeps real time).
+	Clock &GetClock();
+
+	//The clock is not copied, and must outlive its use. NULL restores the default clock.
+	void SetClock(Clock *pClock);
+}
+
+#endif //FRAMEWORK_CLOCK_H
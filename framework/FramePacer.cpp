@@ -0,0 +1,268 @@
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <string.h>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif //WIN32
+
+#ifdef LOAD_X11
+#include <time.h>
+#endif //LOAD_X11
+
+#include <glload/gl_3_3.h>
+#include <glload/gll.hpp>
+
+#ifdef WIN32
+#include <glload/wgl_exts.h>
+#endif //WIN32
+
+#ifdef LOAD_X11
+#include <GL/glx.h>
+#endif //LOAD_X11
+
+#include "framework.h"
+#include "Clock.h"
+#include "FramePacer.h"
+
+namespace Framework
+{
+	namespace
+	{
+		const size_t g_maxRecordedFrames = 512;
+
+		//Sleeping is only trusted to wake up within this long of when it was asked to.
+		const GLuint64 g_spinTimeNs = 1000000;
+
+		GLuint64 g_framePeriodNs = 0;
+		GLuint64 g_nextFrameStartNs = 0;
+
+		int g_maxFramesInFlight = 0;
+		std::deque<GLsync> g_frameFences;
+
+		//A ring buffer of the most recent frame times.
+		std::vector<double> g_frameTimesMs;
+		size_t g_nextFrameTimeIx = 0;
+		GLuint64 g_lastFrameEndNs = 0;
+
+		void SleepNs(GLuint64 durationNs)
+		{
+#ifdef WIN32
+			Sleep((DWORD)(durationNs / 1000000));
+#endif //WIN32
+#ifdef LOAD_X11
+			timespec duration;
+			duration.tv_sec = (time_t)(durationNs / 1000000000);
+			duration.tv_nsec = (long)(durationNs % 1000000000);
+			nanosleep(&duration, NULL);
+#endif //LOAD_X11
+		}
+
+		void WaitUntil(GLuint64 timeNs)
+		{
+			GLuint64 now = GetMonotonicTimeNs();
+			if(now + g_spinTimeNs < timeNs)
+				SleepNs(timeNs - now - g_spinTimeNs);
+
+			while(GetMonotonicTimeNs() < timeNs)
+			{}
+		}
+
+		void WaitForFrameStart()
+		{
+			if(!g_framePeriodNs)
+				return;
+
+			GLuint64 now = GetMonotonicTimeNs();
+
+			//After falling more than a frame behind, start over rather than rushing
+			//through a burst of frames to catch up.
+			if(!g_nextFrameStartNs || now > g_nextFrameStartNs + g_framePeriodNs)
+				g_nextFrameStartNs = now;
+			else
+				WaitUntil(g_nextFrameStartNs);
+
+			g_nextFrameStartNs += g_framePeriodNs;
+		}
+
+		void LimitFramesInFlight()
+		{
+			if(!g_maxFramesInFlight)
+				return;
+
+			g_frameFences.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+			while((int)g_frameFences.size() > g_maxFramesInFlight)
+			{
+				//Wait as long as it takes; the timeout is only so that a lost
+				//context cannot hang the program.
+				glClientWaitSync(g_frameFences.front(), GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+				glDeleteSync(g_frameFences.front());
+				g_frameFences.pop_front();
+			}
+		}
+
+		void RecordFrameTime()
+		{
+			GLuint64 now = GetMonotonicTimeNs();
+			if(g_lastFrameEndNs)
+			{
+				double frameTimeMs = (now - g_lastFrameEndNs) / 1000000.0;
+				if(g_frameTimesMs.size() < g_maxRecordedFrames)
+					g_frameTimesMs.push_back(frameTimeMs);
+				else
+					g_frameTimesMs[g_nextFrameTimeIx] = frameTimeMs;
+
+				g_nextFrameTimeIx = (g_nextFrameTimeIx + 1) % g_maxRecordedFrames;
+			}
+
+			g_lastFrameEndNs = now;
+		}
+
+		double GetPercentile(const std::vector<double> &sortedTimes, int percentile)
+		{
+			//Nearest rank.
+			size_t rank = (sortedTimes.size() * percentile + 99) / 100;
+			return sortedTimes[rank ? rank - 1 : 0];
+		}
+
+#ifdef LOAD_X11
+		bool HasGLXExtension(Display *pDisplay, const char *extName)
+		{
+			const char *extList = glXQueryExtensionsString(pDisplay, DefaultScreen(pDisplay));
+			if(!extList)
+				return false;
+
+			size_t extLen = strlen(extName);
+			for(const char *found = strstr(extList, extName); found; found = strstr(found + 1, extName))
+			{
+				bool isStart = (found == extList) || (found[-1] == ' ');
+				bool isEnd = (found[extLen] == ' ') || (found[extLen] == '\0');
+				if(isStart && isEnd)
+					return true;
+			}
+
+			return false;
+		}
+#endif //LOAD_X11
+	}
+
+	FrameTimeStats GetFrameTimeStats()
+	{
+		FrameTimeStats stats;
+		memset(&stats, 0, sizeof(stats));
+
+		stats.numFrames = (int)g_frameTimesMs.size();
+		if(g_frameTimesMs.empty())
+			return stats;
+
+		std::vector<double> sortedTimes(g_frameTimesMs);
+		std::sort(sortedTimes.begin(), sortedTimes.end());
+
+		double totalMs = 0.0;
+		for(size_t frameIx = 0; frameIx < sortedTimes.size(); ++frameIx)
+			totalMs += sortedTimes[frameIx];
+
+		stats.averageMs = totalMs / sortedTimes.size();
+		stats.p50Ms = GetPercentile(sortedTimes, 50);
+		stats.p95Ms = GetPercentile(sortedTimes, 95);
+		stats.p99Ms = GetPercentile(sortedTimes, 99);
+		stats.maxMs = sortedTimes.back();
+		return stats;
+	}
+
+	void SetTargetFrameRate( double framesPerSec )
+	{
+		g_framePeriodNs = framesPerSec > 0.0 ? (GLuint64)(1000000000.0 / framesPerSec) : 0;
+		g_nextFrameStartNs = 0;
+
+#ifdef WIN32
+		//Sleep() is otherwise only good to the scheduler tick, which is often 15ms.
+		static bool isTimerPeriodSet = false;
+		if(g_framePeriodNs && !isTimerPeriodSet)
+		{
+			timeBeginPeriod(1);
+			isTimerPeriodSet = true;
+		}
+#endif //WIN32
+	}
+
+	double GetTargetFrameRate()
+	{
+		return g_framePeriodNs ? 1000000000.0 / g_framePeriodNs : 0.0;
+	}
+
+	bool SetSwapInterval( int interval )
+	{
+		if(IsHeadless())
+			return false;
+
+#ifdef WIN32
+		HDC hdc = wglGetCurrentDC();
+		if(!hdc)
+			return false;
+
+		//glload does not know WGL_EXT_swap_control.
+		typedef BOOL (WINAPI *SwapIntervalFunc)(int interval);
+		SwapIntervalFunc SwapIntervalEXT = (SwapIntervalFunc)wglGetProcAddress("wglSwapIntervalEXT");
+		if(!SwapIntervalEXT)
+			return false;
+
+		glload::LoadWinFunctions(hdc);
+		const char *extList = wglGetExtensionsStringARB ? wglGetExtensionsStringARB(hdc) : NULL;
+		if(interval < 0 && !(extList && strstr(extList, "WGL_EXT_swap_control_tear")))
+			interval = -interval;
+
+		return SwapIntervalEXT(interval) != FALSE;
+#endif //WIN32
+
+#ifdef LOAD_X11
+		Display *pDisplay = glXGetCurrentDisplay();
+		GLXDrawable drawable = glXGetCurrentDrawable();
+		if(!pDisplay || !drawable)
+			return false;
+
+		//Current system glxext.h headers hide glload's declaration of this, so load it by hand.
+		if(!HasGLXExtension(pDisplay, "GLX_EXT_swap_control"))
+			return false;
+
+		typedef void (*SwapIntervalFunc)(Display *pDisplay, GLXDrawable drawable, int interval);
+		SwapIntervalFunc SwapIntervalEXT = (SwapIntervalFunc)GetGLProcAddress("glXSwapIntervalEXT");
+		if(!SwapIntervalEXT)
+			return false;
+
+		if(interval < 0 && !HasGLXExtension(pDisplay, "GLX_EXT_swap_control_tear"))
+			interval = -interval;
+
+		SwapIntervalEXT(pDisplay, drawable, interval);
+		return true;
+#endif //LOAD_X11
+	}
+
+	void SetMaxFramesInFlight( int numFrames )
+	{
+		g_maxFramesInFlight = numFrames > 0 ? numFrames : 0;
+
+		if(!g_maxFramesInFlight)
+		{
+			for(size_t fenceIx = 0; fenceIx < g_frameFences.size(); ++fenceIx)
+				glDeleteSync(g_frameFences[fenceIx]);
+			g_frameFences.clear();
+		}
+	}
+
+	int GetMaxFramesInFlight()
+	{
+		return g_maxFramesInFlight;
+	}
+
+	void EndFramePacing()
+	{
+		LimitFramesInFlight();
+		WaitForFrameStart();
+		RecordFrameTime();
+	}
+}
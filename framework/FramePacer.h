@@ -0,0 +1,45 @@
+
+#ifndef FRAMEWORK_FRAME_PACER_H
+#define FRAMEWORK_FRAME_PACER_H
+
+namespace Framework
+{
+	//Frame times over the last few hundred frames, in milliseconds. A frame's time is
+	//measured from the end of one display() to the end of the next, including any waiting.
+	struct FrameTimeStats
+	{
+		int numFrames;
+		double averageMs;
+		double p50Ms;
+		double p95Ms;
+		double p99Ms;
+		double maxMs;
+	};
+
+	FrameTimeStats GetFrameTimeStats();
+
+	//Frames are held back so that they start no more often than this. 0, the default,
+	//means as fast as possible. Waiting sleeps for most of the time, then spins for the
+	//last millisecond, since sleeps are not precise enough on their own.
+	//The framework reads this from the GLTUT_TARGET_FPS environment variable.
+	void SetTargetFrameRate(double framesPerSec);
+	double GetTargetFrameRate();
+
+	//Sets the vsync interval, using GLX_EXT_swap_control or WGL_EXT_swap_control. A negative
+	//interval asks for adaptive vsync, where late frames are not held back to the next
+	//vblank; without *_swap_control_tear this falls back to plain vsync. Returns false if
+	//the interval could not be set, which is always the case in headless mode.
+	//The framework reads this from the GLTUT_SWAP_INTERVAL environment variable.
+	bool SetSwapInterval(int interval);
+
+	//Limits how many frames the CPU may queue up ahead of the GPU, using fence sync
+	//objects. 0, the default, leaves it to the driver.
+	//The framework reads this from the GLTUT_MAX_FRAMES_IN_FLIGHT environment variable.
+	void SetMaxFramesInFlight(int numFrames);
+	int GetMaxFramesInFlight();
+
+	//The framework calls this after every display().
+	void EndFramePacing();
+}
+
+#endif //FRAMEWORK_FRAME_PACER_H
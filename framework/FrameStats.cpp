@@ -0,0 +1,163 @@
+
+#include <string>
+#include <fstream>
+#include <exception>
+#include <stdexcept>
+#include <glload/gl_3_3.h>
+#include <glimg/TextureGenerator.h>
+#include "FrameStats.h"
+#include "StateCache.h"
+
+namespace Framework
+{
+	FrameStats::FrameStats()
+		: frameNumber(0)
+		, drawCalls(0)
+		, vertices(0)
+		, triangles(0)
+		, programSwitches(0)
+		, textureSwitches(0)
+		, vaoSwitches(0)
+		, uniformUploads(0)
+		, bufferBytes(0)
+		, textureBytes(0)
+		, stateCallsIssued(0)
+		, stateCallsElided(0)
+	{}
+
+	namespace
+	{
+		FrameStats g_currFrame;
+		FrameStats g_lastFrame;
+
+		//glimg only keeps a running total.
+		size_t g_frameStartTextureBytes = 0;
+
+		std::ofstream *g_pCSVFile = NULL;
+
+		FrameStats FillDerivedStats(FrameStats stats)
+		{
+			stats.textureBytes += glimg::GetTextureUploadByteCount() - g_frameStartTextureBytes;
+
+			StateCacheStats cacheStats = GetCurrentStateCacheStats();
+			stats.stateCallsIssued = cacheStats.issuedCalls;
+			stats.stateCallsElided = cacheStats.elidedCalls;
+			return stats;
+		}
+
+		void WriteCSVHeader(std::ostream &file)
+		{
+			file << "frame,draw calls,vertices,triangles,program switches,texture switches,"
+				"vao switches,uniform uploads,buffer bytes,texture bytes,"
+				"state calls issued,state calls elided\n";
+		}
+
+		void WriteCSVLine(std::ostream &file, const FrameStats &stats)
+		{
+			file << stats.frameNumber << ',' << stats.drawCalls << ','
+				<< stats.vertices << ',' << stats.triangles << ','
+				<< stats.programSwitches << ',' << stats.textureSwitches << ','
+				<< stats.vaoSwitches << ',' << stats.uniformUploads << ','
+				<< stats.bufferBytes << ',' << stats.textureBytes << ','
+				<< stats.stateCallsIssued << ',' << stats.stateCallsElided << '\n';
+		}
+	}
+
+	FrameStats GetFrameStats()
+	{
+		return g_lastFrame;
+	}
+
+	FrameStats GetCurrentFrameStats()
+	{
+		return FillDerivedStats(g_currFrame);
+	}
+
+	void CountDraw( GLenum primType, GLsizei elemCount )
+	{
+		++g_currFrame.drawCalls;
+		g_currFrame.vertices += elemCount;
+
+		switch(primType)
+		{
+		case GL_TRIANGLES:
+			g_currFrame.triangles += elemCount / 3;
+			break;
+		case GL_TRIANGLE_STRIP:
+		case GL_TRIANGLE_FAN:
+			if(elemCount > 2)
+				g_currFrame.triangles += elemCount - 2;
+			break;
+		case GL_TRIANGLES_ADJACENCY:
+			g_currFrame.triangles += elemCount / 6;
+			break;
+		case GL_TRIANGLE_STRIP_ADJACENCY:
+			if(elemCount > 4)
+				g_currFrame.triangles += (elemCount - 4) / 2;
+			break;
+		}
+	}
+
+	void CountProgramSwitch()
+	{
+		++g_currFrame.programSwitches;
+	}
+
+	void CountTextureSwitch()
+	{
+		++g_currFrame.textureSwitches;
+	}
+
+	void CountVaoSwitch()
+	{
+		++g_currFrame.vaoSwitches;
+	}
+
+	void CountUniformUpload()
+	{
+		++g_currFrame.uniformUploads;
+	}
+
+	void CountBufferUpload( size_t byteCount )
+	{
+		g_currFrame.bufferBytes += byteCount;
+	}
+
+	void CountTextureUpload( size_t byteCount )
+	{
+		g_currFrame.textureBytes += byteCount;
+	}
+
+	void SetFrameStatsCSV( const std::string &filename )
+	{
+		delete g_pCSVFile;
+		g_pCSVFile = NULL;
+
+		if(filename.empty())
+			return;
+
+		g_pCSVFile = new std::ofstream(filename.c_str());
+		if(!g_pCSVFile->is_open())
+		{
+			delete g_pCSVFile;
+			g_pCSVFile = NULL;
+			throw std::runtime_error("Could not open the frame statistics file: " + filename);
+		}
+
+		WriteCSVHeader(*g_pCSVFile);
+	}
+
+	void EndFrameStats()
+	{
+		g_lastFrame = FillDerivedStats(g_currFrame);
+		if(g_pCSVFile)
+		{
+			WriteCSVLine(*g_pCSVFile, g_lastFrame);
+			g_pCSVFile->flush();
+		}
+
+		g_currFrame = FrameStats();
+		g_currFrame.frameNumber = g_lastFrame.frameNumber + 1;
+		g_frameStartTextureBytes = glimg::GetTextureUploadByteCount();
+	}
+}
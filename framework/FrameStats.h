@@ -0,0 +1,60 @@
+
+#ifndef FRAMEWORK_FRAME_STATS_H
+#define FRAMEWORK_FRAME_STATS_H
+
+#include <string>
+#include <glload/gl_3_3.h>
+
+namespace Framework
+{
+	//How much rendering work a frame did. Only work that goes through the framework is
+	//counted: scenes, meshes, binders, the state cache, and glimg texture creation.
+	//OpenGL calls that an application makes itself are not, unless it reports them
+	//with the Count* functions below.
+	struct FrameStats
+	{
+		FrameStats();
+
+		int frameNumber;
+
+		int drawCalls;
+		size_t vertices;
+		size_t triangles;
+
+		int programSwitches;
+		int textureSwitches;	//Includes sampler object binds.
+		int vaoSwitches;
+		int uniformUploads;
+
+		size_t bufferBytes;
+		size_t textureBytes;
+
+		int stateCallsIssued;	//From the state cache.
+		int stateCallsElided;
+	};
+
+	//Statistics for the last completed frame.
+	FrameStats GetFrameStats();
+
+	//Statistics for the frame in progress.
+	FrameStats GetCurrentFrameStats();
+
+	void CountDraw(GLenum primType, GLsizei elemCount);
+	void CountProgramSwitch();
+	void CountTextureSwitch();
+	void CountVaoSwitch();
+	void CountUniformUpload();
+	void CountBufferUpload(size_t byteCount);
+	void CountTextureUpload(size_t byteCount);	//For uploads that bypass glimg.
+
+	//Starting with the next completed frame, a line of statistics is written to the given
+	//CSV file for every frame. An empty filename stops writing. If the GLTUT_STATS_CSV
+	//environment variable is set, the framework starts writing to that file at startup.
+	//Throws a std::runtime_error if the file cannot be opened.
+	void SetFrameStatsCSV(const std::string &filename);
+
+	//Finishes the current frame's statistics. The framework calls this after every display().
+	void EndFrameStats();
+}
+
+#endif //FRAMEWORK_FRAME_STATS_H
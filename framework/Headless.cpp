@@ -0,0 +1,218 @@
+
+#include <string>
+#include <exception>
+#include <stdexcept>
+#include <string.h>
+
+#ifdef LOAD_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif //LOAD_X11
+
+#include <glload/gl_3_3.h>
+#include <glload/gll.hpp>
+#include <GL/freeglut.h>
+#include "Headless.h"
+
+#ifdef LOAD_X11
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+#ifndef EGL_NO_CONFIG_KHR
+#define EGL_NO_CONFIG_KHR ((EGLConfig)0)
+#endif
+
+namespace Framework
+{
+	namespace
+	{
+		EGLDisplay g_display = EGL_NO_DISPLAY;
+		EGLContext g_context = EGL_NO_CONTEXT;
+		EGLSurface g_surface = EGL_NO_SURFACE;
+
+		GLuint g_fbo = 0;
+		GLuint g_colorBuffer = 0;
+		GLuint g_depthBuffer = 0;
+
+		bool HasEGLExtension(EGLDisplay display, const char *extName)
+		{
+			const char *extList = eglQueryString(display, EGL_EXTENSIONS);
+			if(!extList)
+				return false;
+
+			size_t extLen = strlen(extName);
+			for(const char *found = strstr(extList, extName); found; found = strstr(found + 1, extName))
+			{
+				bool isStart = (found == extList) || (found[-1] == ' ');
+				bool isEnd = (found[extLen] == ' ') || (found[extLen] == '\0');
+				if(isStart && isEnd)
+					return true;
+			}
+
+			return false;
+		}
+
+		EGLDisplay OpenDisplay()
+		{
+			//Client extensions are queried on EGL_NO_DISPLAY.
+			if(HasEGLExtension(EGL_NO_DISPLAY, "EGL_MESA_platform_surfaceless") &&
+				HasEGLExtension(EGL_NO_DISPLAY, "EGL_EXT_platform_base"))
+			{
+				PFNEGLGETPLATFORMDISPLAYEXTPROC GetPlatformDisplay =
+					(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+				if(GetPlatformDisplay)
+				{
+					EGLDisplay display = GetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+						EGL_DEFAULT_DISPLAY, NULL);
+					if(display != EGL_NO_DISPLAY)
+						return display;
+				}
+			}
+
+			return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		}
+
+		void CreateFramebuffer(int width, int height, unsigned int displayMode)
+		{
+			GLenum colorFormat = (displayMode & GLUT_SRGB) ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+
+			glGenFramebuffers(1, &g_fbo);
+			glBindFramebuffer(GL_FRAMEBUFFER, g_fbo);
+
+			glGenRenderbuffers(1, &g_colorBuffer);
+			glBindRenderbuffer(GL_RENDERBUFFER, g_colorBuffer);
+			glRenderbufferStorage(GL_RENDERBUFFER, colorFormat, width, height);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+				GL_RENDERBUFFER, g_colorBuffer);
+
+			if(displayMode & (GLUT_DEPTH | GLUT_STENCIL))
+			{
+				glGenRenderbuffers(1, &g_depthBuffer);
+				glBindRenderbuffer(GL_RENDERBUFFER, g_depthBuffer);
+				glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+				glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+					GL_RENDERBUFFER, g_depthBuffer);
+			}
+
+			glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+			if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+				throw std::runtime_error("Could not create the headless framebuffer.");
+
+			glViewport(0, 0, width, height);
+		}
+	}
+
+	void CreateHeadlessContext( int width, int height, unsigned int displayMode )
+	{
+		g_display = OpenDisplay();
+		if(g_display == EGL_NO_DISPLAY || !eglInitialize(g_display, NULL, NULL))
+			throw std::runtime_error("Could not open an EGL display.");
+
+		if(!eglBindAPI(EGL_OPENGL_API))
+			throw std::runtime_error("EGL does not support desktop OpenGL.");
+
+		const EGLint configAttribs[] =
+		{
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_NONE,
+		};
+
+		EGLConfig config = EGL_NO_CONFIG_KHR;
+		EGLint numConfigs = 0;
+		bool hasConfig = eglChooseConfig(g_display, configAttribs, &config, 1, &numConfigs) &&
+			numConfigs > 0;
+
+		bool isSurfaceless = HasEGLExtension(g_display, "EGL_KHR_surfaceless_context");
+		if(!hasConfig && !(isSurfaceless && HasEGLExtension(g_display, "EGL_KHR_no_config_context")))
+			throw std::runtime_error("Could not find an EGL config for headless rendering.");
+
+		const EGLint contextAttribs[] =
+		{
+			EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+			EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+#ifdef DEBUG
+			EGL_CONTEXT_FLAGS_KHR, EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR,
+#endif
+			EGL_NONE,
+		};
+
+		g_context = eglCreateContext(g_display, hasConfig ? config : EGL_NO_CONFIG_KHR,
+			EGL_NO_CONTEXT, contextAttribs);
+		if(g_context == EGL_NO_CONTEXT)
+			throw std::runtime_error("Could not create an OpenGL 3.3 core context through EGL.");
+
+		//Without surfaceless support, a tiny pbuffer stands in; it is never rendered to.
+		if(!isSurfaceless)
+		{
+			const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+			g_surface = eglCreatePbufferSurface(g_display, config, pbufferAttribs);
+			if(g_surface == EGL_NO_SURFACE)
+				throw std::runtime_error("Could not create an EGL pbuffer.");
+		}
+
+		if(!eglMakeCurrent(g_display, g_surface, g_surface, g_context))
+			throw std::runtime_error("Could not make the headless context current.");
+
+		glload::LoadFunctions();
+		CreateFramebuffer(width, height, displayMode);
+	}
+
+	void DestroyHeadlessContext()
+	{
+		if(g_display == EGL_NO_DISPLAY)
+			return;
+
+		if(g_context != EGL_NO_CONTEXT)
+		{
+			glDeleteFramebuffers(1, &g_fbo);
+			glDeleteRenderbuffers(1, &g_colorBuffer);
+			glDeleteRenderbuffers(1, &g_depthBuffer);
+			g_fbo = g_colorBuffer = g_depthBuffer = 0;
+
+			eglMakeCurrent(g_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+			eglDestroyContext(g_display, g_context);
+			g_context = EGL_NO_CONTEXT;
+		}
+
+		if(g_surface != EGL_NO_SURFACE)
+		{
+			eglDestroySurface(g_display, g_surface);
+			g_surface = EGL_NO_SURFACE;
+		}
+
+		eglTerminate(g_display);
+		g_display = EGL_NO_DISPLAY;
+	}
+
+	void *GetHeadlessProcAddress( const char *funcName )
+	{
+		return (void *)eglGetProcAddress(funcName);
+	}
+}
+
+#endif //LOAD_X11
+
+#ifdef WIN32
+
+namespace Framework
+{
+	void CreateHeadlessContext( int width, int height, unsigned int displayMode )
+	{
+		throw std::runtime_error("Headless mode is only supported through EGL.");
+	}
+
+	void DestroyHeadlessContext()
+	{}
+
+	void *GetHeadlessProcAddress( const char *funcName )
+	{
+		return NULL;
+	}
+}
+
+#endif //WIN32
@@ -0,0 +1,18 @@
+
+#ifndef FRAMEWORK_HEADLESS_H
+#define FRAMEWORK_HEADLESS_H
+
+namespace Framework
+{
+	//Creates an OpenGL 3.3 core context through EGL, without a window. Prefers Mesa's
+	//surfaceless platform, so that it works with no GPU or X server. The context has no
+	//usable default framebuffer, so a width x height framebuffer object is created and
+	//left bound in its place; displayMode takes GLUT flags, as returned by defaults().
+	//Also loads the OpenGL functions. Throws a std::runtime_error on failure.
+	void CreateHeadlessContext(int width, int height, unsigned int displayMode);
+	void DestroyHeadlessContext();
+
+	void *GetHeadlessProcAddress(const char *funcName);
+}
+
+#endif //FRAMEWORK_HEADLESS_H
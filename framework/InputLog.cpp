@@ -0,0 +1,109 @@
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <exception>
+#include <stdexcept>
+#include <string.h>
+#include "InputLog.h"
+
+namespace Framework
+{
+	namespace
+	{
+		const char g_magic[4] = {'G', 'T', 'I', 'L'};
+		const unsigned char g_version = 1;
+
+		//Frame (4 bytes), type, code, modifiers, state (1 byte each), x, y (2 bytes each).
+		const size_t g_eventSize = 12;
+
+		void PutU16(unsigned char *pDst, unsigned int value)
+		{
+			pDst[0] = (unsigned char)(value & 0xFF);
+			pDst[1] = (unsigned char)((value >> 8) & 0xFF);
+		}
+
+		void PutU32(unsigned char *pDst, unsigned int value)
+		{
+			PutU16(pDst, value & 0xFFFF);
+			PutU16(pDst + 2, value >> 16);
+		}
+
+		unsigned int GetU16(const unsigned char *pSrc)
+		{
+			return pSrc[0] | (pSrc[1] << 8);
+		}
+
+		unsigned int GetU32(const unsigned char *pSrc)
+		{
+			return GetU16(pSrc) | (GetU16(pSrc + 2) << 16);
+		}
+
+		int ToSigned16(unsigned int value)
+		{
+			return value >= 0x8000 ? (int)value - 0x10000 : (int)value;
+		}
+	}
+
+	InputLogWriter::InputLogWriter( const std::string &filename )
+		: m_file(filename.c_str(), std::ios::out | std::ios::binary)
+	{
+		if(!m_file.is_open())
+			throw std::runtime_error("Could not open the input log for writing: " + filename);
+
+		m_file.write(g_magic, sizeof(g_magic));
+		m_file.put((char)g_version);
+		m_file.flush();
+	}
+
+	void InputLogWriter::Write( const InputEvent &event )
+	{
+		unsigned char data[g_eventSize];
+		PutU32(data, event.frameIx);
+		data[4] = (unsigned char)event.type;
+		data[5] = (unsigned char)event.code;
+		data[6] = (unsigned char)event.modifiers;
+		data[7] = (unsigned char)(signed char)event.state;
+		PutU16(data + 8, (unsigned int)(event.x & 0xFFFF));
+		PutU16(data + 10, (unsigned int)(event.y & 0xFFFF));
+
+		m_file.write((const char *)data, g_eventSize);
+		m_file.flush();
+	}
+
+	std::vector<InputEvent> ReadInputLog( const std::string &filename )
+	{
+		std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+		if(!file.is_open())
+			throw std::runtime_error("Could not open the input log: " + filename);
+
+		char header[sizeof(g_magic) + 1];
+		if(!file.read(header, sizeof(header)) || memcmp(header, g_magic, sizeof(g_magic)) != 0)
+			throw std::runtime_error("Not an input log: " + filename);
+
+		if((unsigned char)header[sizeof(g_magic)] != g_version)
+			throw std::runtime_error("Unsupported input log version: " + filename);
+
+		std::vector<InputEvent> events;
+		unsigned char data[g_eventSize];
+		while(file.read((char *)data, g_eventSize))
+		{
+			InputEvent event;
+			event.frameIx = GetU32(data);
+			event.type = (InputEventType)data[4];
+			event.code = data[5];
+			event.modifiers = data[6];
+			event.state = (signed char)data[7];
+			event.x = ToSigned16(GetU16(data + 8));
+			event.y = ToSigned16(GetU16(data + 10));
+
+			if(event.type > INPUT_MOUSE_WHEEL)
+				throw std::runtime_error("Corrupt input log: " + filename);
+
+			events.push_back(event);
+		}
+
+		//A partial event at the end is what a killed recording leaves; it is dropped.
+		return events;
+	}
+}
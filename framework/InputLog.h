@@ -0,0 +1,49 @@
+
+#ifndef FRAMEWORK_INPUT_LOG_H
+#define FRAMEWORK_INPUT_LOG_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+namespace Framework
+{
+	enum InputEventType
+	{
+		INPUT_KEYBOARD,
+		INPUT_MOUSE_BUTTON,
+		INPUT_MOUSE_MOTION,
+		INPUT_MOUSE_WHEEL
+	};
+
+	//One GLUT input callback. It is replayed just before the display() of frame frameIx.
+	struct InputEvent
+	{
+		unsigned int frameIx;
+		InputEventType type;
+		int code;		//The key, the mouse button, or the wheel number.
+		int state;		//GLUT_DOWN or GLUT_UP for buttons; the direction for the wheel.
+		int x;
+		int y;
+		int modifiers;	//GLUT_ACTIVE_* flags.
+	};
+
+	//Writes events to a compact binary log, flushing after each one so that the log
+	//survives the program being killed.
+	class InputLogWriter
+	{
+	public:
+		//Throws a std::runtime_error if the file cannot be opened.
+		explicit InputLogWriter(const std::string &filename);
+
+		void Write(const InputEvent &event);
+
+	private:
+		std::ofstream m_file;
+	};
+
+	//Throws a std::runtime_error if the file cannot be read or is not an input log.
+	std::vector<InputEvent> ReadInputLog(const std::string &filename);
+}
+
+#endif //FRAMEWORK_INPUT_LOG_H
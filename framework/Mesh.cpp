@@ -8,12 +8,17 @@
 #include <stdexcept>
 #include <functional>
 #include <algorithm>
+#include <memory>
 #include <iostream>
 #include <glload/gl_3_2_comp.h>
 #include <glload/gll.h>
 #include <GL/freeglut.h>
 #include "framework.h"
 #include "Mesh.h"
+#include "StateCache.h"
+#include "FrameStats.h"
+#include "Profiler.h"
+#include "ResourceFS.h"
 #include "directories.h"
 #include "rapidxml.hpp"
 #include "rapidxml_helpers.h"
@@ -55,6 +60,8 @@ namespace Framework
 				glDrawElements(ePrimType, elemCount, eIndexDataType, (void*)start);
 			else
 				glDrawArrays(ePrimType, start, elemCount);
+
+			CountDraw(ePrimType, elemCount);
 		}
 	};
 
@@ -94,9 +101,11 @@ namespace Framework
 	while(!inStream.eof() && inStream.good())\
 	{\
 	AttribData theValue;\
-	inStream >> theValue.attribDataValue >> std::ws;\
+	inStream >> theValue.attribDataValue;\
 	if(inStream.fail())\
 	throw std::runtime_error("Parse error in array data stream.");\
+	if(!inStream.eof())\
+	inStream >> std::ws;\
 	outputData.push_back(theValue);\
 	}\
 	}\
@@ -471,16 +480,11 @@ namespace Framework
 		std::vector<std::pair<std::string, std::vector<GLuint> > > namedVaoList;
 
 		{
-			std::string strDataFilename = FindFileOrThrow(strFilename);
-			std::ifstream fileStream(strDataFilename.c_str());
-			if(!fileStream.is_open())
-				throw std::runtime_error("Could not find the mesh file: " + strDataFilename);
-
-			std::vector<char> fileData;
-			fileData.reserve(2*1024*1024);
-			fileData.insert(fileData.end(), std::istreambuf_iterator<char>(fileStream),
-				std::istreambuf_iterator<char>());
+			//rapidxml parses in place, and needs a terminator.
+			std::auto_ptr<FileView> pFile(OpenResource(strFilename));
+			std::vector<char> fileData(pFile->GetData(), pFile->GetData() + pFile->GetSize());
 			fileData.push_back('\0');
+			pFile.reset();
 
 			xml_document<> doc;
 
@@ -490,16 +494,16 @@ namespace Framework
 			}
 			catch(rapidxml::parse_error &e)
 			{
-				std::cout << strDataFilename << ": Parse error in the mesh file." << std::endl;
+				std::cout << strFilename << ": Parse error in the mesh file." << std::endl;
 				std::cout << e.what() << std::endl << e.where<char>() << std::endl;
 				throw;
 			}
 
 			xml_node<> *pRootNode = doc.first_node("mesh");
-			PARSE_THROW(pRootNode, ("`mesh` node not found in mesh file: " + strDataFilename));
+			PARSE_THROW(pRootNode, ("`mesh` node not found in mesh file: " + strFilename));
 
 			const xml_node<> *pNode = pRootNode->first_node("attribute");
-			PARSE_THROW(pNode, ("`mesh` node must have at least one `attribute` child. File: " + strDataFilename));
+			PARSE_THROW(pNode, ("`mesh` node must have at least one `attribute` child. File: " + strFilename));
 
 			for(;
 				pNode && (make_string_name(*pNode) == "attribute");
@@ -560,6 +564,7 @@ namespace Framework
 		glGenBuffers(1, &m_pData->oAttribArraysBuffer);
 		glBindBuffer(GL_ARRAY_BUFFER, m_pData->oAttribArraysBuffer);
 		glBufferData(GL_ARRAY_BUFFER, iAttrbBufferSize, NULL, GL_STATIC_DRAW);
+		CountBufferUpload(iAttrbBufferSize);
 
 		//Fill in our data and set up the attribute arrays.
 		for(size_t iLoop = 0; iLoop < attribs.size(); iLoop++)
@@ -622,6 +627,7 @@ namespace Framework
 			glGenBuffers(1, &m_pData->oIndexBuffer);
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_pData->oIndexBuffer);
 			glBufferData(GL_ELEMENT_ARRAY_BUFFER, iIndexBufferSize, NULL, GL_STATIC_DRAW);
+			CountBufferUpload(iIndexBufferSize);
 
 			//Fill with data.
 			for(size_t iLoop = 0; iLoop < indexData.size(); iLoop++)
@@ -668,10 +674,11 @@ namespace Framework
 		if(!m_pData->oVAO)
 			return;
 
-		glBindVertexArray(m_pData->oVAO);
+		ProfileScope drawScope("Mesh::Render");
+		CachedBindVertexArray(m_pData->oVAO);
 		std::for_each(m_pData->primatives.begin(), m_pData->primatives.end(),
 			std::mem_fun_ref(&RenderCmd::Render));
-		glBindVertexArray(0);
+		CachedBindVertexArray(0);
 	}
 
 	void Mesh::Render( const std::string &strMeshName ) const
@@ -680,10 +687,11 @@ namespace Framework
 		if(theIt == m_pData->namedVAOs.end())
 			return;
 
-		glBindVertexArray(theIt->second);
+		ProfileScope drawScope("Mesh::Render");
+		CachedBindVertexArray(theIt->second);
 		std::for_each(m_pData->primatives.begin(), m_pData->primatives.end(),
 			std::mem_fun_ref(&RenderCmd::Render));
-		glBindVertexArray(0);
+		CachedBindVertexArray(0);
 	}
 
 	void Mesh::DeleteObjects()
@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <GL/freeglut.h>
 #include <glutil/MousePoles.h>
+#include "framework.h"
 
 namespace Framework
 {
@@ -11,7 +12,7 @@ namespace Framework
 	{
 		int ret = 0;
 
-		int modifiers = glutGetModifiers();
+		int modifiers = GetModifiers();
 		if(modifiers & GLUT_ACTIVE_SHIFT)
 			ret |= glutil::MM_KEY_SHIFT;
 		if(modifiers & GLUT_ACTIVE_CTRL)
@@ -0,0 +1,169 @@
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <stdio.h>
+#include <glload/gl_3_3.h>
+#include "framework.h"
+#include "Clock.h"
+#include "PerfReport.h"
+
+namespace Framework
+{
+	namespace
+	{
+		struct PendingGpuFrame
+		{
+			GLuint query;
+			bool isCounted;
+		};
+
+		bool g_isReporting = false;
+		std::string g_reportFilename;
+		int g_warmupFrames = 0;
+		int g_numFrames = 0;
+
+		GLuint64 g_frameStartNs = 0;
+		std::vector<double> g_cpuTimesMs;
+		std::vector<double> g_gpuTimesMs;
+
+		//Queries are read back a few frames late, so that reading them does not stall.
+		std::deque<PendingGpuFrame> g_pendingGpuFrames;
+		std::vector<GLuint> g_freeQueries;
+
+		void CollectGpuFrames(bool shouldWait)
+		{
+			while(!g_pendingGpuFrames.empty())
+			{
+				PendingGpuFrame &frame = g_pendingGpuFrames.front();
+				if(!shouldWait)
+				{
+					GLuint isAvailable = GL_FALSE;
+					glGetQueryObjectuiv(frame.query, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+					if(!isAvailable)
+						return;
+				}
+
+				GLuint64 elapsedNs = 0;
+				glGetQueryObjectui64v(frame.query, GL_QUERY_RESULT, &elapsedNs);
+				if(frame.isCounted)
+					g_gpuTimesMs.push_back(elapsedNs / 1000000.0);
+
+				g_freeQueries.push_back(frame.query);
+				g_pendingGpuFrames.pop_front();
+			}
+		}
+
+		double GetPercentile(const std::vector<double> &sortedTimes, int percentile)
+		{
+			if(sortedTimes.empty())
+				return 0.0;
+
+			//Nearest rank, as for the frame pacer's statistics.
+			size_t rank = (sortedTimes.size() * percentile + 99) / 100;
+			return sortedTimes[rank ? rank - 1 : 0];
+		}
+
+		void WriteTimes(FILE *pFile, const char *name, std::vector<double> times)
+		{
+			std::sort(times.begin(), times.end());
+			fprintf(pFile, "%s_p50_ms %f\n", name, GetPercentile(times, 50));
+			fprintf(pFile, "%s_p95_ms %f\n", name, GetPercentile(times, 95));
+			fprintf(pFile, "%s_p99_ms %f\n", name, GetPercentile(times, 99));
+			fprintf(pFile, "%s_max_ms %f\n", name, times.empty() ? 0.0 : times.back());
+		}
+
+		//FNV-1a, 64-bit.
+		unsigned long long ChecksumPixels(int width, int height)
+		{
+			std::vector<unsigned char> pixels(width * height * 4);
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+
+			unsigned long long hash = 14695981039346656037ULL;
+			for(size_t byteIx = 0; byteIx < pixels.size(); ++byteIx)
+			{
+				hash ^= pixels[byteIx];
+				hash *= 1099511628211ULL;
+			}
+
+			return hash;
+		}
+	}
+
+	void StartPerfReport( const std::string &filename, int warmupFrames )
+	{
+		g_isReporting = true;
+		g_reportFilename = filename;
+		g_warmupFrames = warmupFrames;
+	}
+
+	void BeginPerfFrame()
+	{
+		if(!g_isReporting)
+			return;
+
+		CollectGpuFrames(false);
+
+		if(g_freeQueries.empty())
+		{
+			GLuint newQueries[8];
+			glGenQueries(8, newQueries);
+			g_freeQueries.insert(g_freeQueries.end(), newQueries, newQueries + 8);
+		}
+
+		PendingGpuFrame frame;
+		frame.query = g_freeQueries.back();
+		frame.isCounted = g_numFrames >= g_warmupFrames;
+		g_freeQueries.pop_back();
+		g_pendingGpuFrames.push_back(frame);
+
+		glBeginQuery(GL_TIME_ELAPSED, frame.query);
+		g_frameStartNs = GetMonotonicTimeNs();
+	}
+
+	void EndPerfFrame()
+	{
+		if(!g_isReporting)
+			return;
+
+		GLuint64 frameEndNs = GetMonotonicTimeNs();
+		glEndQuery(GL_TIME_ELAPSED);
+
+		if(g_numFrames >= g_warmupFrames)
+			g_cpuTimesMs.push_back((frameEndNs - g_frameStartNs) / 1000000.0);
+
+		++g_numFrames;
+	}
+
+	void WritePerfReport( int width, int height )
+	{
+		if(!g_isReporting)
+			return;
+
+		CollectGpuFrames(true);
+		if(!g_freeQueries.empty())
+			glDeleteQueries((GLsizei)g_freeQueries.size(), &g_freeQueries[0]);
+		g_freeQueries.clear();
+
+		unsigned long long checksum = ChecksumPixels(width, height);
+
+		FILE *pFile = fopen(g_reportFilename.c_str(), "w");
+		if(!pFile)
+			throw std::runtime_error("Could not write the performance report " + g_reportFilename);
+
+		fprintf(pFile, "frames %d\n", g_numFrames);
+		fprintf(pFile, "timed_frames %d\n", (int)g_cpuTimesMs.size());
+		fprintf(pFile, "width %d\n", width);
+		fprintf(pFile, "height %d\n", height);
+		WriteTimes(pFile, "cpu", g_cpuTimesMs);
+		WriteTimes(pFile, "gpu", g_gpuTimesMs);
+		fprintf(pFile, "checksum %016llx\n", checksum);
+		fclose(pFile);
+
+		g_isReporting = false;
+	}
+}
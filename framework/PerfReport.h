@@ -0,0 +1,27 @@
+
+#ifndef FRAMEWORK_PERF_REPORT_H
+#define FRAMEWORK_PERF_REPORT_H
+
+#include <string>
+
+namespace Framework
+{
+	//Records how long each display() takes, on the CPU and on the GPU, and writes a
+	//summary to a file when the program finishes: the frame percentiles and a checksum
+	//of the final frame's pixels. Test/PerfRunner compares these against a baseline.
+	//The first warmupFrames frames are left out of the percentiles.
+	//The framework reads the filename from the GLTUT_PERF_REPORT environment variable,
+	//and warmupFrames from GLTUT_PERF_WARMUP. Only headless runs write reports.
+	void StartPerfReport(const std::string &filename, int warmupFrames);
+
+	//The framework calls these around every display().
+	void BeginPerfFrame();
+	void EndPerfFrame();
+
+	//Waits for the GPU, then writes the report. The checksum covers the width x height
+	//pixels at the origin of the current read framebuffer.
+	//Throws a std::runtime_error if the file cannot be written.
+	void WritePerfReport(int width, int height);
+}
+
+#endif //FRAMEWORK_PERF_REPORT_H
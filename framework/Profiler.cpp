@@ -0,0 +1,301 @@
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <exception>
+#include <stdexcept>
+#include <stdio.h>
+
+#include <glload/gl_3_3.h>
+#include <glload/gll.hpp>
+#include "framework.h"
+#include "Clock.h"
+#include "Profiler.h"
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#define GL_DEBUG_SOURCE_APPLICATION 0x824A
+
+namespace Framework
+{
+	namespace
+	{
+		typedef void (APIENTRY *PushDebugGroupFunc)(GLenum source, GLuint id, GLsizei length,
+			const GLchar *message);
+		typedef void (APIENTRY *PopDebugGroupFunc)();
+
+		//GPU times are read back this many frames after they were issued. By then the
+		//queries have normally finished, so reading them will not stall.
+		const size_t g_gpuReadbackLatency = 3;
+
+		struct TraceEvent
+		{
+			const char *name;
+			bool isGpu;
+			GLint64 startNs;
+			GLint64 durationNs;
+		};
+
+		struct GpuScope
+		{
+			const char *name;
+			GLuint beginQuery;
+			GLuint endQuery;
+		};
+
+		typedef std::vector<GpuScope> FrameScopes;
+
+		struct ProfilerState
+		{
+			ProfilerState()
+				: isInitialized(false)
+				, hasTimerQuery(false)
+				, PushDebugGroup(NULL)
+				, PopDebugGroup(NULL)
+				, isRecording(false)
+				, traceStartNs(0)
+				, gpuToCpuNs(0)
+			{}
+
+			bool isInitialized;
+			bool hasTimerQuery;
+			PushDebugGroupFunc PushDebugGroup;
+			PopDebugGroupFunc PopDebugGroup;
+
+			bool isRecording;
+			std::string filename;
+			GLint64 traceStartNs;
+			GLint64 gpuToCpuNs;		//Add to a GL_TIMESTAMP to get CPU time.
+
+			std::vector<TraceEvent> events;
+
+			std::vector<GLuint> freeQueries;
+			FrameScopes currFrame;
+			std::deque<FrameScopes> pendingFrames;
+		};
+
+		ProfilerState g_profiler;
+
+		GLuint IssueTimestampQuery()
+		{
+			if(g_profiler.freeQueries.empty())
+			{
+				GLuint newQueries[16];
+				glGenQueries(16, newQueries);
+				g_profiler.freeQueries.insert(g_profiler.freeQueries.end(), newQueries, newQueries + 16);
+			}
+
+			GLuint query = g_profiler.freeQueries.back();
+			g_profiler.freeQueries.pop_back();
+			glQueryCounter(query, GL_TIMESTAMP);
+			return query;
+		}
+
+		void ReleaseQueries(const FrameScopes &frame)
+		{
+			for(size_t scopeIx = 0; scopeIx < frame.size(); ++scopeIx)
+			{
+				g_profiler.freeQueries.push_back(frame[scopeIx].beginQuery);
+				g_profiler.freeQueries.push_back(frame[scopeIx].endQuery);
+			}
+		}
+
+		void ResolveFrame(const FrameScopes &frame)
+		{
+			for(size_t scopeIx = 0; scopeIx < frame.size(); ++scopeIx)
+			{
+				GLuint64 beginTime = 0;
+				GLuint64 endTime = 0;
+				glGetQueryObjectui64v(frame[scopeIx].beginQuery, GL_QUERY_RESULT, &beginTime);
+				glGetQueryObjectui64v(frame[scopeIx].endQuery, GL_QUERY_RESULT, &endTime);
+
+				TraceEvent event;
+				event.name = frame[scopeIx].name;
+				event.isGpu = true;
+				event.startNs = (GLint64)beginTime + g_profiler.gpuToCpuNs;
+				event.durationNs = (GLint64)(endTime - beginTime);
+				g_profiler.events.push_back(event);
+			}
+
+			ReleaseQueries(frame);
+		}
+
+		void DiscardPendingScopes()
+		{
+			ReleaseQueries(g_profiler.currFrame);
+			g_profiler.currFrame.clear();
+			while(!g_profiler.pendingFrames.empty())
+			{
+				ReleaseQueries(g_profiler.pendingFrames.front());
+				g_profiler.pendingFrames.pop_front();
+			}
+		}
+
+		void WriteJSONString(std::ostream &file, const char *str)
+		{
+			file << '"';
+			for(; *str; ++str)
+			{
+				if(*str == '"' || *str == '\\')
+					file << '\\';
+				file << *str;
+			}
+			file << '"';
+		}
+
+		void WriteTrace(std::ostream &file)
+		{
+			file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+			file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+			file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+			char timeBuffer[64];
+			for(size_t eventIx = 0; eventIx < g_profiler.events.size(); ++eventIx)
+			{
+				const TraceEvent &event = g_profiler.events[eventIx];
+				file << ",\n{\"name\":";
+				WriteJSONString(file, event.name);
+
+				//Chrome trace times are in microseconds.
+				sprintf(timeBuffer, "%.3f,\"dur\":%.3f",
+					(event.startNs - g_profiler.traceStartNs) / 1000.0, event.durationNs / 1000.0);
+				file << ",\"cat\":\"" << (event.isGpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"ts\":"
+					<< timeBuffer << ",\"pid\":1,\"tid\":" << (event.isGpu ? 2 : 1) << "}";
+			}
+
+			file << "\n]}\n";
+		}
+	}
+
+	ProfileScope::ProfileScope( const char *name )
+		: m_isActive(g_profiler.isRecording)
+		, m_cpuEventIx(0)
+		, m_beginQuery(0)
+	{
+		if(!m_isActive)
+			return;
+
+		if(g_profiler.PushDebugGroup)
+			g_profiler.PushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+
+		if(g_profiler.hasTimerQuery)
+			m_beginQuery = IssueTimestampQuery();
+
+		TraceEvent event;
+		event.name = name;
+		event.isGpu = false;
+		event.durationNs = 0;
+		m_cpuEventIx = g_profiler.events.size();
+		g_profiler.events.push_back(event);
+
+		//Read the clock last, so that the profiler's own work is not counted.
+		g_profiler.events.back().startNs = GetMonotonicTimeNs();
+	}
+
+	ProfileScope::~ProfileScope()
+	{
+		//The trace may have been stopped, or even restarted, while we were alive.
+		if(!m_isActive || !g_profiler.isRecording || m_cpuEventIx >= g_profiler.events.size())
+			return;
+
+		TraceEvent &event = g_profiler.events[m_cpuEventIx];
+		event.durationNs = (GLint64)GetMonotonicTimeNs() - event.startNs;
+
+		if(m_beginQuery)
+		{
+			GpuScope scope;
+			scope.name = event.name;
+			scope.beginQuery = m_beginQuery;
+			scope.endQuery = IssueTimestampQuery();
+			g_profiler.currFrame.push_back(scope);
+		}
+
+		if(g_profiler.PopDebugGroup)
+			g_profiler.PopDebugGroup();
+	}
+
+	void InitProfiler()
+	{
+		g_profiler.hasTimerQuery = glload::IsVersionGEQ(3, 3) || glext_ARB_timer_query;
+
+		if(glload::IsVersionGEQ(4, 3) || HasGLExtension("GL_KHR_debug"))
+		{
+			g_profiler.PushDebugGroup = (PushDebugGroupFunc)GetGLProcAddress("glPushDebugGroup");
+			g_profiler.PopDebugGroup = (PopDebugGroupFunc)GetGLProcAddress("glPopDebugGroup");
+			if(!g_profiler.PushDebugGroup || !g_profiler.PopDebugGroup)
+			{
+				g_profiler.PushDebugGroup = NULL;
+				g_profiler.PopDebugGroup = NULL;
+			}
+		}
+
+		g_profiler.isInitialized = true;
+	}
+
+	void StartProfileTrace( const std::string &filename )
+	{
+		DiscardPendingScopes();
+		g_profiler.events.clear();
+		g_profiler.filename = filename;
+		g_profiler.isRecording = true;
+		g_profiler.traceStartNs = GetMonotonicTimeNs();
+
+		if(g_profiler.isInitialized && g_profiler.hasTimerQuery)
+		{
+			GLint64 gpuNow = 0;
+			glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+			g_profiler.gpuToCpuNs = (GLint64)GetMonotonicTimeNs() - gpuNow;
+		}
+	}
+
+	void StopProfileTrace()
+	{
+		if(!g_profiler.isRecording)
+			return;
+
+		g_profiler.isRecording = false;
+		DiscardPendingScopes();
+
+		std::ofstream traceFile(g_profiler.filename.c_str());
+		if(!traceFile.is_open())
+			throw std::runtime_error("Could not open the profile trace file: " + g_profiler.filename);
+
+		WriteTrace(traceFile);
+		g_profiler.events.clear();
+	}
+
+	bool IsProfiling()
+	{
+		return g_profiler.isRecording;
+	}
+
+	void EndProfileFrame()
+	{
+		if(!g_profiler.isRecording)
+			return;
+
+		g_profiler.pendingFrames.push_back(FrameScopes());
+		g_profiler.pendingFrames.back().swap(g_profiler.currFrame);
+
+		while(!g_profiler.pendingFrames.empty())
+		{
+			const FrameScopes &oldestFrame = g_profiler.pendingFrames.front();
+
+			//Queries finish in order, so if the frame's last one is done, they all are.
+			//Past the latency limit, wait for them rather than falling further behind.
+			if(!oldestFrame.empty() && g_profiler.pendingFrames.size() <= g_gpuReadbackLatency)
+			{
+				GLuint isAvailable = GL_FALSE;
+				glGetQueryObjectuiv(oldestFrame.back().endQuery, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+				if(!isAvailable)
+					break;
+			}
+
+			ResolveFrame(oldestFrame);
+			g_profiler.pendingFrames.pop_front();
+		}
+	}
+}
@@ -0,0 +1,51 @@
+
+#ifndef FRAMEWORK_PROFILER_H
+#define FRAMEWORK_PROFILER_H
+
+#include <string>
+
+namespace Framework
+{
+	//Records the CPU and GPU time spent while it is alive, under the given name.
+	//Scopes nest. They do nothing unless a trace is being recorded. When KHR_debug is
+	//available, each scope is also emitted as a debug group, so that it shows up in
+	//tools like RenderDoc and apitrace.
+	//
+	//The name is not copied, so it must outlive the trace; string literals are best.
+	//Scopes must only be used on the OpenGL thread.
+	class ProfileScope
+	{
+	public:
+		explicit ProfileScope(const char *name);
+		~ProfileScope();
+
+	private:
+		bool m_isActive;
+		size_t m_cpuEventIx;
+		GLuint m_beginQuery;
+
+		ProfileScope(const ProfileScope &);
+		ProfileScope &operator=(const ProfileScope &);
+	};
+
+	//Must be called after the OpenGL context is created and glload is initialized.
+	//The framework does this itself.
+	void InitProfiler();
+
+	//Starts recording scopes. If the GLTUT_PROFILE_TRACE environment variable is set,
+	//the framework starts a trace to that file before init() is called.
+	void StartProfileTrace(const std::string &filename);
+
+	//Writes everything recorded so far to the trace file as Chrome trace event JSON, which
+	//chrome://tracing and Perfetto can load. GPU times are read back a few frames late,
+	//so the GPU times of the last few frames are dropped. Makes no OpenGL calls.
+	//Throws a std::runtime_error if the file cannot be written.
+	void StopProfileTrace();
+
+	bool IsProfiling();
+
+	//Collects GPU times that have become available. The framework calls this after every display().
+	void EndProfileFrame();
+}
+
+#endif //FRAMEWORK_PROFILER_H
@@ -0,0 +1,147 @@
+
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <stdio.h>
+#include <glload/gl_3_3.h>
+#include <glutil/Shader.h>
+#include "framework.h"
+#include "ShaderCache.h"
+#include "ProgramBatch.h"
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+namespace Framework
+{
+	namespace
+	{
+		typedef void (APIENTRY *MaxShaderCompilerThreadsFunc)(GLuint count);
+
+		//Lets the driver pick how many threads to compile with. Drivers that support the
+		//extension may otherwise compile on the calling thread.
+		void EnableParallelCompile()
+		{
+			static bool isInitialized = false;
+			if(isInitialized)
+				return;
+
+			isInitialized = true;
+
+			MaxShaderCompilerThreadsFunc MaxShaderCompilerThreads = NULL;
+			if(HasGLExtension("GL_KHR_parallel_shader_compile"))
+				MaxShaderCompilerThreads = (MaxShaderCompilerThreadsFunc)GetGLProcAddress("glMaxShaderCompilerThreadsKHR");
+			else if(HasGLExtension("GL_ARB_parallel_shader_compile"))
+				MaxShaderCompilerThreads = (MaxShaderCompilerThreadsFunc)GetGLProcAddress("glMaxShaderCompilerThreadsARB");
+
+			if(MaxShaderCompilerThreads)
+				MaxShaderCompilerThreads(0xFFFFFFFF);
+		}
+	}
+
+	ProgramBatch::ProgramBatch()
+		: m_isFinished(false)
+	{
+		EnableParallelCompile();
+	}
+
+	ProgramBatch::~ProgramBatch()
+	{
+		if(m_isFinished)
+			return;
+
+		for(size_t progIx = 0; progIx < m_programs.size(); ++progIx)
+			glDeleteProgram(m_programs[progIx].program);
+
+		std::for_each(m_shaders.begin(), m_shaders.end(), ReleaseShader);
+	}
+
+	GLuint ProgramBatch::LoadShader(GLenum eShaderType, const std::string &strShaderFilename)
+	{
+		return LoadShader(eShaderType, strShaderFilename, ShaderDefines());
+	}
+
+	GLuint ProgramBatch::LoadShader(GLenum eShaderType, const std::string &strShaderFilename,
+		const ShaderDefines &defines)
+	{
+		GLuint shader = SubmitShader(eShaderType, strShaderFilename, defines);
+		m_shaders.insert(shader);
+		return shader;
+	}
+
+	GLuint ProgramBatch::CreateProgram(const std::vector<GLuint> &shaderList)
+	{
+		//Shaders that did not come from this batch are still released by Finish.
+		m_shaders.insert(shaderList.begin(), shaderList.end());
+
+		PendingProgram pending;
+		pending.program = glCreateProgram();
+		pending.shaders = shaderList;
+		m_programs.push_back(pending);
+
+		for(size_t shaderIx = 0; shaderIx < shaderList.size(); ++shaderIx)
+			glAttachShader(pending.program, shaderList[shaderIx]);
+
+		glLinkProgram(pending.program);
+		return pending.program;
+	}
+
+	GLuint ProgramBatch::CreateProgram(const std::string &strVertexShader,
+		const std::string &strFragmentShader)
+	{
+		std::vector<GLuint> shaderList;
+		shaderList.push_back(LoadShader(GL_VERTEX_SHADER, strVertexShader));
+		shaderList.push_back(LoadShader(GL_FRAGMENT_SHADER, strFragmentShader));
+		return CreateProgram(shaderList);
+	}
+
+	void ProgramBatch::Finish()
+	{
+		for(std::set<GLuint>::iterator shaderIt = m_shaders.begin(); shaderIt != m_shaders.end(); ++shaderIt)
+		{
+			GLuint shader = *shaderIt;
+			try
+			{
+				CheckShader(shader);
+			}
+			catch(std::exception &)
+			{
+				//Already deleted.
+				m_shaders.erase(shaderIt);
+				throw;
+			}
+		}
+
+		for(size_t progIx = 0; progIx < m_programs.size(); ++progIx)
+		{
+			GLuint program = m_programs[progIx].program;
+
+			GLint status;
+			glGetProgramiv(program, GL_LINK_STATUS, &status);
+			if(status == GL_FALSE)
+			{
+				//The exception deletes the program.
+				m_programs.erase(m_programs.begin() + progIx);
+				glutil::CompileLinkException linkError(program, true);
+				fprintf(stderr, "%s\n", linkError.what());
+				throw linkError;
+			}
+		}
+
+		for(size_t progIx = 0; progIx < m_programs.size(); ++progIx)
+		{
+			const PendingProgram &pending = m_programs[progIx];
+			for(size_t shaderIx = 0; shaderIx < pending.shaders.size(); ++shaderIx)
+				glDetachShader(pending.program, pending.shaders[shaderIx]);
+		}
+
+		std::for_each(m_shaders.begin(), m_shaders.end(), ReleaseShader);
+		m_shaders.clear();
+		m_programs.clear();
+		m_isFinished = true;
+	}
+}
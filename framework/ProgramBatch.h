@@ -0,0 +1,55 @@
+
+#ifndef FRAMEWORK_PROGRAM_BATCH_H
+#define FRAMEWORK_PROGRAM_BATCH_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include "framework.h"
+
+namespace Framework
+{
+	//Compiles and links a set of programs without waiting on each compile and link in
+	//turn, so that the driver can overlap them. With KHR_parallel_shader_compile it uses
+	//its own threads for this. Nothing is checked until Finish, so the caller is free to
+	//do other work first; the programs may not be used until Finish returns.
+	class ProgramBatch
+	{
+	public:
+		ProgramBatch();
+
+		//Deletes the programs if Finish did not succeed.
+		~ProgramBatch();
+
+		//As the LoadShader functions.
+		GLuint LoadShader(GLenum eShaderType, const std::string &strShaderFilename);
+		GLuint LoadShader(GLenum eShaderType, const std::string &strShaderFilename,
+			const ShaderDefines &defines);
+
+		//As CreateProgram; the shaders are released by Finish.
+		GLuint CreateProgram(const std::vector<GLuint> &shaderList);
+
+		//Loads both shaders, then creates a program from them.
+		GLuint CreateProgram(const std::string &strVertexShader, const std::string &strFragmentShader);
+
+		//Checks every compile, then every link. The first failure prints its log and throws
+		//a glutil::CompileLinkException.
+		void Finish();
+
+	private:
+		struct PendingProgram
+		{
+			GLuint program;
+			std::vector<GLuint> shaders;
+		};
+
+		std::set<GLuint> m_shaders;
+		std::vector<PendingProgram> m_programs;
+		bool m_isFinished;
+
+		ProgramBatch(const ProgramBatch &);
+		ProgramBatch &operator=(const ProgramBatch &);
+	};
+}
+
+#endif //FRAMEWORK_PROGRAM_BATCH_H
@@ -0,0 +1,397 @@
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <string.h>
+#include <ctype.h>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif //WIN32
+
+#ifdef LOAD_X11
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#endif //LOAD_X11
+
+#include <glload/gl_3_3.h>
+#include <glimg/glimg.h>
+#include <glimg/MappedFile.h>
+#include "framework.h"
+#include "directories.h"
+#include "ResourceFS.h"
+
+//glimg's copy of stb_image carries a raw deflate decoder; there is no need for another.
+extern "C" int stbi_zlib_decode_noheader_buffer(char *obuffer, int olen, const char *ibuffer, int ilen);
+
+namespace Framework
+{
+	namespace
+	{
+		struct ArchiveEntry
+		{
+			size_t archiveIx;
+			size_t localHeaderOffset;
+			size_t compressedSize;
+			size_t size;
+			bool isDeflated;
+		};
+
+		struct ResourceEntry
+		{
+			std::string filePath;	//Empty for archive entries.
+			ArchiveEntry archived;
+		};
+
+		typedef std::map<std::string, ResourceEntry> ResourceIndex;
+
+		ResourceIndex g_index;
+		bool g_isIndexBuilt = false;
+
+		//Archives stay mapped until the program ends, since views may point into them.
+		std::vector<glimg::MappedFile *> g_archives;
+
+		const char *g_searchRoots[] = {LOCAL_FILE_DIR, GLOBAL_FILE_DIR};
+
+		std::string NormalizeName(const std::string &name)
+		{
+			std::string normalized(name);
+			for(size_t charIx = 0; charIx < normalized.size(); ++charIx)
+			{
+				if(normalized[charIx] == '\\')
+					normalized[charIx] = '/';
+			}
+
+			return normalized;
+		}
+
+		void AddFile(const std::string &name, const std::string &filePath)
+		{
+			//Earlier roots win.
+			if(g_index.find(name) != g_index.end())
+				return;
+
+			ResourceEntry entry;
+			entry.filePath = filePath;
+			g_index[name] = entry;
+		}
+
+		void IndexDirectory(const std::string &root, const std::string &prefix)
+		{
+#ifdef WIN32
+			WIN32_FIND_DATAA findData;
+			HANDLE hFind = FindFirstFileA((root + prefix + "*").c_str(), &findData);
+			if(hFind == INVALID_HANDLE_VALUE)
+				return;
+
+			do
+			{
+				std::string fileName(findData.cFileName);
+				if(fileName == "." || fileName == "..")
+					continue;
+
+				if(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+					IndexDirectory(root, prefix + fileName + "/");
+				else
+					AddFile(prefix + fileName, root + prefix + fileName);
+			} while(FindNextFileA(hFind, &findData));
+
+			FindClose(hFind);
+#endif //WIN32
+
+#ifdef LOAD_X11
+			DIR *pDir = opendir((root + prefix).c_str());
+			if(!pDir)
+				return;
+
+			while(dirent *pEntry = readdir(pDir))
+			{
+				std::string fileName(pEntry->d_name);
+				if(fileName == "." || fileName == "..")
+					continue;
+
+				std::string filePath = root + prefix + fileName;
+				bool isDirectory = pEntry->d_type == DT_DIR;
+				if(pEntry->d_type == DT_UNKNOWN)
+				{
+					struct stat fileStat;
+					isDirectory = stat(filePath.c_str(), &fileStat) == 0 && S_ISDIR(fileStat.st_mode);
+				}
+
+				if(isDirectory)
+					IndexDirectory(root, prefix + fileName + "/");
+				else
+					AddFile(prefix + fileName, filePath);
+			}
+
+			closedir(pDir);
+#endif //LOAD_X11
+		}
+
+		void BuildIndex()
+		{
+			if(g_isIndexBuilt)
+				return;
+
+			//Archives may have been mounted already; loose files take precedence.
+			ResourceIndex archived;
+			archived.swap(g_index);
+
+			for(size_t rootIx = 0; rootIx < ARRAY_COUNT(g_searchRoots); ++rootIx)
+				IndexDirectory(g_searchRoots[rootIx], "");
+
+			g_index.insert(archived.begin(), archived.end());
+			g_isIndexBuilt = true;
+		}
+
+		//For files created after the index was built.
+		const ResourceEntry *ProbeFile(const std::string &name)
+		{
+			for(size_t rootIx = 0; rootIx < ARRAY_COUNT(g_searchRoots); ++rootIx)
+			{
+				std::string filePath = std::string(g_searchRoots[rootIx]) + name;
+#ifdef WIN32
+				DWORD attribs = GetFileAttributesA(filePath.c_str());
+				bool isFile = attribs != INVALID_FILE_ATTRIBUTES && !(attribs & FILE_ATTRIBUTE_DIRECTORY);
+#endif //WIN32
+#ifdef LOAD_X11
+				struct stat fileStat;
+				bool isFile = stat(filePath.c_str(), &fileStat) == 0 && S_ISREG(fileStat.st_mode);
+#endif //LOAD_X11
+				if(isFile)
+				{
+					AddFile(name, filePath);
+					return &g_index[name];
+				}
+			}
+
+			return NULL;
+		}
+
+		const ResourceEntry *FindEntry(const std::string &name)
+		{
+			BuildIndex();
+
+			std::string normalized = NormalizeName(name);
+			ResourceIndex::const_iterator theIt = g_index.find(normalized);
+			if(theIt != g_index.end())
+				return &theIt->second;
+
+			return ProbeFile(normalized);
+		}
+
+		unsigned int GetU16(const char *pSrc)
+		{
+			const unsigned char *pBytes = (const unsigned char *)pSrc;
+			return pBytes[0] | (pBytes[1] << 8);
+		}
+
+		unsigned int GetU32(const char *pSrc)
+		{
+			return GetU16(pSrc) | (GetU16(pSrc + 2) << 16);
+		}
+
+		const unsigned int g_endOfDirSig = 0x06054b50;
+		const unsigned int g_dirEntrySig = 0x02014b50;
+		const unsigned int g_localHeaderSig = 0x04034b50;
+		const size_t g_endOfDirSize = 22;
+		const size_t g_dirEntrySize = 46;
+		const size_t g_localHeaderSize = 30;
+
+		enum CompressionMethod
+		{
+			ZIP_STORED = 0,
+			ZIP_DEFLATED = 8
+		};
+
+		void ReadArchiveDirectory(const glimg::MappedFile &archive, size_t archiveIx, const std::string &filename)
+		{
+			const char *pArchiveData = reinterpret_cast<const char *>(archive.GetData());
+			const size_t archiveSize = archive.GetSize();
+			if(archiveSize < g_endOfDirSize)
+				throw std::runtime_error("Not a zip archive: " + filename);
+
+			//The end record is last, but may be followed by a comment of up to 64KB.
+			size_t endIx = archiveSize - g_endOfDirSize;
+			size_t endSearchLimit = endIx > 0xFFFF ? endIx - 0xFFFF : 0;
+			while(GetU32(pArchiveData + endIx) != g_endOfDirSig)
+			{
+				if(endIx == endSearchLimit)
+					throw std::runtime_error("Not a zip archive: " + filename);
+				--endIx;
+			}
+
+			const char *pEnd = pArchiveData + endIx;
+			size_t numEntries = GetU16(pEnd + 10);
+			size_t dirOffset = GetU32(pEnd + 16);
+			if(numEntries == 0xFFFF || dirOffset == 0xFFFFFFFF)
+				throw std::runtime_error("Zip64 archives are not supported: " + filename);
+
+			size_t entryOffset = dirOffset;
+			for(size_t entryIx = 0; entryIx < numEntries; ++entryIx)
+			{
+				if(entryOffset + g_dirEntrySize > archiveSize ||
+					GetU32(pArchiveData + entryOffset) != g_dirEntrySig)
+					throw std::runtime_error("Corrupt zip archive: " + filename);
+
+				const char *pEntry = pArchiveData + entryOffset;
+				unsigned int method = GetU16(pEntry + 10);
+				size_t nameLength = GetU16(pEntry + 28);
+				size_t extraLength = GetU16(pEntry + 30);
+				size_t commentLength = GetU16(pEntry + 32);
+
+				if(entryOffset + g_dirEntrySize + nameLength > archiveSize)
+					throw std::runtime_error("Corrupt zip archive: " + filename);
+
+				std::string name(pEntry + g_dirEntrySize, nameLength);
+				entryOffset += g_dirEntrySize + nameLength + extraLength + commentLength;
+
+				//Directories have entries of their own.
+				if(name.empty() || name[name.size() - 1] == '/')
+					continue;
+
+				if(method != ZIP_STORED && method != ZIP_DEFLATED)
+					throw std::runtime_error("Unsupported compression for " + name + " in " + filename);
+
+				ResourceEntry entry;
+				entry.archived.archiveIx = archiveIx;
+				entry.archived.compressedSize = GetU32(pEntry + 20);
+				entry.archived.size = GetU32(pEntry + 24);
+				entry.archived.localHeaderOffset = GetU32(pEntry + 42);
+				entry.archived.isDeflated = method == ZIP_DEFLATED;
+
+				//Loose files, and archives mounted earlier, win.
+				g_index.insert(ResourceIndex::value_type(NormalizeName(name), entry));
+			}
+		}
+
+		void ReadArchiveEntry(const ArchiveEntry &entry, const std::string &name,
+			const char *&pData, size_t &size, std::vector<char> &inflated)
+		{
+			const glimg::MappedFile &archive = *g_archives[entry.archiveIx];
+			const char *pArchiveData = reinterpret_cast<const char *>(archive.GetData());
+			const size_t archiveSize = archive.GetSize();
+			size_t headerOffset = entry.localHeaderOffset;
+			if(headerOffset + g_localHeaderSize > archiveSize ||
+				GetU32(pArchiveData + headerOffset) != g_localHeaderSig)
+				throw std::runtime_error("Corrupt zip archive entry: " + name);
+
+			//The local header's name and extra field can differ from the directory's.
+			const char *pHeader = pArchiveData + headerOffset;
+			size_t dataOffset = headerOffset + g_localHeaderSize +
+				GetU16(pHeader + 26) + GetU16(pHeader + 28);
+			if(dataOffset + entry.compressedSize > archiveSize)
+				throw std::runtime_error("Corrupt zip archive entry: " + name);
+
+			if(!entry.isDeflated)
+			{
+				pData = pArchiveData + dataOffset;
+				size = entry.compressedSize;
+				return;
+			}
+
+			inflated.resize(entry.size);
+			if(entry.size)
+			{
+				int inflatedSize = stbi_zlib_decode_noheader_buffer(&inflated[0], (int)entry.size,
+					pArchiveData + dataOffset, (int)entry.compressedSize);
+				if(inflatedSize != (int)entry.size)
+					throw std::runtime_error("Could not inflate zip archive entry: " + name);
+			}
+
+			pData = inflated.empty() ? "" : &inflated[0];
+			size = inflated.size();
+		}
+	}
+
+	FileView::FileView()
+		: m_pData("")
+		, m_size(0)
+		, m_pMapping(NULL)
+	{}
+
+	FileView::~FileView()
+	{
+		delete m_pMapping;
+	}
+
+	void MountArchive(const std::string &filename)
+	{
+		glimg::MappedFile *pArchive = glimg::MappedFile::Open(filename);
+		if(!pArchive)
+			throw std::runtime_error("Could not open the archive: " + filename);
+
+		try
+		{
+			ReadArchiveDirectory(*pArchive, g_archives.size(), filename);
+		}
+		catch(...)
+		{
+			delete pArchive;
+			throw;
+		}
+
+		g_archives.push_back(pArchive);
+	}
+
+	bool ResourceExists(const std::string &name)
+	{
+		return FindEntry(name) != NULL;
+	}
+
+	std::string GetResourceFilePath(const std::string &name)
+	{
+		const ResourceEntry *pEntry = FindEntry(name);
+		return pEntry ? pEntry->filePath : std::string();
+	}
+
+	FileView *OpenResource(const std::string &name)
+	{
+		const ResourceEntry *pEntry = FindEntry(name);
+		if(!pEntry)
+			throw std::runtime_error("Could not find the file " + name);
+
+		std::auto_ptr<FileView> pView(new FileView());
+		if(pEntry->filePath.empty())
+		{
+			ReadArchiveEntry(pEntry->archived, name, pView->m_pData, pView->m_size, pView->m_inflated);
+		}
+		else
+		{
+			pView->m_pMapping = glimg::MappedFile::Open(pEntry->filePath, true);
+			if(!pView->m_pMapping)
+				throw std::runtime_error("Could not open the file " + pEntry->filePath);
+
+			//Empty files have no mapping, but views always have data.
+			if(pView->m_pMapping->GetData())
+				pView->m_pData = reinterpret_cast<const char *>(pView->m_pMapping->GetData());
+			pView->m_size = pView->m_pMapping->GetSize();
+		}
+
+		return pView.release();
+	}
+
+	glimg::ImageSet *LoadImageResource(const std::string &name)
+	{
+		std::auto_ptr<FileView> pView(OpenResource(name));
+		const unsigned char *pData = (const unsigned char *)pView->GetData();
+
+		size_t dotLoc = name.rfind('.');
+		if(dotLoc == std::string::npos)
+			throw std::runtime_error("Texture must have an extension. " + name + " does not.");
+
+		std::string ext = name.substr(dotLoc + 1);
+		std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
+
+		if(ext == "dds")
+			return glimg::loaders::dds::LoadFromMemory(pData, pView->GetSize());
+		else
+			return glimg::loaders::stb::LoadFromMemory(pData, pView->GetSize());
+	}
+}
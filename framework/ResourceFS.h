@@ -0,0 +1,65 @@
+
+#ifndef FRAMEWORK_RESOURCE_FS_H
+#define FRAMEWORK_RESOURCE_FS_H
+
+#include <string>
+#include <vector>
+
+namespace glimg
+{
+	class ImageSet;
+	class MappedFile;
+}
+
+namespace Framework
+{
+	//Read-only contents of a resource. Files on disk are memory mapped; files stored
+	//uncompressed in archives point straight into the archive's mapping.
+	class FileView
+	{
+	public:
+		~FileView();
+
+		const char *GetData() const {return m_pData;}
+		size_t GetSize() const {return m_size;}
+
+	private:
+		FileView();
+
+		const char *m_pData;
+		size_t m_size;
+
+		glimg::MappedFile *m_pMapping;	//Only when the view maps a file of its own.
+		std::vector<char> m_inflated;	//Only for compressed archive entries.
+
+		FileView(const FileView &);
+		FileView &operator=(const FileView &);
+
+		friend FileView *OpenResource(const std::string &name);
+	};
+
+	//Resources are looked up in LOCAL_FILE_DIR, then GLOBAL_FILE_DIR, then mounted
+	//archives in the order they were mounted. Both directories are indexed, subdirectories
+	//included, on the first lookup; files that appear afterwards are still found, just
+	//more slowly. Names use '/' as the separator. None of this is thread-safe.
+
+	//Mounts a zip archive. Entries must be stored or deflated, and not zip64.
+	//The framework mounts the ';'-separated archives in the GLTUT_ARCHIVES environment
+	//variable at startup. Throws a std::runtime_error if the archive cannot be read.
+	void MountArchive(const std::string &filename);
+
+	bool ResourceExists(const std::string &name);
+
+	//Returns the resource's path on disk, or an empty string if it is not a loose file.
+	std::string GetResourceFilePath(const std::string &name);
+
+	//The caller owns the returned view. Throws a std::runtime_error if there is no such
+	//resource, or it cannot be read.
+	FileView *OpenResource(const std::string &name);
+
+	//Loads a DDS file, or anything stb_image can read, through OpenResource. The caller
+	//owns the returned image set.
+	glimg::ImageSet *LoadImageResource(const std::string &name);
+}
+
+#endif //FRAMEWORK_RESOURCE_FS_H
@@ -7,6 +7,7 @@
 #include <stdexcept>
 #include <algorithm>
 #include <memory>
+#include <string.h>
 #include <ctype.h>
 
 #include <istream>
@@ -18,6 +19,12 @@
 #include "Scene.h"
 #include "SceneBinders.h"
 #include "Mesh.h"
+#include "StateCache.h"
+#include "FrameStats.h"
+#include "Profiler.h"
+#include "ResourceFS.h"
+#include "ProgramBatch.h"
+#include "TextureStreamer.h"
 #include <glutil/Shader.h>
 
 #include "rapidxml.hpp"
@@ -27,6 +34,8 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glimg/glimg.h>
+#include <glimg/ImageCreator.h>
+#include <glimg/ThreadPool.h>
 
 
 #define PARSE_THROW(cond, message)\
@@ -42,6 +51,18 @@ namespace Framework
 	using rapidxml::make_string;
 
 
+	namespace
+	{
+		//Bumped by InvalidateBindTables. Each scene remembers the value its tables were
+		//built at.
+		unsigned int g_bindTableVersion = 0;
+	}
+
+	void InvalidateBindTables()
+	{
+		++g_bindTableVersion;
+	}
+
 	namespace
 	{
 		void ThrowAttrib(const xml_attribute<> &attrib, const std::string &msg)
@@ -74,19 +95,6 @@ namespace Framework
 			GLuint m_prog;
 		};
 
-		std::string GetExtension(const std::string &filename)
-		{
-			size_t dotLoc = filename.rfind('.');
-			if(dotLoc == std::string::npos)
-				throw std::runtime_error("Texture must have an extension. " + filename + " does not.");
-
-			std::string ext = filename.substr(dotLoc + 1);
-
-			//Make lowercase.
-			std::transform(ext.begin(), ext.end(), ext.begin(), tolower);
-
-			return ext;
-		}
 	}
 
 	class SceneMesh
@@ -115,38 +123,87 @@ namespace Framework
 	class SceneTexture
 	{
 	public:
-		SceneTexture(const std::string &filename, unsigned int creationFlags)
+		//If pStreamer is not NULL, the texture is streamed if the image allows it.
+		SceneTexture(const std::string &filename, unsigned int creationFlags, TextureStreamer *pStreamer)
+			: m_texObj(0)
+			, m_texType(0)
+			, m_pStreamed(NULL)
+			, m_layer(-1)
 		{
-			std::string pathname(Framework::FindFileOrThrow(filename));
+			std::auto_ptr<glimg::ImageSet> pImageSet(Framework::LoadImageResource(filename));
 
-			std::auto_ptr<glimg::ImageSet> pImageSet;
-			std::string ext = GetExtension(pathname);
-			if(ext == "dds")
+			if(pStreamer)
 			{
-				pImageSet.reset(glimg::loaders::dds::LoadFromFile(pathname.c_str()));
-			}
-			else
-			{
-				pImageSet.reset(glimg::loaders::stb::LoadFromFile(pathname.c_str()));
+				glimg::ImageSet *pImage = pImageSet.release();
+				m_pStreamed = pStreamer->AddTexture(pImage, creationFlags);
+				if(m_pStreamed)
+					return;
+
+				pImageSet.reset(pImage);
 			}
 
 			m_texObj = glimg::CreateTexture(pImageSet.get(), creationFlags);
 			m_texType = glimg::GetTextureType(pImageSet.get(), creationFlags);
 		}
 
+		//A layer of an array texture that the scene packed several textures into.
+		SceneTexture(GLuint arrayTexture, GLint layer)
+			: m_texObj(arrayTexture)
+			, m_texType(GL_TEXTURE_2D_ARRAY)
+			, m_pStreamed(NULL)
+			, m_layer(layer)
+		{}
+
+		//Streamed textures belong to their streamer, and packed ones to the scene.
 		~SceneTexture()
 		{
-			glDeleteTextures(1, &m_texObj);
+			if(m_texObj && m_layer == -1)
+				glDeleteTextures(1, &m_texObj);
 		}
 
-		GLuint GetTexture() const {return m_texObj;}
-		GLenum GetType() const {return m_texType;}
+		GLuint GetTexture() const {return m_pStreamed ? m_pStreamed->GetTexture() : m_texObj;}
+		GLenum GetType() const {return m_pStreamed ? m_pStreamed->GetType() : m_texType;}
+
+		//NULL if the texture is not streamed.
+		StreamedTexture *GetStreamed() const {return m_pStreamed;}
+
+		//-1 if the texture is not packed.
+		GLint GetLayer() const {return m_layer;}
 
 	private:
 		GLuint m_texObj;
 		GLenum m_texType;
+		StreamedTexture *m_pStreamed;
+		GLint m_layer;
 	};
 
+	//A uniform binder, flattened for the program of the node it is attached to.
+	struct NodeUniform
+	{
+		GLint location;
+		UniformType type;
+		const void *pValue;
+		size_t cacheSlot;
+	};
+
+	size_t GetUniformTypeSize(UniformType type)
+	{
+		switch(type)
+		{
+		case UNIFORM_FLOAT: return sizeof(GLfloat);
+		case UNIFORM_VEC2: return sizeof(GLfloat) * 2;
+		case UNIFORM_VEC3: return sizeof(GLfloat) * 3;
+		case UNIFORM_VEC4: return sizeof(GLfloat) * 4;
+		case UNIFORM_INT: return sizeof(GLint);
+		case UNIFORM_MAT4: return sizeof(GLfloat) * 16;
+		}
+
+		return 0;
+	}
+
+	//Big enough for any UniformType.
+	const size_t g_uniformSlotSize = sizeof(GLfloat) * 16;
+
 	class SceneProgram
 	{
 	public:
@@ -164,14 +221,78 @@ namespace Framework
 		GLint GetMatrixLoc() const {return m_matrixLoc;}
 		GLint GetNormalMatLoc() const {return m_normalMatLoc;}
 
-		void UseProgram() const {glUseProgram(m_programObj);}
+		void UseProgram() const {CachedUseProgram(m_programObj);}
 
 		GLuint GetProgram() const {return m_programObj;}
 
+		//The uniform that takes the layer of a packed texture bound to the given unit.
+		void SetLayerLoc(GLuint texUnit, GLint location) {m_layerLocs[texUnit] = location;}
+
+		//-1 if there is no such uniform.
+		GLint GetLayerLoc(GLuint texUnit) const
+		{
+			std::map<GLuint, GLint>::const_iterator locIt = m_layerLocs.find(texUnit);
+			return locIt != m_layerLocs.end() ? locIt->second : -1;
+		}
+
+		//Returns the slot that remembers the last value uploaded to the given location.
+		size_t GetUniformSlot(GLint location)
+		{
+			std::map<GLint, size_t>::const_iterator slotIt = m_unifSlots.find(location);
+			if(slotIt != m_unifSlots.end())
+				return slotIt->second;
+
+			size_t slot = m_isSlotValid.size();
+			m_unifSlots[location] = slot;
+			m_slotValues.resize(m_slotValues.size() + g_uniformSlotSize);
+			m_isSlotValid.push_back(0);
+			return slot;
+		}
+
+		//Makes the next UploadUniform to every slot upload its value.
+		void ForgetUniformValues()
+		{
+			std::fill(m_isSlotValid.begin(), m_isSlotValid.end(), 0);
+		}
+
+		//The program must be in use. Does nothing if the program already has this value.
+		//This assumes the scene is the only thing setting these uniforms; see
+		//StateBinder::GetUniformEntry.
+		void UploadUniform(const NodeUniform &unif)
+		{
+			size_t size = GetUniformTypeSize(unif.type);
+			char *pLastValue = &m_slotValues[unif.cacheSlot * g_uniformSlotSize];
+			if(m_isSlotValid[unif.cacheSlot] && memcmp(pLastValue, unif.pValue, size) == 0)
+				return;
+
+			memcpy(pLastValue, unif.pValue, size);
+			m_isSlotValid[unif.cacheSlot] = 1;
+			CountUniformUpload();
+
+			const GLfloat *pFloats = static_cast<const GLfloat *>(unif.pValue);
+			switch(unif.type)
+			{
+			case UNIFORM_FLOAT: glUniform1fv(unif.location, 1, pFloats); break;
+			case UNIFORM_VEC2: glUniform2fv(unif.location, 1, pFloats); break;
+			case UNIFORM_VEC3: glUniform3fv(unif.location, 1, pFloats); break;
+			case UNIFORM_VEC4: glUniform4fv(unif.location, 1, pFloats); break;
+			case UNIFORM_INT:
+				glUniform1iv(unif.location, 1, static_cast<const GLint *>(unif.pValue));
+				break;
+			case UNIFORM_MAT4: glUniformMatrix4fv(unif.location, 1, GL_FALSE, pFloats); break;
+			}
+		}
+
 	private:
 		GLuint m_programObj;
 		GLint m_matrixLoc;
 		GLint m_normalMatLoc;
+
+		std::map<GLint, size_t> m_unifSlots;
+		std::vector<char> m_slotValues;
+		std::vector<char> m_isSlotValid;
+
+		std::map<GLuint, GLint> m_layerLocs;
 	};
 
 	struct Transform
@@ -268,125 +389,366 @@ namespace Framework
 		glSamplerParameterf(samplers[5], GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAniso);
 	}
 
+	//Everything the OpenGL thread needs to draw a node, computed ahead of time.
+	struct NodeRenderCmd
+	{
+		size_t nodeIx;
+		glm::mat4 objMat;
+		glm::mat3 normMat;
+		float pixelsPerUnit;	//How many pixels one model-space unit spans, at the node's origin.
+	};
+
+	//Matrix composition is cheap per node, so only go wide for big scenes.
+	const int g_nodesPerBuildChunk = 256;
+
+	//Keeps nodes at the camera from asking for infinitely fine textures.
+	const float g_minStreamingDistance = 0.001f;
+
+	//Until told otherwise, texture streaming assumes a 90 degree vertical field of view
+	//on a viewport 720 pixels tall.
+	const float g_defaultPixelsPerUnit = 360.0f;
+
 	struct TextureBinding
 	{
 		SceneTexture *pTex;
 		GLuint texUnit;
 		SamplerTypes sampler;
+		float uvDensity;	//Texture coordinate units per model-space unit.
+		GLint layer;		//The array layer of a packed texture; -1 otherwise.
+	};
+
+	//A node's binders, sorted into table-driven uniforms and everything else.
+	struct NodeBindTable
+	{
+		std::vector<NodeUniform> uniforms;
+		std::vector<StateBinder *> binders;
 	};
 
-	class SceneNode
+	//A run of elements within a shared array.
+	struct ArrayRange
+	{
+		size_t first;
+		size_t count;
+	};
+
+	const size_t g_nameNotFound = ~size_t(0);
+
+	//Interns names and maps them to indices, using an open-addressed hash table.
+	class NameIndex
 	{
 	public:
-		SceneNode(SceneMesh *pMesh, SceneProgram *pProg, const glm::vec3 &nodePos,
-			const std::vector<TextureBinding> &texBindings)
-			: m_pMesh(pMesh)
-			, m_pProg(pProg)
-			, m_texBindings(texBindings)
+		NameIndex()
+			: m_slots(16, g_nameNotFound)
+		{}
+
+		//Returns false if the name is already present.
+		bool Insert(const std::string &name, size_t value)
 		{
-			m_nodeTm.m_trans = nodePos;
+			if((m_entries.size() + 1) * 2 > m_slots.size())
+				Rehash(m_slots.size() * 2);
+
+			size_t hash = HashName(name);
+			size_t slot = FindSlot(name, hash);
+			if(m_slots[slot] != g_nameNotFound)
+				return false;
+
+			Entry entry;
+			entry.name = name;
+			entry.hash = hash;
+			entry.value = value;
+			m_slots[slot] = m_entries.size();
+			m_entries.push_back(entry);
+			return true;
 		}
 
-		void NodeSetScale( const glm::vec3 &scale )
+		//Returns g_nameNotFound if the name is not present.
+		size_t Find(const std::string &name) const
 		{
-			m_nodeTm.m_scale = scale;
+			size_t entryIx = m_slots[FindSlot(name, HashName(name))];
+			if(entryIx == g_nameNotFound)
+				return g_nameNotFound;
+
+			return m_entries[entryIx].value;
 		}
 
-		void NodeRotate( const glm::fquat &orient )
+	private:
+		struct Entry
 		{
-			m_nodeTm.m_orient = m_nodeTm.m_orient * orient;
-		}
+			std::string name;
+			size_t hash;
+			size_t value;
+		};
+
+		std::vector<Entry> m_entries;
+		std::vector<size_t> m_slots;	//Indices into m_entries. Size is always a power of two.
 
-		void NodeSetOrient( const glm::fquat &orient )
+		static size_t HashName(const std::string &name)
 		{
-			m_nodeTm.m_orient = orient;
-		}
+			//FNV-1a.
+			unsigned int hash = 2166136261u;
+			for(size_t charIx = 0; charIx < name.size(); ++charIx)
+			{
+				hash ^= (unsigned char)name[charIx];
+				hash *= 16777619u;
+			}
 
-		glm::fquat NodeGetOrient() const {return m_nodeTm.m_orient;}
+			return hash;
+		}
 
-		void SetNodeOrient(const glm::fquat &nodeOrient)
+		//Returns the slot holding the name, or the empty slot where it would go.
+		size_t FindSlot(const std::string &name, size_t hash) const
 		{
-			m_nodeTm.m_orient = glm::normalize(nodeOrient);
+			const size_t mask = m_slots.size() - 1;
+			for(size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+			{
+				size_t entryIx = m_slots[slot];
+				if(entryIx == g_nameNotFound)
+					return slot;
+
+				const Entry &entry = m_entries[entryIx];
+				if(entry.hash == hash && entry.name == name)
+					return slot;
+			}
 		}
 
-		void SetNodeScale(const glm::vec3 &nodeScale)
+		void Rehash(size_t numSlots)
 		{
-			m_nodeTm.m_scale = nodeScale;
+			m_slots.assign(numSlots, g_nameNotFound);
+			const size_t mask = numSlots - 1;
+			for(size_t entryIx = 0; entryIx < m_entries.size(); ++entryIx)
+			{
+				size_t slot = m_entries[entryIx].hash & mask;
+				while(m_slots[slot] != g_nameNotFound)
+					slot = (slot + 1) & mask;
+
+				m_slots[slot] = entryIx;
+			}
 		}
+	};
+
+	//Struct-of-arrays storage for the nodes of a scene. A node is addressed by its
+	//index into these arrays. Nodes are never removed, so an index stays valid for
+	//as long as the scene exists.
+	struct NodePool
+	{
+		std::vector<Transform> transforms;
+		std::vector<SceneMesh *> meshes;	//Unmanaged. Owned by the SceneImpl.
+		std::vector<SceneProgram *> progs;	//Unmanaged. Owned by the SceneImpl.
+		std::vector<ArrayRange> texRanges;	//Ranges into texBindings.
+		std::vector<std::vector<StateBinder *> > binders;	//Unmanaged. These live beyond us.
+		mutable std::vector<NodeBindTable> bindTables;	//Built from binders before rendering.
+		mutable std::vector<char> isBindTableDirty;
+
+		std::vector<TextureBinding> texBindings;
+
+		size_t size() const {return transforms.size();}
 
-		void Render(const std::vector<GLuint> &samplers, glm::mat4 baseMat) const
+		size_t AddNode(SceneMesh *pMesh, SceneProgram *pProg, const glm::vec3 &nodePos,
+			const std::vector<TextureBinding> &nodeTexBindings)
 		{
-			baseMat *= m_nodeTm.GetMatrix();
-			glm::mat4 objMat = baseMat * m_objTm.GetMatrix();
+			Transform nodeTm;
+			nodeTm.m_trans = nodePos;
+
+			ArrayRange texRange;
+			texRange.first = texBindings.size();
+			texRange.count = nodeTexBindings.size();
+			texBindings.insert(texBindings.end(), nodeTexBindings.begin(), nodeTexBindings.end());
+
+			transforms.push_back(nodeTm);
+			meshes.push_back(pMesh);
+			progs.push_back(pProg);
+			texRanges.push_back(texRange);
+			binders.push_back(std::vector<StateBinder *>());
+			bindTables.push_back(NodeBindTable());
+			isBindTableDirty.push_back(0);
+
+			return transforms.size() - 1;
+		}
 
-			m_pProg->UseProgram();
-			glUniformMatrix4fv(m_pProg->GetMatrixLoc(), 1, GL_FALSE, glm::value_ptr(objMat));
+		//Must be called on the OpenGL thread, since it allocates program uniform slots.
+		void BuildBindTable(size_t nodeIx) const
+		{
+			NodeBindTable &table = bindTables[nodeIx];
+			table.uniforms.clear();
+			table.binders.clear();
 
-			if(m_pProg->GetNormalMatLoc() != -1)
+			SceneProgram *pProg = progs[nodeIx];
+			const std::vector<StateBinder *> &nodeBinders = binders[nodeIx];
+			for(size_t binderIx = 0; binderIx < nodeBinders.size(); ++binderIx)
 			{
-				glm::mat3 normMat = glm::mat3(glm::transpose(glm::inverse(objMat)));
-				glUniformMatrix3fv(m_pProg->GetNormalMatLoc(), 1, GL_FALSE,
-					glm::value_ptr(normMat));
-			}
+				UniformTableEntry entry;
+				if(!nodeBinders[binderIx]->GetUniformEntry(pProg->GetProgram(), entry))
+				{
+					table.binders.push_back(nodeBinders[binderIx]);
+					continue;
+				}
 
-			std::for_each(m_binders.begin(), m_binders.end(), BindBinder(m_pProg->GetProgram()));
-			for(size_t texIx = 0; texIx < m_texBindings.size(); ++texIx)
-			{
-				const TextureBinding &binding = m_texBindings[texIx];
-				glActiveTexture(GL_TEXTURE0 + binding.texUnit);
-				glBindTexture(binding.pTex->GetType(), binding.pTex->GetTexture());
-				glBindSampler(binding.texUnit, samplers[binding.sampler]);
-			}
+				//Not in this program; OpenGL would ignore it anyway.
+				if(entry.location == -1)
+					continue;
 
-			m_pMesh->Render();
+				NodeUniform unif;
+				unif.location = entry.location;
+				unif.type = entry.type;
+				unif.pValue = entry.pValue;
+				unif.cacheSlot = pProg->GetUniformSlot(entry.location);
+				table.uniforms.push_back(unif);
+			}
 
-			for(size_t texIx = 0; texIx < m_texBindings.size(); ++texIx)
+			//Packed textures tell the program which layer of their array to sample.
+			const ArrayRange &texRange = texRanges[nodeIx];
+			for(size_t texIx = texRange.first; texIx < texRange.first + texRange.count; ++texIx)
 			{
-				const TextureBinding &binding = m_texBindings[texIx];
-				glActiveTexture(GL_TEXTURE0 + binding.texUnit);
-				glBindTexture(binding.pTex->GetType(), 0);
-				glBindSampler(binding.texUnit, 0);
+				const TextureBinding &binding = texBindings[texIx];
+				GLint location = pProg->GetLayerLoc(binding.texUnit);
+				if(binding.layer == -1 || location == -1)
+					continue;
+
+				NodeUniform unif;
+				unif.location = location;
+				unif.type = UNIFORM_INT;
+				unif.pValue = &binding.layer;
+				unif.cacheSlot = pProg->GetUniformSlot(location);
+				table.uniforms.push_back(unif);
 			}
-			std::for_each(m_binders.rbegin(), m_binders.rend(), UnbindBinder(m_pProg->GetProgram()));
-			glUseProgram(0);
-		}
 
-		void NodeOffset(const glm::vec3 &offset)
-		{
-			m_nodeTm.m_trans += offset;
+			isBindTableDirty[nodeIx] = 0;
 		}
 
-		void NodeSetTrans(const glm::vec3 &offset)
+		//Computes everything about a node's rendering that does not touch OpenGL.
+		//Safe to call from any thread. pixelsPerUnit is the number of pixels that one
+		//camera-space unit spans at a distance of one.
+		void BuildRenderCmd(size_t nodeIx, NodeRenderCmd &cmd, const glm::mat4 &cameraMatrix,
+			float pixelsPerUnit) const
 		{
-			m_nodeTm.m_trans = offset;
+			cmd.nodeIx = nodeIx;
+			cmd.objMat = cameraMatrix * transforms[nodeIx].GetMatrix();
+
+			if(progs[nodeIx]->GetNormalMatLoc() != -1)
+				cmd.normMat = glm::mat3(glm::transpose(glm::inverse(cmd.objMat)));
+
+			//Measured at the node's origin, with its largest scale.
+			float scale = std::max(glm::length(glm::vec3(cmd.objMat[0])),
+				std::max(glm::length(glm::vec3(cmd.objMat[1])), glm::length(glm::vec3(cmd.objMat[2]))));
+			float distance = std::max(glm::length(glm::vec3(cmd.objMat[3])), g_minStreamingDistance);
+			cmd.pixelsPerUnit = pixelsPerUnit * scale / distance;
 		}
 
-		void SetStateBinder(StateBinder *pBinder)
+		//Asks the streamed textures of the node for the level its size on screen needs.
+		void RequestTextureLevels(const NodeRenderCmd &cmd) const
 		{
-			m_binders.push_back(pBinder);
+			const ArrayRange &texRange = texRanges[cmd.nodeIx];
+			for(size_t texIx = texRange.first; texIx < texRange.first + texRange.count; ++texIx)
+			{
+				const TextureBinding &binding = texBindings[texIx];
+				if(StreamedTexture *pStreamed = binding.pTex->GetStreamed())
+					pStreamed->RequestPixelsPerUv(cmd.pixelsPerUnit / binding.uvDensity);
+			}
 		}
 
-		GLuint GetProgram() const
+		//Must be called on the OpenGL thread.
+		void Render(const std::vector<GLuint> &samplers, const NodeRenderCmd &cmd) const
 		{
-			return m_pProg->GetProgram();
-		}
+			SceneProgram *pProg = progs[cmd.nodeIx];
+			const NodeBindTable &table = bindTables[cmd.nodeIx];
+			const TextureBinding *pTexBindings = texRanges[cmd.nodeIx].count ?
+				&texBindings[texRanges[cmd.nodeIx].first] : NULL;
+			const size_t numTexBindings = texRanges[cmd.nodeIx].count;
 
+			pProg->UseProgram();
+			glUniformMatrix4fv(pProg->GetMatrixLoc(), 1, GL_FALSE, glm::value_ptr(cmd.objMat));
+			CountUniformUpload();
 
-	private:
-		SceneMesh *m_pMesh;		//Unmanaged. We are deleted first, so these should always be real values.
-		SceneProgram *m_pProg;	//Unmanaged. We are deleted first, so these should always be real values.
+			if(pProg->GetNormalMatLoc() != -1)
+			{
+				glUniformMatrix3fv(pProg->GetNormalMatLoc(), 1, GL_FALSE,
+					glm::value_ptr(cmd.normMat));
+				CountUniformUpload();
+			}
 
-		std::vector<StateBinder*> m_binders;	//Unmanaged. These live beyond us.
-		std::vector<TextureBinding> m_texBindings;
+			for(size_t unifIx = 0; unifIx < table.uniforms.size(); ++unifIx)
+				pProg->UploadUniform(table.uniforms[unifIx]);
 
-		Transform m_nodeTm;
-		Transform m_objTm;
+			std::for_each(table.binders.begin(), table.binders.end(), BindBinder(pProg->GetProgram()));
+			for(size_t texIx = 0; texIx < numTexBindings; ++texIx)
+			{
+				const TextureBinding &binding = pTexBindings[texIx];
+				CachedBindTexture(binding.texUnit, binding.pTex->GetType(), binding.pTex->GetTexture());
+				CachedBindSampler(binding.texUnit, samplers[binding.sampler]);
+			}
+
+			meshes[cmd.nodeIx]->Render();
+
+			for(size_t texIx = 0; texIx < numTexBindings; ++texIx)
+			{
+				const TextureBinding &binding = pTexBindings[texIx];
+				CachedBindTexture(binding.texUnit, binding.pTex->GetType(), 0);
+				CachedBindSampler(binding.texUnit, 0);
+			}
+			std::for_each(table.binders.rbegin(), table.binders.rend(), UnbindBinder(pProg->GetProgram()));
+			CachedUseProgram(0);
+		}
 	};
 
 	typedef std::map<std::string, SceneMesh*> MeshMap;
 	typedef std::map<std::string, SceneTexture*> TextureMap;
 	typedef std::map<std::string, SceneProgram*> ProgramMap;
-	typedef std::map<std::string, SceneNode*> NodeMap;
+
+	class BuildRenderCmdsTask : public glimg::ParallelTask
+	{
+	public:
+		BuildRenderCmdsTask(const NodePool &nodes, std::vector<NodeRenderCmd> &cmds,
+			const glm::mat4 &cameraMatrix, float pixelsPerUnit)
+			: m_nodes(nodes)
+			, m_cmds(cmds)
+			, m_cameraMatrix(cameraMatrix)
+			, m_pixelsPerUnit(pixelsPerUnit)
+		{}
+
+		virtual void Execute(int itemIx)
+		{
+			size_t start = itemIx * g_nodesPerBuildChunk;
+			size_t end = std::min(start + g_nodesPerBuildChunk, m_nodes.size());
+			for(size_t nodeIx = start; nodeIx < end; ++nodeIx)
+				m_nodes.BuildRenderCmd(nodeIx, m_cmds[nodeIx], m_cameraMatrix, m_pixelsPerUnit);
+		}
+
+	private:
+		const NodePool &m_nodes;
+		std::vector<NodeRenderCmd> &m_cmds;
+		glm::mat4 m_cameraMatrix;
+		float m_pixelsPerUnit;
+	};
+
+	//A texture waiting to be packed into an array texture with others like it.
+	struct PackedTextureSource
+	{
+		std::string name;
+		glimg::ImageSet *pImageSet;
+		unsigned int creationFlags;
+	};
+
+	void DeletePackedImage(PackedTextureSource &source)
+	{
+		delete source.pImageSet;
+		source.pImageSet = NULL;
+	}
+
+	//Textures can share an array texture if all of their layers upload the same way.
+	bool CanShareArray(const PackedTextureSource &lhs, const PackedTextureSource &rhs)
+	{
+		glimg::Dimensions lhsDims = lhs.pImageSet->GetDimensions();
+		glimg::Dimensions rhsDims = rhs.pImageSet->GetDimensions();
+		glimg::ImageFormat lhsFmt = lhs.pImageSet->GetFormat();
+		glimg::ImageFormat rhsFmt = rhs.pImageSet->GetFormat();
+
+		return lhs.creationFlags == rhs.creationFlags &&
+			lhsDims.width == rhsDims.width && lhsDims.height == rhsDims.height &&
+			lhs.pImageSet->GetMipmapCount() == rhs.pImageSet->GetMipmapCount() &&
+			lhsFmt.Type() == rhsFmt.Type() && lhsFmt.Components() == rhsFmt.Components() &&
+			lhsFmt.Order() == rhsFmt.Order() && lhsFmt.Depth() == rhsFmt.Depth() &&
+			lhsFmt.LineAlign() == rhsFmt.LineAlign();
+	}
 
 	class SceneImpl
 	{
@@ -394,26 +756,39 @@ namespace Framework
 		MeshMap m_meshes;
 		TextureMap m_textures;
 		ProgramMap m_progs;
-		NodeMap m_nodes;
 
-		std::vector<SceneNode *> m_rootNodes;
+		NodePool m_nodes;
+		NameIndex m_nodeNames;
+
+		std::vector<size_t> m_rootNodes;
+
+		mutable std::vector<NodeRenderCmd> m_renderCmds;
+
+		//Nodes whose binders changed since their bind table was last built.
+		mutable std::vector<size_t> m_dirtyBindTables;
+		mutable unsigned int m_bindTableVersion;
 
 		std::vector<GLuint> m_samplers;
 
+		//The array textures that packed textures are layers of.
+		std::vector<GLuint> m_arrayTextures;
+
+		TextureStreamer *m_pStreamer;
+		float m_pixelsPerUnit;
+
 	public:
 		SceneImpl(const std::string &filename)
+			: m_bindTableVersion(g_bindTableVersion)
+			, m_pStreamer(NULL)
+			, m_pixelsPerUnit(g_defaultPixelsPerUnit)
 		{
-			std::string pathname = FindFileOrThrow(filename);
-
-			std::ifstream fileStream(pathname.c_str());
-			if(!fileStream.is_open())
-				throw std::runtime_error("Could not open the scene file.");
+			ProfileScope loadScope("Scene load");
 
-			std::vector<char> fileData;
-			fileData.reserve(2000);
-			fileData.insert(fileData.end(), std::istreambuf_iterator<char>(fileStream),
-				std::istreambuf_iterator<char>());
+			//rapidxml parses in place, and needs a terminator.
+			std::auto_ptr<FileView> pFile(OpenResource(filename));
+			std::vector<char> fileData(pFile->GetData(), pFile->GetData() + pFile->GetSize());
 			fileData.push_back('\0');
+			pFile.reset();
 
 			xml_document<> doc;
 
@@ -433,20 +808,44 @@ namespace Framework
 
 			try
 			{
-				ReadMeshes(*pSceneNode);
-				ReadTextures(*pSceneNode);
-				ReadPrograms(*pSceneNode);
-				ReadNodes(NULL, *pSceneNode);
+				//Programs compile while the meshes and textures load.
+				ProgramBatch programBatch;
+				std::vector<PendingProgram> pendingProgs;
+				{
+					ProfileScope readScope("Scene load: programs");
+					ReadPrograms(*pSceneNode, programBatch, pendingProgs);
+				}
+				{
+					ProfileScope readScope("Scene load: meshes");
+					ReadMeshes(*pSceneNode);
+				}
+				{
+					ProfileScope readScope("Scene load: textures");
+					m_pStreamer = new TextureStreamer();
+					ReadTextures(*pSceneNode);
+				}
+				{
+					ProfileScope readScope("Scene load: program link");
+					programBatch.Finish();
+					FinishPrograms(pendingProgs);
+				}
+				{
+					ProfileScope readScope("Scene load: nodes");
+					ReadNodes(g_nameNotFound, *pSceneNode);
+				}
 			}
 			catch(...)
 			{
-				std::for_each(m_nodes.begin(), m_nodes.end(), DeleteSecond<NodeMap::value_type>);
 				std::for_each(m_progs.begin(), m_progs.end(), DeleteSecond<ProgramMap::value_type>);
 				std::for_each(m_textures.begin(), m_textures.end(), DeleteSecond<TextureMap::value_type>);
 				std::for_each(m_meshes.begin(), m_meshes.end(), DeleteSecond<MeshMap::value_type>);
+				DeleteArrayTextures();
+				delete m_pStreamer;
 				throw;
 			}
 
+			m_renderCmds.resize(m_nodes.size());
+
 			MakeSamplerObjects(m_samplers);
 		}
 
@@ -455,29 +854,98 @@ namespace Framework
 			glDeleteSamplers(m_samplers.size(), &m_samplers[0]);
 			m_samplers.clear();
 
-			std::for_each(m_nodes.begin(), m_nodes.end(), DeleteSecond<NodeMap::value_type>);
 			std::for_each(m_progs.begin(), m_progs.end(), DeleteSecond<ProgramMap::value_type>);
 			std::for_each(m_textures.begin(), m_textures.end(), DeleteSecond<TextureMap::value_type>);
 			std::for_each(m_meshes.begin(), m_meshes.end(), DeleteSecond<MeshMap::value_type>);
+			DeleteArrayTextures();
+			delete m_pStreamer;
 		}
 
 		void Render(const glm::mat4 &cameraMatrix) const
 		{
-			for(NodeMap::const_iterator theIt = m_nodes.begin();
-				theIt != m_nodes.end();
-				++theIt)
+			ProfileScope renderScope("Scene::Render");
+
+			//Binders are matched to program uniforms at the first render after they are
+			//attached, and again at the first render after any binder is associated with
+			//a program. So they may be associated with programs before or after that.
+			if(m_bindTableVersion != g_bindTableVersion)
+			{
+				for(size_t nodeIx = 0; nodeIx < m_nodes.size(); ++nodeIx)
+				{
+					if(!m_nodes.binders[nodeIx].empty())
+						MarkBindTableDirty(nodeIx);
+				}
+				for(ProgramMap::const_iterator progIt = m_progs.begin(); progIt != m_progs.end(); ++progIt)
+					progIt->second->ForgetUniformValues();
+				m_bindTableVersion = g_bindTableVersion;
+			}
+
+			for(size_t dirtyIx = 0; dirtyIx < m_dirtyBindTables.size(); ++dirtyIx)
+				m_nodes.BuildBindTable(m_dirtyBindTables[dirtyIx]);
+			m_dirtyBindTables.clear();
+
+			//Worker threads do the per-node math; only this thread talks to OpenGL.
+			{
+				ProfileScope buildScope("Scene::Render: build commands");
+				BuildRenderCmdsTask buildTask(m_nodes, m_renderCmds, cameraMatrix, m_pixelsPerUnit);
+				int numChunks = (int)((m_nodes.size() + g_nodesPerBuildChunk - 1) / g_nodesPerBuildChunk);
+				if(numChunks > 1)
+					glimg::GetSharedThreadPool().ParallelFor(buildTask, numChunks);
+				else if(numChunks == 1)
+					buildTask.Execute(0);
+			}
+
+			//Textures get this frame's levels before anything is drawn with them.
+			if(m_pStreamer->GetStats().numTextures != 0)
 			{
-				theIt->second->Render(m_samplers, cameraMatrix);
+				ProfileScope streamScope("Scene::Render: texture streaming");
+				for(size_t cmdIx = 0; cmdIx < m_renderCmds.size(); ++cmdIx)
+					m_nodes.RequestTextureLevels(m_renderCmds[cmdIx]);
+				m_pStreamer->Update();
 			}
+
+			//Nodes unbind everything they bind; the cache turns most of that into nothing.
+			StateCacheScope stateScope;
+			for(size_t cmdIx = 0; cmdIx < m_renderCmds.size(); ++cmdIx)
+				m_nodes.Render(m_samplers, m_renderCmds[cmdIx]);
 		}
 
 		NodeRef FindNode(const std::string &nodeName)
 		{
-			NodeMap::iterator theIt = m_nodes.find(nodeName);
-			if(theIt == m_nodes.end())
+			size_t nodeIx = m_nodeNames.Find(nodeName);
+			if(nodeIx == g_nameNotFound)
 				throw std::runtime_error("Could not find the node named: " + nodeName);
 
-			return NodeRef(theIt->second);
+			return NodeRef(this, (unsigned int)nodeIx);
+		}
+
+		Transform &GetNodeTransform(const NodeRef &node)
+		{
+			return m_nodes.transforms[GetNodeIndex(node)];
+		}
+
+		void AddNodeBinder(const NodeRef &node, StateBinder *pBinder)
+		{
+			size_t nodeIx = GetNodeIndex(node);
+			m_nodes.binders[nodeIx].push_back(pBinder);
+			MarkBindTableDirty(nodeIx);
+		}
+
+		GLint GetNodeTextureLayer(const NodeRef &node, GLuint texUnit)
+		{
+			const ArrayRange &texRange = m_nodes.texRanges[GetNodeIndex(node)];
+			for(size_t texIx = texRange.first; texIx < texRange.first + texRange.count; ++texIx)
+			{
+				if(m_nodes.texBindings[texIx].texUnit == texUnit)
+					return m_nodes.texBindings[texIx].layer;
+			}
+
+			return -1;
+		}
+
+		GLuint GetNodeProgram(const NodeRef &node)
+		{
+			return m_nodes.progs[GetNodeIndex(node)]->GetProgram();
 		}
 
 		GLuint FindProgram(const std::string &progName)
@@ -507,8 +975,50 @@ namespace Framework
 			return std::make_pair(theIt->second->GetTexture(), theIt->second->GetType());
 		}
 
+		void SetTextureBudget(size_t budgetBytes)
+		{
+			m_pStreamer->SetBudget(budgetBytes);
+		}
+
+		void SetStreamingView(const glm::mat4 &cameraToClipMatrix, int viewportHeight)
+		{
+			m_pixelsPerUnit = cameraToClipMatrix[1][1] * viewportHeight * 0.5f;
+		}
+
+		TextureStreamingStats GetTextureStreamingStats() const
+		{
+			return m_pStreamer->GetStats();
+		}
+
+		TextureResidency GetTextureResidency(const std::string &textureName) const
+		{
+			TextureMap::const_iterator theIt = m_textures.find(textureName);
+			if(theIt == m_textures.end())
+				throw std::runtime_error("Could not find the texture named: " + textureName);
+			if(!theIt->second->GetStreamed())
+				throw std::runtime_error("The texture named " + textureName + " is not streamed.");
+
+			return theIt->second->GetStreamed()->GetResidency();
+		}
+
 	private:
 
+		void MarkBindTableDirty(size_t nodeIx) const
+		{
+			if(!m_nodes.isBindTableDirty[nodeIx])
+			{
+				m_nodes.isBindTableDirty[nodeIx] = 1;
+				m_dirtyBindTables.push_back(nodeIx);
+			}
+		}
+
+		void DeleteArrayTextures()
+		{
+			if(!m_arrayTextures.empty())
+				glDeleteTextures((GLsizei)m_arrayTextures.size(), &m_arrayTextures[0]);
+			m_arrayTextures.clear();
+		}
+
 		void ReadMeshes(const xml_node<> &scene)
 		{
 			for(const xml_node<> *pMeshNode = scene.first_node("mesh");
@@ -540,15 +1050,29 @@ namespace Framework
 
 		void ReadTextures(const xml_node<> &scene)
 		{
-			for(const xml_node<> *pTexNode = scene.first_node("texture");
-				pTexNode;
-				pTexNode = pTexNode->next_sibling("texture"))
+			//Packed textures are created once they have all been read.
+			std::vector<PackedTextureSource> packedTextures;
+			try
 			{
-				ReadTexture(*pTexNode);
+				for(const xml_node<> *pTexNode = scene.first_node("texture");
+					pTexNode;
+					pTexNode = pTexNode->next_sibling("texture"))
+				{
+					ReadTexture(*pTexNode, packedTextures);
+				}
+
+				PackTextures(packedTextures);
 			}
+			catch(...)
+			{
+				std::for_each(packedTextures.begin(), packedTextures.end(), DeletePackedImage);
+				throw;
+			}
+
+			std::for_each(packedTextures.begin(), packedTextures.end(), DeletePackedImage);
 		}
 
-		void ReadTexture(const xml_node<> &TexNode)
+		void ReadTexture(const xml_node<> &TexNode, std::vector<PackedTextureSource> &packedTextures)
 		{
 			const xml_attribute<> *pNameNode = TexNode.first_attribute("xml:id");
 			const xml_attribute<> *pFilenameNode = TexNode.first_attribute("file");
@@ -567,23 +1091,133 @@ namespace Framework
 			unsigned int creationFlags = 0;
 			if(get_attrib_bool(TexNode, "srgb"))
 				creationFlags |= glimg::FORCE_SRGB_COLORSPACE_FMT;
+			if(get_attrib_bool(TexNode, "compress"))
+				creationFlags |= glimg::FORCE_BLOCK_COMPRESSED_FMT;
+
+			bool isStreamed = get_attrib_bool(TexNode, "stream");
+			if(get_attrib_bool(TexNode, "pack"))
+			{
+				if(isStreamed)
+					throw std::runtime_error("The texture named \"" + name + "\" cannot be both streamed and packed.");
+
+				ReadPackedTexture(name, make_string(*pFilenameNode), creationFlags, packedTextures);
+				return;
+			}
+
+			TextureStreamer *pStreamer = isStreamed ? m_pStreamer : NULL;
 
-			SceneTexture *pTexture = new SceneTexture(make_string(*pFilenameNode), creationFlags);
+			SceneTexture *pTexture = new SceneTexture(make_string(*pFilenameNode), creationFlags, pStreamer);
 
 			m_textures[name] = pTexture;
 		}
 
-		void ReadPrograms(const xml_node<> &scene)
+		void ReadPackedTexture(const std::string &name, const std::string &filename,
+			unsigned int creationFlags, std::vector<PackedTextureSource> &packedTextures)
+		{
+			std::auto_ptr<glimg::ImageSet> pImageSet(Framework::LoadImageResource(filename));
+			if(glimg::GetTextureType(pImageSet.get(), creationFlags) != GL_TEXTURE_2D)
+			{
+				throw std::runtime_error("The texture named \"" + name +
+					"\" cannot be packed. Only 2D textures can be.");
+			}
+
+			PackedTextureSource source;
+			source.name = name;
+			source.pImageSet = NULL;
+			source.creationFlags = creationFlags;
+			packedTextures.push_back(source);
+			packedTextures.back().pImageSet = pImageSet.release();
+		}
+
+		//Textures of the same format, size and mipmap count become the layers of one
+		//GL_TEXTURE_2D_ARRAY. A texture that is like no other still gets an array of its
+		//own, since the programs that use it expect one.
+		void PackTextures(const std::vector<PackedTextureSource> &packedTextures)
+		{
+			if(packedTextures.empty())
+				return;
+
+			GLint maxLayers = 0;
+			glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+			std::vector<char> isPacked(packedTextures.size(), 0);
+			for(size_t firstIx = 0; firstIx < packedTextures.size(); ++firstIx)
+			{
+				if(isPacked[firstIx])
+					continue;
+
+				std::vector<const PackedTextureSource *> layers;
+				for(size_t texIx = firstIx;
+					texIx < packedTextures.size() && (GLint)layers.size() < maxLayers;
+					++texIx)
+				{
+					if(!isPacked[texIx] && CanShareArray(packedTextures[firstIx], packedTextures[texIx]))
+					{
+						layers.push_back(&packedTextures[texIx]);
+						isPacked[texIx] = 1;
+					}
+				}
+
+				CreateArrayTexture(layers);
+			}
+		}
+
+		void CreateArrayTexture(const std::vector<const PackedTextureSource *> &layers)
+		{
+			const glimg::ImageSet &firstImage = *layers[0]->pImageSet;
+			const int numMipmaps = firstImage.GetMipmapCount();
+
+			//ImageSets are already bottom-up, so the images go in as they are.
+			std::vector<glimg::ImageDataSource> images;
+			for(size_t layerIx = 0; layerIx < layers.size(); ++layerIx)
+			{
+				for(int mipmapLevel = 0; mipmapLevel < numMipmaps; ++mipmapLevel)
+				{
+					glimg::ImageDataSource image;
+					image.pixelData = layers[layerIx]->pImageSet->GetImageArray(mipmapLevel);
+					image.mipmapLevel = mipmapLevel;
+					image.arrayIx = (int)layerIx;
+					image.faceIx = 0;
+					images.push_back(image);
+				}
+			}
+
+			glimg::ImageCreator creator(firstImage.GetFormat(), firstImage.GetDimensions(),
+				numMipmaps, (int)layers.size(), 1);
+			creator.SetImageDataBatch(&images[0], (int)images.size(), false);
+			std::auto_ptr<glimg::ImageSet> pArrayImage(creator.CreateImage());
+
+			m_arrayTextures.reserve(m_arrayTextures.size() + 1);
+			GLuint arrayTexture = glimg::CreateTexture(pArrayImage.get(),
+				layers[0]->creationFlags | glimg::FORCE_ARRAY_TEXTURE);
+			m_arrayTextures.push_back(arrayTexture);
+
+			for(size_t layerIx = 0; layerIx < layers.size(); ++layerIx)
+				m_textures[layers[layerIx]->name] = new SceneTexture(arrayTexture, (GLint)layerIx);
+		}
+
+		struct PendingProgram
+		{
+			const xml_node<> *pProgNode;
+			std::string name;
+			GLuint program;
+		};
+
+		void ReadPrograms(const xml_node<> &scene, ProgramBatch &programBatch,
+			std::vector<PendingProgram> &pendingProgs)
 		{
 			for(const xml_node<> *pProgNode = scene.first_node("prog");
 				pProgNode;
 				pProgNode = pProgNode->next_sibling("prog"))
 			{
-				ReadProgram(*pProgNode);
+				PendingProgram pending;
+				pending.pProgNode = pProgNode;
+				pending.program = ReadProgram(*pProgNode, programBatch, pending.name);
+				pendingProgs.push_back(pending);
 			}
 		}
 
-		void ReadProgram(const xml_node<> &progNode)
+		GLuint ReadProgram(const xml_node<> &progNode, ProgramBatch &programBatch, std::string &name)
 		{
 			const xml_attribute<> *pNameNode = progNode.first_attribute("xml:id");
 			const xml_attribute<> *pVertexShaderNode = progNode.first_attribute("vert");
@@ -596,33 +1230,52 @@ namespace Framework
 			PARSE_THROW(pModelMatrixNode, "Program found with no model-to-camera matrix uniform name specified.");
 
 			//Optional.
-			const xml_attribute<> *pNormalMatrixNode = progNode.first_attribute("normal-model-to-camera");
 			const xml_attribute<> *pGeometryShaderNode = progNode.first_attribute("geom");
 
-			std::string name = make_string(*pNameNode);
+			name = make_string(*pNameNode);
 			if(m_progs.find(name) != m_progs.end())
 				throw std::runtime_error("The program named \"" + name + "\" already exists.");
 
 			m_progs[name] = NULL;
 
 			std::vector<GLuint> shaders;
-			GLuint program = 0;
+			shaders.push_back(programBatch.LoadShader(GL_VERTEX_SHADER, make_string(*pVertexShaderNode)));
+			shaders.push_back(programBatch.LoadShader(GL_FRAGMENT_SHADER, make_string(*pFragmentShaderNode)));
+			if(pGeometryShaderNode)
+				shaders.push_back(programBatch.LoadShader(GL_GEOMETRY_SHADER, make_string(*pGeometryShaderNode)));
 
-			try
-			{
-				shaders.push_back(LoadShader(GL_VERTEX_SHADER, make_string(*pVertexShaderNode)));
-				shaders.push_back(LoadShader(GL_FRAGMENT_SHADER, make_string(*pFragmentShaderNode)));
-				if(pGeometryShaderNode)
-					shaders.push_back(LoadShader(GL_GEOMETRY_SHADER, make_string(*pGeometryShaderNode)));
-				program = glutil::LinkProgram(shaders);
-			}
-			catch(std::exception &)
+			return programBatch.CreateProgram(shaders);
+		}
+
+		//Takes ownership of the programs, deleting the ones it does not get to.
+		void FinishPrograms(const std::vector<PendingProgram> &pendingProgs)
+		{
+			for(size_t progIx = 0; progIx < pendingProgs.size(); ++progIx)
 			{
-				std::for_each(shaders.begin(), shaders.end(), glDeleteShader);
-				throw;
+				try
+				{
+					FinishProgram(pendingProgs[progIx]);
+				}
+				catch(...)
+				{
+					for(size_t deleteIx = progIx + 1; deleteIx < pendingProgs.size(); ++deleteIx)
+						glDeleteProgram(pendingProgs[deleteIx].program);
+					throw;
+				}
 			}
+		}
+
+		void FinishProgram(const PendingProgram &pending)
+		{
+			const xml_node<> &progNode = *pending.pProgNode;
+			const std::string &name = pending.name;
+			GLuint program = pending.program;
+
+			//ReadProgram made sure this exists.
+			const xml_attribute<> *pModelMatrixNode = progNode.first_attribute("model-to-camera");
 
-			std::for_each(shaders.begin(), shaders.end(), glDeleteShader);
+			//Optional.
+			const xml_attribute<> *pNormalMatrixNode = progNode.first_attribute("normal-model-to-camera");
 
 			std::string matrixName = make_string(*pModelMatrixNode);
 			GLint matrixLoc = glGetUniformLocation(program, matrixName.c_str());
@@ -646,13 +1299,16 @@ namespace Framework
 				}
 			}
 
-			m_progs[name] = new SceneProgram(program, matrixLoc, normalMatLoc);
+			SceneProgram *pProg = new SceneProgram(program, matrixLoc, normalMatLoc);
+			m_progs[name] = pProg;
 
-			ReadProgramContents(program, progNode);
+			ReadProgramContents(*pProg, progNode);
 		}
 
-		void ReadProgramContents(GLuint program, const xml_node<> &progNode)
+		void ReadProgramContents(SceneProgram &prog, const xml_node<> &progNode)
 		{
+			const GLuint program = prog.GetProgram();
+
 			std::set<std::string> blockBindings;
 			std::set<std::string> samplerBindings;
 
@@ -692,6 +1348,7 @@ namespace Framework
 				{
 					const xml_attribute<> *pNameNode = pChildNode->first_attribute("name");
 					const xml_attribute<> *pTexunitNode = pChildNode->first_attribute("unit");
+					const xml_attribute<> *pLayerNode = pChildNode->first_attribute("layer");
 
 					PARSE_THROW(pNameNode, "Program `sampler` element with no `name`.");
 					PARSE_THROW(pTexunitNode, "Program `sampler` element with no `unit`.");
@@ -713,6 +1370,17 @@ namespace Framework
 					glUseProgram(program);
 					glUniform1i(samplerLoc, textureUnit);
 					glUseProgram(0);
+
+					//Optional. The int uniform that gets the layer of a packed texture.
+					if(pLayerNode)
+					{
+						std::string layerName = make_string(*pLayerNode);
+						GLint layerLoc = glGetUniformLocation(program, layerName.c_str());
+						if(layerLoc == -1)
+							std::cout << "Warning: the layer uniform " << layerName << " could not be found." << std::endl;
+						else
+							prog.SetLayerLoc(textureUnit, layerLoc);
+					}
 				}
 				else
 				{
@@ -722,17 +1390,25 @@ namespace Framework
 			}
 		}
 
-		void ReadNodes(SceneNode *pParent, const xml_node<> &scene)
+		size_t GetNodeIndex(const NodeRef &node) const
+		{
+			if(node.m_pScene != this || node.m_nodeIx >= m_nodes.size())
+				throw std::runtime_error("The node reference does not belong to this scene.");
+
+			return node.m_nodeIx;
+		}
+
+		void ReadNodes(size_t parentIx, const xml_node<> &scene)
 		{
 			for(const xml_node<> *pNodeNode = scene.first_node("node");
 				pNodeNode;
 				pNodeNode = pNodeNode->next_sibling("node"))
 			{
-				ReadNode(pParent, *pNodeNode);
+				ReadNode(parentIx, *pNodeNode);
 			}
 		}
 
-		void ReadNode(SceneNode *pParent, const xml_node<> &nodeNode)
+		void ReadNode(size_t parentIx, const xml_node<> &nodeNode)
 		{
 			const xml_attribute<> *pNameNode = nodeNode.first_attribute("name");
 			const xml_attribute<> *pMeshNode = nodeNode.first_attribute("mesh");
@@ -749,11 +1425,9 @@ namespace Framework
 			PARSE_THROW(pPositionNode, "Node found with no `pos` specified.");
 
 			std::string name = make_string(*pNameNode);
-			if(m_nodes.find(name) != m_nodes.end())
+			if(m_nodeNames.Find(name) != g_nameNotFound)
 				throw std::runtime_error("The node named \"" + name + "\" already exists.");
 
-			m_nodes[name] = NULL;
-
 			std::string meshName = make_string(*pMeshNode);
 			MeshMap::iterator meshIt = m_meshes.find(meshName);
 			if(meshIt == m_meshes.end())
@@ -772,25 +1446,33 @@ namespace Framework
 
 			glm::vec3 nodePos = rapidxml::attrib_to_vec3(*pPositionNode, ThrowAttrib);
 
-			SceneNode *pNode = new SceneNode(meshIt->second, progIt->second, nodePos,
-				ReadNodeTextures(nodeNode));
-			m_nodes[name] = pNode;
+			std::vector<TextureBinding> texBindings = ReadNodeTextures(nodeNode);
+			size_t nodeIx = m_nodes.AddNode(meshIt->second, progIt->second, nodePos, texBindings);
+			m_nodeNames.Insert(name, nodeIx);
+
+			//The layers of packed textures are uniforms, which live in the bind table.
+			for(size_t texIx = 0; texIx < texBindings.size(); ++texIx)
+			{
+				if(texBindings[texIx].layer != -1)
+					MarkBindTableDirty(nodeIx);
+			}
 
 			//TODO: parent/child nodes.
-			if(!pParent)
-				m_rootNodes.push_back(pNode);
+			if(parentIx == g_nameNotFound)
+				m_rootNodes.push_back(nodeIx);
 
+			Transform &nodeTm = m_nodes.transforms[nodeIx];
 			if(pOrientNode)
-				pNode->SetNodeOrient(rapidxml::attrib_to_quat(*pOrientNode, ThrowAttrib));
+				nodeTm.m_orient = glm::normalize(rapidxml::attrib_to_quat(*pOrientNode, ThrowAttrib));
 
 			if(pScaleNode)
 			{
 				if(rapidxml::attrib_is_vec3(*pScaleNode))
-					pNode->SetNodeScale(rapidxml::attrib_to_vec3(*pScaleNode, ThrowAttrib));
+					nodeTm.m_scale = rapidxml::attrib_to_vec3(*pScaleNode, ThrowAttrib);
 				else
 				{
 					float unifScale = rapidxml::attrib_to_float(*pScaleNode, ThrowAttrib);
-					pNode->SetNodeScale(glm::vec3(unifScale));
+					nodeTm.m_scale = glm::vec3(unifScale);
 				}
 			}
 
@@ -822,6 +1504,7 @@ namespace Framework
 				const xml_attribute<> *pNameNode = texNode.first_attribute("name");
 				const xml_attribute<> *pUnitName = texNode.first_attribute("unit");
 				const xml_attribute<> *pSamplerName = texNode.first_attribute("sampler");
+				const xml_attribute<> *pUvDensityNode = texNode.first_attribute("uv-density");
 
 				PARSE_THROW(pNameNode, "Textures on nodes must have a `name` attribute.");
 				PARSE_THROW(pUnitName, "Textures on nodes must have a `unit` attribute.");
@@ -840,6 +1523,14 @@ namespace Framework
 				binding.pTex = texIt->second;
 				binding.texUnit = rapidxml::attrib_to_int(*pUnitName, ThrowAttrib);
 				binding.sampler = GetTypeFromName(make_string(*pSamplerName));
+				binding.layer = binding.pTex->GetLayer();
+				binding.uvDensity = 1.0f;
+				if(pUvDensityNode)
+				{
+					binding.uvDensity = rapidxml::attrib_to_float(*pUvDensityNode, ThrowAttrib);
+					if(!(binding.uvDensity > 0.0f))
+						throw std::runtime_error("The `uv-density` of node texture " + textureName + " must be positive.");
+				}
 
 				if(texUnits.find(binding.texUnit) != texUnits.end())
 					throw std::runtime_error("Multiply bound texture unit in node texture " + textureName);
@@ -855,47 +1546,53 @@ namespace Framework
 
 	void NodeRef::NodeSetScale( const glm::vec3 &scale )
 	{
-		m_pNode->NodeSetScale(scale);
+		m_pScene->GetNodeTransform(*this).m_scale = scale;
 	}
 
 	void NodeRef::NodeSetScale( float scale )
 	{
-		m_pNode->NodeSetScale(glm::vec3(scale));
+		m_pScene->GetNodeTransform(*this).m_scale = glm::vec3(scale);
 	}
 
 	void NodeRef::NodeRotate( const glm::fquat &orient )
 	{
-		m_pNode->NodeRotate(orient);
+		Transform &nodeTm = m_pScene->GetNodeTransform(*this);
+		nodeTm.m_orient = nodeTm.m_orient * orient;
 	}
 
 	void NodeRef::NodeSetOrient( const glm::fquat &orient )
 	{
-		m_pNode->NodeSetOrient(orient);
+		m_pScene->GetNodeTransform(*this).m_orient = orient;
 	}
 
 	glm::fquat NodeRef::NodeGetOrient() const
 	{
-		return m_pNode->NodeGetOrient();
+		return m_pScene->GetNodeTransform(*this).m_orient;
 	}
 
 	void NodeRef::NodeOffset( const glm::vec3 &offset )
 	{
-		m_pNode->NodeOffset(offset);
+		m_pScene->GetNodeTransform(*this).m_trans += offset;
 	}
 
 	void NodeRef::NodeSetTrans( const glm::vec3 &offset )
 	{
-		m_pNode->NodeSetTrans(offset);
+		m_pScene->GetNodeTransform(*this).m_trans = offset;
 	}
 
 	void NodeRef::SetStateBinder( StateBinder *pBinder )
 	{
-		m_pNode->SetStateBinder(pBinder);
+		m_pScene->AddNodeBinder(*this, pBinder);
 	}
 
 	GLuint NodeRef::GetProgram() const
 	{
-		return m_pNode->GetProgram();
+		return m_pScene->GetNodeProgram(*this);
+	}
+
+	GLint NodeRef::GetTextureLayer( GLuint texUnit ) const
+	{
+		return m_pScene->GetNodeTextureLayer(*this, texUnit);
 	}
 
 	Scene::Scene( const std::string &filename )
@@ -926,4 +1623,24 @@ namespace Framework
 	{
 		return m_pImpl->FindMesh(meshName);
 	}
+
+	void Scene::SetTextureBudget( size_t budgetBytes )
+	{
+		m_pImpl->SetTextureBudget(budgetBytes);
+	}
+
+	void Scene::SetStreamingView( const glm::mat4 &cameraToClipMatrix, int viewportHeight )
+	{
+		m_pImpl->SetStreamingView(cameraToClipMatrix, viewportHeight);
+	}
+
+	TextureStreamingStats Scene::GetTextureStreamingStats() const
+	{
+		return m_pImpl->GetTextureStreamingStats();
+	}
+
+	TextureResidency Scene::GetTextureResidency( const std::string &textureName ) const
+	{
+		return m_pImpl->GetTextureResidency(textureName);
+	}
 }
@@ -5,11 +5,11 @@
 #include <string>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include "TextureStreamer.h"
 
 namespace Framework
 {
 	class SceneImpl;
-	class SceneNode;
 
 	class Mesh;
 
@@ -39,10 +39,18 @@ namespace Framework
 
 		GLuint GetProgram() const;
 
+		//Textures with the `pack` attribute are layers of GL_TEXTURE_2D_ARRAY textures.
+		//Returns the layer of the one this node binds to the given texture unit, or -1
+		//if that texture is not packed or there is none.
+		GLint GetTextureLayer(GLuint texUnit) const;
+
 	private:
 		NodeRef();	//No default-construction.
-		explicit NodeRef(SceneNode *pNode) : m_pNode(pNode) {}
-		SceneNode *m_pNode;
+		NodeRef(SceneImpl *pScene, unsigned int nodeIx)
+			: m_pScene(pScene), m_nodeIx(nodeIx) {}
+
+		SceneImpl *m_pScene;
+		unsigned int m_nodeIx;
 
 		friend class SceneImpl;
 	};
@@ -61,6 +69,21 @@ namespace Framework
 
 		Mesh *FindMesh(const std::string &meshName);
 
+		//Textures with the `stream` attribute start out with only their mipmap tail loaded.
+		//Every Render asks for the levels that the nodes using them need, from the size of
+		//the nodes on screen and their textures' `uv-density`, and then loads and drops
+		//levels within the budget. The budget is unlimited by default.
+		void SetTextureBudget(size_t budgetBytes);
+
+		//Tells texture streaming how large nodes look on screen. Call it whenever the
+		//projection or the viewport changes.
+		void SetStreamingView(const glm::mat4 &cameraToClipMatrix, int viewportHeight);
+
+		TextureStreamingStats GetTextureStreamingStats() const;
+
+		//Throws if the texture does not exist or is not streamed.
+		TextureResidency GetTextureResidency(const std::string &textureName) const;
+
 	private:
 		SceneImpl *m_pImpl;
 	};
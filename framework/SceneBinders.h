@@ -7,9 +7,29 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "Scene.h"
+#include "StateCache.h"
+#include "FrameStats.h"
 
 namespace Framework
 {
+	enum UniformType
+	{
+		UNIFORM_FLOAT,
+		UNIFORM_VEC2,
+		UNIFORM_VEC3,
+		UNIFORM_VEC4,
+		UNIFORM_INT,
+		UNIFORM_MAT4
+	};
+
+	//Describes the uniform that a binder sets in a particular program.
+	struct UniformTableEntry
+	{
+		GLint location;
+		UniformType type;
+		const void *pValue;		//Read at render time, so it must live as long as the binder.
+	};
+
 	class StateBinder
 	{
 	public:
@@ -20,8 +40,23 @@ namespace Framework
 
 		//The current program will be in use when this is called.
 		virtual void UnbindState(GLuint prog) const = 0;
+
+		//Binders that only set a uniform can describe it here. The scene then uploads it
+		//from a table, and only when the value differs from the last one the scene uploaded
+		//to that program. So the scene must be the only thing that sets the uniform: after a
+		//glUniform* call on a scene program from outside, or relinking one, the next upload
+		//of the value the scene last set would be skipped. Call InvalidateBindTables after
+		//doing either. Or return false to have BindState/UnbindState called instead; they set
+		//the uniform on every draw.
+		virtual bool GetUniformEntry(GLuint, UniformTableEntry &) const {return false;}
 	};
 
+	//Makes every scene rebuild the tables of its nodes' binders at its next Render, asking
+	//them for their uniforms again, and upload every table uniform again. Call this when a
+	//binder's GetUniformEntry would give a different location than before, or when scene
+	//programs' uniforms were changed from outside the scene.
+	void InvalidateBindTables();
+
 	class UniformBinderBase : public StateBinder
 	{
 	public:
@@ -30,6 +65,7 @@ namespace Framework
 		void AssociateWithProgram(GLuint prog, const std::string &unifName)
 		{
 			m_progUnifLoc[prog] = glGetUniformLocation(prog, unifName.c_str());
+			InvalidateBindTables();
 		}
 
 	protected:
@@ -42,6 +78,15 @@ namespace Framework
 			return loc->second;
 		}
 
+		bool MakeUniformEntry(GLuint prog, UniformType type, const void *pValue,
+			UniformTableEntry &entry) const
+		{
+			entry.location = GetUniformLoc(prog);
+			entry.type = type;
+			entry.pValue = pValue;
+			return true;
+		}
+
 	private:
 		std::map<GLuint, GLint> m_progUnifLoc;
 	};
@@ -57,10 +102,16 @@ namespace Framework
 		virtual void BindState(GLuint prog) const
 		{
 			glUniform4fv(GetUniformLoc(prog), 1, glm::value_ptr(m_val));
+			CountUniformUpload();
 		}
 
 		virtual void UnbindState(GLuint prog) const {}
 
+		virtual bool GetUniformEntry(GLuint prog, UniformTableEntry &entry) const
+		{
+			return MakeUniformEntry(prog, UNIFORM_VEC4, glm::value_ptr(m_val), entry);
+		}
+
 	private:
 		glm::vec4 m_val;
 	};
@@ -76,10 +127,16 @@ namespace Framework
 		virtual void BindState(GLuint prog) const
 		{
 			glUniform3fv(GetUniformLoc(prog), 1, glm::value_ptr(m_val));
+			CountUniformUpload();
 		}
 
 		virtual void UnbindState(GLuint prog) const {}
 
+		virtual bool GetUniformEntry(GLuint prog, UniformTableEntry &entry) const
+		{
+			return MakeUniformEntry(prog, UNIFORM_VEC3, glm::value_ptr(m_val), entry);
+		}
+
 	private:
 		glm::vec3 m_val;
 	};
@@ -95,10 +152,16 @@ namespace Framework
 		virtual void BindState(GLuint prog) const
 		{
 			glUniform2fv(GetUniformLoc(prog), 1, glm::value_ptr(m_val));
+			CountUniformUpload();
 		}
 
 		virtual void UnbindState(GLuint prog) const {}
 
+		virtual bool GetUniformEntry(GLuint prog, UniformTableEntry &entry) const
+		{
+			return MakeUniformEntry(prog, UNIFORM_VEC2, glm::value_ptr(m_val), entry);
+		}
+
 	private:
 		glm::vec2 m_val;
 	};
@@ -114,10 +177,16 @@ namespace Framework
 		virtual void BindState(GLuint prog) const
 		{
 			glUniform1f(GetUniformLoc(prog), m_val);
+			CountUniformUpload();
 		}
 
 		virtual void UnbindState(GLuint prog) const {}
 
+		virtual bool GetUniformEntry(GLuint prog, UniformTableEntry &entry) const
+		{
+			return MakeUniformEntry(prog, UNIFORM_FLOAT, &m_val, entry);
+		}
+
 	private:
 		float m_val;
 	};
@@ -133,10 +202,16 @@ namespace Framework
 		virtual void BindState(GLuint prog) const
 		{
 			glUniform1i(GetUniformLoc(prog), m_val);
+			CountUniformUpload();
 		}
 
 		virtual void UnbindState(GLuint prog) const {}
 
+		virtual bool GetUniformEntry(GLuint prog, UniformTableEntry &entry) const
+		{
+			return MakeUniformEntry(prog, UNIFORM_INT, &m_val, entry);
+		}
+
 	private:
 		int m_val;
 	};
@@ -152,10 +227,16 @@ namespace Framework
 		virtual void BindState(GLuint prog) const
 		{
 			glUniformMatrix4fv(GetUniformLoc(prog), 1, GL_FALSE, glm::value_ptr(m_val));
+			CountUniformUpload();
 		}
 
 		virtual void UnbindState(GLuint prog) const {}
 
+		virtual bool GetUniformEntry(GLuint prog, UniformTableEntry &entry) const
+		{
+			return MakeUniformEntry(prog, UNIFORM_MAT4, glm::value_ptr(m_val), entry);
+		}
+
 	private:
 		glm::mat4 m_val;
 	};
@@ -180,16 +261,14 @@ namespace Framework
 
 		virtual void BindState(GLuint prog) const
 		{
-			glActiveTexture(GL_TEXTURE0 + m_texUnit);
-			glBindTexture(m_texType, m_texObj);
-			glBindSampler(m_texUnit, m_samplerObj);
+			CachedBindTexture(m_texUnit, m_texType, m_texObj);
+			CachedBindSampler(m_texUnit, m_samplerObj);
 		}
 
 		virtual void UnbindState(GLuint prog) const
 		{
-			glActiveTexture(GL_TEXTURE0 + m_texUnit);
-			glBindTexture(m_texType, 0);
-			glBindSampler(m_texUnit, 0);
+			CachedBindTexture(m_texUnit, m_texType, 0);
+			CachedBindSampler(m_texUnit, 0);
 		}
 
 	private:
@@ -215,13 +294,13 @@ namespace Framework
 
 		virtual void BindState(GLuint prog) const
 		{
-			glBindBufferRange(GL_UNIFORM_BUFFER, m_blockIndex, m_unifBuffer,
+			CachedBindBufferRange(GL_UNIFORM_BUFFER, m_blockIndex, m_unifBuffer,
 				m_buffOffset, m_buffSize);
 		}
 
 		virtual void UnbindState(GLuint prog) const
 		{
-			glBindBufferBase(GL_UNIFORM_BUFFER, m_blockIndex, 0);
+			CachedBindBufferBase(GL_UNIFORM_BUFFER, m_blockIndex, 0);
 		}
 
 	private:
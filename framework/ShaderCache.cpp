@@ -0,0 +1,277 @@
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <sstream>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <stdio.h>
+#include <glload/gl_3_3.h>
+#include <glutil/Shader.h>
+#include "framework.h"
+#include "ResourceFS.h"
+#include "ShaderCache.h"
+
+namespace Framework
+{
+	namespace
+	{
+		typedef std::pair<GLenum, std::string> ShaderKey;
+		typedef std::map<ShaderKey, GLuint> ShaderMap;
+
+		ShaderMap g_shaderCache;
+		std::set<GLuint> g_cachedShaders;
+
+		//For compile errors; maps shaders to the files their source strings came from.
+		std::map<GLuint, std::vector<std::string> > g_shaderSourceFiles;
+		ShaderCacheStats g_stats = {0, 0};
+
+		//Returns the directive's name if the line is one, with the rest of the line in 'args'.
+		std::string GetDirective(const std::string &line, std::string &args)
+		{
+			size_t hashIx = line.find_first_not_of(" \t");
+			if(hashIx == std::string::npos || line[hashIx] != '#')
+				return std::string();
+
+			size_t nameIx = line.find_first_not_of(" \t", hashIx + 1);
+			if(nameIx == std::string::npos)
+				return std::string();
+
+			size_t nameEndIx = line.find_first_of(" \t", nameIx);
+			if(nameEndIx == std::string::npos)
+			{
+				args.clear();
+				return line.substr(nameIx);
+			}
+
+			args = line.substr(nameEndIx);
+			return line.substr(nameIx, nameEndIx - nameIx);
+		}
+
+		std::string GetIncludeName(const std::string &args, const std::string &filename, int lineNum)
+		{
+			size_t openIx = args.find('"');
+			size_t closeIx = openIx == std::string::npos ? openIx : args.find('"', openIx + 1);
+			if(closeIx == std::string::npos)
+			{
+				std::ostringstream message;
+				message << filename << "(" << lineNum << "): #include expects \"filename\".";
+				throw std::runtime_error(message.str());
+			}
+
+			std::string includeName = args.substr(openIx + 1, closeIx - openIx - 1);
+
+			size_t dirEndIx = filename.rfind('/');
+			if(dirEndIx != std::string::npos)
+			{
+				std::string relativeName = filename.substr(0, dirEndIx + 1) + includeName;
+				if(ResourceExists(relativeName))
+					return relativeName;
+			}
+
+			return includeName;
+		}
+
+		class Preprocessor
+		{
+		public:
+			Preprocessor(const ShaderDefines &defines, std::vector<std::string> &sourceFiles)
+				: m_defines(defines)
+				, m_sourceFiles(sourceFiles)
+				, m_hasInjectedDefines(false)
+			{
+				m_sourceFiles.clear();
+			}
+
+			std::string Process(const std::string &filename)
+			{
+				AppendFile(filename);
+
+				//No #version; the defines go first.
+				if(!m_hasInjectedDefines)
+				{
+					std::ostringstream withDefines;
+					AppendDefines(withDefines);
+					withDefines << "#line 1 0\n" << m_output.str();
+					return withDefines.str();
+				}
+
+				return m_output.str();
+			}
+
+		private:
+			const ShaderDefines &m_defines;
+			std::vector<std::string> &m_sourceFiles;
+			std::vector<std::string> m_includeStack;
+			std::ostringstream m_output;
+			bool m_hasInjectedDefines;
+
+			void AppendDefines(std::ostream &output)
+			{
+				for(ShaderDefines::const_iterator defIt = m_defines.begin();
+					defIt != m_defines.end();
+					++defIt)
+				{
+					output << "#define " << defIt->first;
+					if(!defIt->second.empty())
+						output << " " << defIt->second;
+					output << "\n";
+				}
+
+				m_hasInjectedDefines = true;
+			}
+
+			void AppendFile(const std::string &filename)
+			{
+				if(std::find(m_includeStack.begin(), m_includeStack.end(), filename) != m_includeStack.end())
+					throw std::runtime_error("Recursive #include of " + filename);
+
+				std::auto_ptr<FileView> pFile(OpenResource(filename));
+				std::string text(pFile->GetData(), pFile->GetSize());
+				pFile.reset();
+
+				int sourceIx = (int)m_sourceFiles.size();
+				m_sourceFiles.push_back(filename);
+				m_includeStack.push_back(filename);
+
+				int lineNum = 0;
+				size_t lineStartIx = 0;
+				while(lineStartIx < text.size())
+				{
+					size_t lineEndIx = text.find('\n', lineStartIx);
+					if(lineEndIx == std::string::npos)
+						lineEndIx = text.size();
+
+					std::string line = text.substr(lineStartIx, lineEndIx - lineStartIx);
+					if(!line.empty() && line[line.size() - 1] == '\r')
+						line.erase(line.size() - 1);
+
+					lineStartIx = lineEndIx + 1;
+					++lineNum;
+
+					std::string args;
+					std::string directive = GetDirective(line, args);
+					if(directive == "include")
+					{
+						std::string includeName = GetIncludeName(args, filename, lineNum);
+						m_output << "#line 1 " << m_sourceFiles.size() << "\n";
+						AppendFile(includeName);
+						m_output << "#line " << lineNum + 1 << " " << sourceIx << "\n";
+					}
+					else if(directive == "version" && m_includeStack.size() == 1 && !m_hasInjectedDefines)
+					{
+						m_output << line << "\n";
+						AppendDefines(m_output);
+						m_output << "#line " << lineNum + 1 << " " << sourceIx << "\n";
+					}
+					else
+					{
+						m_output << line << "\n";
+					}
+				}
+
+				m_includeStack.pop_back();
+			}
+		};
+	}
+
+	std::string PreprocessShader(const std::string &filename, const ShaderDefines &defines,
+		std::vector<std::string> &sourceFiles)
+	{
+		Preprocessor preprocessor(defines, sourceFiles);
+		return preprocessor.Process(filename);
+	}
+
+	GLuint SubmitShader(GLenum eShaderType, const std::string &strShaderFilename,
+		const ShaderDefines &defines)
+	{
+		++g_stats.numLoads;
+
+		std::vector<std::string> sourceFiles;
+		ShaderKey key(eShaderType, PreprocessShader(strShaderFilename, defines, sourceFiles));
+
+		ShaderMap::const_iterator cachedIt = g_shaderCache.find(key);
+		if(cachedIt != g_shaderCache.end())
+			return cachedIt->second;
+
+		GLuint shader = glCreateShader(eShaderType);
+		GLint textLength = (GLint)key.second.size();
+		const GLchar *pText = key.second.c_str();
+		glShaderSource(shader, 1, &pText, &textLength);
+		glCompileShader(shader);
+
+		++g_stats.numCompiles;
+		g_shaderCache[key] = shader;
+		g_cachedShaders.insert(shader);
+		g_shaderSourceFiles[shader].swap(sourceFiles);
+		return shader;
+	}
+
+	void CheckShader(GLuint shader)
+	{
+		GLint status;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+		if(status != GL_FALSE)
+			return;
+
+		//The exception deletes the shader, so it cannot stay in the cache.
+		if(g_cachedShaders.erase(shader))
+		{
+			for(ShaderMap::iterator cachedIt = g_shaderCache.begin(); cachedIt != g_shaderCache.end(); ++cachedIt)
+			{
+				if(cachedIt->second == shader)
+				{
+					g_shaderCache.erase(cachedIt);
+					break;
+				}
+			}
+		}
+
+		std::vector<std::string> sourceFiles;
+		sourceFiles.swap(g_shaderSourceFiles[shader]);
+		g_shaderSourceFiles.erase(shader);
+
+		glutil::CompileLinkException compileError(shader);
+		fprintf(stderr, "%s\n", compileError.what());
+		if(sourceFiles.size() > 1)
+		{
+			for(size_t sourceIx = 0; sourceIx < sourceFiles.size(); ++sourceIx)
+				fprintf(stderr, "Source %d: %s\n", (int)sourceIx, sourceFiles[sourceIx].c_str());
+		}
+
+		throw compileError;
+	}
+
+	GLuint LoadShader(GLenum eShaderType, const std::string &strShaderFilename,
+		const ShaderDefines &defines)
+	{
+		GLuint shader = SubmitShader(eShaderType, strShaderFilename, defines);
+		CheckShader(shader);
+		return shader;
+	}
+
+	void ReleaseShader(GLuint shader)
+	{
+		if(g_cachedShaders.find(shader) == g_cachedShaders.end())
+			glDeleteShader(shader);
+	}
+
+	ShaderCacheStats GetShaderCacheStats()
+	{
+		return g_stats;
+	}
+
+	void ClearShaderCache()
+	{
+		if(g_cachedShaders.empty())
+			return;
+
+		std::for_each(g_cachedShaders.begin(), g_cachedShaders.end(), glDeleteShader);
+		g_cachedShaders.clear();
+		g_shaderCache.clear();
+		g_shaderSourceFiles.clear();
+	}
+}
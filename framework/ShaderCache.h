@@ -0,0 +1,44 @@
+
+#ifndef FRAMEWORK_SHADER_CACHE_H
+#define FRAMEWORK_SHADER_CACHE_H
+
+#include <string>
+#include <vector>
+#include "framework.h"
+
+namespace Framework
+{
+	//Returns the shader text that LoadShader compiles. Included files are found through
+	//the resource file system, relative to the including file first. #line directives keep
+	//compiler messages pointing at the right lines; source string N is sourceFiles[N].
+	std::string PreprocessShader(const std::string &filename, const ShaderDefines &defines,
+		std::vector<std::string> &sourceFiles);
+
+	//As LoadShader, but does not wait for the compile to finish. Check it with CheckShader.
+	GLuint SubmitShader(GLenum eShaderType, const std::string &strShaderFilename,
+		const ShaderDefines &defines);
+
+	//Prints the log and throws a glutil::CompileLinkException if the shader did not compile.
+	//The exception deletes the shader.
+	void CheckShader(GLuint shader);
+
+	struct ShaderCacheStats
+	{
+		int numLoads;
+		int numCompiles;
+	};
+
+	//Totals since the program started. numLoads - numCompiles compiles were saved.
+	//Setting GLTUT_SHADER_STATS prints these once init() returns.
+	ShaderCacheStats GetShaderCacheStats();
+
+	//Deletes the cached shader objects. Programs already linked with them are unaffected.
+	//Shaders stay cached until this is called, so a permutation is compiled once, whenever
+	//it is loaded. An edited shader file does not need this to be recompiled, since its
+	//preprocessed text is the cache key. Call it after reloading all shaders, to delete the
+	//ones nothing uses any more. The framework calls it before destroying a headless
+	//context; a window's context deletes them along with itself.
+	void ClearShaderCache();
+}
+
+#endif //FRAMEWORK_SHADER_CACHE_H
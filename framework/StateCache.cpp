@@ -0,0 +1,393 @@
+
+#include <glload/gl_3_3.h>
+#include "StateCache.h"
+#include "FrameStats.h"
+
+namespace Framework
+{
+	namespace
+	{
+		const GLuint g_maxTrackedUnits = 32;
+		const GLuint g_maxTrackedBlockIndices = 64;
+
+		const GLenum g_textureTargets[] =
+		{
+			GL_TEXTURE_1D,
+			GL_TEXTURE_2D,
+			GL_TEXTURE_3D,
+			GL_TEXTURE_1D_ARRAY,
+			GL_TEXTURE_2D_ARRAY,
+			GL_TEXTURE_RECTANGLE,
+			GL_TEXTURE_CUBE_MAP,
+			GL_TEXTURE_BUFFER,
+			GL_TEXTURE_2D_MULTISAMPLE,
+			GL_TEXTURE_2D_MULTISAMPLE_ARRAY,
+		};
+
+		const int g_numTextureTargets = sizeof(g_textureTargets) / sizeof(g_textureTargets[0]);
+
+		//GL_ELEMENT_ARRAY_BUFFER is part of VAO state, so it is not tracked.
+		const GLenum g_bufferTargets[] =
+		{
+			GL_ARRAY_BUFFER,
+			GL_COPY_READ_BUFFER,
+			GL_COPY_WRITE_BUFFER,
+			GL_PIXEL_PACK_BUFFER,
+			GL_PIXEL_UNPACK_BUFFER,
+			GL_TEXTURE_BUFFER,
+			GL_UNIFORM_BUFFER,
+		};
+
+		const int g_numBufferTargets = sizeof(g_bufferTargets) / sizeof(g_bufferTargets[0]);
+
+		int FindTarget(const GLenum *targets, int numTargets, GLenum target)
+		{
+			for(int targetIx = 0; targetIx < numTargets; ++targetIx)
+			{
+				if(targets[targetIx] == target)
+					return targetIx;
+			}
+
+			return -1;
+		}
+
+		struct Binding
+		{
+			GLuint obj;
+			GLintptr offset;	//Offset and size are both 0 for whole-buffer bindings.
+			GLsizeiptr size;
+			bool isKnown;
+			bool isUnbindPending;
+
+			void Reset()
+			{
+				obj = 0;
+				offset = 0;
+				size = 0;
+				isKnown = false;
+				isUnbindPending = false;
+			}
+		};
+
+		struct CacheState
+		{
+			int scopeDepth;
+
+			Binding program;
+			Binding vao;
+			Binding textures[g_maxTrackedUnits][g_numTextureTargets];
+			Binding samplers[g_maxTrackedUnits];
+			Binding buffers[g_numBufferTargets];
+			Binding uniformBlocks[g_maxTrackedBlockIndices];
+
+			GLuint activeUnit;
+			bool isActiveUnitKnown;
+
+			StateCacheStats currFrame;
+			StateCacheStats lastFrame;
+
+			void Reset()
+			{
+				program.Reset();
+				vao.Reset();
+				for(GLuint unit = 0; unit < g_maxTrackedUnits; ++unit)
+				{
+					for(int targetIx = 0; targetIx < g_numTextureTargets; ++targetIx)
+						textures[unit][targetIx].Reset();
+
+					samplers[unit].Reset();
+				}
+
+				for(int targetIx = 0; targetIx < g_numBufferTargets; ++targetIx)
+					buffers[targetIx].Reset();
+
+				for(GLuint index = 0; index < g_maxTrackedBlockIndices; ++index)
+					uniformBlocks[index].Reset();
+
+				activeUnit = 0;
+				isActiveUnitKnown = false;
+			}
+		};
+
+		CacheState g_cache;
+
+		void CountIssued()
+		{
+			++g_cache.currFrame.issuedCalls;
+		}
+
+		void CountElided()
+		{
+			++g_cache.currFrame.elidedCalls;
+		}
+
+		//Returns true if the caller must issue the bind now. Counts the call either way.
+		bool RequestBind(Binding &binding, GLuint obj, GLintptr offset, GLsizeiptr size)
+		{
+			if(!g_cache.scopeDepth)
+			{
+				CountIssued();
+				return true;
+			}
+
+			if(obj == 0)
+			{
+				if(binding.isUnbindPending || (binding.isKnown && binding.obj == 0))
+					CountElided();
+				else
+					binding.isUnbindPending = true;
+
+				return false;
+			}
+
+			//Something is bound before the deferred unbind happened, so it never needs to.
+			if(binding.isUnbindPending)
+			{
+				binding.isUnbindPending = false;
+				CountElided();
+			}
+
+			if(binding.isKnown && binding.obj == obj &&
+				binding.offset == offset && binding.size == size)
+			{
+				CountElided();
+				return false;
+			}
+
+			binding.obj = obj;
+			binding.offset = offset;
+			binding.size = size;
+			binding.isKnown = true;
+			CountIssued();
+			return true;
+		}
+
+		//For flushing a deferred unbind.
+		void MarkUnbound(Binding &binding)
+		{
+			binding.Reset();
+			binding.isKnown = true;
+			CountIssued();
+		}
+
+		void SelectTextureUnit(GLuint texUnit)
+		{
+			if(g_cache.scopeDepth)
+			{
+				if(g_cache.isActiveUnitKnown && g_cache.activeUnit == texUnit)
+					return;
+
+				g_cache.activeUnit = texUnit;
+				g_cache.isActiveUnitKnown = true;
+			}
+
+			glActiveTexture(GL_TEXTURE0 + texUnit);
+			CountIssued();
+		}
+
+		void SetUniformBufferShadow(GLuint buffer)
+		{
+			//Indexed binds also change the generic binding point.
+			if(g_cache.scopeDepth)
+			{
+				Binding &generic = g_cache.buffers[FindTarget(g_bufferTargets,
+					g_numBufferTargets, GL_UNIFORM_BUFFER)];
+				generic.obj = buffer;
+				generic.offset = 0;
+				generic.size = 0;
+				generic.isKnown = true;
+			}
+		}
+
+		void FlushDeferredUnbinds()
+		{
+			for(GLuint unit = 0; unit < g_maxTrackedUnits; ++unit)
+			{
+				for(int targetIx = 0; targetIx < g_numTextureTargets; ++targetIx)
+				{
+					Binding &binding = g_cache.textures[unit][targetIx];
+					if(binding.isUnbindPending)
+					{
+						SelectTextureUnit(unit);
+						glBindTexture(g_textureTargets[targetIx], 0);
+						MarkUnbound(binding);
+						CountTextureSwitch();
+					}
+				}
+
+				if(g_cache.samplers[unit].isUnbindPending)
+				{
+					glBindSampler(unit, 0);
+					MarkUnbound(g_cache.samplers[unit]);
+					CountTextureSwitch();
+				}
+			}
+
+			for(GLuint index = 0; index < g_maxTrackedBlockIndices; ++index)
+			{
+				if(g_cache.uniformBlocks[index].isUnbindPending)
+				{
+					glBindBufferBase(GL_UNIFORM_BUFFER, index, 0);
+					MarkUnbound(g_cache.uniformBlocks[index]);
+					SetUniformBufferShadow(0);
+				}
+			}
+
+			for(int targetIx = 0; targetIx < g_numBufferTargets; ++targetIx)
+			{
+				if(g_cache.buffers[targetIx].isUnbindPending)
+				{
+					glBindBuffer(g_bufferTargets[targetIx], 0);
+					MarkUnbound(g_cache.buffers[targetIx]);
+				}
+			}
+
+			if(g_cache.vao.isUnbindPending)
+			{
+				glBindVertexArray(0);
+				MarkUnbound(g_cache.vao);
+				CountVaoSwitch();
+			}
+
+			if(g_cache.program.isUnbindPending)
+			{
+				glUseProgram(0);
+				MarkUnbound(g_cache.program);
+				CountProgramSwitch();
+			}
+		}
+	}
+
+	void CachedUseProgram( GLuint program )
+	{
+		if(RequestBind(g_cache.program, program, 0, 0))
+		{
+			glUseProgram(program);
+			CountProgramSwitch();
+		}
+	}
+
+	void CachedBindVertexArray( GLuint vao )
+	{
+		if(RequestBind(g_cache.vao, vao, 0, 0))
+		{
+			glBindVertexArray(vao);
+			CountVaoSwitch();
+		}
+	}
+
+	void CachedBindTexture( GLuint texUnit, GLenum target, GLuint texture )
+	{
+		int targetIx = FindTarget(g_textureTargets, g_numTextureTargets, target);
+		if(texUnit >= g_maxTrackedUnits || targetIx == -1)
+		{
+			SelectTextureUnit(texUnit);
+			glBindTexture(target, texture);
+			CountIssued();
+			CountTextureSwitch();
+			return;
+		}
+
+		if(RequestBind(g_cache.textures[texUnit][targetIx], texture, 0, 0))
+		{
+			SelectTextureUnit(texUnit);
+			glBindTexture(target, texture);
+			CountTextureSwitch();
+		}
+	}
+
+	void CachedBindSampler( GLuint texUnit, GLuint sampler )
+	{
+		if(texUnit >= g_maxTrackedUnits)
+		{
+			glBindSampler(texUnit, sampler);
+			CountIssued();
+			CountTextureSwitch();
+			return;
+		}
+
+		if(RequestBind(g_cache.samplers[texUnit], sampler, 0, 0))
+		{
+			glBindSampler(texUnit, sampler);
+			CountTextureSwitch();
+		}
+	}
+
+	void CachedBindBuffer( GLenum target, GLuint buffer )
+	{
+		int targetIx = FindTarget(g_bufferTargets, g_numBufferTargets, target);
+		if(targetIx == -1)
+		{
+			glBindBuffer(target, buffer);
+			CountIssued();
+			return;
+		}
+
+		if(RequestBind(g_cache.buffers[targetIx], buffer, 0, 0))
+			glBindBuffer(target, buffer);
+	}
+
+	void CachedBindBufferBase( GLenum target, GLuint index, GLuint buffer )
+	{
+		if(target != GL_UNIFORM_BUFFER || index >= g_maxTrackedBlockIndices)
+		{
+			glBindBufferBase(target, index, buffer);
+			CountIssued();
+			return;
+		}
+
+		if(RequestBind(g_cache.uniformBlocks[index], buffer, 0, 0))
+		{
+			glBindBufferBase(target, index, buffer);
+			SetUniformBufferShadow(buffer);
+		}
+	}
+
+	void CachedBindBufferRange( GLenum target, GLuint index, GLuint buffer,
+		GLintptr offset, GLsizeiptr size )
+	{
+		if(target != GL_UNIFORM_BUFFER || index >= g_maxTrackedBlockIndices)
+		{
+			glBindBufferRange(target, index, buffer, offset, size);
+			CountIssued();
+			return;
+		}
+
+		if(RequestBind(g_cache.uniformBlocks[index], buffer, offset, size))
+		{
+			glBindBufferRange(target, index, buffer, offset, size);
+			SetUniformBufferShadow(buffer);
+		}
+	}
+
+	StateCacheScope::StateCacheScope()
+	{
+		if(g_cache.scopeDepth++ == 0)
+			g_cache.Reset();
+	}
+
+	StateCacheScope::~StateCacheScope()
+	{
+		if(g_cache.scopeDepth == 1)
+			FlushDeferredUnbinds();
+
+		--g_cache.scopeDepth;
+	}
+
+	StateCacheStats GetStateCacheStats()
+	{
+		return g_cache.lastFrame;
+	}
+
+	StateCacheStats GetCurrentStateCacheStats()
+	{
+		return g_cache.currFrame;
+	}
+
+	void EndStateCacheFrame()
+	{
+		g_cache.lastFrame = g_cache.currFrame;
+		g_cache.currFrame.issuedCalls = 0;
+		g_cache.currFrame.elidedCalls = 0;
+	}
+}
@@ -0,0 +1,58 @@
+
+#ifndef FRAMEWORK_STATE_CACHE_H
+#define FRAMEWORK_STATE_CACHE_H
+
+#include <glload/gl_3_3.h>
+
+namespace Framework
+{
+	//These functions shadow the current program, vertex array, per-unit texture and
+	//sampler bindings, and buffer bindings, and drop calls that would change nothing.
+	//
+	//Tracking only happens while a StateCacheScope is alive. Outside of one, every call
+	//goes straight to OpenGL. Inside one, binding object 0 is deferred: the unbind is only
+	//issued if nothing else is bound there before the scope ends. So when the outermost
+	//scope ends, OpenGL is left in the same state as if every call had been issued.
+	//
+	//Inside a scope, the tracked bindings (and the active texture unit) must not be changed
+	//except through these functions.
+	void CachedUseProgram(GLuint program);
+	void CachedBindVertexArray(GLuint vao);
+	void CachedBindTexture(GLuint texUnit, GLenum target, GLuint texture);
+	void CachedBindSampler(GLuint texUnit, GLuint sampler);
+	void CachedBindBuffer(GLenum target, GLuint buffer);
+	void CachedBindBufferBase(GLenum target, GLuint index, GLuint buffer);
+	void CachedBindBufferRange(GLenum target, GLuint index, GLuint buffer,
+		GLintptr offset, GLsizeiptr size);
+
+	class StateCacheScope
+	{
+	public:
+		//The first scope assumes nothing about the current OpenGL state.
+		StateCacheScope();
+
+		//Leaving the outermost scope issues all deferred unbinds.
+		~StateCacheScope();
+
+	private:
+		StateCacheScope(const StateCacheScope &);
+		StateCacheScope &operator=(const StateCacheScope &);
+	};
+
+	struct StateCacheStats
+	{
+		int issuedCalls;	//Calls that reached OpenGL, including glActiveTexture.
+		int elidedCalls;	//Requested binds that were dropped.
+	};
+
+	//Counters for the last completed frame.
+	StateCacheStats GetStateCacheStats();
+
+	//Counters for the frame in progress.
+	StateCacheStats GetCurrentStateCacheStats();
+
+	//Finishes the current frame's counters. The framework calls this after every display().
+	void EndStateCacheFrame();
+}
+
+#endif //FRAMEWORK_STATE_CACHE_H
@@ -0,0 +1,408 @@
+
+#include <vector>
+#include <queue>
+#include <utility>
+#include <algorithm>
+#include <memory>
+#include <math.h>
+#include <glload/gl_3_3.h>
+#include <glimg/glimg.h>
+#include <glimg/BlockCompressor.h>
+#include <glimg/FormatConverter.h>
+#include "TextureStreamer.h"
+#include "FrameStats.h"
+
+namespace Framework
+{
+	namespace
+	{
+		//Levels no larger than this are always resident. They are small enough that
+		//streaming them would cost more in bookkeeping than it saves.
+		const int g_mipTailSize = 64;
+
+		const size_t g_defaultUploadLimit = 4 * 1024 * 1024;
+
+		//The flags that only choose how glimg creates a texture.
+		const unsigned int g_creationFunctionFlags = glimg::USE_TEXTURE_STORAGE |
+			glimg::FORCE_TEXTURE_STORAGE | glimg::USE_DSA | glimg::FORCE_DSA;
+
+		int GetLargerDimension(const glimg::ImageSet &imageSet, int mipmapLevel)
+		{
+			glimg::Dimensions dims = imageSet.GetImage(mipmapLevel).GetDimensions();
+			return std::max(dims.width, dims.height);
+		}
+
+		//Streaming needs every level to be specified on its own, and the levels above
+		//the base level to be free to go.
+		bool CanStreamImage(const glimg::ImageSet &imageSet, unsigned int creationFlags)
+		{
+			if(imageSet.GetMipmapCount() < 2 || GetLargerDimension(imageSet, 0) <= g_mipTailSize)
+				return false;
+
+			return glimg::GetTextureType(&imageSet, creationFlags) == GL_TEXTURE_2D;
+		}
+
+		//Binds textures to GL_TEXTURE_2D of the active unit, and puts back what was bound
+		//there once it goes away. The binding is only queried if something gets bound.
+		class TextureBinder
+		{
+		public:
+			TextureBinder() : m_prevTexture(-1) {}
+
+			~TextureBinder()
+			{
+				if(m_prevTexture != -1)
+					glBindTexture(GL_TEXTURE_2D, m_prevTexture);
+			}
+
+			void Bind(GLuint texture)
+			{
+				if(m_prevTexture == -1)
+					glGetIntegerv(GL_TEXTURE_BINDING_2D, &m_prevTexture);
+				glBindTexture(GL_TEXTURE_2D, texture);
+			}
+
+		private:
+			GLint m_prevTexture;
+		};
+
+		struct FurthestFromAllowed
+		{
+			bool operator()(const StreamedTexture *pLhs, const StreamedTexture *pRhs) const
+			{
+				TextureResidency lhs = pLhs->GetResidency();
+				TextureResidency rhs = pRhs->GetResidency();
+				return (lhs.residentLevel - lhs.allowedLevel) > (rhs.residentLevel - rhs.allowedLevel);
+			}
+		};
+	}
+
+	TextureStreamingStats::TextureStreamingStats()
+		: budgetBytes(0)
+		, residentBytes(0)
+		, wantedBytes(0)
+		, fullBytes(0)
+		, numTextures(0)
+		, numResidentLevels(0)
+		, numOverBudget(0)
+		, numStreaming(0)
+		, levelsLoaded(0)
+		, levelsDropped(0)
+		, bytesLoaded(0)
+	{}
+
+	StreamedTexture::StreamedTexture( glimg::ImageSet *pImageSet, unsigned int creationFlags )
+		: m_pImageSet(pImageSet)
+		, m_texObj(0)
+		, m_baseSize(GetLargerDimension(*pImageSet, 0))
+	{
+		glimg::ImageFormat format = pImageSet->GetFormat();
+		glimg::OpenGLPixelTransferParams params = glimg::GetUploadFormatType(format, creationFlags);
+		m_internalFormat = glimg::GetInternalFormat(format, creationFlags);
+		m_pixelFormat = params.format;
+		m_pixelType = params.type;
+		m_isCompressed = format.Type() >= glimg::DT_NUM_UNCOMPRESSED_TYPES;
+
+		const int numLevels = pImageSet->GetMipmapCount();
+		m_tailLevel = numLevels - 1;
+		for(int mipmapLevel = 0; mipmapLevel < numLevels; ++mipmapLevel)
+		{
+			m_levelBytes.push_back(pImageSet->GetImage(mipmapLevel).GetImageByteSize());
+			if(m_tailLevel == numLevels - 1 && GetLargerDimension(*pImageSet, mipmapLevel) <= g_mipTailSize)
+				m_tailLevel = mipmapLevel;
+		}
+
+		m_residentLevel = numLevels;
+		m_requestedLevel = m_tailLevel;
+		m_wantedLevel = m_tailLevel;
+		m_allowedLevel = m_tailLevel;
+
+		glGenTextures(1, &m_texObj);
+		glBindTexture(GL_TEXTURE_2D, m_texObj);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numLevels - 1);
+		for(int mipmapLevel = numLevels - 1; mipmapLevel >= m_tailLevel; --mipmapLevel)
+			LoadLevel(mipmapLevel);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	StreamedTexture::~StreamedTexture()
+	{
+		glDeleteTextures(1, &m_texObj);
+		delete m_pImageSet;
+	}
+
+	void StreamedTexture::RequestPixelsPerUv( float pixelsPerUv )
+	{
+		//Also rejects NaN.
+		if(!(pixelsPerUv > 0.0f))
+			return;
+
+		float level = (float)(log(m_baseSize / pixelsPerUv) / log(2.0));
+		if(level < (float)m_tailLevel)
+			RequestLevel(level < 0.0f ? 0 : (int)level);
+	}
+
+	void StreamedTexture::RequestLevel( int mipmapLevel )
+	{
+		m_requestedLevel = std::max(std::min(m_requestedLevel, mipmapLevel), 0);
+	}
+
+	TextureResidency StreamedTexture::GetResidency() const
+	{
+		TextureResidency residency;
+		residency.numLevels = (int)m_levelBytes.size();
+		residency.tailLevel = m_tailLevel;
+		residency.residentLevel = m_residentLevel;
+		residency.wantedLevel = m_wantedLevel;
+		residency.allowedLevel = m_allowedLevel;
+		residency.residentBytes = GetBytesFrom(m_residentLevel);
+		return residency;
+	}
+
+	size_t StreamedTexture::GetBytesFrom( int mipmapLevel ) const
+	{
+		size_t byteCount = 0;
+		for(size_t levelIx = mipmapLevel; levelIx < m_levelBytes.size(); ++levelIx)
+			byteCount += m_levelBytes[levelIx];
+
+		return byteCount;
+	}
+
+	//The texture must be bound. mipmapLevel must be the level just finer than the resident ones.
+	void StreamedTexture::LoadLevel( int mipmapLevel )
+	{
+		glimg::SingleImage image = m_pImageSet->GetImage(mipmapLevel);
+		glimg::Dimensions dims = image.GetDimensions();
+
+		if(m_isCompressed)
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, mipmapLevel, m_internalFormat, dims.width, dims.height,
+				0, (GLsizei)image.GetImageByteSize(), image.GetImageData());
+		}
+		else
+		{
+			glPixelStorei(GL_UNPACK_ALIGNMENT, image.GetFormat().LineAlign());
+			glTexImage2D(GL_TEXTURE_2D, mipmapLevel, m_internalFormat, dims.width, dims.height, 0,
+				m_pixelFormat, m_pixelType, image.GetImageData());
+		}
+
+		m_residentLevel = mipmapLevel;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, m_residentLevel);
+		CountTextureUpload(m_levelBytes[mipmapLevel]);
+	}
+
+	//The texture must be bound. Redefining a level as empty lets the driver free it; levels
+	//above the base level do not count toward the texture's completeness.
+	void StreamedTexture::DropLevels( int newResidentLevel )
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, newResidentLevel);
+		for(int mipmapLevel = m_residentLevel; mipmapLevel < newResidentLevel; ++mipmapLevel)
+		{
+			if(m_isCompressed)
+				glCompressedTexImage2D(GL_TEXTURE_2D, mipmapLevel, m_internalFormat, 0, 0, 0, 0, NULL);
+			else
+			{
+				glTexImage2D(GL_TEXTURE_2D, mipmapLevel, m_internalFormat, 0, 0, 0,
+					m_pixelFormat, m_pixelType, NULL);
+			}
+		}
+
+		m_residentLevel = newResidentLevel;
+	}
+
+	TextureStreamer::TextureStreamer( size_t budgetBytes )
+		: m_budgetBytes(budgetBytes)
+		, m_uploadLimit(g_defaultUploadLimit)
+	{
+		m_stats.budgetBytes = budgetBytes;
+	}
+
+	TextureStreamer::~TextureStreamer()
+	{
+		for(size_t texIx = 0; texIx < m_textures.size(); ++texIx)
+			delete m_textures[texIx];
+	}
+
+	StreamedTexture * TextureStreamer::AddTexture( glimg::ImageSet *pImageSet, unsigned int creationFlags )
+	{
+		creationFlags &= ~g_creationFunctionFlags;
+		if(!CanStreamImage(*pImageSet, creationFlags))
+			return NULL;
+
+		std::auto_ptr<glimg::ImageSet> pOwnedImage(pImageSet);
+		if(creationFlags & glimg::FORCE_BLOCK_COMPRESSED_FMT)
+		{
+			creationFlags &= ~glimg::FORCE_BLOCK_COMPRESSED_FMT;
+			if(glimg::CanCompressImage(*pOwnedImage))
+			{
+				pOwnedImage.reset(glimg::CompressImage(*pOwnedImage,
+					glimg::GetDefaultCompressedType(pOwnedImage->GetFormat())));
+			}
+		}
+
+		//Levels are uploaded as they are, so convert them all now. Formats that cannot be
+		//made renderable are rejected by glimg::GetInternalFormat.
+		if(creationFlags & glimg::FORCE_COLOR_RENDERABLE_FMT)
+		{
+			const glimg::ImageFormat &format = pOwnedImage->GetFormat();
+			try
+			{
+				glimg::ImageFormat renderFormat = glimg::GetColorRenderableFormat(format);
+				if(renderFormat.Components() != format.Components())
+					pOwnedImage.reset(glimg::ConvertImage(*pOwnedImage, renderFormat));
+			}
+			catch(glimg::ConversionUnsupportedException &)
+			{
+			}
+		}
+
+		m_textures.reserve(m_textures.size() + 1);
+		StreamedTexture *pTexture = new StreamedTexture(pOwnedImage.get(), creationFlags);
+		pOwnedImage.release();
+		m_textures.push_back(pTexture);
+
+		UpdateStats(m_stats.wantedBytes + pTexture->GetBytesFrom(pTexture->m_tailLevel));
+		return pTexture;
+	}
+
+	void TextureStreamer::SetBudget( size_t budgetBytes )
+	{
+		m_budgetBytes = budgetBytes;
+		m_stats.budgetBytes = budgetBytes;
+	}
+
+	void TextureStreamer::SetUploadLimit( size_t bytesPerUpdate )
+	{
+		m_uploadLimit = bytesPerUpdate;
+	}
+
+	void TextureStreamer::Update()
+	{
+		size_t wantedBytes = 0;
+		for(size_t texIx = 0; texIx < m_textures.size(); ++texIx)
+		{
+			StreamedTexture &tex = *m_textures[texIx];
+			tex.m_wantedLevel = tex.m_requestedLevel;
+			tex.m_allowedLevel = tex.m_requestedLevel;
+			tex.m_requestedLevel = tex.m_tailLevel;
+			wantedBytes += tex.GetBytesFrom(tex.m_wantedLevel);
+		}
+
+		FitBudget();
+
+		TextureBinder binder;
+		m_stats.levelsLoaded = 0;
+		m_stats.levelsDropped = 0;
+		m_stats.bytesLoaded = 0;
+
+		//A texture whose need hovers around a level boundary would load and drop the same
+		//level over and over. So one level finer than needed is kept, unless the budget
+		//needs the room.
+		size_t finalBytes = 0;
+		std::vector<StreamedTexture *> toLoad;
+		std::vector<std::pair<size_t, StreamedTexture *> > spareLevels;
+		for(size_t texIx = 0; texIx < m_textures.size(); ++texIx)
+		{
+			StreamedTexture &tex = *m_textures[texIx];
+			int keptLevel = tex.m_allowedLevel;
+			if(tex.m_allowedLevel == tex.m_wantedLevel && keptLevel > 0)
+				--keptLevel;
+
+			if(tex.m_residentLevel < keptLevel)
+			{
+				binder.Bind(tex.m_texObj);
+				m_stats.levelsDropped += keptLevel - tex.m_residentLevel;
+				tex.DropLevels(keptLevel);
+			}
+
+			if(tex.m_residentLevel < tex.m_allowedLevel)
+				spareLevels.push_back(std::make_pair(tex.m_levelBytes[tex.m_residentLevel], &tex));
+			else if(tex.m_residentLevel > tex.m_allowedLevel)
+				toLoad.push_back(&tex);
+
+			finalBytes += tex.GetBytesFrom(std::min(tex.m_residentLevel, tex.m_allowedLevel));
+		}
+
+		//Once everything allowed is loaded, it must fit with the spare levels.
+		std::sort(spareLevels.begin(), spareLevels.end());
+		while(finalBytes > m_budgetBytes && !spareLevels.empty())
+		{
+			StreamedTexture &tex = *spareLevels.back().second;
+			finalBytes -= spareLevels.back().first;
+			spareLevels.pop_back();
+
+			binder.Bind(tex.m_texObj);
+			tex.DropLevels(tex.m_allowedLevel);
+			++m_stats.levelsDropped;
+		}
+
+		//Each texture gets one level at a time, coarsest first; the ones furthest from what
+		//they are allowed go first.
+		std::stable_sort(toLoad.begin(), toLoad.end(), FurthestFromAllowed());
+		for(size_t loadIx = 0; loadIx < toLoad.size(); ++loadIx)
+		{
+			StreamedTexture &tex = *toLoad[loadIx];
+			size_t levelBytes = tex.m_levelBytes[tex.m_residentLevel - 1];
+			if(m_stats.bytesLoaded != 0 && m_stats.bytesLoaded + levelBytes > m_uploadLimit)
+				continue;
+
+			binder.Bind(tex.m_texObj);
+			tex.LoadLevel(tex.m_residentLevel - 1);
+			++m_stats.levelsLoaded;
+			m_stats.bytesLoaded += levelBytes;
+		}
+
+		UpdateStats(wantedBytes);
+	}
+
+	//Makes the allowed levels fit the budget by giving up the largest allowed level
+	//until they do. The mipmap tails always stay.
+	void TextureStreamer::FitBudget()
+	{
+		size_t allowedBytes = 0;
+		std::priority_queue<std::pair<size_t, size_t> > largestLevels;
+		for(size_t texIx = 0; texIx < m_textures.size(); ++texIx)
+		{
+			const StreamedTexture &tex = *m_textures[texIx];
+			allowedBytes += tex.GetBytesFrom(tex.m_allowedLevel);
+			if(tex.m_allowedLevel < tex.m_tailLevel)
+				largestLevels.push(std::make_pair(tex.m_levelBytes[tex.m_allowedLevel], texIx));
+		}
+
+		while(allowedBytes > m_budgetBytes && !largestLevels.empty())
+		{
+			size_t texIx = largestLevels.top().second;
+			allowedBytes -= largestLevels.top().first;
+			largestLevels.pop();
+
+			StreamedTexture &tex = *m_textures[texIx];
+			++tex.m_allowedLevel;
+			if(tex.m_allowedLevel < tex.m_tailLevel)
+				largestLevels.push(std::make_pair(tex.m_levelBytes[tex.m_allowedLevel], texIx));
+		}
+	}
+
+	void TextureStreamer::UpdateStats( size_t wantedBytes )
+	{
+		m_stats.budgetBytes = m_budgetBytes;
+		m_stats.wantedBytes = wantedBytes;
+		m_stats.residentBytes = 0;
+		m_stats.fullBytes = 0;
+		m_stats.numTextures = (int)m_textures.size();
+		m_stats.numResidentLevels = 0;
+		m_stats.numOverBudget = 0;
+		m_stats.numStreaming = 0;
+
+		for(size_t texIx = 0; texIx < m_textures.size(); ++texIx)
+		{
+			const StreamedTexture &tex = *m_textures[texIx];
+			m_stats.residentBytes += tex.GetBytesFrom(tex.m_residentLevel);
+			m_stats.fullBytes += tex.GetBytesFrom(0);
+			m_stats.numResidentLevels += (int)tex.m_levelBytes.size() - tex.m_residentLevel;
+			if(tex.m_allowedLevel > tex.m_wantedLevel)
+				++m_stats.numOverBudget;
+			if(tex.m_residentLevel > tex.m_allowedLevel)
+				++m_stats.numStreaming;
+		}
+	}
+}
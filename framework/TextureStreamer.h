@@ -0,0 +1,150 @@
+
+#ifndef FRAMEWORK_TEXTURE_STREAMER_H
+#define FRAMEWORK_TEXTURE_STREAMER_H
+
+#include <vector>
+#include <glload/gl_3_3.h>
+
+namespace glimg
+{
+	class ImageSet;
+}
+
+namespace Framework
+{
+	//The state of a TextureStreamer's memory, as of its last Update. Byte counts are
+	//the sizes of the pixel data; drivers may use more.
+	struct TextureStreamingStats
+	{
+		TextureStreamingStats();
+
+		size_t budgetBytes;
+		size_t residentBytes;	//Every level currently in a texture.
+		size_t wantedBytes;		//What the requested levels would take, ignoring the budget.
+		size_t fullBytes;		//What every level of every texture would take.
+
+		int numTextures;
+		int numResidentLevels;
+		int numOverBudget;		//Textures held coarser than requested to stay in the budget.
+		int numStreaming;		//Textures still waiting for finer levels that the budget allows.
+
+		//Work done by the last Update.
+		int levelsLoaded;
+		int levelsDropped;
+		size_t bytesLoaded;
+	};
+
+	//Where one streamed texture stands. Levels are numbered as in the texture: 0 is the finest.
+	struct TextureResidency
+	{
+		int numLevels;
+		int tailLevel;		//This level and all coarser ones are always resident.
+		int residentLevel;	//The finest resident level. Also the texture's GL_TEXTURE_BASE_LEVEL.
+		int wantedLevel;	//The finest level that was requested before the last Update.
+		int allowedLevel;	//wantedLevel, made coarser as far as the budget required.
+		size_t residentBytes;
+	};
+
+	class TextureStreamer;
+
+	//A 2D texture whose finer mipmap levels come and go. The texture object stays the same;
+	//only its GL_TEXTURE_BASE_LEVEL and the levels above it change.
+	class StreamedTexture
+	{
+	public:
+		GLuint GetTexture() const {return m_texObj;}
+		GLenum GetType() const {return GL_TEXTURE_2D;}
+
+		//Asks for the level at which one texel covers about one pixel, given how many pixels
+		//one unit of texture coordinates spans on screen. Every request until the next
+		//TextureStreamer::Update counts; the finest one wins.
+		void RequestPixelsPerUv(float pixelsPerUv);
+
+		//Asks for the given level directly.
+		void RequestLevel(int mipmapLevel);
+
+		TextureResidency GetResidency() const;
+
+	private:
+		StreamedTexture(glimg::ImageSet *pImageSet, unsigned int creationFlags);
+		~StreamedTexture();
+
+		void LoadLevel(int mipmapLevel);
+		void DropLevels(int newResidentLevel);
+
+		glimg::ImageSet *m_pImageSet;
+		GLuint m_texObj;
+		GLenum m_internalFormat;
+		GLenum m_pixelFormat;
+		GLenum m_pixelType;
+		bool m_isCompressed;
+
+		std::vector<size_t> m_levelBytes;
+		int m_baseSize;			//The larger dimension of level 0.
+		int m_tailLevel;
+		int m_residentLevel;
+		int m_requestedLevel;	//Reset to the tail by every Update.
+		int m_wantedLevel;
+		int m_allowedLevel;
+
+		size_t GetBytesFrom(int mipmapLevel) const;
+
+		friend class TextureStreamer;
+
+		StreamedTexture(const StreamedTexture &);
+		StreamedTexture &operator=(const StreamedTexture &);
+	};
+
+	//Keeps the mipmaps of a set of textures within a memory budget. Each texture starts with
+	//only its mipmap tail resident. Every frame, its users request the level they need; Update
+	//then drops the levels that are no longer needed, and loads finer ones, coarsest first,
+	//as far as the budget allows. When the requests do not fit, the largest levels are given
+	//up first, which keeps the resolutions of the textures close to each other.
+	//
+	//The whole image stays in client memory; only what OpenGL holds is managed.
+	//All functions must be called on the OpenGL thread.
+	class TextureStreamer
+	{
+	public:
+		//The default budget is unlimited, so every requested level is loaded.
+		explicit TextureStreamer(size_t budgetBytes = ~size_t(0));
+		~TextureStreamer();
+
+		//Creates a texture with only its mipmap tail loaded. Takes ownership of the image,
+		//even if this throws, unless NULL is returned. That happens if the image cannot be
+		//streamed: only 2D images with levels larger than the tail can be.
+		//
+		//creationFlags are those of glimg::CreateTexture. FORCE_BLOCK_COMPRESSED_FMT
+		//compresses the image right away, and FORCE_COLOR_RENDERABLE_FMT converts it; the
+		//flags that pick texture creation functions are ignored.
+		StreamedTexture *AddTexture(glimg::ImageSet *pImageSet, unsigned int creationFlags);
+
+		void SetBudget(size_t budgetBytes);
+		size_t GetBudget() const {return m_budgetBytes;}
+
+		//How many bytes an Update may upload. At least one level is always loaded if one
+		//is wanted, however big it is.
+		void SetUploadLimit(size_t bytesPerUpdate);
+
+		//Applies the requests made since the last Update. Changes the GL_UNPACK_ALIGNMENT.
+		//Textures are bound to the active texture unit while their levels change, but its
+		//binding is restored afterwards.
+		void Update();
+
+		TextureStreamingStats GetStats() const {return m_stats;}
+
+	private:
+		std::vector<StreamedTexture *> m_textures;
+		size_t m_budgetBytes;
+		size_t m_uploadLimit;
+		TextureStreamingStats m_stats;
+
+		void FitBudget();
+		void UpdateStats(size_t wantedBytes);
+
+		TextureStreamer(const TextureStreamer &);
+		TextureStreamer &operator=(const TextureStreamer &);
+	};
+}
+
+#endif //FRAMEWORK_TEXTURE_STREAMER_H
@@ -2,8 +2,9 @@
 
 #include <math.h>
 #include <glm/glm.hpp>
-#include <GL/freeglut.h>
+#include <glload/gl_3_3.h>
 #include "framework.h"
+#include "Clock.h"
 #include "Timer.h"
 
 
@@ -15,8 +16,8 @@ namespace Framework
 		, m_secDuration(fDuration)
 		, m_hasUpdated(false)
 		, m_isPaused(false)
-		, m_absPrevTime(0.0f)
-		, m_secAccumTime(0.0f)
+		, m_absPrevTime(0.0)
+		, m_secAccumTime(0.0)
 	{
 		if(m_eType != TT_INFINITE)
 			assert(m_secDuration > 0.0f);
@@ -25,7 +26,7 @@ namespace Framework
 	void Timer::Reset()
 	{
 		m_hasUpdated = false;
-		m_secAccumTime = 0.0f;
+		m_secAccumTime = 0.0;
 	}
 
 	bool Timer::TogglePause()
@@ -46,7 +47,7 @@ namespace Framework
 
 	bool Timer::Update()
 	{
-		float absCurrTime = glutGet(GLUT_ELAPSED_TIME) / 1000.0f;
+		double absCurrTime = GetClock().GetTime();
 		if(!m_hasUpdated)
 		{
 			m_absPrevTime = absCurrTime;
@@ -59,7 +60,7 @@ namespace Framework
 			return false;
 		}
 
-		float fDeltaTime = absCurrTime - m_absPrevTime;
+		double fDeltaTime = absCurrTime - m_absPrevTime;
 		m_secAccumTime += fDeltaTime;
 
 		m_absPrevTime = absCurrTime;
@@ -72,8 +73,8 @@ namespace Framework
 	void Timer::Rewind( float secRewind )
 	{
 		m_secAccumTime -= secRewind;
-		if(m_secAccumTime < 0.0f)
-			m_secAccumTime = 0.0f;
+		if(m_secAccumTime < 0.0)
+			m_secAccumTime = 0.0;
 	}
 
 	void Timer::Fastforward( float secFF )
@@ -86,9 +87,9 @@ namespace Framework
 		switch(m_eType)
 		{
 		case TT_LOOP:
-			return fmodf(m_secAccumTime, m_secDuration) / m_secDuration;
+			return (float)(fmod(m_secAccumTime, m_secDuration) / m_secDuration);
 		case TT_SINGLE:
-			return glm::clamp(m_secAccumTime / m_secDuration, 0.0f, 1.0f);
+			return glm::clamp((float)(m_secAccumTime / m_secDuration), 0.0f, 1.0f);
 		}
 
 		return -1.0f;	//Garbage.
@@ -99,9 +100,9 @@ namespace Framework
 		switch(m_eType)
 		{
 		case TT_LOOP:
-			return fmodf(m_secAccumTime, m_secDuration);
+			return (float)fmod(m_secAccumTime, m_secDuration);
 		case TT_SINGLE:
-			return glm::clamp(m_secAccumTime, 0.0f, m_secDuration);
+			return glm::clamp((float)m_secAccumTime, 0.0f, m_secDuration);
 		}
 
 		return -1.0f;	//Garbage.
@@ -109,6 +110,6 @@ namespace Framework
 
 	float Timer::GetTimeSinceStart() const
 	{
-		return m_secAccumTime;
+		return (float)m_secAccumTime;
 	}
 }
@@ -72,8 +72,9 @@ namespace Framework
 		bool m_hasUpdated;
 		bool m_isPaused;
 
-		float m_absPrevTime;
-		float m_secAccumTime;
+		//Doubles, so that long runs do not lose precision.
+		double m_absPrevTime;
+		double m_secAccumTime;
 	};
 }
 
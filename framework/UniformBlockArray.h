@@ -6,6 +6,7 @@
 
 #include <string.h>
 #include <vector>
+#include "FrameStats.h"
 
 namespace Framework
 {
@@ -87,6 +88,7 @@ namespace Framework
 			glBindBuffer(GL_UNIFORM_BUFFER, bufferObject);
 			glBufferData(GL_UNIFORM_BUFFER, m_storage.size(), &m_storage[0], GL_STATIC_DRAW);
 			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			CountBufferUpload(m_storage.size());
 
 			return bufferObject;
 		}
@@ -2,41 +2,339 @@
 #include <algorithm>
 #include <string>
 #include <vector>
+#include <memory>
 #include <fstream>
 #include <sstream>
 #include <exception>
 #include <stdexcept>
 #include <string.h>
+#include <stdlib.h>
 #include <glload/gl_3_3.h>
 #include <glload/gll.hpp>
 #include <glutil/Shader.h>
 #include <GL/freeglut.h>
 #include "framework.h"
+#include "StateCache.h"
+#include "FrameStats.h"
+#include "Profiler.h"
+#include "Headless.h"
+#include "Clock.h"
+#include "InputLog.h"
+#include "FramePacer.h"
+#include "ResourceFS.h"
+#include "ShaderCache.h"
+#include "PerfReport.h"
 #include "directories.h"
 
 #ifdef LOAD_X11
 #define APIENTRY
 #endif
 
+void init();
+void display();
+void reshape(int w, int h);
+void keyboard(unsigned char key, int x, int y);
+
+unsigned int defaults(unsigned int displayMode, int &width, int &height);
+
 namespace Framework
 {
-	GLuint LoadShader(GLenum eShaderType, const std::string &strShaderFilename)
+	namespace
 	{
-		std::string strFilename = FindFileOrThrow(strShaderFilename);
-		std::ifstream shaderFile(strFilename.c_str());
-		std::stringstream shaderData;
-		shaderData << shaderFile.rdbuf();
-		shaderFile.close();
+		const int g_defaultHeadlessFrames = 100;
 
-		try
+		bool g_isHeadless = false;
+		bool g_isLeavingMainLoop = false;
+
+		typedef void (*MouseFunc)(int button, int state, int x, int y);
+		typedef void (*MotionFunc)(int x, int y);
+		typedef void (*MouseWheelFunc)(int wheel, int direction, int x, int y);
+
+		MouseFunc g_pMouseFunc = NULL;
+		MotionFunc g_pMotionFunc = NULL;
+		MouseWheelFunc g_pMouseWheelFunc = NULL;
+
+		//Input is recorded and replayed against this; it counts display() calls.
+		unsigned int g_frameIx = 0;
+
+		InputLogWriter *g_pInputRecorder = NULL;
+
+		//While replaying, live input is ignored.
+		std::vector<InputEvent> g_replayEvents;
+		size_t g_nextReplayIx = 0;
+		bool g_isReplaying = false;
+		bool g_isDispatchingReplay = false;
+		int g_replayModifiers = 0;
+
+		//Returns 0 if the program should open a window.
+		int GetHeadlessFrameCount(int argc, char **argv)
 		{
-			return glutil::CompileShader(eShaderType, shaderData.str());
+			const char *frameCountStr = NULL;
+			bool isHeadless = false;
+			for(int argIx = 1; argIx < argc; ++argIx)
+			{
+				if(strcmp(argv[argIx], "--headless") == 0)
+					isHeadless = true;
+				else if(strncmp(argv[argIx], "--headless=", 11) == 0)
+				{
+					isHeadless = true;
+					frameCountStr = argv[argIx] + 11;
+				}
+			}
+
+			if(!isHeadless)
+			{
+				frameCountStr = getenv("GLTUT_HEADLESS");
+				isHeadless = frameCountStr && frameCountStr[0];
+			}
+
+			if(!isHeadless)
+				return 0;
+
+			int numFrames = frameCountStr ? atoi(frameCountStr) : 0;
+			return numFrames > 0 ? numFrames : g_defaultHeadlessFrames;
 		}
-		catch(std::exception &e)
+
+		//Replayed input only reproduces a run if time is replayed too, so replaying
+		//implies the fixed-step clock.
+		void SetupClock()
 		{
-			fprintf(stderr, "%s\n", e.what());
-			throw;
+			static FixedStepClock fixedStepClock;
+
+			const char *stepStr = getenv("GLTUT_FIXED_STEP");
+			if(!stepStr && !g_isHeadless && !g_isReplaying)
+				return;
+
+			double secPerFrame = stepStr ? atof(stepStr) : 1.0 / 60.0;
+			if(secPerFrame > 0.0)
+			{
+				fixedStepClock = FixedStepClock(secPerFrame);
+				SetClock(&fixedStepClock);
+			}
+		}
+
+		void SetupInputLog()
+		{
+			if(const char *replayFilename = getenv("GLTUT_REPLAY_INPUT"))
+			{
+				g_replayEvents = ReadInputLog(replayFilename);
+				g_nextReplayIx = 0;
+				g_isReplaying = !g_replayEvents.empty();
+			}
+
+			if(const char *recordFilename = getenv("GLTUT_RECORD_INPUT"))
+				g_pInputRecorder = new InputLogWriter(recordFilename);
+		}
+
+		void MountArchives()
+		{
+			const char *archivesStr = getenv("GLTUT_ARCHIVES");
+			if(!archivesStr)
+				return;
+
+			std::string archives(archivesStr);
+			size_t startIx = 0;
+			while(startIx <= archives.size())
+			{
+				size_t endIx = archives.find(';', startIx);
+				if(endIx == std::string::npos)
+					endIx = archives.size();
+
+				if(endIx != startIx)
+					MountArchive(archives.substr(startIx, endIx - startIx));
+
+				startIx = endIx + 1;
+			}
+		}
+
+		void RecordInput(InputEventType type, int code, int state, int x, int y, int modifiers)
+		{
+			if(!g_pInputRecorder)
+				return;
+
+			InputEvent event;
+			event.frameIx = g_frameIx;
+			event.type = type;
+			event.code = code;
+			event.state = state;
+			event.x = x;
+			event.y = y;
+			event.modifiers = modifiers;
+			g_pInputRecorder->Write(event);
+		}
+
+		void KeyboardInput(unsigned char key, int x, int y)
+		{
+			if(g_isReplaying)
+				return;
+
+			RecordInput(INPUT_KEYBOARD, key, 0, x, y, glutGetModifiers());
+			keyboard(key, x, y);
+		}
+
+		void MouseInput(int button, int state, int x, int y)
+		{
+			if(g_isReplaying)
+				return;
+
+			RecordInput(INPUT_MOUSE_BUTTON, button, state, x, y, glutGetModifiers());
+			if(g_pMouseFunc)
+				g_pMouseFunc(button, state, x, y);
+		}
+
+		void MotionInput(int x, int y)
+		{
+			if(g_isReplaying)
+				return;
+
+			//GLUT does not report modifiers for motion.
+			RecordInput(INPUT_MOUSE_MOTION, 0, 0, x, y, 0);
+			if(g_pMotionFunc)
+				g_pMotionFunc(x, y);
+		}
+
+		void MouseWheelInput(int wheel, int direction, int x, int y)
+		{
+			if(g_isReplaying)
+				return;
+
+			RecordInput(INPUT_MOUSE_WHEEL, wheel, direction, x, y, glutGetModifiers());
+			if(g_pMouseWheelFunc)
+				g_pMouseWheelFunc(wheel, direction, x, y);
+		}
+
+		void DispatchReplayedInput(const InputEvent &event)
+		{
+			g_isDispatchingReplay = true;
+			g_replayModifiers = event.modifiers;
+
+			switch(event.type)
+			{
+			case INPUT_KEYBOARD:
+				keyboard((unsigned char)event.code, event.x, event.y);
+				break;
+			case INPUT_MOUSE_BUTTON:
+				if(g_pMouseFunc)
+					g_pMouseFunc(event.code, event.state, event.x, event.y);
+				break;
+			case INPUT_MOUSE_MOTION:
+				if(g_pMotionFunc)
+					g_pMotionFunc(event.x, event.y);
+				break;
+			case INPUT_MOUSE_WHEEL:
+				if(g_pMouseWheelFunc)
+					g_pMouseWheelFunc(event.code, event.state, event.x, event.y);
+				break;
+			}
+
+			g_isDispatchingReplay = false;
+		}
+
+		//Called before every display().
+		void ReplayInput()
+		{
+			if(!g_isReplaying)
+				return;
+
+			while(g_nextReplayIx < g_replayEvents.size() &&
+				g_replayEvents[g_nextReplayIx].frameIx <= g_frameIx)
+			{
+				DispatchReplayedInput(g_replayEvents[g_nextReplayIx]);
+				++g_nextReplayIx;
+			}
+
+			//Once the log runs out, live input takes over.
+			if(g_nextReplayIx == g_replayEvents.size())
+				g_isReplaying = false;
+		}
+	}
+
+	bool IsHeadless()
+	{
+		return g_isHeadless;
+	}
+
+	void SwapBuffers()
+	{
+		if(g_isHeadless)
+			glFlush();
+		else
+			glutSwapBuffers();
+	}
+
+	void PostRedisplay()
+	{
+		//Headless mode renders frames back to back anyway.
+		if(!g_isHeadless)
+			glutPostRedisplay();
+	}
+
+	void LeaveMainLoop()
+	{
+		if(g_isHeadless)
+			g_isLeavingMainLoop = true;
+		else
+			glutLeaveMainLoop();
+	}
+
+	void SetMouseFunc(void (*func)(int button, int state, int x, int y))
+	{
+		g_pMouseFunc = func;
+		if(!g_isHeadless)
+			glutMouseFunc(MouseInput);
+	}
+
+	void SetMotionFunc(void (*func)(int x, int y))
+	{
+		g_pMotionFunc = func;
+		if(!g_isHeadless)
+			glutMotionFunc(MotionInput);
+	}
+
+	void SetMouseWheelFunc(void (*func)(int wheel, int direction, int x, int y))
+	{
+		g_pMouseWheelFunc = func;
+		if(!g_isHeadless)
+			glutMouseWheelFunc(MouseWheelInput);
+	}
+
+	int GetModifiers()
+	{
+		if(g_isDispatchingReplay)
+			return g_replayModifiers;
+
+		//Without GLUT, the only input there is comes from replays.
+		if(g_isHeadless)
+			return 0;
+
+		return glutGetModifiers();
+	}
+
+	void *GetGLProcAddress( const char *funcName )
+	{
+		if(g_isHeadless)
+			return GetHeadlessProcAddress(funcName);
+
+		return (void *)glutGetProcAddress(funcName);
+	}
+
+	bool HasGLExtension(const char *extName)
+	{
+		GLint numExtensions = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+		for(GLint extIx = 0; extIx < numExtensions; ++extIx)
+		{
+			const char *currExt = (const char *)glGetStringi(GL_EXTENSIONS, extIx);
+			if(currExt && strcmp(currExt, extName) == 0)
+				return true;
 		}
+
+		return false;
+	}
+
+	GLuint LoadShader(GLenum eShaderType, const std::string &strShaderFilename)
+	{
+		return LoadShader(eShaderType, strShaderFilename, ShaderDefines());
 	}
 
 	GLuint CreateProgram(const std::vector<GLuint> &shaderList)
@@ -44,12 +342,12 @@ namespace Framework
 		try
 		{
 			GLuint prog = glutil::LinkProgram(shaderList);
-			std::for_each(shaderList.begin(), shaderList.end(), glDeleteShader);
+			std::for_each(shaderList.begin(), shaderList.end(), ReleaseShader);
 			return prog;
 		}
 		catch(std::exception &e)
 		{
-			std::for_each(shaderList.begin(), shaderList.end(), glDeleteShader);
+			std::for_each(shaderList.begin(), shaderList.end(), ReleaseShader);
 			fprintf(stderr, "%s\n", e.what());
 			throw;
 		}
@@ -63,28 +361,41 @@ namespace Framework
 
 	std::string FindFileOrThrow( const std::string &strBasename )
 	{
-		std::string strFilename = LOCAL_FILE_DIR + strBasename;
-		std::ifstream testFile(strFilename.c_str());
-		if(testFile.is_open())
+		std::string strFilename = GetResourceFilePath(strBasename);
+		if(!strFilename.empty())
 			return strFilename;
 
-		
-		strFilename = GLOBAL_FILE_DIR + strBasename;
-		testFile.open(strFilename.c_str());
-		if(testFile.is_open())
-			return strFilename;
+		if(ResourceExists(strBasename))
+			throw std::runtime_error("The file " + strBasename + " is only available from an archive.");
 
 		throw std::runtime_error("Could not find the file " + strBasename);
 	}
 }
 
 
-void init();
-void display();
-void reshape(int w, int h);
-void keyboard(unsigned char key, int x, int y);
+//Wraps the tutorial's display() so that per-frame bookkeeping happens in one place.
+void DisplayFrame()
+{
+	Framework::ReplayInput();
 
-unsigned int defaults(unsigned int displayMode, int &width, int &height);
+	{
+		Framework::ProfileScope frameScope("Frame");
+		Framework::BeginPerfFrame();
+		display();
+		Framework::EndPerfFrame();
+	}
+
+	Framework::EndFrameStats();
+	Framework::EndStateCacheFrame();
+	Framework::EndProfileFrame();
+	Framework::EndFramePacing();
+	Framework::GetClock().EndFrame();
+	++Framework::g_frameIx;
+
+	//Replays must not wait for the window system to ask for frames.
+	if(Framework::g_isReplaying)
+		Framework::PostRedisplay();
+}
 
 void APIENTRY DebugFunc(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
 			   const GLchar* message, GLvoid* userParam)
@@ -125,32 +436,62 @@ void APIENTRY DebugFunc(GLenum source, GLenum type, GLuint id, GLenum severity,
 
 int main(int argc, char** argv)
 {
-	glutInit(&argc, argv);
+	int numHeadlessFrames = Framework::GetHeadlessFrameCount(argc, argv);
+	Framework::g_isHeadless = numHeadlessFrames > 0;
+
+	if(!Framework::g_isHeadless)
+		glutInit(&argc, argv);
 
 	int width = 500;
 	int height = 500;
 	unsigned int displayMode = GLUT_DOUBLE | GLUT_ALPHA | GLUT_DEPTH | GLUT_STENCIL;
 	displayMode = defaults(displayMode, width, height);
 
-	glutInitDisplayMode (displayMode);
-	glutInitContextVersion (3, 3);
-	glutInitContextProfile(GLUT_CORE_PROFILE);
+	//Lets the performance runner use the same size for every tutorial.
+	if(const char *sizeStr = getenv("GLTUT_WINDOW_SIZE"))
+		sscanf(sizeStr, "%dx%d", &width, &height);
+
+	int window = 0;
+	if(Framework::g_isHeadless)
+	{
+		try
+		{
+			Framework::CreateHeadlessContext(width, height, displayMode);
+		}
+		catch(std::exception &e)
+		{
+			fprintf(stderr, "%s\n", e.what());
+			Framework::DestroyHeadlessContext();
+			return 1;
+		}
+	}
+	else
+	{
+		glutInitDisplayMode (displayMode);
+		glutInitContextVersion (3, 3);
+		glutInitContextProfile(GLUT_CORE_PROFILE);
 #ifdef DEBUG
-	glutInitContextFlags(GLUT_DEBUG);
+		glutInitContextFlags(GLUT_DEBUG);
 #endif
-	glutInitWindowSize (width, height); 
-	glutInitWindowPosition (300, 200);
-	int window = glutCreateWindow (argv[0]);
+		glutInitWindowSize (width, height); 
+		glutInitWindowPosition (300, 200);
+		window = glutCreateWindow (argv[0]);
+
+		glload::LoadFunctions();
 
-	glload::LoadFunctions();
+		glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_CONTINUE_EXECUTION);
+	}
 
-	glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_CONTINUE_EXECUTION);
+	Framework::InitProfiler();
 
 	if(!glload::IsVersionGEQ(3, 3))
 	{
 		printf("Your OpenGL version is %i, %i. You must have at least OpenGL 3.3 to run this tutorial.\n",
 			glload::GetMajorVersion(), glload::GetMinorVersion());
-		glutDestroyWindow(window);
+		if(Framework::g_isHeadless)
+			Framework::DestroyHeadlessContext();
+		else
+			glutDestroyWindow(window);
 		return 0;
 	}
 
@@ -160,11 +501,75 @@ int main(int argc, char** argv)
 		glDebugMessageCallbackARB(DebugFunc, (void*)15);
 	}
 
+	Framework::SetupInputLog();
+	Framework::SetupClock();
+	Framework::MountArchives();
+
+	if(const char *statsFilename = getenv("GLTUT_STATS_CSV"))
+		Framework::SetFrameStatsCSV(statsFilename);
+
+	if(const char *traceFilename = getenv("GLTUT_PROFILE_TRACE"))
+		Framework::StartProfileTrace(traceFilename);
+
+	if(const char *fpsStr = getenv("GLTUT_TARGET_FPS"))
+		Framework::SetTargetFrameRate(atof(fpsStr));
+
+	if(const char *intervalStr = getenv("GLTUT_SWAP_INTERVAL"))
+	{
+		if(!Framework::SetSwapInterval(atoi(intervalStr)))
+			printf("Could not set the swap interval.\n");
+	}
+
+	if(const char *framesStr = getenv("GLTUT_MAX_FRAMES_IN_FLIGHT"))
+		Framework::SetMaxFramesInFlight(atoi(framesStr));
+
+	if(const char *reportFilename = getenv("GLTUT_PERF_REPORT"))
+	{
+		const char *warmupStr = getenv("GLTUT_PERF_WARMUP");
+		if(Framework::g_isHeadless)
+			Framework::StartPerfReport(reportFilename, warmupStr ? atoi(warmupStr) : 5);
+	}
+
 	init();
 
-	glutDisplayFunc(display); 
+	if(getenv("GLTUT_SHADER_STATS"))
+	{
+		Framework::ShaderCacheStats shaderStats = Framework::GetShaderCacheStats();
+		printf("Shaders: %d loaded, %d compiled, %d compiles saved.\n", shaderStats.numLoads,
+			shaderStats.numCompiles, shaderStats.numLoads - shaderStats.numCompiles);
+	}
+
+	if(Framework::g_isHeadless)
+	{
+		//GLUT would call reshape() when the window first appears.
+		reshape(width, height);
+		for(int frameIx = 0; frameIx < numHeadlessFrames && !Framework::g_isLeavingMainLoop; ++frameIx)
+			DisplayFrame();
+
+		glFinish();
+		Framework::StopProfileTrace();
+		Framework::ClearShaderCache();
+
+		int exitCode = 0;
+		try
+		{
+			Framework::WritePerfReport(width, height);
+		}
+		catch(std::exception &e)
+		{
+			fprintf(stderr, "%s\n", e.what());
+			exitCode = 1;
+		}
+
+		Framework::DestroyHeadlessContext();
+		return exitCode;
+	}
+
+	glutDisplayFunc(DisplayFrame); 
 	glutReshapeFunc(reshape);
-	glutKeyboardFunc(keyboard);
+	glutKeyboardFunc(Framework::KeyboardInput);
 	glutMainLoop();
+
+	Framework::StopProfileTrace();
 	return 0;
 }
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <map>
 
 #define ARRAY_COUNT( array ) (sizeof( array ) / (sizeof( array[0] ) * (sizeof( array ) != sizeof(void*) || sizeof( array[0] ) <= sizeof(void*))))
 
@@ -14,13 +15,53 @@ namespace Framework
 		const std::string &strShaderFile, const std::string &strShaderName);
 	GLuint LoadShader(GLenum eShaderType, const std::string &strShaderFilename);
 
-	//Will *delete* the shaders given.
+	//Maps macro names to their values, which may be empty.
+	typedef std::map<std::string, std::string> ShaderDefines;
+
+	//Resolves #include "file" directives and defines the given macros right after the #version
+	//line. Shaders that come out identical are compiled once and share a shader object, which
+	//stays alive until the end of the frame; release it with ReleaseShader, not glDeleteShader.
+	GLuint LoadShader(GLenum eShaderType, const std::string &strShaderFilename,
+		const ShaderDefines &defines);
+
+	//Deletes the shader, unless it belongs to LoadShader's cache.
+	void ReleaseShader(GLuint shader);
+
+	//Will *release* the shaders given.
 	GLuint CreateProgram(const std::vector<GLuint> &shaderList);
 
 	//Will find a file with the given base filename, either in the local directory or the global one.
 	//If it doesn't, it will throw a std::runtime_error.
 	std::string FindFileOrThrow(const std::string &strBasename);
 
+	//Headless mode is selected with the --headless[=frames] command-line option, or the
+	//GLTUT_HEADLESS=frames environment variable. There is no window; the tutorial renders
+	//the given number of frames (100 by default) into an offscreen framebuffer and exits.
+	//GLTUT_WINDOW_SIZE=WxH overrides the size the tutorial asks for, in either mode.
+	bool IsHeadless();
+
+	//Use these instead of their GLUT equivalents, which cannot be called in headless mode.
+	void SwapBuffers();
+	void PostRedisplay();
+	void LeaveMainLoop();
+	void SetMouseFunc(void (*func)(int button, int state, int x, int y));
+	void SetMotionFunc(void (*func)(int x, int y));
+	void SetMouseWheelFunc(void (*func)(int wheel, int direction, int x, int y));
+
+	//Setting GLTUT_RECORD_INPUT=file records every keyboard and mouse callback, with the
+	//frame it arrived in, to a binary log. GLTUT_REPLAY_INPUT=file plays such a log back
+	//on the same frames, ignoring live input until it runs out, and uses the fixed-step
+	//clock (see Clock.h), so that a replayed run renders the same frames every time.
+
+	//Use instead of glutGetModifiers, so that replayed input has the recorded modifiers.
+	int GetModifiers();
+
+	//Use instead of glutGetProcAddress.
+	void *GetGLProcAddress(const char *funcName);
+
+	//For extensions that glload does not know about.
+	bool HasGLExtension(const char *extName);
+
 
 }
 
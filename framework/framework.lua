@@ -77,7 +77,7 @@ function SetupProject(projName, ...)
 			links {"glu32", "opengl32", "gdi32", "winmm", "user32"}
 
 	    configuration "linux"
-	        links {"GL", "GLU"}
+	        links {"GL", "GLU", "EGL", "pthread"}
 
 end
 
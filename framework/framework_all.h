@@ -7,7 +7,17 @@
 #include "MousePole.h"
 #include "Scene.h"
 #include "SceneBinders.h"
+#include "Clock.h"
 #include "Timer.h"
+#include "InputLog.h"
+#include "StateCache.h"
+#include "FrameStats.h"
+#include "FramePacer.h"
+#include "Profiler.h"
+#include "ResourceFS.h"
+#include "ShaderCache.h"
+#include "ProgramBatch.h"
+#include "PerfReport.h"
 #include "UniformBlockArray.h"
 #include "Interpolators.h"
 
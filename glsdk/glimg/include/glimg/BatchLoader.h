@@ -0,0 +1,71 @@
+/** Copyright (C) 2011 by Jason L. McKesson **/
+/** This file is licensed by the MIT License. **/
+
+
+
+#ifndef GLIMG_BATCH_LOADER_H
+#define GLIMG_BATCH_LOADER_H
+
+#include <string>
+#include <vector>
+#include <exception>
+#include "ImageSet.h"
+
+/**
+\file
+
+\brief Has the function that loads many image files at once, on several threads.
+**/
+
+namespace glimg
+{
+	namespace loaders
+	{
+		///\addtogroup module_glimg_exceptions
+		///@{
+
+		///Thrown by LoadBatch if one of its files could not be loaded.
+		class BatchLoadException : public std::exception
+		{
+		public:
+			BatchLoadException(const std::string &filename, const std::string &msg)
+			{
+				message = "The file \"" + filename + "\" could not be loaded.\n" + msg;
+			}
+
+			virtual ~BatchLoadException() throw() {}
+
+			virtual const char *what() const throw() {return message.c_str();}
+
+		protected:
+			std::string message;
+		};
+		///@}
+
+		/**
+		\brief Loads a list of image files, decoding several of them at the same time.
+
+		Files with the <tt>.dds</tt> extension, in any case, are loaded with dds::LoadFromFile. All
+		others are loaded with stb::LoadFromFile. Each file is decoded whole by one thread; the
+		threads take the next file in the list as they finish one, so with many files, every
+		core is kept busy.
+
+		\ingroup module_glimg_loaders
+
+		\param filenames The files to load.
+		\param ddsFlags A bitfield containing values from dds::DdsLoaderFlags, used for every DDS file.
+		\param numThreads The number of threads to work on, including the caller. 0 uses a pool
+		shared by glimg, with a thread for each hardware thread. If the shared pool is busy
+		with another call, this one runs on the calling thread alone.
+
+		\return The loaded ImageSets, in the same order as \a filenames. The caller owns them.
+
+		\throw BatchLoadException If any file could not be loaded. It describes the first such file
+		in the list. None of the ImageSets are returned.
+		**/
+		std::vector<ImageSet *> LoadBatch(const std::vector<std::string> &filenames,
+			unsigned int ddsFlags = 0, int numThreads = 0);
+	}
+}
+
+#endif //GLIMG_BATCH_LOADER_H
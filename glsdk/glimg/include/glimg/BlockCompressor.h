@@ -0,0 +1,101 @@
+/** Copyright (C) 2011 by Jason L. McKesson **/
+/** This file is licensed by the MIT License. **/
+
+
+
+#ifndef GLIMG_BLOCK_COMPRESSOR_H
+#define GLIMG_BLOCK_COMPRESSOR_H
+
+#include <string>
+#include <exception>
+#include "ImageSet.h"
+
+/**
+\file
+
+\brief Include this to \ref module_glimg_creation "block-compress images" on the CPU.
+**/
+
+namespace glimg
+{
+	///\addtogroup module_glimg_exceptions
+	///@{
+
+	///Base class for all exceptions thrown by the block compressor.
+	class CompressionException : public std::exception
+	{
+	public:
+	    virtual ~CompressionException() throw() {}
+
+		virtual const char *what() const throw() {return message.c_str();}
+
+	protected:
+		std::string message;
+	};
+
+	///Thrown if an image cannot be compressed to the requested format.
+	class CompressionUnsupportedException : public CompressionException
+	{
+	public:
+		explicit CompressionUnsupportedException(const std::string &msg)
+		{
+			message = "Cannot compress this image.\n" + msg;
+		}
+	};
+	///@}
+
+	///\addtogroup module_glimg_creation
+	///@{
+
+	///How much effort CompressImage spends searching for the best encoding of each block.
+	enum CompressionQuality
+	{
+		COMPRESSION_QUALITY_FAST,		///<Endpoints come from the bounding box of each block's colors. Several times faster than the others, but blocks with colors along more than one axis suffer.
+		COMPRESSION_QUALITY_NORMAL,		///<Endpoints come from the principal axis of each block's colors, then are refined once. Both BC1 color modes are tried.
+		COMPRESSION_QUALITY_HIGH,		///<As COMPRESSION_QUALITY_NORMAL, but refines the endpoints until they stop improving, then searches the neighboring endpoint values.
+	};
+
+	/**
+	\brief Retrieves the compressed type that suits images of the given format.
+
+	Red images get DT_COMPRESSED_UNSIGNED_BC4, RG images DT_COMPRESSED_UNSIGNED_BC5, RGB and RGBX
+	images DT_COMPRESSED_BC1, and RGBA images DT_COMPRESSED_BC3.
+
+	\throw CompressionUnsupportedException If CompressImage cannot compress images of this format.
+	**/
+	PixelDataType GetDefaultCompressedType(const ImageFormat &format);
+
+	///Returns true if CompressImage can compress the given image to its GetDefaultCompressedType.
+	bool CanCompressImage(const ImageSet &imageSet);
+
+	/**
+	\brief Creates a new ImageSet containing the block-compressed form of the given one.
+
+	Every mipmap level, array layer and cubemap face is compressed. sRGB images stay sRGB; their
+	stored values are compressed as they are. BC1 images that have alpha get 1-bit alpha: texels
+	with an alpha below one half become transparent black.
+
+	The work is split across threads by blocks and by mipmap levels.
+
+	\param imageSet The image to compress. Must be 2D (arrays and cubemaps are fine), and made of
+	normalized unsigned integers of 8 or 16 bits per component, or of BD_PACKED_32_BIT_8888 and
+	its _REV form.
+	\param compressedType The type to compress to. DT_COMPRESSED_BC1 and DT_COMPRESSED_BC3 take RGB,
+	RGBX or RGBA images; DT_COMPRESSED_UNSIGNED_BC4 takes red images and DT_COMPRESSED_UNSIGNED_BC5
+	takes RG images.
+	\param quality How hard to search for a good encoding.
+	\param numThreads The number of threads to work on, including the caller. 0 uses a pool
+	shared by glimg, with a thread for each hardware thread. If the shared pool is busy
+	with another call, this one runs on the calling thread alone.
+
+	\return The compressed ImageSet. The caller owns it.
+
+	\throw CompressionUnsupportedException If the image cannot be compressed to the requested type.
+	**/
+	ImageSet *CompressImage(const ImageSet &imageSet, PixelDataType compressedType,
+		CompressionQuality quality = COMPRESSION_QUALITY_NORMAL, int numThreads = 0);
+
+	///@}
+}
+
+#endif //GLIMG_BLOCK_COMPRESSOR_H
@@ -83,26 +83,46 @@ namespace glimg
 			};
 			///@}
 
+			///Flags that change how a DDS file's images are loaded.
+			enum DdsLoaderFlags
+			{
+				KEEP_TOP_LEFT_ORIGIN	= 0x0001,	///<Keep the images top-down, as DDS stores them, rather than flipping them to OpenGL's bottom-left origin. Texture coordinates must be flipped to match.
+			};
+
 			/**
 			\brief Loads a DDS file from the disk, given an ASCII filename.
 
 			DDS is a good texture format, because it naturally fits the needs of textures. It
 			supports features like mipmaps and arrays that other image formats do not.
 
+			Files with the DX10 extended header are supported, including array and cubemap array
+			textures and BC6H/BC7 compressed formats. DXGI formats are loaded as their nearest
+			ImageFormat; typeless formats and formats glimg has no equivalent for are not supported.
+			DXGI_FORMAT_D24_UNORM_S8_UINT is one of these: it stores depth in the low 24 bits, the
+			reverse of BD_PACKED_32_BIT_248.
+
+			BC6H and BC7 blocks cannot be flipped, so those images always keep the top-left origin,
+			as if loaded with KEEP_TOP_LEFT_ORIGIN. Their texture coordinates must be flipped.
+
+			The file is memory mapped rather than read into a buffer. With KEEP_TOP_LEFT_ORIGIN, the
+			ImageSet can use the mapped image data without copying it, when each mipmap level's images
+			are stored together in the file (the file has one mipmap level, or one image per level)
+			and uncompressed rows need no padding. The mapping is then released with the ImageSet, and
+			the file must not be truncated until it is.
+
+			\param filename The file to load.
+			\param flags A bitfield containing values from DdsLoaderFlags.
+
 			\throws DdsLoaderException The image could not be loaded.  There are derived classes from this type that could be thrown.
 			\return An ImageSet that represents the loaded image data.
 
-			\todo Flip the textures, or allow the user to decide not to.
 			\todo Get 3D textures working.
 			\todo Get cubemap textures working. With mipmaps.
-			\todo Implement the D3D10 format.
-			\todo Get array textures working. With mipmaps.
-			\todo Get cubemap array textures working.
 			**/
-			ImageSet *LoadFromFile(const std::string &filename);
+			ImageSet *LoadFromFile(const std::string &filename, unsigned int flags = 0);
 
 			///As LoadFromFile, but from an already loaded buffer. The buffer pointer may be deleted after this call.
-			ImageSet *LoadFromMemory(const unsigned char *buffer, size_t bufSize);
+			ImageSet *LoadFromMemory(const unsigned char *buffer, size_t bufSize, unsigned int flags = 0);
 		}
 	}
 }
@@ -0,0 +1,104 @@
+/** Copyright (C) 2011 by Jason L. McKesson **/
+/** This file is licensed by the MIT License. **/
+
+
+
+#ifndef GLIMG_DIRECT_DRAW_SURFACE_WRITER_H
+#define GLIMG_DIRECT_DRAW_SURFACE_WRITER_H
+
+#include <string>
+#include <vector>
+#include <exception>
+#include "ImageSet.h"
+
+/**
+\file
+\brief Has the DDS writing functions.
+
+**/
+
+namespace glimg
+{
+	namespace writers
+	{
+		/**
+		\brief Contains the DDS writer functions and exceptions
+
+		\ingroup module_glimg_writers
+		**/
+		namespace dds
+		{
+			///\addtogroup module_glimg_exceptions
+			///@{
+
+			///Base class for all exceptions thrown by the DDS writers.
+			class DdsWriterException : public std::exception
+			{
+			public:
+
+			    virtual ~DdsWriterException() throw() {}
+
+				virtual const char *what() const throw() {return message.c_str();}
+
+			protected:
+				std::string message;
+			};
+
+			///Thrown if the DDS file could not be created or written to.
+			class DdsFileNotWritableException : public DdsWriterException
+			{
+			public:
+				explicit DdsFileNotWritableException(const std::string &filename)
+				{
+					message = "The file \"" + filename + "\" could not be written.";
+				}
+			};
+
+			///Thrown if the ImageSet's format or layout cannot be stored in the requested kind of DDS.
+			class DdsFormatUnsupportedException : public DdsWriterException
+			{
+			public:
+				explicit DdsFormatUnsupportedException(const std::string &msg)
+				{
+					message = "The image cannot be written as a DDS.\n" + msg;
+				}
+			};
+			///@}
+
+			///\addtogroup module_glimg_writers
+			///@{
+
+			///Flags that control which DDS header is written.
+			enum DdsWriterFlags
+			{
+				FORCE_DX10_HEADER		= 0x0001,	///<Always write the DX10 extended header, even if the image could be described without it.
+			};
+
+			/**
+			\brief Writes an ImageSet to a DDS file, with all of its mipmaps, array layers and faces.
+
+			The plain (DX9) DDS header is used when it can describe the image. Array textures,
+			1D textures, sRGB formats and formats that DX9 has no equivalent for are written with
+			the DX10 extended header instead.
+
+			Written files can be read back with loaders::dds::LoadFromFile, giving an ImageSet with the
+			same format, dimensions and image data. The one exception is DT_COMPRESSED_BC1 with alpha
+			written with the plain header, which comes back as RGB; DX9 files do not tell them apart.
+
+			\param pImage The image to write.
+			\param filename The file to write to. It will be replaced if it exists.
+			\param flags A bitfield containing values from DdsWriterFlags.
+
+			\throws DdsWriterException The image could not be written. There are derived classes from this type that could be thrown.
+			**/
+			void SaveToFile(const ImageSet *pImage, const std::string &filename, unsigned int flags = 0);
+
+			///As SaveToFile, but replaces the contents of \a ddsData with the file's contents.
+			void SaveToMemory(const ImageSet *pImage, std::vector<unsigned char> &ddsData, unsigned int flags = 0);
+
+			///@}
+		}
+	}
+}
+
+#endif //GLIMG_DIRECT_DRAW_SURFACE_WRITER_H
@@ -0,0 +1,113 @@
+/** Copyright (C) 2011 by Jason L. McKesson **/
+/** This file is licensed by the MIT License. **/
+
+
+
+#ifndef GLIMG_FORMAT_CONVERTER_H
+#define GLIMG_FORMAT_CONVERTER_H
+
+#include <string>
+#include <exception>
+#include "ImageSet.h"
+
+/**
+\file
+
+\brief Include this to \ref module_glimg_creation "convert images" between uncompressed formats on the CPU.
+**/
+
+namespace glimg
+{
+	///\addtogroup module_glimg_exceptions
+	///@{
+
+	///Base class for all exceptions thrown by the format converter.
+	class ConversionException : public std::exception
+	{
+	public:
+	    virtual ~ConversionException() throw() {}
+
+		virtual const char *what() const throw() {return message.c_str();}
+
+	protected:
+		std::string message;
+	};
+
+	///Thrown if an image cannot be converted to the requested format.
+	class ConversionUnsupportedException : public ConversionException
+	{
+	public:
+		explicit ConversionUnsupportedException(const std::string &msg)
+		{
+			message = "Cannot convert this image.\n" + msg;
+		}
+	};
+	///@}
+
+	///\addtogroup module_glimg_creation
+	///@{
+
+	/**
+	\brief Returns true if ConvertImage can convert images from one format to the other.
+
+	Both formats must be uncompressed color formats. Shared-exponent and BD_PACKED_32_BIT_101111_REV
+	formats cannot be converted. Both must be in the same colorspace, and either both or neither
+	must be integral.
+	**/
+	bool CanConvertFormat(const ImageFormat &srcFormat, const ImageFormat &dstFormat);
+
+	/**
+	\brief Retrieves the format that OpenGL implementations store the given format in.
+
+	Uploading an image in this format lets the driver copy it as it is, rather than convert every
+	texel. Three-component formats gain a fourth component: RGB becomes RGBX, keeping the order, type
+	and bitdepth. BD_PACKED_16_BIT_565 formats become RGBX with 8 bits per component. Every other
+	format, including compressed ones, is returned as it is.
+	**/
+	ImageFormat GetNativeFormat(const ImageFormat &format);
+
+	/**
+	\brief Retrieves the format that OpenGL requires to be color-renderable which holds the given format's data.
+
+	This is the GetNativeFormat of the format. It is what CreateTexture converts images to when
+	given FORCE_COLOR_RENDERABLE_FMT.
+
+	\throw ConversionUnsupportedException If no such format exists without changing the kind of
+	data: compressed, signed normalized, shared-exponent and depth formats.
+	**/
+	ImageFormat GetColorRenderableFormat(const ImageFormat &format);
+
+	/**
+	\brief Creates a new ImageSet containing the given one converted to another format.
+
+	Every mipmap level, array layer and cubemap face is converted. Components are matched by
+	meaning, so the order may change freely; components missing from the source become 0, or 1
+	for alpha. Normalized values keep their meaning across bitdepths, and are rounded to the
+	nearest representable value. Values outside what the destination can hold are clamped; for
+	half floats, finite values beyond 65504 become 65504, while infinities and NaNs are kept.
+	Integral values are converted as numbers, exactly, including 32-bit values beyond what a
+	float can hold. sRGB values are not linearized.
+
+	Reordering components of the same type and bitdepth, and adding a fourth component, copies
+	the components as they are; for 8-bit components, this is vectorized. Other integral
+	conversions go through doubles. The rest go through floats, and the encoding of
+	4-component half floats is vectorized as well.
+
+	The work is split across threads by rows.
+
+	\param imageSet The image to convert.
+	\param dstFormat The format to convert to. Its line alignment is used for the new image.
+	\param numThreads The number of threads to work on, including the caller. 0 uses a pool
+	shared by glimg, with a thread for each hardware thread. If the shared pool is busy
+	with another call, this one runs on the calling thread alone.
+
+	\return The converted ImageSet. The caller owns it.
+
+	\throw ConversionUnsupportedException If CanConvertFormat rejects the formats.
+	**/
+	ImageSet *ConvertImage(const ImageSet &imageSet, const ImageFormat &dstFormat, int numThreads = 0);
+
+	///@}
+}
+
+#endif //GLIMG_FORMAT_CONVERTER_H
@@ -26,6 +26,15 @@ namespace glimg
 	///A useful typedef for automatic memory management of image data.
 	typedef std::vector<unsigned char> ImageBuffer;
 
+	///One image's pixel data and where it goes, for ImageCreator::SetImageDataBatch.
+	struct ImageDataSource
+	{
+		const void *pixelData;	///<The pixel data for the image, formatted as for ImageCreator::SetImageData.
+		int mipmapLevel;		///<The mipmap layer of the image to set.
+		int arrayIx;			///<The array index of the image to set.
+		int faceIx;				///<The face index of the image to set.
+	};
+
 	/**
 	\brief A factory object for creating ImageSet objects.
 
@@ -69,6 +78,7 @@ namespace glimg
 		\brief Sets the data for a single image.
 
 		The pixel data from the given buffer will be copied into the given image in the ImageCreator.
+		Large images are copied using glimg's shared thread pool.
 
 		\param pixelData The pixel data for the mipmap. It is expected to be formatted exactly as specified
 		by the ImageFormat given to this ImageCreator at creation time.
@@ -85,6 +95,27 @@ namespace glimg
 		**/
 		void SetImageData(const void *pixelData, bool isTopLeft, int mipmapLevel, int arrayIx = 0, int faceIx = 0);
 
+		/**
+		\brief Sets the data for several images at once.
+
+		This does the same as calling SetImageData for each image, but the copying and flipping of
+		all of the images is spread across threads. Large images are split between threads as well.
+
+		\param pImages The images to set. There must be \a numImages of them.
+		\param numImages The number of images to set.
+		\param isTopLeft True if the orientation of the given image data is top-left. False if it is bottom-left.
+		\param numThreads The number of threads to work on, including the caller. 0 uses a pool
+		shared by glimg, with a thread for each hardware thread. If the shared pool is busy
+		with another call, this one runs on the calling thread alone.
+
+		\throw ImageSetAlreadyCreatedException If CreateImage has already been called for this ImageCreator.
+		\throw MipmapLayerOutOfBoundsException If any image's \a mipmapLevel is out of range. No image
+		data is set in that case; the same goes for the other exceptions.
+		\throw ArrayOutOfBoundsException If any image's \a arrayIx is out of range.
+		\throw FaceIndexOutOfBoundsException If any image's \a faceIx is out of range.
+		**/
+		void SetImageDataBatch(const ImageDataSource *pImages, int numImages, bool isTopLeft, int numThreads = 0);
+
 		/**
 		\brief Sets the data for an entire mipmap layer.
 		
@@ -131,8 +162,6 @@ namespace glimg
 		//Indexed by mipmap.
 		std::vector<ImageBuffer> m_imageData;
 		std::vector<size_t> m_imageSizes;
-
-		void CopyImageFlipped(const void *pixelData, unsigned char *pSrcData, int mipmapLevel);
 	};
 
 	///@}
@@ -178,6 +178,7 @@ namespace glimg
 		explicit ImageSet(detail::ImageSetImpl *pImpl);
 
 		friend class ImageCreator;
+		friend class detail::ImageSetImpl;
 		friend void CreateTexture(unsigned int textureName, const ImageSet *pImage, unsigned int forceConvertBits);
 
 		//Prevent copying.
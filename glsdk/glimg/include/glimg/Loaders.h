@@ -13,6 +13,7 @@
 
 #include "StbLoader.h"
 #include "DdsLoader.h"
+#include "BatchLoader.h"
 
 
 #endif //GLIMG_LOADERS_H
@@ -0,0 +1,67 @@
+/** Copyright (C) 2011 by Jason L. McKesson **/
+/** This file is licensed by the MIT License. **/
+
+
+
+#ifndef GLIMG_MAPPED_FILE_H
+#define GLIMG_MAPPED_FILE_H
+
+#include <string>
+
+/**
+\file
+
+\brief Has the read-only file mapping that the DDS loader reads files through.
+**/
+
+namespace glimg
+{
+	///\addtogroup module_glimg_loaders
+	///@{
+
+	/**
+	\brief A whole file, mapped read-only into memory.
+
+	The mapping lasts until the object is deleted. The file must not be truncated while it is mapped.
+	**/
+	class MappedFile
+	{
+	public:
+		/**
+		\brief Maps a file.
+
+		\param filename The file to map.
+		\param isSequential True if the contents will be read once, from front to back. The system
+		can then read further ahead, and drop pages sooner once they are read.
+
+		\return The mapping, which the caller owns. NULL if the file cannot be opened or mapped, or
+		if this platform cannot map files.
+		**/
+		static MappedFile *Open(const std::string &filename, bool isSequential = false);
+
+		~MappedFile();
+
+		///Returns the contents of the file. NULL if the file is empty.
+		const unsigned char *GetData() const {return m_pData;}
+
+		///Returns the size of the file in bytes.
+		size_t GetSize() const {return m_size;}
+
+	private:
+		MappedFile();
+
+		const unsigned char *m_pData;
+		size_t m_size;
+
+		//Windows needs its file and mapping handles kept until the view is unmapped.
+		void *m_hFile;
+		void *m_hMapping;
+
+		MappedFile(const MappedFile &);
+		MappedFile &operator=(const MappedFile &);
+	};
+
+	///@}
+}
+
+#endif //GLIMG_MAPPED_FILE_H
@@ -0,0 +1,97 @@
+/** Copyright (C) 2011 by Jason L. McKesson **/
+/** This file is licensed by the MIT License. **/
+
+
+
+#ifndef GLIMG_MIPMAP_GENERATOR_H
+#define GLIMG_MIPMAP_GENERATOR_H
+
+#include <string>
+#include <exception>
+#include "ImageSet.h"
+
+/**
+\file
+
+\brief Include this to \ref module_glimg_creation "build mipmap chains" on the CPU.
+**/
+
+namespace glimg
+{
+	///\addtogroup module_glimg_exceptions
+	///@{
+
+	///Base class for all exceptions thrown by GenerateMipmaps.
+	class MipmapGenerationException : public std::exception
+	{
+	public:
+	    virtual ~MipmapGenerationException() throw() {}
+
+		virtual const char *what() const throw() {return message.c_str();}
+
+	protected:
+		std::string message;
+	};
+
+	///Thrown if GenerateMipmaps is given an image whose format or layout it cannot filter.
+	class MipmapUnsupportedException : public MipmapGenerationException
+	{
+	public:
+		explicit MipmapUnsupportedException(const std::string &msg)
+		{
+			message = "Cannot generate mipmaps for this image.\n" + msg;
+		}
+	};
+	///@}
+
+	///\addtogroup module_glimg_creation
+	///@{
+
+	///The filters that GenerateMipmaps can use to shrink each mipmap into the next.
+	enum MipmapFilter
+	{
+		MIPMAP_FILTER_BOX,			///<Averages each 2x2 block of texels. The fastest, but the softest and most prone to aliasing.
+		MIPMAP_FILTER_KAISER,		///<A Kaiser-windowed sinc, 3 texels wide. Sharper than a box, with little ringing.
+		MIPMAP_FILTER_LANCZOS,		///<A Lanczos-windowed sinc, 3 texels wide. The sharpest, but may ring around hard edges.
+	};
+
+	///Flags that change how GenerateMipmaps treats the pixel data.
+	enum MipmapGenerationFlags
+	{
+		MIPMAP_FORCE_SRGB			= 0x0001,	///<The color components are sRGB, even if the format says otherwise. Images from the stb loader usually are. Only 8 and 16-bit normalized formats can be sRGB.
+		MIPMAP_FORCE_LINEAR			= 0x0002,	///<The components are filtered as they are stored, even if the format is sRGB.
+	};
+
+	/**
+	\brief Creates a new ImageSet with a full mipmap chain built from the base level of the given one.
+
+	Every array layer and cubemap face is given the same number of mipmaps, down to 1x1. Mipmaps after
+	the first in the given ImageSet are ignored. The new ImageSet has the same format as the given one.
+
+	Filtering happens in linear space with floating-point precision. sRGB color components are
+	decoded to linear first and encoded again afterwards; alpha is always linear. Each mipmap is
+	made from the unquantized previous one, so errors do not build up over the chain. Texels
+	past the edges of the image are clamped.
+
+	The work is split across threads by rows and by images. Uses SSE when the compiler targets it.
+
+	\param imageSet The image to build mipmaps for. Must be 1D or 2D, and uncompressed.
+	Supported formats are normalized unsigned integers of 8 or 16 bits per component
+	(including BD_PACKED_32_BIT_8888 and its _REV form) and 32-bit floats.
+	\param filter The filter to shrink each mipmap with.
+	\param flags A bitfield containing values from MipmapGenerationFlags.
+	\param numThreads The number of threads to work on, including the caller. 0 uses a pool
+	shared by glimg, with a thread for each hardware thread. If the shared pool is busy
+	with another call, this one runs on the calling thread alone.
+
+	\return An ImageSet with the full mipmap chain. The caller owns it.
+
+	\throw MipmapUnsupportedException If the image is compressed, 3D, or of an unsupported format.
+	**/
+	ImageSet *GenerateMipmaps(const ImageSet &imageSet, MipmapFilter filter = MIPMAP_FILTER_BOX,
+		unsigned int flags = 0, int numThreads = 0);
+
+	///@}
+}
+
+#endif //GLIMG_MIPMAP_GENERATOR_H
@@ -27,7 +27,6 @@ namespace glimg
 	texture data. The enumerators that end in "FMT" affect how the format is chosen, while
 	the ones ending in "TEX" affect the texture choice.
 	
-	\todo Finish implementing color renderable forcing.
 	\todo Implement the forcing of required formats.
 	**/
 	enum ForcedConvertFlags
@@ -40,13 +39,14 @@ namespace glimg
 //		FORCE_REQUIRED_FMT			= 0x0010,	///<Will only get image formats that are required to exist by OpenGL.
 		FORCE_INTEGRAL_FMT			= 0x0020,	///<Image formats that contain normalized integers will be uploaded as non-normalized integers. Ignored for floating-point or compressed formats.
 		FORCE_SIGNED_FMT			= 0x0040,	///<Image formats that contain unsigned integers will be uploaded as signed integers. Ignored if the format is not an integer/integral format, or if it isn't BC4 or BC5 compressed.
-		FORCE_COLOR_RENDERABLE_FMT	= 0x0080,	///<NOT YET SUPPORTED! Will force the use of formats that are required to be valid render targets. This will add components if necessary, but it will throw if conversion would require fundamentally changing the basic format (from signed to unsigned, compressed textures, etc).
+		FORCE_COLOR_RENDERABLE_FMT	= 0x0080,	///<Will force the use of formats that are required to be valid render targets. This will add components if necessary, but it will throw if conversion would require fundamentally changing the basic format (from signed to unsigned, compressed textures, etc). CreateTexture converts images to their GetColorRenderableFormat on the CPU before uploading; GetInternalFormat returns the renderable format, and GetUploadFormatType describes the image's own data.
 
-		FORCE_ARRAY_TEXTURE			= 0x0004,	///<NOT YET SUPPORTED! The texture will be an array texture even if the depth is not present. Ignored for formats that can't be arrays. Will throw if array textures of that type are not supported (ie: cubemap arrays, 2D arrays for lesser hardware, etc).
+		FORCE_ARRAY_TEXTURE			= 0x0004,	///<The texture will be an array texture even if the image has only one array image: 1D and 2D images become 1D and 2D array textures of one layer, and cubemaps become cubemap arrays. Ignored for 3D images, which can't be arrays. Will throw TextureUnsupportedException if array textures of that type are not supported (ie: cubemap arrays, 2D arrays for lesser hardware, etc).
 		USE_TEXTURE_STORAGE			= 0x0100,	///<If ARB_texture_storage or GL 4.2 is available, then texture storage functions will be used to create the textures. Otherwise regular glTex* functions will be used.
 		FORCE_TEXTURE_STORAGE		= 0x0200,	///<If ARB_texture_storage or GL 4.2 is available, then texture storage functions will be used to create the textures. Otherwise, an exception will be thrown.
 		USE_DSA						= 0x0400,	///<If EXT_direct_state_access is available, then DSA functions will be used to create the texture. Otherwise, regular ones will be used.
 		FORCE_DSA					= 0x0800,	///<If EXT_direct_state_access is available, then DSA functions will be used to create the texture. Otherwise, an exception will be thrown.
+		FORCE_BLOCK_COMPRESSED_FMT	= 0x1000,	///<Uncompressed images will be compressed on the CPU with CompressImage, to their GetDefaultCompressedType, before being uploaded. Ignored by GetInternalFormat and GetUploadFormatType, and for images that CanCompressImage rejects.
 	};
 
 	/**
@@ -195,6 +195,17 @@ glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, dims.width, dims.height,
 	\throws ... Everything that CreateTexture(const ImageSet *, unsigned int) throws.
 	**/
 	void CreateTexture(unsigned int textureName, const ImageSet *pImage, unsigned int forceConvertBits);
+
+	/**
+	\brief Retrieves the number of bytes of image data that CreateTexture has uploaded.
+
+	This is a running total over the life of the program. To measure the uploads done by
+	some stretch of code, take the difference between the values before and after it.
+	
+	Like CreateTexture, this is meant to be used from the OpenGL thread; the count is not
+	synchronized.
+	**/
+	size_t GetTextureUploadByteCount();
 	///@}
 }
 
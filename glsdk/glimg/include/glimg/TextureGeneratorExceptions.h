@@ -109,6 +109,28 @@ namespace glimg
 			message = "The current OpenGL implementation does not support EXT_direct_state_access";
 		}
 	};
+
+	///Thrown when creating a TextureUploadQueue if the OpenGL implementation cannot support one.
+	class UploadQueueUnsupportedException : public TextureGenerationException
+	{
+	public:
+		UploadQueueUnsupportedException()
+		{
+			message = "The current OpenGL implementation does not support GL 3.2 or above, or the "
+				"ARB_pixel_buffer_object, ARB_map_buffer_range and ARB_sync extensions.";
+		}
+	};
+
+	///Thrown by TextureUploadHandle::GetTexture when the image could not be loaded or uploaded.
+	class TextureUploadFailedException : public TextureGenerationException
+	{
+	public:
+		explicit TextureUploadFailedException(const std::string &msg)
+		{
+			message = "The texture could not be uploaded for this reason:\n";
+			message += msg;
+		}
+	};
 	///@}
 }
 
@@ -0,0 +1,175 @@
+/** Copyright (C) 2011 by Jason L. McKesson **/
+/** This file is licensed by the MIT License. **/
+
+
+
+#ifndef GLIMG_TEXTURE_UPLOAD_QUEUE_H
+#define GLIMG_TEXTURE_UPLOAD_QUEUE_H
+
+#include <string>
+#include "ImageSet.h"
+#include "TextureGeneratorExceptions.h"
+
+/**
+\file
+\brief Has the asynchronous texture upload queue.
+
+**/
+
+namespace glimg
+{
+	namespace detail
+	{
+		struct TextureUploadState;
+		struct TextureUploadQueueData;
+	}
+
+	///\addtogroup module_glimg_texture
+	///@{
+
+	/**
+	\brief A handle to a texture that a TextureUploadQueue is creating.
+
+	Handles are cheap to copy; all copies refer to the same upload. A handle only changes state
+	in TextureUploadQueue::Update and the other TextureUploadQueue functions, so like the queue,
+	it should only be used on the OpenGL thread.
+
+	Once the upload has finished, the texture belongs to the user. If every handle to an upload
+	is destroyed before it finishes, the queue deletes the texture itself.
+	**/
+	class TextureUploadHandle
+	{
+	public:
+		///Creates a handle that refers to no upload.
+		TextureUploadHandle();
+		TextureUploadHandle(const TextureUploadHandle &other);
+		TextureUploadHandle &operator=(const TextureUploadHandle &other);
+		~TextureUploadHandle();
+
+		///Returns true if this handle refers to an upload.
+		bool IsValid() const;
+
+		///Returns true once the upload has finished, whether it succeeded or failed.
+		bool IsReady() const;
+
+		///Returns true if the upload finished with an error.
+		bool HasFailed() const;
+
+		/**
+		\brief Retrieves the texture.
+
+		\return The texture object, which can be used as if CreateTexture had just returned it.
+		0 if the upload has not finished yet.
+
+		\throws TextureUploadFailedException The image could not be loaded, or CreateTexture
+		would have thrown for it. The message contains the original error.
+		**/
+		unsigned int GetTexture() const;
+
+		///Retrieves the texture type, as GetTextureType would return it. 0 if the upload has not finished yet.
+		unsigned int GetTextureType() const;
+
+	private:
+		detail::TextureUploadState *m_pState;
+
+		explicit TextureUploadHandle(detail::TextureUploadState *pState);
+
+		friend class TextureUploadQueue;
+	};
+
+	/**
+	\brief Creates textures without making the OpenGL thread wait for the pixel data to be copied.
+
+	CreateTexture gives OpenGL pointers to client memory, so the driver copies all of the pixel data
+	before the call returns. The upload queue instead copies it into pixel buffer objects on worker
+	threads. Each buffer in a ring is mapped, filled with the images of one or more uploads, then
+	unmapped and used as the source for the textures' uploads. A fence marks when OpenGL is done
+	with a buffer; the uploads that used it are finished at that point, and the buffer can be mapped
+	again.
+
+	Images that come from files are loaded on the worker threads as well. DDS files are flipped
+	straight from the file mapping into the buffer, so the pixel data is copied only once.
+
+	All functions must be called on the thread of the OpenGL context that the queue was created on.
+	Call Update regularly, once per frame for example, to move uploads along.
+
+	\note This class requires an active OpenGL context, and it requires that \ref module_glload "GLLoad"
+	has been initialized.
+	**/
+	class TextureUploadQueue
+	{
+	public:
+		/**
+		\brief Creates the buffers and worker threads.
+
+		\param bufferByteSize The size of each pixel buffer object. An upload whose images do not fit in
+		one buffer is done with CreateTexture on the OpenGL thread instead.
+		\param numBuffers The number of buffers in the ring. At least 2 lets one be filled while another is in use by OpenGL.
+		\param numThreads The number of worker threads. If 0, one per hardware thread.
+
+		\throws UploadQueueUnsupportedException The OpenGL implementation does not have pixel buffer objects,
+		buffer range mapping and sync objects.
+		**/
+		explicit TextureUploadQueue(size_t bufferByteSize = 16 * 1024 * 1024, int numBuffers = 3,
+			int numThreads = 0);
+
+		/**
+		\brief Stops the worker threads and deletes the buffers.
+
+		Uploads that have not finished will never finish; their handles report a failure, and
+		their textures are deleted.
+		**/
+		~TextureUploadQueue();
+
+		/**
+		\brief Queues an ImageSet for uploading.
+
+		\param pImage The image to upload. It must stay alive until the handle is ready.
+		\param forceConvertBits As for CreateTexture. FORCE_BLOCK_COMPRESSED_FMT compression and FORCE_COLOR_RENDERABLE_FMT conversion are done on a worker thread.
+
+		\return A handle to the upload. Errors that CreateTexture would throw are reported through it.
+		**/
+		TextureUploadHandle Enqueue(const ImageSet *pImage, unsigned int forceConvertBits);
+
+		/**
+		\brief Queues a DDS file for loading and uploading.
+
+		The file is loaded on a worker thread. Loading errors are reported through the handle.
+
+		\param filename The DDS file to load.
+		\param forceConvertBits As for CreateTexture.
+		**/
+		TextureUploadHandle EnqueueDdsFile(const std::string &filename, unsigned int forceConvertBits);
+
+		/**
+		\brief Moves the queued uploads along, without waiting for anything.
+
+		Collects the work that the worker threads have finished, issues the uploads of buffers that
+		have been filled, finishes the uploads whose fences have been signaled, and starts filling
+		buffers for the uploads that are waiting.
+
+		This changes the same OpenGL state as CreateTexture. It also changes the GL_PIXEL_UNPACK_BUFFER
+		binding, leaving 0 bound.
+		**/
+		void Update();
+
+		///Updates the queue until the given upload is ready, blocking as needed.
+		void Wait(const TextureUploadHandle &handle);
+
+		///Updates the queue until every upload is ready, blocking as needed.
+		void Finish();
+
+		///Returns the number of uploads that have not finished.
+		int GetPendingCount() const;
+
+	private:
+		detail::TextureUploadQueueData *m_pData;
+
+		TextureUploadQueue(const TextureUploadQueue &);
+		TextureUploadQueue &operator=(const TextureUploadQueue &);
+	};
+
+	///@}
+}
+
+#endif //GLIMG_TEXTURE_UPLOAD_QUEUE_H
@@ -0,0 +1,93 @@
+/** Copyright (C) 2011 by Jason L. McKesson **/
+/** This file is licensed by the MIT License. **/
+
+
+
+#ifndef GLIMG_THREAD_POOL_H
+#define GLIMG_THREAD_POOL_H
+
+/**
+\file
+
+\brief Has the \ref module_glimg_threads "thread pool" that glimg spreads its work across.
+**/
+
+namespace glimg
+{
+	namespace detail
+	{
+		struct ThreadPoolData;
+	}
+
+	///\addtogroup module_glimg_threads
+	///@{
+
+	/**
+	\brief A unit of work that can be split into independent items.
+
+	Execute will be called concurrently from several threads, each time with a different item index.
+	**/
+	class ParallelTask
+	{
+	public:
+		virtual ~ParallelTask() {}
+
+		///Does the work of one item. Must be safe to call at the same time as for any other item.
+		virtual void Execute(int itemIx) = 0;
+	};
+
+	/**
+	\brief A fixed set of worker threads.
+
+	They work on one ParallelFor at a time. A ParallelFor called while another is running, from
+	another thread or from inside an item, runs its items on the calling thread alone.
+	**/
+	class ThreadPool
+	{
+	public:
+		/**
+		\brief Starts the worker threads.
+
+		\param numThreads The number of threads that execute items, including the one that calls
+		ParallelFor. If 0, one per hardware thread.
+		**/
+		explicit ThreadPool(int numThreads = 0);
+
+		///Stops the worker threads. No ParallelFor may be running.
+		~ThreadPool();
+
+		///Returns the number of threads that execute items, including the caller.
+		int GetThreadCount() const;
+
+		/**
+		\brief Executes every item in [0, \a numItems) and returns once they have all finished.
+
+		The calling thread executes items too.
+
+		\throws std::runtime_error If any item threw. It has the first exception's message, and is
+		thrown after all items are done.
+		**/
+		void ParallelFor(ParallelTask &task, int numItems);
+
+	private:
+		detail::ThreadPoolData *m_pData;
+
+		ThreadPool(const ThreadPool &);
+		ThreadPool &operator=(const ThreadPool &);
+	};
+
+	///Returns the number of hardware threads on this machine. Always at least 1.
+	int GetHardwareThreadCount();
+
+	/**
+	\brief Returns the pool that glimg functions use when they are not given a thread count.
+
+	It has one thread per hardware thread, and is created on first use. Other code may use it as
+	well; while it is busy, other callers run their items on their own thread.
+	**/
+	ThreadPool &GetSharedThreadPool();
+
+	///@}
+}
+
+#endif //GLIMG_THREAD_POOL_H
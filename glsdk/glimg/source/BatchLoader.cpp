@@ -0,0 +1,117 @@
+//Copyright (C) 2011 by Jason L. McKesson
+//This file is licensed by the MIT License.
+
+
+
+#include <ctype.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include "glimg/ImageSet.h"
+#include "glimg/StbLoader.h"
+#include "glimg/DdsLoader.h"
+#include "glimg/BatchLoader.h"
+#include "glimg/ThreadPool.h"
+
+namespace glimg
+{
+	namespace
+	{
+		bool IsDdsFilename(const std::string &filename)
+		{
+			const char ddsExtension[] = ".dds";
+			const size_t extensionLen = sizeof(ddsExtension) - 1;
+			if(filename.size() < extensionLen)
+				return false;
+
+			for(size_t charIx = 0; charIx < extensionLen; ++charIx)
+			{
+				char fileChar = filename[filename.size() - extensionLen + charIx];
+				if(tolower((unsigned char)fileChar) != ddsExtension[charIx])
+					return false;
+			}
+
+			return true;
+		}
+
+		//Each item loads one file. Failures are kept rather than thrown, so that the first one
+		//in the list is reported, whichever thread saw it.
+		class LoadTask : public ParallelTask
+		{
+		public:
+			LoadTask(const std::vector<std::string> &filenames, unsigned int ddsFlags)
+				: m_filenames(filenames)
+				, m_ddsFlags(ddsFlags)
+				, m_imageSets(filenames.size(), NULL)
+				, m_errors(filenames.size())
+			{}
+
+			virtual ~LoadTask()
+			{
+				for(size_t fileIx = 0; fileIx < m_imageSets.size(); ++fileIx)
+					delete m_imageSets[fileIx];
+			}
+
+			virtual void Execute(int itemIx)
+			{
+				const std::string &filename = m_filenames[itemIx];
+				try
+				{
+					if(IsDdsFilename(filename))
+						m_imageSets[itemIx] = loaders::dds::LoadFromFile(filename, m_ddsFlags);
+					else
+						m_imageSets[itemIx] = loaders::stb::LoadFromFile(filename);
+				}
+				catch(std::exception &e)
+				{
+					m_errors[itemIx] = e.what();
+				}
+			}
+
+			int GetNumItems() const {return (int)m_filenames.size();}
+
+			//Throws for the first file that failed. Otherwise, hands over the ImageSets.
+			std::vector<ImageSet *> TakeImageSets()
+			{
+				for(size_t fileIx = 0; fileIx < m_imageSets.size(); ++fileIx)
+				{
+					if(!m_imageSets[fileIx])
+						throw loaders::BatchLoadException(m_filenames[fileIx], m_errors[fileIx]);
+				}
+
+				std::vector<ImageSet *> imageSets;
+				imageSets.swap(m_imageSets);
+				return imageSets;
+			}
+
+		private:
+			const std::vector<std::string> &m_filenames;
+			unsigned int m_ddsFlags;
+			std::vector<ImageSet *> m_imageSets;
+			std::vector<std::string> m_errors;
+		};
+	}
+
+	std::vector<ImageSet *> loaders::LoadBatch( const std::vector<std::string> &filenames,
+		unsigned int ddsFlags, int numThreads )
+	{
+		LoadTask task(filenames, ddsFlags);
+
+		if(numThreads == 1)
+		{
+			for(int itemIx = 0; itemIx < task.GetNumItems(); ++itemIx)
+				task.Execute(itemIx);
+		}
+		else
+		{
+			std::auto_ptr<ThreadPool> pOwnPool;
+			if(numThreads > 0)
+				pOwnPool.reset(new ThreadPool(numThreads));
+			ThreadPool &pool = pOwnPool.get() ? *pOwnPool : GetSharedThreadPool();
+
+			pool.ParallelFor(task, task.GetNumItems());
+		}
+
+		return task.TakeImageSets();
+	}
+}
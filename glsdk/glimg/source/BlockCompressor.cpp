@@ -0,0 +1,928 @@
+//Copyright (C) 2011 by Jason L. McKesson
+//This file is licensed by the MIT License.
+
+
+
+#include <string.h>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "glimg/ImageSet.h"
+#include "glimg/ImageCreator.h"
+#include "glimg/BlockCompressor.h"
+#include "Util.h"
+#include "glimg/ThreadPool.h"
+
+namespace glimg
+{
+	namespace
+	{
+		//Where the 8-bit red, green, blue and alpha of a texel come from.
+		struct SourceLayout
+		{
+			int texelByteSize;
+			int compByteSize;		//1 or 2. 16-bit components are rounded to 8 bits.
+			int numComponents;		//Red, RG, RGB or RGBA. RGBX images have 3.
+			int compOffsets[4];		//The byte offset of each component within a texel.
+		};
+
+		bool IsLittleEndian()
+		{
+			const unsigned int testValue = 1;
+			return *reinterpret_cast<const unsigned char *>(&testValue) == 1;
+		}
+
+		//Empty if the format can be compressed.
+		std::string GetUnsupportedReason(const ImageFormat &format)
+		{
+			if(format.Type() >= DT_NUM_UNCOMPRESSED_TYPES)
+				return "The image is already compressed.";
+
+			if(format.Type() != DT_NORM_UNSIGNED_INTEGER)
+				return "Only normalized unsigned integers can be compressed.";
+
+			switch(format.Depth())
+			{
+			case BD_PER_COMP_8:
+			case BD_PER_COMP_16:
+			case BD_PACKED_32_BIT_8888:
+			case BD_PACKED_32_BIT_8888_REV:
+				break;
+			default:
+				return "Only 8 and 16-bit components, or BD_PACKED_32_BIT_8888 and its _REV form, can be compressed.";
+			}
+
+			if(format.Components() == FMT_DEPTH || format.Components() == FMT_DEPTH_X)
+				return "Depth images cannot be compressed.";
+
+			if(format.Order() != ORDER_RGBA && format.Order() != ORDER_BGRA)
+				return "Only RGBA and BGRA component orders can be compressed.";
+
+			return std::string();
+		}
+
+		SourceLayout GetSourceLayout(const ImageFormat &format)
+		{
+			SourceLayout layout;
+			int numStored = ComponentCount(format.Components());
+			layout.compByteSize = format.Depth() == BD_PER_COMP_16 ? 2 : 1;
+			if(format.Depth() == BD_PACKED_32_BIT_8888 || format.Depth() == BD_PACKED_32_BIT_8888_REV)
+				numStored = 4;
+			layout.texelByteSize = numStored * layout.compByteSize;
+
+			switch(format.Components())
+			{
+			case FMT_COLOR_RGBX:
+			case FMT_COLOR_RGBX_sRGB:
+				layout.numComponents = 3;
+				break;
+			default:
+				layout.numComponents = std::min(numStored, 4);
+				break;
+			}
+
+			//Packed formats put the first component in the highest bits, unless they are _REV.
+			bool isReversed = format.Depth() == BD_PACKED_32_BIT_8888 ? IsLittleEndian() :
+				(format.Depth() == BD_PACKED_32_BIT_8888_REV ? !IsLittleEndian() : false);
+
+			const int bgraPositions[4] = {2, 1, 0, 3};
+			for(int compIx = 0; compIx < 4; ++compIx)
+			{
+				int position = format.Order() == ORDER_BGRA ? bgraPositions[compIx] : compIx;
+				if(isReversed)
+					position = 3 - position;
+				layout.compOffsets[compIx] = position * layout.compByteSize;
+			}
+
+			return layout;
+		}
+
+		//Throws if an image of the given format can't be compressed to eType.
+		PixelComponents GetCompressedComponents(const ImageFormat &format, PixelDataType eType)
+		{
+			std::string reason = GetUnsupportedReason(format);
+			if(!reason.empty())
+				throw CompressionUnsupportedException(reason);
+
+			bool isSRGB = false;
+			bool hasAlpha = false;
+			int numComponents = 0;
+			switch(format.Components())
+			{
+			case FMT_COLOR_RED:			numComponents = 1;							break;
+			case FMT_COLOR_RG:			numComponents = 2;							break;
+			case FMT_COLOR_RGB:			numComponents = 3;							break;
+			case FMT_COLOR_RGBX:		numComponents = 3;							break;
+			case FMT_COLOR_RGBA:		numComponents = 3;	hasAlpha = true;		break;
+			case FMT_COLOR_RGB_sRGB:	numComponents = 3;	isSRGB = true;			break;
+			case FMT_COLOR_RGBX_sRGB:	numComponents = 3;	isSRGB = true;			break;
+			case FMT_COLOR_RGBA_sRGB:	numComponents = 3;	isSRGB = true;	hasAlpha = true;	break;
+			default:
+				break;
+			}
+
+			switch(eType)
+			{
+			case DT_COMPRESSED_BC1:
+				if(numComponents == 3)
+				{
+					if(hasAlpha)
+						return isSRGB ? FMT_COLOR_RGBA_sRGB : FMT_COLOR_RGBA;
+					return isSRGB ? FMT_COLOR_RGB_sRGB : FMT_COLOR_RGB;
+				}
+				throw CompressionUnsupportedException("BC1 needs an RGB, RGBX or RGBA image.");
+			case DT_COMPRESSED_BC3:
+				if(numComponents == 3)
+					return isSRGB ? FMT_COLOR_RGBA_sRGB : FMT_COLOR_RGBA;
+				throw CompressionUnsupportedException("BC3 needs an RGB, RGBX or RGBA image.");
+			case DT_COMPRESSED_UNSIGNED_BC4:
+				if(numComponents == 1)
+					return FMT_COLOR_RED;
+				throw CompressionUnsupportedException("BC4 needs a red image.");
+			case DT_COMPRESSED_UNSIGNED_BC5:
+				if(numComponents == 2)
+					return FMT_COLOR_RG;
+				throw CompressionUnsupportedException("BC5 needs an RG image.");
+			default:
+				throw CompressionUnsupportedException("Only BC1, BC3, unsigned BC4 and unsigned BC5 are supported.");
+			}
+		}
+
+		//The 4x4 texels of a block, as 8-bit RGBA. Texels past the edge of the image repeat the edge.
+		struct BlockTexels
+		{
+			unsigned char texels[16][4];
+		};
+
+		void FetchBlock(const unsigned char *pImage, size_t rowPitch, int width, int height,
+			int blockX, int blockY, const SourceLayout &layout, BlockTexels &block)
+		{
+			for(int y = 0; y < 4; ++y)
+			{
+				const unsigned char *pRow = pImage + std::min(blockY * 4 + y, height - 1) * rowPitch;
+				for(int x = 0; x < 4; ++x)
+				{
+					const unsigned char *pTexel = pRow +
+						std::min(blockX * 4 + x, width - 1) * layout.texelByteSize;
+					unsigned char *pDst = block.texels[y * 4 + x];
+					pDst[0] = pDst[1] = pDst[2] = 0;
+					pDst[3] = 255;
+
+					for(int compIx = 0; compIx < layout.numComponents; ++compIx)
+					{
+						const unsigned char *pComp = pTexel + layout.compOffsets[compIx];
+						if(layout.compByteSize == 1)
+							pDst[compIx] = *pComp;
+						else
+						{
+							unsigned int value = *reinterpret_cast<const unsigned short *>(pComp);
+							pDst[compIx] = (unsigned char)((value * 255 + 32767) / 65535);
+						}
+					}
+				}
+			}
+		}
+
+		int Clamp(int value, int minValue, int maxValue)
+		{
+			return value < minValue ? minValue : (value > maxValue ? maxValue : value);
+		}
+
+		void WriteBlockBytes(unsigned char *pDst, unsigned int value, int numBytes)
+		{
+			for(int byteIx = 0; byteIx < numBytes; ++byteIx)
+				pDst[byteIx] = (unsigned char)(value >> (byteIx * 8));
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		//BC1 color blocks. The BC3 color block is the same, but always has 4 colors.
+		struct ColorBlock
+		{
+			int colors[16][3];
+			bool isTransparent[16];
+			bool hasTransparency;
+			bool canUseBlack;			//Index 3 of a 3-color block may stand for opaque black.
+		};
+
+		struct EncodedColors
+		{
+			unsigned short color0;
+			unsigned short color1;
+			bool isThreeColor;
+			unsigned char indices[16];
+			int error;
+		};
+
+		unsigned short PackColor565(const float color[3])
+		{
+			int red = Clamp((int)(color[0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+			int green = Clamp((int)(color[1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+			int blue = Clamp((int)(color[2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+			return (unsigned short)((red << 11) | (green << 5) | blue);
+		}
+
+		void UnpackColor565(unsigned short packed, int color[3])
+		{
+			int red = (packed >> 11) & 0x1F;
+			int green = (packed >> 5) & 0x3F;
+			int blue = packed & 0x1F;
+			color[0] = (red << 3) | (red >> 2);
+			color[1] = (green << 2) | (green >> 4);
+			color[2] = (blue << 3) | (blue >> 2);
+		}
+
+		int ColorDistance(const int lhs[3], const int rhs[3])
+		{
+			int red = lhs[0] - rhs[0];
+			int green = lhs[1] - rhs[1];
+			int blue = lhs[2] - rhs[2];
+			return red * red + green * green + blue * blue;
+		}
+
+		EncodedColors EvaluateColors(const ColorBlock &block, bool isThreeColor,
+			unsigned short endpointA, unsigned short endpointB)
+		{
+			//Four color blocks need color0 > color1, three color blocks color0 <= color1.
+			//When they are equal, only the first three palette entries can be relied upon.
+			EncodedColors encoded;
+			bool isSwapped = isThreeColor ? endpointA > endpointB : endpointA < endpointB;
+			encoded.color0 = isSwapped ? endpointB : endpointA;
+			encoded.color1 = isSwapped ? endpointA : endpointB;
+			encoded.isThreeColor = isThreeColor || encoded.color0 == encoded.color1;
+
+			int palette[4][3];
+			UnpackColor565(encoded.color0, palette[0]);
+			UnpackColor565(encoded.color1, palette[1]);
+			int numColors = 4;
+			for(int compIx = 0; compIx < 3; ++compIx)
+			{
+				if(encoded.isThreeColor)
+				{
+					palette[2][compIx] = (palette[0][compIx] + palette[1][compIx] + 1) / 2;
+					palette[3][compIx] = 0;
+				}
+				else
+				{
+					palette[2][compIx] = (2 * palette[0][compIx] + palette[1][compIx] + 1) / 3;
+					palette[3][compIx] = (palette[0][compIx] + 2 * palette[1][compIx] + 1) / 3;
+				}
+			}
+
+			if(encoded.isThreeColor && !(block.canUseBlack && isThreeColor))
+				numColors = 3;
+
+			encoded.error = 0;
+			for(int texelIx = 0; texelIx < 16; ++texelIx)
+			{
+				if(block.isTransparent[texelIx])
+				{
+					encoded.indices[texelIx] = 3;
+					continue;
+				}
+
+				int bestIx = 0;
+				int bestDistance = ColorDistance(block.colors[texelIx], palette[0]);
+				for(int paletteIx = 1; paletteIx < numColors; ++paletteIx)
+				{
+					int distance = ColorDistance(block.colors[texelIx], palette[paletteIx]);
+					if(distance < bestDistance)
+					{
+						bestIx = paletteIx;
+						bestDistance = distance;
+					}
+				}
+
+				encoded.indices[texelIx] = (unsigned char)bestIx;
+				encoded.error += bestDistance;
+			}
+
+			return encoded;
+		}
+
+		void KeepBest(EncodedColors &best, const EncodedColors &candidate)
+		{
+			if(candidate.error < best.error)
+				best = candidate;
+		}
+
+		//Endpoints from the bounding box of the opaque colors, with the diagonal chosen by the
+		//signs of green's covariance with red and blue.
+		void FindBoundingBoxEndpoints(const ColorBlock &block, float endpoints[2][3])
+		{
+			float mins[3] = {255.0f, 255.0f, 255.0f};
+			float maxs[3] = {0.0f, 0.0f, 0.0f};
+			float means[3] = {0.0f, 0.0f, 0.0f};
+			int numOpaque = 0;
+			for(int texelIx = 0; texelIx < 16; ++texelIx)
+			{
+				if(block.isTransparent[texelIx])
+					continue;
+				for(int compIx = 0; compIx < 3; ++compIx)
+				{
+					float value = (float)block.colors[texelIx][compIx];
+					mins[compIx] = std::min(mins[compIx], value);
+					maxs[compIx] = std::max(maxs[compIx], value);
+					means[compIx] += value;
+				}
+				++numOpaque;
+			}
+
+			for(int compIx = 0; compIx < 3; ++compIx)
+				means[compIx] /= numOpaque;
+
+			float covRedGreen = 0.0f;
+			float covBlueGreen = 0.0f;
+			for(int texelIx = 0; texelIx < 16; ++texelIx)
+			{
+				if(block.isTransparent[texelIx])
+					continue;
+				float green = block.colors[texelIx][1] - means[1];
+				covRedGreen += (block.colors[texelIx][0] - means[0]) * green;
+				covBlueGreen += (block.colors[texelIx][2] - means[2]) * green;
+			}
+
+			if(covRedGreen < 0.0f)
+				std::swap(mins[0], maxs[0]);
+			if(covBlueGreen < 0.0f)
+				std::swap(mins[2], maxs[2]);
+
+			//Inset the box a little, since the endpoints are rarely the best colors to hit exactly.
+			for(int compIx = 0; compIx < 3; ++compIx)
+			{
+				float inset = (maxs[compIx] - mins[compIx]) / 16.0f;
+				endpoints[0][compIx] = maxs[compIx] - inset;
+				endpoints[1][compIx] = mins[compIx] + inset;
+			}
+		}
+
+		//Endpoints from the extent of the opaque colors along their principal axis.
+		void FindPrincipalAxisEndpoints(const ColorBlock &block, float endpoints[2][3])
+		{
+			float means[3] = {0.0f, 0.0f, 0.0f};
+			int numOpaque = 0;
+			for(int texelIx = 0; texelIx < 16; ++texelIx)
+			{
+				if(block.isTransparent[texelIx])
+					continue;
+				for(int compIx = 0; compIx < 3; ++compIx)
+					means[compIx] += block.colors[texelIx][compIx];
+				++numOpaque;
+			}
+
+			for(int compIx = 0; compIx < 3; ++compIx)
+				means[compIx] /= numOpaque;
+
+			float covariance[3][3] = {{0.0f}};
+			for(int texelIx = 0; texelIx < 16; ++texelIx)
+			{
+				if(block.isTransparent[texelIx])
+					continue;
+				float offset[3];
+				for(int compIx = 0; compIx < 3; ++compIx)
+					offset[compIx] = block.colors[texelIx][compIx] - means[compIx];
+				for(int row = 0; row < 3; ++row)
+				{
+					for(int column = 0; column < 3; ++column)
+						covariance[row][column] += offset[row] * offset[column];
+				}
+			}
+
+			//Power iteration, starting from the row with the most variance.
+			int startRow = 0;
+			for(int row = 1; row < 3; ++row)
+			{
+				if(covariance[row][row] > covariance[startRow][startRow])
+					startRow = row;
+			}
+
+			float axis[3] = {covariance[startRow][0], covariance[startRow][1], covariance[startRow][2]};
+			for(int iteration = 0; iteration < 8; ++iteration)
+			{
+				float next[3];
+				float largest = 0.0f;
+				for(int row = 0; row < 3; ++row)
+				{
+					next[row] = covariance[row][0] * axis[0] + covariance[row][1] * axis[1] +
+						covariance[row][2] * axis[2];
+					largest = std::max(largest, next[row] < 0.0f ? -next[row] : next[row]);
+				}
+
+				if(largest == 0.0f)
+					break;
+
+				for(int row = 0; row < 3; ++row)
+					axis[row] = next[row] / largest;
+			}
+
+			float lengthSqr = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+			float minProj = 0.0f;
+			float maxProj = 0.0f;
+			if(lengthSqr > 0.0f)
+			{
+				for(int texelIx = 0; texelIx < 16; ++texelIx)
+				{
+					if(block.isTransparent[texelIx])
+						continue;
+					float proj = 0.0f;
+					for(int compIx = 0; compIx < 3; ++compIx)
+						proj += (block.colors[texelIx][compIx] - means[compIx]) * axis[compIx];
+					minProj = std::min(minProj, proj);
+					maxProj = std::max(maxProj, proj);
+				}
+				minProj /= lengthSqr;
+				maxProj /= lengthSqr;
+			}
+
+			for(int compIx = 0; compIx < 3; ++compIx)
+			{
+				endpoints[0][compIx] = means[compIx] + axis[compIx] * maxProj;
+				endpoints[1][compIx] = means[compIx] + axis[compIx] * minProj;
+			}
+		}
+
+		//Solves for the endpoints that best fit the colors, given the palette entries they were
+		//assigned to. Returns false if the indices do not pin down two endpoints.
+		bool FitEndpoints(const ColorBlock &block, const EncodedColors &encoded,
+			unsigned short &color0, unsigned short &color1)
+		{
+			static const float fourColorWeights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+			static const float threeColorWeights[3] = {1.0f, 0.0f, 0.5f};
+
+			float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+			float ax[3] = {0.0f, 0.0f, 0.0f};
+			float bx[3] = {0.0f, 0.0f, 0.0f};
+			for(int texelIx = 0; texelIx < 16; ++texelIx)
+			{
+				int index = encoded.indices[texelIx];
+				if(encoded.isThreeColor && index == 3)
+					continue;
+
+				float alpha = encoded.isThreeColor ? threeColorWeights[index] : fourColorWeights[index];
+				float beta = 1.0f - alpha;
+				aa += alpha * alpha;
+				bb += beta * beta;
+				ab += alpha * beta;
+				for(int compIx = 0; compIx < 3; ++compIx)
+				{
+					ax[compIx] += alpha * block.colors[texelIx][compIx];
+					bx[compIx] += beta * block.colors[texelIx][compIx];
+				}
+			}
+
+			float determinant = aa * bb - ab * ab;
+			if(determinant < 1.0e-4f)
+				return false;
+
+			float endpoints[2][3];
+			for(int compIx = 0; compIx < 3; ++compIx)
+			{
+				endpoints[0][compIx] = (ax[compIx] * bb - bx[compIx] * ab) / determinant;
+				endpoints[1][compIx] = (bx[compIx] * aa - ax[compIx] * ab) / determinant;
+			}
+
+			color0 = PackColor565(endpoints[0]);
+			color1 = PackColor565(endpoints[1]);
+			return true;
+		}
+
+		void RefineColors(const ColorBlock &block, bool isThreeColor, int maxIterations,
+			EncodedColors &best)
+		{
+			for(int iteration = 0; iteration < maxIterations; ++iteration)
+			{
+				unsigned short color0, color1;
+				if(!FitEndpoints(block, best, color0, color1))
+					return;
+
+				EncodedColors candidate = EvaluateColors(block, isThreeColor, color0, color1);
+				if(candidate.error >= best.error)
+					return;
+				best = candidate;
+			}
+		}
+
+		//Nudges each channel of each endpoint by one step until nothing improves.
+		void SearchNeighboringColors(const ColorBlock &block, bool isThreeColor, EncodedColors &best)
+		{
+			static const int channelShifts[3] = {11, 5, 0};
+			static const int channelMaxs[3] = {31, 63, 31};
+
+			for(int pass = 0; pass < 8; ++pass)
+			{
+				bool hasImproved = false;
+				for(int endpointIx = 0; endpointIx < 2; ++endpointIx)
+				{
+					for(int channelIx = 0; channelIx < 3; ++channelIx)
+					{
+						for(int step = -1; step <= 1; step += 2)
+						{
+							unsigned short endpoints[2] = {best.color0, best.color1};
+							int shift = channelShifts[channelIx];
+							int value = ((endpoints[endpointIx] >> shift) & channelMaxs[channelIx]) + step;
+							if(value < 0 || value > channelMaxs[channelIx])
+								continue;
+
+							endpoints[endpointIx] = (unsigned short)((endpoints[endpointIx] &
+								~(channelMaxs[channelIx] << shift)) | (value << shift));
+							EncodedColors candidate = EvaluateColors(block, isThreeColor,
+								endpoints[0], endpoints[1]);
+							if(candidate.error < best.error)
+							{
+								best = candidate;
+								hasImproved = true;
+							}
+						}
+					}
+				}
+
+				if(!hasImproved)
+					return;
+			}
+		}
+
+		EncodedColors EncodeColorsInMode(const ColorBlock &block, bool isThreeColor,
+			const float endpoints[2][3], CompressionQuality quality)
+		{
+			EncodedColors best = EvaluateColors(block, isThreeColor,
+				PackColor565(endpoints[0]), PackColor565(endpoints[1]));
+
+			switch(quality)
+			{
+			case COMPRESSION_QUALITY_FAST:
+				break;
+			case COMPRESSION_QUALITY_NORMAL:
+				RefineColors(block, isThreeColor, 1, best);
+				break;
+			case COMPRESSION_QUALITY_HIGH:
+				RefineColors(block, isThreeColor, 8, best);
+				SearchNeighboringColors(block, isThreeColor, best);
+				break;
+			}
+
+			return best;
+		}
+
+		void CompressColorBlock(const BlockTexels &texels, bool allowThreeColor, bool canUseBlack,
+			bool hasAlpha, CompressionQuality quality, unsigned char *pDst)
+		{
+			ColorBlock block;
+			block.hasTransparency = false;
+			block.canUseBlack = canUseBlack;
+			for(int texelIx = 0; texelIx < 16; ++texelIx)
+			{
+				for(int compIx = 0; compIx < 3; ++compIx)
+					block.colors[texelIx][compIx] = texels.texels[texelIx][compIx];
+				block.isTransparent[texelIx] = hasAlpha && texels.texels[texelIx][3] < 128;
+				block.hasTransparency = block.hasTransparency || block.isTransparent[texelIx];
+			}
+
+			EncodedColors encoded;
+			int numTransparent = 0;
+			for(int texelIx = 0; texelIx < 16; ++texelIx)
+				numTransparent += block.isTransparent[texelIx] ? 1 : 0;
+
+			if(numTransparent == 16)
+			{
+				encoded.color0 = 0;
+				encoded.color1 = 0;
+				memset(encoded.indices, 3, sizeof(encoded.indices));
+			}
+			else
+			{
+				float endpoints[2][3];
+				if(quality == COMPRESSION_QUALITY_FAST)
+					FindBoundingBoxEndpoints(block, endpoints);
+				else
+					FindPrincipalAxisEndpoints(block, endpoints);
+
+				if(block.hasTransparency)
+					encoded = EncodeColorsInMode(block, true, endpoints, quality);
+				else
+				{
+					encoded = EncodeColorsInMode(block, false, endpoints, quality);
+					if(allowThreeColor && quality != COMPRESSION_QUALITY_FAST && encoded.error > 0)
+						KeepBest(encoded, EncodeColorsInMode(block, true, endpoints, quality));
+				}
+			}
+
+			unsigned int packedIndices = 0;
+			for(int texelIx = 0; texelIx < 16; ++texelIx)
+				packedIndices |= (unsigned int)encoded.indices[texelIx] << (texelIx * 2);
+
+			WriteBlockBytes(pDst, encoded.color0, 2);
+			WriteBlockBytes(pDst + 2, encoded.color1, 2);
+			WriteBlockBytes(pDst + 4, packedIndices, 4);
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		//BC4 blocks. Also the alpha of BC3, and each channel of BC5.
+		struct EncodedChannel
+		{
+			int value0;
+			int value1;
+			unsigned char indices[16];
+			int error;
+		};
+
+		EncodedChannel EvaluateChannel(const int values[16], bool isSixValue, int endpointA, int endpointB)
+		{
+			//Eight value blocks need value0 > value1, six value blocks value0 <= value1.
+			EncodedChannel encoded;
+			bool isSwapped = isSixValue ? endpointA > endpointB : endpointA < endpointB;
+			encoded.value0 = isSwapped ? endpointB : endpointA;
+			encoded.value1 = isSwapped ? endpointA : endpointB;
+
+			int palette[8];
+			palette[0] = encoded.value0;
+			palette[1] = encoded.value1;
+			if(encoded.value0 > encoded.value1)
+			{
+				for(int step = 1; step < 7; ++step)
+					palette[step + 1] = ((7 - step) * encoded.value0 + step * encoded.value1 + 3) / 7;
+			}
+			else
+			{
+				for(int step = 1; step < 5; ++step)
+					palette[step + 1] = ((5 - step) * encoded.value0 + step * encoded.value1 + 2) / 5;
+				palette[6] = 0;
+				palette[7] = 255;
+			}
+
+			encoded.error = 0;
+			for(int texelIx = 0; texelIx < 16; ++texelIx)
+			{
+				int bestIx = 0;
+				int bestDistance = (values[texelIx] - palette[0]) * (values[texelIx] - palette[0]);
+				for(int paletteIx = 1; paletteIx < 8; ++paletteIx)
+				{
+					int distance = (values[texelIx] - palette[paletteIx]) * (values[texelIx] - palette[paletteIx]);
+					if(distance < bestDistance)
+					{
+						bestIx = paletteIx;
+						bestDistance = distance;
+					}
+				}
+
+				encoded.indices[texelIx] = (unsigned char)bestIx;
+				encoded.error += bestDistance;
+			}
+
+			return encoded;
+		}
+
+		//Tries shrinking the range between the endpoints by a few steps at either end.
+		void SearchChannelInsets(const int values[16], bool isSixValue, int low, int high,
+			EncodedChannel &best)
+		{
+			int maxInset = std::min((high - low) / 8, 4);
+			for(int lowInset = 0; lowInset <= maxInset; ++lowInset)
+			{
+				for(int highInset = 0; highInset <= maxInset; ++highInset)
+				{
+					EncodedChannel candidate = EvaluateChannel(values, isSixValue,
+						low + lowInset, high - highInset);
+					if(candidate.error < best.error)
+						best = candidate;
+				}
+			}
+		}
+
+		void CompressChannelBlock(const BlockTexels &texels, int compIx, CompressionQuality quality,
+			unsigned char *pDst)
+		{
+			int values[16];
+			int low = 255, high = 0;
+			int innerLow = 255, innerHigh = 0;
+			for(int texelIx = 0; texelIx < 16; ++texelIx)
+			{
+				int value = texels.texels[texelIx][compIx];
+				values[texelIx] = value;
+				low = std::min(low, value);
+				high = std::max(high, value);
+				if(value != 0 && value != 255)
+				{
+					innerLow = std::min(innerLow, value);
+					innerHigh = std::max(innerHigh, value);
+				}
+			}
+
+			//The six value mode has exact 0 and 255, so its endpoints need only cover the rest.
+			if(innerLow > innerHigh)
+				innerLow = innerHigh = 0;
+
+			EncodedChannel encoded = EvaluateChannel(values, false, high, low);
+			if(quality != COMPRESSION_QUALITY_FAST && encoded.error > 0)
+			{
+				EncodedChannel sixValue = EvaluateChannel(values, true, innerLow, innerHigh);
+				if(quality == COMPRESSION_QUALITY_HIGH)
+				{
+					SearchChannelInsets(values, false, low, high, encoded);
+					SearchChannelInsets(values, true, innerLow, innerHigh, sixValue);
+				}
+
+				if(sixValue.error < encoded.error)
+					encoded = sixValue;
+			}
+
+			pDst[0] = (unsigned char)encoded.value0;
+			pDst[1] = (unsigned char)encoded.value1;
+
+			//16 3-bit indices, as a little-endian 48-bit integer.
+			unsigned int lowIndices = 0;
+			unsigned int highIndices = 0;
+			for(int texelIx = 0; texelIx < 8; ++texelIx)
+			{
+				lowIndices |= (unsigned int)encoded.indices[texelIx] << (texelIx * 3);
+				highIndices |= (unsigned int)encoded.indices[texelIx + 8] << (texelIx * 3);
+			}
+
+			WriteBlockBytes(pDst + 2, lowIndices, 3);
+			WriteBlockBytes(pDst + 5, highIndices, 3);
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		//One image of one mipmap level, and where its blocks go.
+		struct ImageToCompress
+		{
+			const unsigned char *pSrc;
+			size_t srcRowPitch;
+			int width;
+			int height;
+			unsigned char *pDst;
+		};
+
+		//Rows of blocks are compressed in bands, so that small mipmaps don't each cost an item.
+		const int g_blockRowsPerBand = 8;
+
+		struct BlockBand
+		{
+			int imageIx;
+			int firstBlockRow;
+			int numBlockRows;
+		};
+
+		class BlockCompressionTask : public ParallelTask
+		{
+		public:
+			BlockCompressionTask(PixelDataType eType, bool hasAlpha, const SourceLayout &layout,
+				CompressionQuality quality)
+				: m_eType(eType)
+				, m_hasAlpha(hasAlpha)
+				, m_layout(layout)
+				, m_quality(quality)
+				, m_blockByteCount(GetBlockCompressionData(eType).byteCount)
+			{}
+
+			void AddImage(const ImageToCompress &image)
+			{
+				m_images.push_back(image);
+
+				int numBlockRows = (image.height + 3) / 4;
+				for(int blockRow = 0; blockRow < numBlockRows; blockRow += g_blockRowsPerBand)
+				{
+					BlockBand band;
+					band.imageIx = (int)m_images.size() - 1;
+					band.firstBlockRow = blockRow;
+					band.numBlockRows = std::min(g_blockRowsPerBand, numBlockRows - blockRow);
+					m_bands.push_back(band);
+				}
+			}
+
+			int GetNumItems() const {return (int)m_bands.size();}
+
+			virtual void Execute(int itemIx)
+			{
+				const BlockBand &band = m_bands[itemIx];
+				const ImageToCompress &image = m_images[band.imageIx];
+				int numBlockColumns = (image.width + 3) / 4;
+
+				BlockTexels texels;
+				for(int blockRow = band.firstBlockRow; blockRow < band.firstBlockRow + band.numBlockRows; ++blockRow)
+				{
+					unsigned char *pDst = image.pDst + (size_t)blockRow * numBlockColumns * m_blockByteCount;
+					for(int blockColumn = 0; blockColumn < numBlockColumns; ++blockColumn, pDst += m_blockByteCount)
+					{
+						FetchBlock(image.pSrc, image.srcRowPitch, image.width, image.height,
+							blockColumn, blockRow, m_layout, texels);
+						CompressBlock(texels, pDst);
+					}
+				}
+			}
+
+		private:
+			const PixelDataType m_eType;
+			const bool m_hasAlpha;
+			const SourceLayout m_layout;
+			const CompressionQuality m_quality;
+			const size_t m_blockByteCount;
+
+			std::vector<ImageToCompress> m_images;
+			std::vector<BlockBand> m_bands;
+
+			void CompressBlock(const BlockTexels &texels, unsigned char *pDst) const
+			{
+				switch(m_eType)
+				{
+				case DT_COMPRESSED_BC1:
+					//Index 3 is transparent in RGBA blocks, but black in RGB ones.
+					CompressColorBlock(texels, true, !m_hasAlpha, m_hasAlpha, m_quality, pDst);
+					break;
+				case DT_COMPRESSED_BC3:
+					CompressChannelBlock(texels, 3, m_quality, pDst);
+					CompressColorBlock(texels, false, false, false, m_quality, pDst + 8);
+					break;
+				case DT_COMPRESSED_UNSIGNED_BC4:
+					CompressChannelBlock(texels, 0, m_quality, pDst);
+					break;
+				case DT_COMPRESSED_UNSIGNED_BC5:
+					CompressChannelBlock(texels, 0, m_quality, pDst);
+					CompressChannelBlock(texels, 1, m_quality, pDst + 8);
+					break;
+				default:
+					break;
+				}
+			}
+		};
+	}
+
+	PixelDataType GetDefaultCompressedType( const ImageFormat &format )
+	{
+		std::string reason = GetUnsupportedReason(format);
+		if(!reason.empty())
+			throw CompressionUnsupportedException(reason);
+
+		switch(format.Components())
+		{
+		case FMT_COLOR_RED:
+			return DT_COMPRESSED_UNSIGNED_BC4;
+		case FMT_COLOR_RG:
+			return DT_COMPRESSED_UNSIGNED_BC5;
+		case FMT_COLOR_RGBA:
+		case FMT_COLOR_RGBA_sRGB:
+			return DT_COMPRESSED_BC3;
+		default:
+			return DT_COMPRESSED_BC1;
+		}
+	}
+
+	bool CanCompressImage( const ImageSet &imageSet )
+	{
+		return imageSet.GetDimensions().numDimensions == 2 &&
+			GetUnsupportedReason(imageSet.GetFormat()).empty();
+	}
+
+	ImageSet *CompressImage( const ImageSet &imageSet, PixelDataType compressedType,
+		CompressionQuality quality, int numThreads )
+	{
+		const ImageFormat &srcFormat = imageSet.GetFormat();
+		PixelComponents dstComponents = GetCompressedComponents(srcFormat, compressedType);
+
+		Dimensions baseDims = imageSet.GetDimensions();
+		if(baseDims.numDimensions != 2)
+			throw CompressionUnsupportedException("Only 2D images can be block compressed.");
+
+		ImageFormat dstFormat(compressedType, dstComponents, ORDER_COMPRESSED, BD_COMPRESSED, 1);
+		bool hasAlpha = dstComponents == FMT_COLOR_RGBA || dstComponents == FMT_COLOR_RGBA_sRGB;
+		SourceLayout layout = GetSourceLayout(srcFormat);
+
+		const int mipmapCount = imageSet.GetMipmapCount();
+		const int numImages = imageSet.GetArrayCount() * imageSet.GetFaceCount();
+
+		//Every level goes into one task, so that the small levels fill in around the large one.
+		BlockCompressionTask task(compressedType, hasAlpha, layout, quality);
+		std::vector<ImageBuffer> levelData(mipmapCount);
+		for(int level = 0; level < mipmapCount; ++level)
+		{
+			Dimensions levelDims = ModifySizeForMipmap(baseDims, level);
+			size_t srcImageSize = CalcImageByteSize(srcFormat, levelDims);
+			size_t dstImageSize = CalcImageByteSize(dstFormat, levelDims);
+			levelData[level].resize(dstImageSize * numImages);
+
+			const unsigned char *pSrcLevel = static_cast<const unsigned char *>(imageSet.GetImageArray(level));
+			for(int imageIx = 0; imageIx < numImages; ++imageIx)
+			{
+				ImageToCompress image;
+				image.pSrc = pSrcLevel + imageIx * srcImageSize;
+				image.srcRowPitch = srcFormat.AlignByteCount(layout.texelByteSize * levelDims.width);
+				image.width = levelDims.width;
+				image.height = levelDims.height;
+				image.pDst = &levelData[level][0] + imageIx * dstImageSize;
+				task.AddImage(image);
+			}
+		}
+
+		std::auto_ptr<ThreadPool> pOwnPool;
+		if(numThreads > 0)
+			pOwnPool.reset(new ThreadPool(numThreads));
+		ThreadPool &pool = pOwnPool.get() ? *pOwnPool : GetSharedThreadPool();
+
+		pool.ParallelFor(task, task.GetNumItems());
+
+		ImageCreator creator(dstFormat, baseDims, mipmapCount, imageSet.GetArrayCount(),
+			imageSet.GetFaceCount());
+		for(int level = 0; level < mipmapCount; ++level)
+			creator.SetFullMipmapLevel(&levelData[level][0], false, level);
+
+		return creator.CreateImage();
+	}
+}
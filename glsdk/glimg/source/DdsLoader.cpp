@@ -4,6 +4,7 @@
 
 
 #include <vector>
+#include <memory>
 #include <stdio.h>
 #include <string.h>
 #include "glimg/ImageSet.h"
@@ -11,6 +12,7 @@
 #include "glimg/ImageCreator.h"
 #include "glimg/DdsLoader.h"
 #include "DdsLoaderInt.h"
+#include "glimg/MappedFile.h"
 #include "Util.h"
 
 #define ARRAY_COUNT( array ) (sizeof( array ) / (sizeof( array[0] ) * (sizeof( array ) != sizeof(void*) || sizeof( array[0] ) <= sizeof(void*))))
@@ -31,14 +33,24 @@ namespace dds
 		}
 
 		//Will either generate this or return the actual one.
-		dds10Header GetDDS10Header(const ddsHeader &header, const FileBuffer &ddsData)
+		dds10Header GetDDS10Header(const ddsHeader &header, const unsigned char *pDdsData, size_t ddsSize)
 		{
 			if(header.ddspf.dwFourCC == DDS10_FOUR_CC)
 			{
 				dds10Header header10;
 				size_t offsetToNewHeader = 4 + sizeof(ddsHeader);
 
-				memcpy(&header10, &ddsData[offsetToNewHeader], sizeof(dds10Header));
+				if(ddsSize < offsetToNewHeader + sizeof(dds10Header))
+					throw DdsFileMalformedException(std::string(), "The DX10 header is cut off.");
+
+				memcpy(&header10, pDdsData + offsetToNewHeader, sizeof(dds10Header));
+
+				//An array size of 0 is as good as 1.
+				if(header10.arraySize == 0)
+					header10.arraySize = 1;
+
+				if(header10.resourceDimension == DDS_DIMENSION_TEXTURE3D && header10.arraySize > 1)
+					throw DdsFileUnsupportedException(std::string(), "There are no 3D array textures.");
 
 				return header10;
 			}
@@ -80,6 +92,28 @@ namespace dds
 			Dimensions dims;
 			dims.numDimensions = 1;
 			dims.width = header.dwWidth;
+
+			//The DX10 header says outright; DX9 headers only have the flags.
+			if(header.ddspf.dwFourCC == DDS10_FOUR_CC)
+			{
+				switch(header10.resourceDimension)
+				{
+				case DDS_DIMENSION_TEXTURE1D:
+					return dims;
+				case DDS_DIMENSION_TEXTURE2D:
+					dims.numDimensions = 2;
+					dims.height = header.dwHeight;
+					return dims;
+				case DDS_DIMENSION_TEXTURE3D:
+					dims.numDimensions = 3;
+					dims.height = header.dwHeight;
+					dims.depth = header.dwDepth;
+					return dims;
+				default:
+					throw DdsFileMalformedException(std::string(), "The DX10 header has an invalid resource dimension.");
+				}
+			}
+
 			if(header.dwFlags & DDSD_HEIGHT)
 			{
 				dims.numDimensions = 2;
@@ -94,23 +128,6 @@ namespace dds
 			return dims;
 		}
 
-		struct OldDdsFmtMatch
-		{
-			DWORD dwFlags;
-			DWORD bitDepth;
-			DWORD rBitmask;
-			DWORD gBitmask;
-			DWORD bBitmask;
-			DWORD aBitmask;
-			DWORD fourCC;
-		};
-
-		struct OldDdsFormatConv
-		{
-			UncheckedImageFormat fmt;
-			OldDdsFmtMatch ddsFmt;
-		};
-
 		bool DoesMatchFormat(const OldDdsFmtMatch &ddsFmt, const ddsHeader &header)
 		{
 			if(!(header.ddspf.dwFlags & ddsFmt.dwFlags))
@@ -145,12 +162,23 @@ namespace dds
 #include "OldDdsFmtConv.inc"
 		};
 
+		Dds10FormatConv g_dds10FmtConvert[] =
+		{
+#include "Dds10FmtConv.inc"
+		};
+
 		UncheckedImageFormat GetImageFormat(const ddsHeader &header, const dds10Header &header10)
 		{
 			if(header10.dxgiFormat != DXGI_FORMAT_UNKNOWN)
 			{
-				//TODO: implement.
-				return UncheckedImageFormat();
+				//The first entry for a DXGI format is the one to load it as.
+				for(size_t convIx = 0; convIx < ARRAY_COUNT(g_dds10FmtConvert); convIx++)
+				{
+					if(g_dds10FmtConvert[convIx].dxgiFormat == header10.dxgiFormat)
+						return g_dds10FmtConvert[convIx].fmt;
+				}
+
+				throw DdsFileUnsupportedException(std::string(), "Could not use the DX10 header's DXGI format.");
 			}
 
 			for(int convIx = 0; convIx < ARRAY_COUNT(g_oldFmtConvert); convIx++)
@@ -244,26 +272,50 @@ namespace dds
 			return numLines * lineSize;
 		}
 
-		//Takes ownership of ddsData;
-		ImageSet *ProcessDDSData(FileBuffer &ddsData, const std::string &filename = std::string())
+		//The images can stay where they are if they need no flipping and no padding, and if
+		//each mipmap level's images are next to each other. DDS stores each image's mipmaps
+		//together, so that takes a single mipmap level or a single image.
+		bool CanUseDataInPlace(const ImageFormat &format, const glimg::Dimensions &dims,
+			int numMipmaps, int numImages, unsigned int flags)
+		{
+			if(!(flags & KEEP_TOP_LEFT_ORIGIN))
+				return false;
+
+			if(numMipmaps != 1 && numImages != 1)
+				return false;
+
+			for(int mipmapLevel = 0; mipmapLevel < numMipmaps; mipmapLevel++)
+			{
+				Dimensions levelDims = ModifySizeForMipmap(dims, mipmapLevel);
+				if(CalcImageByteSize(format, levelDims) !=
+					CalcMipmapSize(dims, mipmapLevel, format.GetUncheckedFormat()))
+					return false;
+			}
+
+			return true;
+		}
+
+		//If pMapping holds the data, the ImageSet may take ownership of it.
+		ImageSet *ProcessDDSData(const unsigned char *pDdsData, size_t ddsSize, unsigned int flags,
+			std::auto_ptr<MappedFile> &pMapping, const std::string &filename = std::string())
 		{
+			if(ddsSize < sizeof(ddsHeader) + 4)
+				throw DdsFileMalformedException(filename, "The data is way too small to store actual information.");
+
 			//Check the first 4 bytes.
 			unsigned int magicTest = 0;
-			memcpy(&magicTest, &ddsData[0], 4);
+			memcpy(&magicTest, pDdsData, 4);
 			if(magicTest != DDS_MAGIC_NUMBER)
 				throw DdsFileMalformedException(filename, "The Magic number is missing from the file.");
 
-			if(ddsData.size() < sizeof(ddsHeader) + 4)
-				throw DdsFileMalformedException(filename, "The data is way too small to store actual information.");
-
 			//Now, get a DDS header.
 			ddsHeader header;
-			memcpy(&header, &ddsData[4], sizeof(ddsHeader));
+			memcpy(&header, pDdsData + 4, sizeof(ddsHeader));
 
 			ThrowIfHeaderInvalid(header);
 
 			//Collect info from the DDS file.
-			dds10Header header10 = GetDDS10Header(header, ddsData);
+			dds10Header header10 = GetDDS10Header(header, pDdsData, ddsSize);
 			glimg::Dimensions dims = GetDimensions(header, header10);
 			UncheckedImageFormat fmt = GetImageFormat(header, header10);
 
@@ -274,10 +326,38 @@ namespace dds
 
 			const size_t baseOffset = GetByteOffsetToData(header);
 
-			//TODO: support array textures
+			//Make sure the data is all there before reading any of it.
+			size_t dataByteSize = 0;
+			for(int mipmapLevel = 0; mipmapLevel < numMipmaps; mipmapLevel++)
+				dataByteSize += CalcMipmapSize(dims, mipmapLevel, fmt);
+			dataByteSize *= numArrays * numFaces;
+			if(ddsSize < baseOffset + dataByteSize)
+				throw DdsFileMalformedException(filename, "The image data is cut off.");
+
+			if(pMapping.get() && CanUseDataInPlace(fmt, dims, numMipmaps, numArrays * numFaces, flags))
+			{
+				std::vector<const unsigned char *> levelData(numMipmaps);
+				std::vector<size_t> imageSizes(numMipmaps);
+				size_t cumulativeOffset = baseOffset;
+				for(int mipmapLevel = 0; mipmapLevel < numMipmaps; mipmapLevel++)
+				{
+					levelData[mipmapLevel] = pDdsData + cumulativeOffset;
+					imageSizes[mipmapLevel] = CalcMipmapSize(dims, mipmapLevel, fmt);
+					cumulativeOffset += imageSizes[mipmapLevel] * numArrays * numFaces;
+				}
+
+				detail::ImageSetImpl *pImpl = new detail::ImageSetImpl(fmt, dims, numMipmaps,
+					numArrays, numFaces, levelData, imageSizes, pMapping.get());
+				pMapping.release();
+				return detail::ImageSetImpl::CreateImageSet(pImpl);
+			}
+
 			//Build the image creator. No more exceptions, except for those thrown by.
 			//the ImageCreator.
+			//The DDS stores each array element (and each face of it) with all of its mipmaps.
 			ImageCreator imgCreator(fmt, dims, numMipmaps, numArrays, numFaces);
+			std::vector<ImageDataSource> images;
+			images.reserve(numArrays * numFaces * numMipmaps);
 			size_t cumulativeOffset = baseOffset;
 			for(int arrayIx = 0; arrayIx < numArrays; arrayIx++)
 			{
@@ -285,18 +365,29 @@ namespace dds
 				{
 					for(int mipmapLevel = 0; mipmapLevel < numMipmaps; mipmapLevel++)
 					{
-						imgCreator.SetImageData(&ddsData[0] + cumulativeOffset,
-							true, mipmapLevel, arrayIx, faceIx);
+						ImageDataSource image = {pDdsData + cumulativeOffset, mipmapLevel, arrayIx, faceIx};
+						images.push_back(image);
 						cumulativeOffset += CalcMipmapSize(dims, mipmapLevel, fmt);
 					}
 				}
 			}
+
+			//All at once, so that the flipping is spread across threads.
+			const bool isTopLeft = !(flags & KEEP_TOP_LEFT_ORIGIN);
+			imgCreator.SetImageDataBatch(&images[0], (int)images.size(), isTopLeft);
 			return imgCreator.CreateImage();
 		}
 	}
 
-	ImageSet * LoadFromFile( const std::string &filename )
+	ImageSet * LoadFromFile( const std::string &filename, unsigned int flags )
 	{
+		std::auto_ptr<MappedFile> pMapping(MappedFile::Open(filename, true));
+		if(pMapping.get())
+		{
+			return ProcessDDSData(pMapping->GetData(), pMapping->GetSize(), flags,
+				pMapping, filename);
+		}
+
 		//Load the file.
 		FILE *pFile = fopen(filename.c_str(),"rb");
 		if(!pFile)
@@ -310,17 +401,18 @@ namespace dds
 		fileData.reserve(fileSize);
 		fileData.resize(fileSize);
 
-		fread(&fileData[0], fileSize, 1, pFile);
+		if(fileSize)
+			fread(&fileData[0], fileSize, 1, pFile);
 		fclose(pFile);
 
-		return ProcessDDSData(fileData, filename);
+		return ProcessDDSData(fileData.empty() ? NULL : &fileData[0], fileData.size(), flags,
+			pMapping, filename);
 	}
 
-	ImageSet * LoadFromMemory( const unsigned char *buffer, size_t bufSize )
+	ImageSet * LoadFromMemory( const unsigned char *buffer, size_t bufSize, unsigned int flags )
 	{
-		FileBuffer fileData(buffer, buffer + bufSize);
-
-		return ProcessDDSData(fileData);
+		std::auto_ptr<MappedFile> pNoMapping;
+		return ProcessDDSData(buffer, bufSize, flags, pNoMapping);
 	}
 }
 }
@@ -6,6 +6,7 @@
 #ifndef GLIMG_DIRECT_DRAW_SURFACE_INTERNAL_LOADER_H
 #define GLIMG_DIRECT_DRAW_SURFACE_INTERNAL_LOADER_H
 
+#include "glimg/ImageFormat.h"
 
 namespace glimg
 {
@@ -16,7 +17,7 @@ namespace glimg
 		enum MagicNumbers
 		{
 			DDS_MAGIC_NUMBER		= 0x20534444,	//"DDS "
-			DDS10_FOUR_CC			= 0x30314458,	//"DX10"
+			DDS10_FOUR_CC			= 0x30315844,	//"DX10"
 
 			DDSFOURCC_DXT1			= 0x31545844, //"DXT1"
 			DDSFOURCC_DXT3			= 0x33545844, //"DXT3"
@@ -225,6 +226,32 @@ namespace glimg
 			DXGI_FORMAT_FORCE_UINT                   = 0xffffffffUL 
 		};
 
+		//The entries of OldDdsFmtConv.inc.
+		struct OldDdsFmtMatch
+		{
+			DWORD dwFlags;
+			DWORD bitDepth;
+			DWORD rBitmask;
+			DWORD gBitmask;
+			DWORD bBitmask;
+			DWORD aBitmask;
+			DWORD fourCC;
+		};
+
+		struct OldDdsFormatConv
+		{
+			UncheckedImageFormat fmt;
+			OldDdsFmtMatch ddsFmt;
+		};
+
+		//The entries of Dds10FmtConv.inc. A DXGI format may have several entries; the first
+		//is the one it loads as.
+		struct Dds10FormatConv
+		{
+			UncheckedImageFormat fmt;
+			DWORD dxgiFormat;
+		};
+
 	}
 }
 
@@ -0,0 +1,260 @@
+//Copyright (C) 2011 by Jason L. McKesson
+//This file is licensed by the MIT License.
+
+
+
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#include "glimg/ImageSet.h"
+#include "glimg/DdsWriter.h"
+#include "DdsLoaderInt.h"
+#include "Util.h"
+
+#define ARRAY_COUNT( array ) (sizeof( array ) / (sizeof( array[0] ) * (sizeof( array ) != sizeof(void*) || sizeof( array[0] ) <= sizeof(void*))))
+
+namespace glimg
+{
+namespace writers
+{
+namespace dds
+{
+	namespace
+	{
+		OldDdsFormatConv g_oldFmtConvert[] =
+		{
+#include "OldDdsFmtConv.inc"
+		};
+
+		Dds10FormatConv g_dds10FmtConvert[] =
+		{
+#include "Dds10FmtConv.inc"
+		};
+
+		bool IsSameFormat(const UncheckedImageFormat &lhs, const ImageFormat &rhs)
+		{
+			return lhs.eType == rhs.Type() && lhs.eFormat == rhs.Components() &&
+				lhs.eOrder == rhs.Order() && lhs.eBitdepth == rhs.Depth();
+		}
+
+		//Returns NULL if the plain header cannot describe the format.
+		const OldDdsFmtMatch *FindOldFormat(const ImageFormat &format)
+		{
+			for(size_t convIx = 0; convIx < ARRAY_COUNT(g_oldFmtConvert); convIx++)
+			{
+				if(IsSameFormat(g_oldFmtConvert[convIx].fmt, format))
+					return &g_oldFmtConvert[convIx].ddsFmt;
+			}
+
+			//DXT1 is listed as RGB, but its 1-bit alpha is in the data either way.
+			if(format.Type() == DT_COMPRESSED_BC1 && format.Components() == FMT_COLOR_RGBA)
+			{
+				ImageFormat rgbFormat(DT_COMPRESSED_BC1, FMT_COLOR_RGB, ORDER_COMPRESSED, BD_COMPRESSED, 1);
+				return FindOldFormat(rgbFormat);
+			}
+
+			return NULL;
+		}
+
+		DWORD FindDxgiFormat(const ImageFormat &format)
+		{
+			for(size_t convIx = 0; convIx < ARRAY_COUNT(g_dds10FmtConvert); convIx++)
+			{
+				if(IsSameFormat(g_dds10FmtConvert[convIx].fmt, format))
+					return g_dds10FmtConvert[convIx].dxgiFormat;
+			}
+
+			throw DdsFormatUnsupportedException("The image format has no DXGI equivalent.");
+		}
+
+		//The size of a row as DDS stores it: tightly packed. For compressed formats, a row of blocks.
+		size_t CalcDdsRowSize(const ImageFormat &format, int width)
+		{
+			if(format.Type() >= DT_NUM_UNCOMPRESSED_TYPES)
+			{
+				CompressedBlockData blockData = GetBlockCompressionData(format.Type());
+				return ((width + 3) / 4) * blockData.byteCount;
+			}
+
+			return width * CalcBytesPerPixel(format);
+		}
+
+		void WriteDword(std::vector<unsigned char> &ddsData, size_t offset, DWORD value)
+		{
+			ddsData[offset + 0] = (unsigned char)(value);
+			ddsData[offset + 1] = (unsigned char)(value >> 8);
+			ddsData[offset + 2] = (unsigned char)(value >> 16);
+			ddsData[offset + 3] = (unsigned char)(value >> 24);
+		}
+
+		//The headers are written field by field, so that the file is little-endian regardless.
+		void WriteHeaders(const ImageSet *pImage, const OldDdsFmtMatch *pOldFormat,
+			std::vector<unsigned char> &ddsData)
+		{
+			const ImageFormat &format = pImage->GetFormat();
+			const Dimensions dims = pImage->GetDimensions();
+			const int mipmapCount = pImage->GetMipmapCount();
+			const bool isCompressed = format.Type() >= DT_NUM_UNCOMPRESSED_TYPES;
+
+			ddsHeader header;
+			memset(&header, 0, sizeof(header));
+			header.dwSize = sizeof(ddsHeader);
+			header.dwFlags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT;
+			header.dwWidth = dims.width;
+			header.dwHeight = dims.numDimensions > 1 ? dims.height : 1;
+			header.dwCaps = DDSCAPS_TEXTURE;
+
+			if(isCompressed)
+			{
+				header.dwFlags |= DDSD_LINEARSIZE;
+				header.dwPitchOrLinearSize = (DWORD)(CalcDdsRowSize(format, dims.width) *
+					((header.dwHeight + 3) / 4));
+			}
+			else
+			{
+				header.dwFlags |= DDSD_PITCH;
+				header.dwPitchOrLinearSize = (DWORD)CalcDdsRowSize(format, dims.width);
+			}
+
+			if(dims.numDimensions == 3)
+			{
+				header.dwFlags |= DDSD_DEPTH;
+				header.dwDepth = dims.depth;
+				header.dwCaps |= DDSCAPS_COMPLEX;
+				header.dwCaps2 |= DDSCAPS2_VOLUME;
+			}
+
+			if(mipmapCount > 1)
+			{
+				header.dwFlags |= DDSD_MIPMAPCOUNT;
+				header.dwMipMapCount = mipmapCount;
+				header.dwCaps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+			}
+
+			if(pImage->GetFaceCount() == 6)
+			{
+				header.dwCaps |= DDSCAPS_COMPLEX;
+				header.dwCaps2 |= DDSCAPS2_CUBEMAP_ALL;
+			}
+
+			header.ddspf.dwSize = sizeof(ddsPixelFormat);
+			if(pOldFormat)
+			{
+				header.ddspf.dwFlags = pOldFormat->dwFlags;
+				header.ddspf.dwFourCC = pOldFormat->fourCC;
+				if(!(pOldFormat->dwFlags & DDPF_FOURCC))
+				{
+					header.ddspf.dwRGBBitCount = (DWORD)(CalcBytesPerPixel(format) * 8);
+					header.ddspf.dwRBitMask = pOldFormat->rBitmask;
+					header.ddspf.dwGBitMask = pOldFormat->gBitmask;
+					header.ddspf.dwBBitMask = pOldFormat->bBitmask;
+					header.ddspf.dwABitMask = pOldFormat->aBitmask;
+				}
+			}
+			else
+			{
+				header.ddspf.dwFlags = DDPF_FOURCC;
+				header.ddspf.dwFourCC = DDS10_FOUR_CC;
+			}
+
+			const DWORD *pHeaderDwords = reinterpret_cast<const DWORD *>(&header);
+			size_t offset = ddsData.size();
+			ddsData.resize(offset + 4 + sizeof(ddsHeader));
+			WriteDword(ddsData, offset, DDS_MAGIC_NUMBER);
+			offset += 4;
+			for(size_t dwordIx = 0; dwordIx < sizeof(ddsHeader) / 4; ++dwordIx, offset += 4)
+				WriteDword(ddsData, offset, pHeaderDwords[dwordIx]);
+
+			if(pOldFormat)
+				return;
+
+			dds10Header header10;
+			memset(&header10, 0, sizeof(header10));
+			header10.dxgiFormat = FindDxgiFormat(format);
+			header10.resourceDimension = DDS_DIMENSION_TEXTURE1D + (dims.numDimensions - 1);
+			header10.miscFlag = pImage->GetFaceCount() == 6 ? DDS_RESOURCE_MISC_TEXTURECUBE : 0;
+			header10.arraySize = pImage->GetArrayCount();
+
+			pHeaderDwords = reinterpret_cast<const DWORD *>(&header10);
+			ddsData.resize(offset + sizeof(dds10Header));
+			for(size_t dwordIx = 0; dwordIx < sizeof(dds10Header) / 4; ++dwordIx, offset += 4)
+				WriteDword(ddsData, offset, pHeaderDwords[dwordIx]);
+		}
+
+		//DDS images are stored top-down, with rows packed tightly. The loader flips them,
+		//so flipping again undoes it.
+		void WriteImageData(const ImageSet *pImage, std::vector<unsigned char> &ddsData)
+		{
+			const ImageFormat &format = pImage->GetFormat();
+			const Dimensions dims = pImage->GetDimensions();
+			const int mipmapCount = pImage->GetMipmapCount();
+			const int faceCount = pImage->GetFaceCount();
+
+			std::vector<unsigned char> flipped;
+			for(int arrayIx = 0; arrayIx < pImage->GetArrayCount(); arrayIx++)
+			{
+				for(int faceIx = 0; faceIx < faceCount; faceIx++)
+				{
+					for(int mipmapLevel = 0; mipmapLevel < mipmapCount; mipmapLevel++)
+					{
+						Dimensions levelDims = ModifySizeForMipmap(dims, mipmapLevel);
+						size_t imageSize = CalcImageByteSize(format, levelDims);
+						const unsigned char *pLevel =
+							static_cast<const unsigned char *>(pImage->GetImageArray(mipmapLevel));
+
+						flipped.resize(imageSize);
+						FlipImageData(format, levelDims, pLevel + (arrayIx * faceCount + faceIx) * imageSize,
+							&flipped[0], imageSize);
+
+						size_t ddsRowSize = CalcDdsRowSize(format, levelDims.width);
+						size_t alignedRowSize = ddsRowSize;
+						if(format.Type() < DT_NUM_UNCOMPRESSED_TYPES)
+							alignedRowSize = format.AlignByteCount(ddsRowSize);
+
+						size_t numRows = imageSize / alignedRowSize;
+						size_t offset = ddsData.size();
+						ddsData.resize(offset + numRows * ddsRowSize);
+						for(size_t row = 0; row < numRows; ++row)
+						{
+							memcpy(&ddsData[offset + row * ddsRowSize], &flipped[row * alignedRowSize],
+								ddsRowSize);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void SaveToMemory( const ImageSet *pImage, std::vector<unsigned char> &ddsData, unsigned int flags )
+	{
+		const ImageFormat &format = pImage->GetFormat();
+		const Dimensions dims = pImage->GetDimensions();
+
+		if(dims.numDimensions == 3 && format.Type() >= DT_NUM_UNCOMPRESSED_TYPES)
+			throw DdsFormatUnsupportedException("3D images cannot be compressed.");
+
+		const OldDdsFmtMatch *pOldFormat = NULL;
+		if(!(flags & FORCE_DX10_HEADER) && pImage->GetArrayCount() == 1 && dims.numDimensions > 1)
+			pOldFormat = FindOldFormat(format);
+
+		ddsData.clear();
+		WriteHeaders(pImage, pOldFormat, ddsData);
+		WriteImageData(pImage, ddsData);
+	}
+
+	void SaveToFile( const ImageSet *pImage, const std::string &filename, unsigned int flags )
+	{
+		std::vector<unsigned char> ddsData;
+		SaveToMemory(pImage, ddsData, flags);
+
+		FILE *pFile = fopen(filename.c_str(), "wb");
+		if(!pFile)
+			throw DdsFileNotWritableException(filename);
+
+		size_t numWritten = fwrite(&ddsData[0], ddsData.size(), 1, pFile);
+		if(fclose(pFile) != 0 || numWritten != 1)
+			throw DdsFileNotWritableException(filename);
+	}
+}
+}
+}
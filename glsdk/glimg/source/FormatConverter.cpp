@@ -0,0 +1,1095 @@
+//Copyright (C) 2011 by Jason L. McKesson
+//This file is licensed by the MIT License.
+
+
+
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "glimg/ImageSet.h"
+#include "glimg/ImageCreator.h"
+#include "glimg/FormatConverter.h"
+#include "Util.h"
+#include "glimg/ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GLIMG_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace glimg
+{
+	namespace
+	{
+		enum ValueKind
+		{
+			VALUE_UNORM,
+			VALUE_SNORM,
+			VALUE_UINT,
+			VALUE_SINT,
+			VALUE_FLOAT,
+		};
+
+		//Where the components of a texel are, and what they hold.
+		struct TexelLayout
+		{
+			ValueKind kind;
+			int texelByteSize;
+			int numStored;			//Components in memory. RGBX has 4.
+			int channels[4];		//The channel (red, green, blue, alpha) of each stored component. -1 for X.
+			int compByteSize;		//1, 2 or 4. 0 for packed formats.
+			int bits[4];			//Packed formats only: the width and position of each stored component.
+			int shifts[4];
+		};
+
+		bool IsSRGB(PixelComponents components)
+		{
+			return components == FMT_COLOR_RGB_sRGB || components == FMT_COLOR_RGBX_sRGB ||
+				components == FMT_COLOR_RGBA_sRGB;
+		}
+
+		bool IsIntegral(PixelDataType eType)
+		{
+			return eType == DT_UNSIGNED_INTEGRAL || eType == DT_SIGNED_INTEGRAL;
+		}
+
+		bool IsDepth(PixelComponents components)
+		{
+			return components == FMT_DEPTH || components == FMT_DEPTH_X;
+		}
+
+		//Empty if the format can be converted.
+		std::string GetUnsupportedReason(const ImageFormat &format)
+		{
+			if(format.Type() >= DT_NUM_UNCOMPRESSED_TYPES)
+				return "Compressed images cannot be converted.";
+
+			if(format.Type() == DT_SHARED_EXP_FLOAT)
+				return "Shared-exponent images cannot be converted.";
+
+			if(format.Depth() == BD_PACKED_32_BIT_101111_REV)
+				return "BD_PACKED_32_BIT_101111_REV images cannot be converted.";
+
+			if(IsDepth(format.Components()))
+				return "Depth images cannot be converted.";
+
+			return std::string();
+		}
+
+		std::string GetUnsupportedReason(const ImageFormat &srcFormat, const ImageFormat &dstFormat)
+		{
+			std::string reason = GetUnsupportedReason(srcFormat);
+			if(reason.empty())
+				reason = GetUnsupportedReason(dstFormat);
+			if(!reason.empty())
+				return reason;
+
+			if(IsSRGB(srcFormat.Components()) != IsSRGB(dstFormat.Components()))
+				return "Images cannot be converted between the sRGB and linear colorspaces.";
+
+			if(IsIntegral(srcFormat.Type()) != IsIntegral(dstFormat.Type()))
+				return "Integral images can only be converted to and from other integral formats.";
+
+			return std::string();
+		}
+
+		void SetPackedBits(TexelLayout &layout, int bits0, int bits1, int bits2, int bits3, bool isReversed)
+		{
+			const int bits[4] = {bits0, bits1, bits2, bits3};
+			int position = isReversed ? 0 : layout.texelByteSize * 8;
+			for(int compIx = 0; compIx < 4; ++compIx)
+			{
+				layout.bits[compIx] = bits[compIx];
+				if(isReversed)
+				{
+					layout.shifts[compIx] = position;
+					position += bits[compIx];
+				}
+				else
+				{
+					position -= bits[compIx];
+					layout.shifts[compIx] = position;
+				}
+			}
+		}
+
+		TexelLayout GetTexelLayout(const ImageFormat &format)
+		{
+			TexelLayout layout;
+			switch(format.Type())
+			{
+			case DT_NORM_SIGNED_INTEGER:	layout.kind = VALUE_SNORM;	break;
+			case DT_UNSIGNED_INTEGRAL:		layout.kind = VALUE_UINT;	break;
+			case DT_SIGNED_INTEGRAL:		layout.kind = VALUE_SINT;	break;
+			case DT_FLOAT:					layout.kind = VALUE_FLOAT;	break;
+			default:						layout.kind = VALUE_UNORM;	break;
+			}
+
+			layout.texelByteSize = (int)CalcBytesPerPixel(format);
+			layout.numStored = ComponentCount(format.Components());
+
+			const int bgraChannels[4] = {2, 1, 0, 3};
+			for(int compIx = 0; compIx < 4; ++compIx)
+				layout.channels[compIx] = format.Order() == ORDER_BGRA ? bgraChannels[compIx] : compIx;
+
+			if(format.Components() == FMT_COLOR_RGBX || format.Components() == FMT_COLOR_RGBX_sRGB)
+				layout.channels[3] = -1;
+
+			layout.compByteSize = 0;
+			switch(format.Depth())
+			{
+			case BD_PACKED_16_BIT_565:			SetPackedBits(layout, 5, 6, 5, 0, false);		break;
+			case BD_PACKED_16_BIT_5551:			SetPackedBits(layout, 5, 5, 5, 1, false);		break;
+			case BD_PACKED_16_BIT_4444:			SetPackedBits(layout, 4, 4, 4, 4, false);		break;
+			case BD_PACKED_32_BIT_8888:			SetPackedBits(layout, 8, 8, 8, 8, false);		break;
+			case BD_PACKED_32_BIT_1010102:		SetPackedBits(layout, 10, 10, 10, 2, false);	break;
+			case BD_PACKED_16_BIT_565_REV:		SetPackedBits(layout, 5, 6, 5, 0, true);		break;
+			case BD_PACKED_16_BIT_1555_REV:		SetPackedBits(layout, 5, 5, 5, 1, true);		break;
+			case BD_PACKED_16_BIT_4444_REV:		SetPackedBits(layout, 4, 4, 4, 4, true);		break;
+			case BD_PACKED_32_BIT_8888_REV:		SetPackedBits(layout, 8, 8, 8, 8, true);		break;
+			case BD_PACKED_32_BIT_2101010_REV:	SetPackedBits(layout, 10, 10, 10, 2, true);		break;
+			default:
+				layout.compByteSize = layout.texelByteSize / layout.numStored;
+				break;
+			}
+
+			return layout;
+		}
+
+		//The bits of a component that holds 1, or the largest value for normalized ones.
+		unsigned int GetOneBits(const TexelLayout &layout)
+		{
+			switch(layout.kind)
+			{
+			case VALUE_UNORM:
+				return layout.compByteSize == 1 ? 0xFF : 0xFFFF;
+			case VALUE_SNORM:
+				return layout.compByteSize == 1 ? 0x7F : 0x7FFF;
+			case VALUE_FLOAT:
+				return layout.compByteSize == 2 ? 0x3C00 : 0x3F800000;
+			default:
+				return 1;
+			}
+		}
+
+		enum ConversionPath
+		{
+			PATH_COPY,			//The texels are the same; only the line alignment may differ.
+			PATH_SHUFFLE,		//The components are the same type and size, so they are moved as they are.
+			PATH_GENERAL,		//Each texel goes through floats.
+			PATH_INTEGRAL,		//Integral components of another type or size; each texel goes through doubles.
+		};
+
+		struct ConversionPlan
+		{
+			ConversionPath path;
+			TexelLayout src;
+			TexelLayout dst;
+
+			//For PATH_SHUFFLE: the source component of each destination component, or -1 for
+			//a constant. 0, or 1 for alpha and X.
+			int sources[4];
+			unsigned int constants[4];
+		};
+
+		ConversionPlan GetConversionPlan(const ImageFormat &srcFormat, const ImageFormat &dstFormat)
+		{
+			ConversionPlan plan;
+			plan.src = GetTexelLayout(srcFormat);
+			plan.dst = GetTexelLayout(dstFormat);
+
+			if(srcFormat.Type() == dstFormat.Type() && srcFormat.Components() == dstFormat.Components() &&
+				srcFormat.Order() == dstFormat.Order() && srcFormat.Depth() == dstFormat.Depth())
+			{
+				plan.path = PATH_COPY;
+				return plan;
+			}
+
+			if(plan.src.compByteSize == 0 || plan.src.kind != plan.dst.kind ||
+				plan.src.compByteSize != plan.dst.compByteSize)
+			{
+				//Integral images are only converted to integral ones.
+				const bool isIntegral = plan.src.kind == VALUE_UINT || plan.src.kind == VALUE_SINT;
+				plan.path = isIntegral ? PATH_INTEGRAL : PATH_GENERAL;
+				return plan;
+			}
+
+			plan.path = PATH_SHUFFLE;
+			for(int dstIx = 0; dstIx < plan.dst.numStored; ++dstIx)
+			{
+				const int channel = plan.dst.channels[dstIx];
+				plan.sources[dstIx] = -1;
+				plan.constants[dstIx] = (channel == 3 || channel == -1) ? GetOneBits(plan.dst) : 0;
+				if(channel == -1)
+					continue;
+
+				for(int srcIx = 0; srcIx < plan.src.numStored; ++srcIx)
+				{
+					if(plan.src.channels[srcIx] == channel)
+						plan.sources[dstIx] = srcIx;
+				}
+			}
+
+			return plan;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// SHUFFLING
+		template<typename Component>
+		void ShuffleRow(const unsigned char *pSrcRow, unsigned char *pDstRow, int firstTexel, int width,
+			const ConversionPlan &plan)
+		{
+			const int srcStride = plan.src.numStored;
+			const int dstStride = plan.dst.numStored;
+			const Component *pSrc = reinterpret_cast<const Component *>(pSrcRow) + firstTexel * srcStride;
+			Component *pDst = reinterpret_cast<Component *>(pDstRow) + firstTexel * dstStride;
+
+			for(int texelIx = firstTexel; texelIx < width; ++texelIx)
+			{
+				for(int dstIx = 0; dstIx < dstStride; ++dstIx)
+				{
+					const int srcIx = plan.sources[dstIx];
+					pDst[dstIx] = srcIx < 0 ? (Component)plan.constants[dstIx] : pSrc[srcIx];
+				}
+
+				pSrc += srcStride;
+				pDst += dstStride;
+			}
+		}
+
+#ifdef GLIMG_USE_SSE2
+		int LoadTexelBytes(const unsigned char *pSrc)
+		{
+			int texel;
+			memcpy(&texel, pSrc, sizeof(texel));
+			return texel;
+		}
+
+		//Shuffles the 8-bit components of 4-component destination texels, four at a time. Each
+		//texel is one 32-bit lane. Destination components that move by the same number of bytes
+		//are masked and shifted together, so a swap of red and blue takes three groups, and
+		//RGB to RGBX takes one plus the constant alpha.
+		//
+		//Returns the number of texels done; the rest are left to ShuffleRow.
+		int ShuffleBytesSse2(const unsigned char *pSrcRow, unsigned char *pDstRow, int width,
+			const ConversionPlan &plan)
+		{
+			const int srcStride = plan.src.numStored;
+			if(plan.dst.numStored != 4 || srcStride < 3)
+				return 0;
+
+			unsigned int constant = 0;
+			unsigned int groupMasks[7] = {0};	//Indexed by the shift in bytes, plus 3.
+			for(int dstIx = 0; dstIx < 4; ++dstIx)
+			{
+				const int srcIx = plan.sources[dstIx];
+				if(srcIx < 0)
+					constant |= plan.constants[dstIx] << (8 * dstIx);
+				else
+					groupMasks[dstIx - srcIx + 3] |= 0xFFu << (8 * srcIx);
+			}
+
+			int numGroups = 0;
+			__m128i masks[4];
+			__m128i leftShifts[4];
+			__m128i rightShifts[4];
+			for(int shiftIx = 0; shiftIx < 7; ++shiftIx)
+			{
+				if(!groupMasks[shiftIx])
+					continue;
+
+				const int byteShift = shiftIx - 3;
+				masks[numGroups] = _mm_set1_epi32((int)groupMasks[shiftIx]);
+				leftShifts[numGroups] = _mm_cvtsi32_si128(byteShift > 0 ? 8 * byteShift : 0);
+				rightShifts[numGroups] = _mm_cvtsi32_si128(byteShift < 0 ? -8 * byteShift : 0);
+				++numGroups;
+			}
+
+			const __m128i constants = _mm_set1_epi32((int)constant);
+
+			//Three-byte texels are loaded four bytes at a time, so the last texel of the row
+			//must not be loaded this way.
+			const int lastTexel = srcStride == 3 ? width - 1 : width;
+			int texelIx = 0;
+			for(; texelIx + 4 <= lastTexel; texelIx += 4)
+			{
+				const unsigned char *pSrc = pSrcRow + texelIx * srcStride;
+				__m128i texels;
+				if(srcStride == 4)
+					texels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc));
+				else
+				{
+					texels = _mm_set_epi32(LoadTexelBytes(pSrc + 9), LoadTexelBytes(pSrc + 6),
+						LoadTexelBytes(pSrc + 3), LoadTexelBytes(pSrc));
+				}
+
+				__m128i result = constants;
+				for(int groupIx = 0; groupIx < numGroups; ++groupIx)
+				{
+					__m128i group = _mm_and_si128(texels, masks[groupIx]);
+					group = _mm_sll_epi32(group, leftShifts[groupIx]);
+					group = _mm_srl_epi32(group, rightShifts[groupIx]);
+					result = _mm_or_si128(result, group);
+				}
+
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(pDstRow + texelIx * 4), result);
+			}
+
+			return texelIx;
+		}
+#endif //GLIMG_USE_SSE2
+
+		void ShuffleBytes(const unsigned char *pSrcRow, unsigned char *pDstRow, int width,
+			const ConversionPlan &plan)
+		{
+			int firstTexel = 0;
+#ifdef GLIMG_USE_SSE2
+			firstTexel = ShuffleBytesSse2(pSrcRow, pDstRow, width, plan);
+#endif
+			ShuffleRow<unsigned char>(pSrcRow, pDstRow, firstTexel, width, plan);
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// GENERAL CONVERSION
+		float HalfToFloat(unsigned short half)
+		{
+			const unsigned int sign = (half & 0x8000u) << 16;
+			const unsigned int exponent = (half >> 10) & 0x1F;
+			const unsigned int mantissa = half & 0x3FF;
+
+			unsigned int bits = sign;
+			if(exponent == 0x1F)
+				bits |= 0x7F800000 | (mantissa << 13);
+			else if(exponent != 0)
+				bits |= ((exponent + 112) << 23) | (mantissa << 13);
+			else if(mantissa != 0)
+			{
+				//Denormals are a multiple of 2^-24.
+				const float value = mantissa * (1.0f / 16777216.0f);
+				return sign ? -value : value;
+			}
+
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		//Rounds to the nearest half, ties to even. Finite values beyond the largest half, 65504,
+		//are clamped to it; infinities and NaNs stay what they are.
+		unsigned short FloatToHalf(float value)
+		{
+			unsigned int bits;
+			memcpy(&bits, &value, sizeof(bits));
+			const unsigned int sign = (bits >> 16) & 0x8000;
+			const unsigned int absBits = bits & 0x7FFFFFFF;
+
+			//Infinity and NaN.
+			if(absBits >= 0x7F800000)
+				return (unsigned short)(sign | 0x7C00 | (absBits > 0x7F800000 ? 0x200 : 0));
+
+			//At least the largest half. Rounding would make the ones past 65520 infinite.
+			if(absBits >= 0x477FE000)
+				return (unsigned short)(sign | 0x7BFF);
+
+			//At most half the smallest denormal.
+			if(absBits <= 0x33000000)
+				return (unsigned short)sign;
+
+			unsigned int half = 0;
+			unsigned int remainder = 0;
+			unsigned int halfway = 0;
+			if(absBits < 0x38800000)
+			{
+				const unsigned int shift = 126 - (absBits >> 23);
+				const unsigned int mantissa = (absBits & 0x7FFFFF) | 0x800000;
+				half = mantissa >> shift;
+				remainder = mantissa & ((1u << shift) - 1);
+				halfway = 1u << (shift - 1);
+			}
+			else
+			{
+				half = (absBits >> 13) - (112 << 10);
+				remainder = absBits & 0x1FFF;
+				halfway = 0x1000;
+			}
+
+			//A carry out of the mantissa correctly moves to the next exponent.
+			if(remainder > halfway || (remainder == halfway && (half & 1)))
+				++half;
+
+			return (unsigned short)(sign | half);
+		}
+
+#ifdef GLIMG_USE_SSE2
+		//FloatToHalf for four values at once, with the same results. Normal halves round by
+		//adding to the bits, denormal ones by letting a float addition do it.
+		__m128i FloatToHalfSse2(__m128 values)
+		{
+			const __m128i minNormal = _mm_set1_epi32(0x38800000);
+			const __m128i infinity = _mm_set1_epi32(0x7F800000);
+			const __m128i denormalMagic = _mm_set1_epi32(0x3F000000);
+			const __m128i normalBias = _mm_set1_epi32(0xFFF - (112 << 23));
+
+			const __m128 sign = _mm_and_ps(values, _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u)));
+			const __m128 absValues = _mm_xor_ps(values, sign);
+
+			const __m128i isNaN = _mm_castps_si128(_mm_cmpunord_ps(absValues, absValues));
+			const __m128i isFinite = _mm_cmpgt_epi32(infinity, _mm_castps_si128(absValues));
+
+			//Finite values are clamped to the largest half first, so that they cannot round up to infinity.
+			const __m128 clampedValues = _mm_min_ps(absValues, _mm_set1_ps(65504.0f));
+			const __m128i absBits = _mm_castps_si128(clampedValues);
+			const __m128i isDenormal = _mm_cmpgt_epi32(minNormal, absBits);
+			const __m128i special = _mm_or_si128(_mm_set1_epi32(0x7C00), _mm_and_si128(isNaN, _mm_set1_epi32(0x200)));
+
+			const __m128i denormal = _mm_sub_epi32(_mm_castps_si128(
+				_mm_add_ps(clampedValues, _mm_castsi128_ps(denormalMagic))), denormalMagic);
+
+			//Ties go up only if the kept mantissa is odd.
+			const __m128i isOdd = _mm_srai_epi32(_mm_slli_epi32(absBits, 18), 31);
+			const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absBits, normalBias), isOdd), 13);
+
+			__m128i halves = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+			halves = _mm_or_si128(_mm_and_si128(isFinite, halves), _mm_andnot_si128(isFinite, special));
+			return _mm_or_si128(halves, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+		}
+
+		//Encodes 4-component half-float texels, one texel per vector.
+		void EncodeHalfTexelsSse2(const float *pValues, int width, const TexelLayout &layout,
+			unsigned char *pDstRow)
+		{
+			//Values are in RGBA order; X components hold 1.
+			const bool isRGBA = layout.channels[0] == 0 && layout.channels[1] == 1 &&
+				layout.channels[2] == 2 && layout.channels[3] == 3;
+			const int channels[4] = {layout.channels[0], layout.channels[1], layout.channels[2],
+				layout.channels[3] < 0 ? 4 : layout.channels[3]};
+
+			for(int texelIx = 0; texelIx < width; ++texelIx)
+			{
+				const float *pTexelValues = pValues + texelIx * 4;
+				__m128 texel;
+				if(isRGBA)
+					texel = _mm_loadu_ps(pTexelValues);
+				else
+				{
+					const float values[5] = {pTexelValues[0], pTexelValues[1], pTexelValues[2],
+						pTexelValues[3], 1.0f};
+					texel = _mm_set_ps(values[channels[3]], values[channels[2]], values[channels[1]],
+						values[channels[0]]);
+				}
+
+				//Halves are offset into the signed range, so that the saturating pack keeps them.
+				const __m128i halves = FloatToHalfSse2(texel);
+				const __m128i packed = _mm_packs_epi32(_mm_sub_epi32(halves, _mm_set1_epi32(0x8000)),
+					_mm_setzero_si128());
+				_mm_storel_epi64(reinterpret_cast<__m128i *>(pDstRow + texelIx * 8),
+					_mm_xor_si128(packed, _mm_set1_epi16((short)0x8000)));
+			}
+		}
+#endif //GLIMG_USE_SSE2
+
+		//Integral values go through DecodeIntegral and EncodeIntegral instead.
+		float DecodeValue(const unsigned char *pValue, ValueKind kind, int byteSize)
+		{
+			switch(byteSize)
+			{
+			case 1:
+				switch(kind)
+				{
+				case VALUE_SNORM:	return std::max(*reinterpret_cast<const signed char *>(pValue) / 127.0f, -1.0f);
+				default:			return *pValue / 255.0f;
+				}
+			case 2:
+				{
+					unsigned short value;
+					memcpy(&value, pValue, sizeof(value));
+					switch(kind)
+					{
+					case VALUE_UNORM:	return value / 65535.0f;
+					case VALUE_SNORM:	return std::max((short)value / 32767.0f, -1.0f);
+					default:			return HalfToFloat(value);
+					}
+				}
+			default:
+				{
+					unsigned int value;
+					memcpy(&value, pValue, sizeof(value));
+					switch(kind)
+					{
+					case VALUE_FLOAT:
+						{
+							float floatValue;
+							memcpy(&floatValue, &value, sizeof(floatValue));
+							return floatValue;
+						}
+					default:			return (float)value;
+					}
+				}
+			}
+		}
+
+		//NaN becomes the low end.
+		double Clamp(double value, double low, double high)
+		{
+			if(!(value > low))
+				return low;
+			return value < high ? value : high;
+		}
+
+		double RoundNearest(double value)
+		{
+			return floor(value + 0.5);
+		}
+
+		//The common case, kept in floats: normalized values never need more than 16 bits.
+		unsigned int EncodeUnorm(float value, float maxValue)
+		{
+			if(!(value > 0.0f))
+				return 0;
+			return (unsigned int)((value < 1.0f ? value : 1.0f) * maxValue + 0.5f);
+		}
+
+		void StoreValueBits(unsigned int bits, int byteSize, unsigned char *pValue)
+		{
+			switch(byteSize)
+			{
+			case 1:
+				*pValue = (unsigned char)bits;
+				break;
+			case 2:
+				{
+					const unsigned short shortBits = (unsigned short)bits;
+					memcpy(pValue, &shortBits, sizeof(shortBits));
+				}
+				break;
+			default:
+				memcpy(pValue, &bits, sizeof(bits));
+				break;
+			}
+		}
+
+		void EncodeValue(float value, ValueKind kind, int byteSize, unsigned char *pValue)
+		{
+			unsigned int bits = 0;
+			switch(kind)
+			{
+			case VALUE_UNORM:
+				{
+					bits = EncodeUnorm(value, byteSize == 1 ? 255.0f : 65535.0f);
+				}
+				break;
+			case VALUE_SNORM:
+				{
+					const double maxValue = byteSize == 1 ? 127.0 : 32767.0;
+					bits = (unsigned int)(int)RoundNearest(Clamp(value, -1.0, 1.0) * maxValue);
+				}
+				break;
+			default:
+				if(byteSize == 2)
+					bits = FloatToHalf(value);
+				else
+					memcpy(&bits, &value, sizeof(bits));
+				break;
+			}
+
+			StoreValueBits(bits, byteSize, pValue);
+		}
+
+		unsigned int LoadPackedTexel(const unsigned char *pTexel, int texelByteSize)
+		{
+			if(texelByteSize == 2)
+			{
+				unsigned short texel;
+				memcpy(&texel, pTexel, sizeof(texel));
+				return texel;
+			}
+
+			unsigned int texel;
+			memcpy(&texel, pTexel, sizeof(texel));
+			return texel;
+		}
+
+		void StorePackedTexel(unsigned int texel, unsigned char *pTexel, int texelByteSize)
+		{
+			if(texelByteSize == 2)
+			{
+				const unsigned short shortTexel = (unsigned short)texel;
+				memcpy(pTexel, &shortTexel, sizeof(shortTexel));
+			}
+			else
+				memcpy(pTexel, &texel, sizeof(texel));
+		}
+
+		//Rows are decoded and encoded one component at a time, so that the choice of kind
+		//and size is made once per row rather than once per value.
+		template<typename Value>
+		void DecodeNormComponents(const unsigned char *pSrc, int width, int texelByteSize,
+			float scale, float low, float *pValues)
+		{
+			for(int texelIx = 0; texelIx < width; ++texelIx)
+			{
+				Value value;
+				memcpy(&value, pSrc + texelIx * texelByteSize, sizeof(value));
+				pValues[texelIx * 4] = std::max(value * scale, low);
+			}
+		}
+
+		void DecodeComponents(const unsigned char *pSrc, int width, const TexelLayout &layout,
+			float *pValues)
+		{
+			const int texelByteSize = layout.texelByteSize;
+			switch(layout.kind)
+			{
+			case VALUE_UNORM:
+				if(layout.compByteSize == 1)
+					DecodeNormComponents<unsigned char>(pSrc, width, texelByteSize, 1.0f / 255.0f, 0.0f, pValues);
+				else
+					DecodeNormComponents<unsigned short>(pSrc, width, texelByteSize, 1.0f / 65535.0f, 0.0f, pValues);
+				return;
+			case VALUE_SNORM:
+				if(layout.compByteSize == 1)
+					DecodeNormComponents<signed char>(pSrc, width, texelByteSize, 1.0f / 127.0f, -1.0f, pValues);
+				else
+					DecodeNormComponents<short>(pSrc, width, texelByteSize, 1.0f / 32767.0f, -1.0f, pValues);
+				return;
+			default:
+				for(int texelIx = 0; texelIx < width; ++texelIx)
+				{
+					pValues[texelIx * 4] = DecodeValue(pSrc + texelIx * texelByteSize,
+						layout.kind, layout.compByteSize);
+				}
+				return;
+			}
+		}
+
+		void DecodePackedComponent(const unsigned char *pSrc, int width, int texelByteSize,
+			int shift, int bits, float *pValues)
+		{
+			const unsigned int maxValue = (1u << bits) - 1;
+			const float scale = 1.0f / maxValue;
+			for(int texelIx = 0; texelIx < width; ++texelIx)
+			{
+				const unsigned int texel = LoadPackedTexel(pSrc + texelIx * texelByteSize, texelByteSize);
+				pValues[texelIx * 4] = ((texel >> shift) & maxValue) * scale;
+			}
+		}
+
+		//Fills pValues with the red, green, blue and alpha of each texel.
+		void DecodeRow(const unsigned char *pSrcRow, int width, const TexelLayout &layout, float *pValues)
+		{
+			bool hasChannel[4] = {false, false, false, false};
+			for(int compIx = 0; compIx < layout.numStored; ++compIx)
+			{
+				const int channel = layout.channels[compIx];
+				if(channel < 0)
+					continue;
+
+				hasChannel[channel] = true;
+				if(layout.compByteSize == 0)
+				{
+					DecodePackedComponent(pSrcRow, width, layout.texelByteSize, layout.shifts[compIx],
+						layout.bits[compIx], pValues + channel);
+				}
+				else
+				{
+					DecodeComponents(pSrcRow + compIx * layout.compByteSize, width, layout,
+						pValues + channel);
+				}
+			}
+
+			for(int channel = 0; channel < 4; ++channel)
+			{
+				if(hasChannel[channel])
+					continue;
+
+				const float value = channel == 3 ? 1.0f : 0.0f;
+				for(int texelIx = 0; texelIx < width; ++texelIx)
+					pValues[texelIx * 4 + channel] = value;
+			}
+		}
+
+		template<typename Value>
+		void EncodeUnormComponents(const float *pValues, int width, int texelByteSize, float maxValue,
+			unsigned char *pDst)
+		{
+			for(int texelIx = 0; texelIx < width; ++texelIx)
+			{
+				const Value value = (Value)EncodeUnorm(pValues[texelIx * 4], maxValue);
+				memcpy(pDst + texelIx * texelByteSize, &value, sizeof(value));
+			}
+		}
+
+		void EncodeComponents(const float *pValues, int width, const TexelLayout &layout,
+			unsigned char *pDst)
+		{
+			const int texelByteSize = layout.texelByteSize;
+			if(layout.kind == VALUE_UNORM)
+			{
+				if(layout.compByteSize == 1)
+					EncodeUnormComponents<unsigned char>(pValues, width, texelByteSize, 255.0f, pDst);
+				else
+					EncodeUnormComponents<unsigned short>(pValues, width, texelByteSize, 65535.0f, pDst);
+				return;
+			}
+
+			for(int texelIx = 0; texelIx < width; ++texelIx)
+			{
+				EncodeValue(pValues[texelIx * 4], layout.kind, layout.compByteSize,
+					pDst + texelIx * texelByteSize);
+			}
+		}
+
+		void EncodeRow(const float *pValues, int width, const TexelLayout &layout, unsigned char *pDstRow)
+		{
+			//X components hold 1.
+			const float one = 1.0f;
+
+#ifdef GLIMG_USE_SSE2
+			if(layout.kind == VALUE_FLOAT && layout.compByteSize == 2 && layout.numStored == 4)
+			{
+				EncodeHalfTexelsSse2(pValues, width, layout, pDstRow);
+				return;
+			}
+#endif
+
+			if(layout.compByteSize == 0)
+			{
+				float maxValues[4];
+				for(int compIx = 0; compIx < layout.numStored; ++compIx)
+					maxValues[compIx] = (float)((1u << layout.bits[compIx]) - 1);
+
+				for(int texelIx = 0; texelIx < width; ++texelIx)
+				{
+					const float *pTexelValues = pValues + texelIx * 4;
+					unsigned int texel = 0;
+					for(int compIx = 0; compIx < layout.numStored; ++compIx)
+					{
+						const int channel = layout.channels[compIx];
+						const float value = channel < 0 ? one : pTexelValues[channel];
+						texel |= EncodeUnorm(value, maxValues[compIx]) << layout.shifts[compIx];
+					}
+
+					StorePackedTexel(texel, pDstRow + texelIx * layout.texelByteSize, layout.texelByteSize);
+				}
+				return;
+			}
+
+			for(int compIx = 0; compIx < layout.numStored; ++compIx)
+			{
+				unsigned char *pDst = pDstRow + compIx * layout.compByteSize;
+				const int channel = layout.channels[compIx];
+				if(channel >= 0)
+				{
+					EncodeComponents(pValues + channel, width, layout, pDst);
+					continue;
+				}
+
+				unsigned char oneBits[4];
+				EncodeValue(one, layout.kind, layout.compByteSize, oneBits);
+				for(int texelIx = 0; texelIx < width; ++texelIx)
+					memcpy(pDst + texelIx * layout.texelByteSize, oneBits, layout.compByteSize);
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// INTEGRAL CONVERSION
+		//Integral values are numbers rather than fractions, and 32-bit ones do not fit in a
+		//float's 24-bit mantissa. Doubles hold every one of them exactly.
+		double DecodeIntegral(const unsigned char *pValue, ValueKind kind, int byteSize)
+		{
+			switch(byteSize)
+			{
+			case 1:
+				return kind == VALUE_SINT ? *reinterpret_cast<const signed char *>(pValue) : *pValue;
+			case 2:
+				{
+					unsigned short value;
+					memcpy(&value, pValue, sizeof(value));
+					return kind == VALUE_SINT ? (short)value : value;
+				}
+			default:
+				{
+					unsigned int value;
+					memcpy(&value, pValue, sizeof(value));
+					return kind == VALUE_SINT ? (double)(int)value : (double)value;
+				}
+			}
+		}
+
+		//Values outside of the destination's range are clamped to it.
+		void EncodeIntegral(double value, ValueKind kind, int byteSize, unsigned char *pValue)
+		{
+			unsigned int bits = 0;
+			if(kind == VALUE_UINT)
+			{
+				const double maxValue = byteSize == 1 ? 255.0 : (byteSize == 2 ? 65535.0 : 4294967295.0);
+				bits = (unsigned int)Clamp(value, 0.0, maxValue);
+			}
+			else
+			{
+				const double maxValue = byteSize == 1 ? 127.0 : (byteSize == 2 ? 32767.0 : 2147483647.0);
+				bits = (unsigned int)(int)Clamp(value, -maxValue - 1.0, maxValue);
+			}
+
+			StoreValueBits(bits, byteSize, pValue);
+		}
+
+		//Integral formats are never packed. Missing channels are 0, or 1 for alpha.
+		void DecodeIntegralRow(const unsigned char *pSrcRow, int width, const TexelLayout &layout,
+			double *pValues)
+		{
+			for(int texelIx = 0; texelIx < width; ++texelIx)
+			{
+				const unsigned char *pTexel = pSrcRow + texelIx * layout.texelByteSize;
+				double *pTexelValues = pValues + texelIx * 4;
+				pTexelValues[0] = pTexelValues[1] = pTexelValues[2] = 0.0;
+				pTexelValues[3] = 1.0;
+				for(int compIx = 0; compIx < layout.numStored; ++compIx)
+				{
+					const int channel = layout.channels[compIx];
+					if(channel >= 0)
+					{
+						pTexelValues[channel] = DecodeIntegral(pTexel + compIx * layout.compByteSize,
+							layout.kind, layout.compByteSize);
+					}
+				}
+			}
+		}
+
+		void EncodeIntegralRow(const double *pValues, int width, const TexelLayout &layout,
+			unsigned char *pDstRow)
+		{
+			for(int texelIx = 0; texelIx < width; ++texelIx)
+			{
+				unsigned char *pTexel = pDstRow + texelIx * layout.texelByteSize;
+				const double *pTexelValues = pValues + texelIx * 4;
+				for(int compIx = 0; compIx < layout.numStored; ++compIx)
+				{
+					//X components hold 1.
+					const int channel = layout.channels[compIx];
+					EncodeIntegral(channel < 0 ? 1.0 : pTexelValues[channel], layout.kind,
+						layout.compByteSize, pTexel + compIx * layout.compByteSize);
+				}
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		/// THE TASK
+		struct ImageToConvert
+		{
+			const unsigned char *pSrc;
+			unsigned char *pDst;
+			int width;
+			int numRows;			//Every row of every slice.
+			size_t srcRowPitch;
+			size_t dstRowPitch;
+		};
+
+		struct RowBand
+		{
+			int imageIx;
+			int firstRow;
+			int numRows;
+		};
+
+		//Images are split into bands of rows of about this many destination bytes.
+		const size_t BAND_BYTE_SIZE = 256 * 1024;
+
+		//Less data than this is converted on the calling thread; waking the others costs more.
+		const size_t MIN_PARALLEL_BYTE_SIZE = 1024 * 1024;
+
+		class ConversionTask : public ParallelTask
+		{
+		public:
+			explicit ConversionTask(const ConversionPlan &plan)
+				: m_plan(plan)
+				, m_totalByteSize(0)
+			{}
+
+			void AddImage(const ImageToConvert &image)
+			{
+				m_images.push_back(image);
+				m_totalByteSize += image.dstRowPitch * image.numRows;
+
+				const int rowsPerBand = (int)std::max<size_t>(BAND_BYTE_SIZE / image.dstRowPitch, 1);
+				for(int firstRow = 0; firstRow < image.numRows; firstRow += rowsPerBand)
+				{
+					RowBand band = {(int)m_images.size() - 1, firstRow,
+						std::min(rowsPerBand, image.numRows - firstRow)};
+					m_bands.push_back(band);
+				}
+			}
+
+			int GetNumItems() const {return (int)m_bands.size();}
+			size_t GetTotalByteSize() const {return m_totalByteSize;}
+
+			virtual void Execute(int itemIx)
+			{
+				const RowBand &band = m_bands[itemIx];
+				const ImageToConvert &image = m_images[band.imageIx];
+
+				std::vector<float> values;
+				std::vector<double> integralValues;
+				if(m_plan.path == PATH_GENERAL)
+					values.resize(image.width * 4);
+				else if(m_plan.path == PATH_INTEGRAL)
+					integralValues.resize(image.width * 4);
+
+				for(int row = band.firstRow; row < band.firstRow + band.numRows; ++row)
+				{
+					const unsigned char *pSrcRow = image.pSrc + row * image.srcRowPitch;
+					unsigned char *pDstRow = image.pDst + row * image.dstRowPitch;
+					switch(m_plan.path)
+					{
+					case PATH_COPY:
+						memcpy(pDstRow, pSrcRow, image.width * m_plan.src.texelByteSize);
+						break;
+					case PATH_SHUFFLE:
+						switch(m_plan.src.compByteSize)
+						{
+						case 1:
+							ShuffleBytes(pSrcRow, pDstRow, image.width, m_plan);
+							break;
+						case 2:
+							ShuffleRow<unsigned short>(pSrcRow, pDstRow, 0, image.width, m_plan);
+							break;
+						default:
+							ShuffleRow<unsigned int>(pSrcRow, pDstRow, 0, image.width, m_plan);
+							break;
+						}
+						break;
+					case PATH_GENERAL:
+						DecodeRow(pSrcRow, image.width, m_plan.src, &values[0]);
+						EncodeRow(&values[0], image.width, m_plan.dst, pDstRow);
+						break;
+					case PATH_INTEGRAL:
+						DecodeIntegralRow(pSrcRow, image.width, m_plan.src, &integralValues[0]);
+						EncodeIntegralRow(&integralValues[0], image.width, m_plan.dst, pDstRow);
+						break;
+					}
+				}
+			}
+
+		private:
+			const ConversionPlan &m_plan;
+			size_t m_totalByteSize;
+			std::vector<ImageToConvert> m_images;
+			std::vector<RowBand> m_bands;
+		};
+
+		int GetRowCount(const Dimensions &dims)
+		{
+			int numRows = dims.numDimensions > 1 ? dims.height : 1;
+			if(dims.numDimensions == 3)
+				numRows *= dims.depth;
+			return numRows;
+		}
+	}
+
+	bool CanConvertFormat( const ImageFormat &srcFormat, const ImageFormat &dstFormat )
+	{
+		return GetUnsupportedReason(srcFormat, dstFormat).empty();
+	}
+
+	ImageFormat GetNativeFormat( const ImageFormat &format )
+	{
+		UncheckedImageFormat native = format.GetUncheckedFormat();
+		if(native.eFormat != FMT_COLOR_RGB && native.eFormat != FMT_COLOR_RGB_sRGB)
+			return format;
+
+		switch(native.eBitdepth)
+		{
+		case BD_PER_COMP_8:
+		case BD_PER_COMP_16:
+		case BD_PER_COMP_32:
+			break;
+		case BD_PACKED_16_BIT_565:
+		case BD_PACKED_16_BIT_565_REV:
+			native.eBitdepth = BD_PER_COMP_8;
+			break;
+		default:
+			//Compressed, shared-exponent and 11/11/10 float formats are stored as they are.
+			return format;
+		}
+
+		native.eFormat = native.eFormat == FMT_COLOR_RGB ? FMT_COLOR_RGBX : FMT_COLOR_RGBX_sRGB;
+		return native;
+	}
+
+	ImageFormat GetColorRenderableFormat( const ImageFormat &format )
+	{
+		if(format.Type() >= DT_NUM_UNCOMPRESSED_TYPES)
+			throw ConversionUnsupportedException("Compressed formats are not color-renderable.");
+
+		if(format.Type() == DT_NORM_SIGNED_INTEGER)
+			throw ConversionUnsupportedException("Signed normalized formats are not required to be color-renderable.");
+
+		if(format.Type() == DT_SHARED_EXP_FLOAT)
+			throw ConversionUnsupportedException("Shared-exponent formats are not color-renderable.");
+
+		if(IsDepth(format.Components()))
+			throw ConversionUnsupportedException("Depth formats are not color formats.");
+
+		return GetNativeFormat(format);
+	}
+
+	ImageSet *ConvertImage( const ImageSet &imageSet, const ImageFormat &dstFormat, int numThreads )
+	{
+		const ImageFormat &srcFormat = imageSet.GetFormat();
+		std::string reason = GetUnsupportedReason(srcFormat, dstFormat);
+		if(!reason.empty())
+			throw ConversionUnsupportedException(reason);
+
+		const ConversionPlan plan = GetConversionPlan(srcFormat, dstFormat);
+		const Dimensions baseDims = imageSet.GetDimensions();
+		const int mipmapCount = imageSet.GetMipmapCount();
+		const int numImages = imageSet.GetArrayCount() * imageSet.GetFaceCount();
+
+		ConversionTask task(plan);
+		std::vector<ImageBuffer> levelData(mipmapCount);
+		for(int level = 0; level < mipmapCount; ++level)
+		{
+			Dimensions levelDims = ModifySizeForMipmap(baseDims, level);
+			size_t srcImageSize = CalcImageByteSize(srcFormat, levelDims);
+			size_t dstImageSize = CalcImageByteSize(dstFormat, levelDims);
+			levelData[level].resize(dstImageSize * numImages);
+
+			const unsigned char *pSrcLevel = static_cast<const unsigned char *>(imageSet.GetImageArray(level));
+			for(int imageIx = 0; imageIx < numImages; ++imageIx)
+			{
+				ImageToConvert image;
+				image.pSrc = pSrcLevel + imageIx * srcImageSize;
+				image.pDst = &levelData[level][0] + imageIx * dstImageSize;
+				image.width = levelDims.width;
+				image.numRows = GetRowCount(levelDims);
+				image.srcRowPitch = srcFormat.AlignByteCount(plan.src.texelByteSize * levelDims.width);
+				image.dstRowPitch = dstFormat.AlignByteCount(plan.dst.texelByteSize * levelDims.width);
+				task.AddImage(image);
+			}
+		}
+
+		if(numThreads == 1 || task.GetTotalByteSize() < MIN_PARALLEL_BYTE_SIZE)
+		{
+			for(int itemIx = 0; itemIx < task.GetNumItems(); ++itemIx)
+				task.Execute(itemIx);
+		}
+		else
+		{
+			std::auto_ptr<ThreadPool> pOwnPool;
+			if(numThreads > 0)
+				pOwnPool.reset(new ThreadPool(numThreads));
+			ThreadPool &pool = pOwnPool.get() ? *pOwnPool : GetSharedThreadPool();
+
+			pool.ParallelFor(task, task.GetNumItems());
+		}
+
+		ImageCreator creator(dstFormat, baseDims, mipmapCount, imageSet.GetArrayCount(),
+			imageSet.GetFaceCount());
+		for(int level = 0; level < mipmapCount; ++level)
+			creator.SetFullMipmapLevel(&levelData[level][0], false, level);
+
+		return creator.CreateImage();
+	}
+}
@@ -6,11 +6,19 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
+#include <memory>
 #include <algorithm>
 #include "glimg/ImageSet.h"
 #include "glimg/ImageCreator.h"
 #include "ImageSetImpl.h"
 #include "Util.h"
+#include "glimg/ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GLIMG_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace glimg
 {
@@ -49,28 +57,21 @@ namespace glimg
 
 	namespace
 	{
-		//Returns a pointer to the next image.
-		const void * CopyPixelsFlipped( unsigned char * pMipmapData, const Dimensions &dims,
-			const ImageFormat &format, int mipmapLevel, const void * pixelData, int imageSize )
+		//Copies rows [firstRow, firstRow + numRows) of the destination from the matching rows
+		//counted from the bottom of the source. Rows are lines of pixels.
+		void CopyPixelRowsFlipped(unsigned char *pDstData, const void *pixelData, size_t lineByteSize,
+			size_t numLines, size_t firstRow, size_t numRows)
 		{
-			//Flip the data. Copy line by line.
-			size_t numLines = dims.NumLines();
-			size_t lineByteSize = format.AlignByteCount(CalcBytesPerPixel(format) * dims.width);
-
-			//Move the pixel data to the last row.
 			const unsigned char *pInputRow = static_cast<const unsigned char *>(pixelData);
-			pInputRow += imageSize;
-			pInputRow -= lineByteSize;
-			for(size_t line = 0; line < numLines; ++line)
+			pInputRow += (numLines - 1 - firstRow) * lineByteSize;
+			pDstData += firstRow * lineByteSize;
+			for(size_t line = 0; line < numRows; ++line)
 			{
-				memcpy(pMipmapData, pInputRow, lineByteSize);
-				pMipmapData += lineByteSize;
+				memcpy(pDstData, pInputRow, lineByteSize);
+				pDstData += lineByteSize;
 				pInputRow -= lineByteSize;
 			}
-
-			return static_cast<const unsigned char *>(pixelData) + imageSize;
 		}
-
 		void CopyBlockBC1Flipped(unsigned char * pDst, const unsigned char * pSrc)
 		{
 			//First 4 bytes are 2 16-bit colors. Keep them the same.
@@ -176,70 +177,322 @@ namespace glimg
 			CopyBlockS3TCAlphaFlipped(pDst + 8, pSrc + 8);
 		}
 
+#ifdef GLIMG_USE_SSE2
+		//The block flips below, done on both 64-bit halves of a register at once.
+		//Each half is taken as a little-endian integer, so the rows of indices are
+		//bit fields that can be moved with shifts and masks.
+		inline __m128i Mask64(unsigned int highBits, unsigned int lowBits)
+		{
+			return _mm_set_epi32((int)highBits, (int)lowBits, (int)highBits, (int)lowBits);
+		}
 
-		template<typename FlipFunc>
-		const void *CopyBCFlipped(unsigned char *pMipmapData, const Dimensions &dims,
-			const ImageFormat &format, int mipmapLevel, const void *pixelData, int imageSize, FlipFunc FlippingFunc)
+		//BC1 colors: 2 16-bit colors, then 4 rows of 8 bits of indices.
+		inline __m128i FlipColorHalves(__m128i blocks)
 		{
-			//No support for 3D compressed formats.
-			assert(dims.numDimensions != 3);
+			__m128i result = _mm_and_si128(blocks, Mask64(0x00000000, 0xFFFFFFFF));
+			result = _mm_or_si128(result, _mm_and_si128(_mm_srli_epi64(blocks, 24), Mask64(0x000000FF, 0)));
+			result = _mm_or_si128(result, _mm_and_si128(_mm_srli_epi64(blocks, 8), Mask64(0x0000FF00, 0)));
+			result = _mm_or_si128(result, _mm_and_si128(_mm_slli_epi64(blocks, 8), Mask64(0x00FF0000, 0)));
+			result = _mm_or_si128(result, _mm_and_si128(_mm_slli_epi64(blocks, 24), Mask64(0xFF000000, 0)));
+			return result;
+		}
+
+		//BC3 alpha, BC4 and BC5: 2 8-bit values, then 4 rows of 12 bits of indices.
+		inline __m128i FlipAlphaHalves(__m128i blocks)
+		{
+			__m128i result = _mm_and_si128(blocks, Mask64(0x00000000, 0x0000FFFF));
+			result = _mm_or_si128(result, _mm_and_si128(_mm_srli_epi64(blocks, 36), Mask64(0x00000000, 0x0FFF0000)));
+			result = _mm_or_si128(result, _mm_and_si128(_mm_srli_epi64(blocks, 12), Mask64(0x000000FF, 0xF0000000)));
+			result = _mm_or_si128(result, _mm_and_si128(_mm_slli_epi64(blocks, 12), Mask64(0x000FFF00, 0)));
+			result = _mm_or_si128(result, _mm_and_si128(_mm_slli_epi64(blocks, 36), Mask64(0xFFF00000, 0)));
+			return result;
+		}
+
+		//BC2 alpha: 4 rows of 16 bits of explicit alpha.
+		inline __m128i FlipExplicitAlphaHalves(__m128i blocks)
+		{
+			__m128i result = _mm_srli_epi64(blocks, 48);
+			result = _mm_or_si128(result, _mm_and_si128(_mm_srli_epi64(blocks, 16), Mask64(0, 0xFFFF0000)));
+			result = _mm_or_si128(result, _mm_and_si128(_mm_slli_epi64(blocks, 16), Mask64(0x0000FFFF, 0)));
+			result = _mm_or_si128(result, _mm_slli_epi64(blocks, 48));
+			return result;
+		}
+
+		//For 16-byte blocks made of two different halves. Does two blocks at a time.
+		template<typename FirstHalfFunc, typename SecondHalfFunc>
+		size_t FlipBlockPairs(unsigned char *pDst, const unsigned char *pSrc, size_t numBlocks,
+			FirstHalfFunc FlipFirstHalves, SecondHalfFunc FlipSecondHalves)
+		{
+			size_t blockIx = 0;
+			for(; blockIx + 2 <= numBlocks; blockIx += 2, pSrc += 32, pDst += 32)
+			{
+				__m128i firstBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc));
+				__m128i secondBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + 16));
+				__m128i firstHalves = FlipFirstHalves(_mm_unpacklo_epi64(firstBlock, secondBlock));
+				__m128i secondHalves = FlipSecondHalves(_mm_unpackhi_epi64(firstBlock, secondBlock));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(pDst), _mm_unpacklo_epi64(firstHalves, secondHalves));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(pDst + 16), _mm_unpackhi_epi64(firstHalves, secondHalves));
+			}
+
+			return blockIx;
+		}
+
+		//For blocks that are made only of halves of one kind: 8-byte blocks, or BC5.
+		//Returns the number of blocks flipped.
+		template<typename HalfFunc>
+		size_t FlipUniformBlocks(unsigned char *pDst, const unsigned char *pSrc, size_t numBlocks,
+			size_t blockByteCount, HalfFunc FlipHalves)
+		{
+			const size_t numRegisters = (numBlocks * blockByteCount) / 16;
+			for(size_t regIx = 0; regIx < numRegisters; ++regIx, pSrc += 16, pDst += 16)
+			{
+				__m128i blocks = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(pDst), FlipHalves(blocks));
+			}
+
+			return (numRegisters * 16) / blockByteCount;
+		}
+#endif //GLIMG_USE_SSE2
+
+		//Flips each of the numBlocks blocks in a row of blocks. Returns false for formats
+		//it cannot flip.
+		bool FlipBlockRow(PixelDataType eType, unsigned char *pDst, const unsigned char *pSrc,
+			size_t numBlocks)
+		{
+			void (*FlipBlock)(unsigned char *, const unsigned char *) = NULL;
+			size_t blockByteCount = 16;
+			size_t numDone = 0;
+			switch(eType)
+			{
+			case DT_COMPRESSED_BC1:
+				FlipBlock = CopyBlockBC1Flipped;
+				blockByteCount = 8;
+#ifdef GLIMG_USE_SSE2
+				numDone = FlipUniformBlocks(pDst, pSrc, numBlocks, 8, FlipColorHalves);
+#endif
+				break;
+			case DT_COMPRESSED_BC2:
+				FlipBlock = CopyBlockBC2Flipped;
+#ifdef GLIMG_USE_SSE2
+				numDone = FlipBlockPairs(pDst, pSrc, numBlocks, FlipExplicitAlphaHalves, FlipColorHalves);
+#endif
+				break;
+			case DT_COMPRESSED_BC3:
+				FlipBlock = CopyBlockBC3Flipped;
+#ifdef GLIMG_USE_SSE2
+				numDone = FlipBlockPairs(pDst, pSrc, numBlocks, FlipAlphaHalves, FlipColorHalves);
+#endif
+				break;
+			case DT_COMPRESSED_UNSIGNED_BC4:
+			case DT_COMPRESSED_SIGNED_BC4:
+				FlipBlock = CopyBlockBC4Flipped;
+				blockByteCount = 8;
+#ifdef GLIMG_USE_SSE2
+				numDone = FlipUniformBlocks(pDst, pSrc, numBlocks, 8, FlipAlphaHalves);
+#endif
+				break;
+			case DT_COMPRESSED_UNSIGNED_BC5:
+			case DT_COMPRESSED_SIGNED_BC5:
+				FlipBlock = CopyBlockBC5Flipped;
+#ifdef GLIMG_USE_SSE2
+				numDone = FlipUniformBlocks(pDst, pSrc, numBlocks, 16, FlipAlphaHalves);
+#endif
+				break;
+			default:
+				return false;
+			}
+
+			//Whatever the vector code left over.
+			for(size_t blockIx = numDone; blockIx < numBlocks; ++blockIx)
+				FlipBlock(pDst + blockIx * blockByteCount, pSrc + blockIx * blockByteCount);
+
+			return true;
+		}
+
+		//The number of rows that FlipImageRows works in: lines of pixels, or rows of blocks.
+		size_t CalcFlipRowCount(const ImageFormat &format, const Dimensions &dims, size_t imageSize)
+		{
+			if(format.Type() < DT_NUM_UNCOMPRESSED_TYPES)
+				return dims.NumLines();
 
 			CompressedBlockData blockData = GetBlockCompressionData(format.Type());
 			const size_t blocksPerRow = (dims.width + (blockData.dims.width - 1)) / blockData.dims.width;
+			return imageSize / (blocksPerRow * blockData.byteCount);
+		}
 
-			const size_t blockRowByteSize = blocksPerRow * blockData.byteCount;
-			const size_t numTotalBlocks = imageSize / blockData.byteCount;
-			const size_t numLines = numTotalBlocks / blocksPerRow;
+		//Fills rows [firstRow, firstRow + numRows) of the flipped image.
+		void FlipImageRows(const ImageFormat &format, const Dimensions &dims, const void *pixelData,
+			unsigned char *pDstData, size_t imageSize, size_t firstRow, size_t numRows)
+		{
+			const size_t totalRows = CalcFlipRowCount(format, dims, imageSize);
+			const size_t rowByteSize = imageSize / totalRows;
 
-			//Copy each block.
-			const unsigned char *pInputRow = static_cast<const unsigned char *>(pixelData);
-			pInputRow += imageSize;
-			pInputRow -= blockRowByteSize;
-			for(size_t line = 0; line < numLines; ++line)
+			if(format.Type() < DT_NUM_UNCOMPRESSED_TYPES)
+			{
+				CopyPixelRowsFlipped(pDstData, pixelData, rowByteSize, totalRows, firstRow, numRows);
+				return;
+			}
+
+			//No support for 3D compressed formats.
+			assert(dims.numDimensions != 3);
+
+			//Have to decode the pixel data and flip it manually.
+			const size_t blocksPerRow = rowByteSize / GetBlockCompressionData(format.Type()).byteCount;
+			const unsigned char *pSrcData = static_cast<const unsigned char *>(pixelData);
+			for(size_t row = firstRow; row < firstRow + numRows; ++row)
+			{
+				if(!FlipBlockRow(format.Type(), pDstData + row * rowByteSize,
+					pSrcData + (totalRows - 1 - row) * rowByteSize, blocksPerRow))
+				{
+					//Formats that cannot be flipped are copied as they are.
+					memcpy(pDstData + row * rowByteSize, pSrcData + row * rowByteSize, rowByteSize);
+				}
+			}
+		}
+
+		//Flipped and copied images are split into bands of rows of about this size, so that
+		//one large image is spread across threads as well.
+		const size_t BAND_BYTE_SIZE = 256 * 1024;
+
+		//Less data than this is copied on the calling thread; waking the others costs more.
+		const size_t MIN_PARALLEL_BYTE_SIZE = 1024 * 1024;
+
+		//Copies images into the creator's storage, flipping them if needed. Each item is one
+		//band of one image.
+		class ImageCopyTask : public ParallelTask
+		{
+		public:
+			ImageCopyTask(const ImageFormat &format, bool isTopLeft)
+				: m_format(format)
+				, m_isTopLeft(isTopLeft)
+				, m_totalByteSize(0)
+			{}
+
+			void AddImage(const void *pixelData, unsigned char *pDstData, const Dimensions &dims,
+				size_t imageSize)
+			{
+				ImageCopy image = {pixelData, pDstData, dims, imageSize,
+					CalcFlipRowCount(m_format, dims, imageSize)};
+				m_images.push_back(image);
+				m_totalByteSize += imageSize;
+
+				const size_t rowByteSize = imageSize / image.numRows;
+				const size_t rowsPerBand = std::max<size_t>(BAND_BYTE_SIZE / rowByteSize, 1);
+				for(size_t firstRow = 0; firstRow < image.numRows; firstRow += rowsPerBand)
+				{
+					Band band = {m_images.size() - 1, firstRow,
+						std::min(rowsPerBand, image.numRows - firstRow)};
+					m_bands.push_back(band);
+				}
+			}
+
+			int GetNumItems() const {return (int)m_bands.size();}
+			size_t GetTotalByteSize() const {return m_totalByteSize;}
+
+			virtual void Execute(int itemIx)
 			{
-				for(size_t block = 0; block < blocksPerRow; ++block)
+				const Band &band = m_bands[itemIx];
+				const ImageCopy &image = m_images[band.imageIx];
+				if(m_isTopLeft)
 				{
-					FlippingFunc(pMipmapData, pInputRow);
-					pMipmapData += blockData.byteCount;
-					pInputRow += blockData.byteCount;
+					FlipImageRows(m_format, image.dims, image.pixelData, image.pDstData,
+						image.imageSize, band.firstRow, band.numRows);
+					return;
 				}
-				//First goes back to beginning, second goes back one row.
-				pInputRow -= blockRowByteSize;
-				pInputRow -= blockRowByteSize;
+
+				//The last band takes whatever does not divide into rows.
+				const size_t rowByteSize = image.imageSize / image.numRows;
+				const size_t firstByte = band.firstRow * rowByteSize;
+				size_t byteCount = band.numRows * rowByteSize;
+				if(band.firstRow + band.numRows == image.numRows)
+					byteCount = image.imageSize - firstByte;
+				memcpy(image.pDstData + firstByte,
+					static_cast<const unsigned char *>(image.pixelData) + firstByte, byteCount);
 			}
 
-			return static_cast<const unsigned char *>(pixelData) + imageSize;
+		private:
+			struct ImageCopy
+			{
+				const void *pixelData;
+				unsigned char *pDstData;
+				Dimensions dims;
+				size_t imageSize;
+				size_t numRows;
+			};
+
+			struct Band
+			{
+				size_t imageIx;
+				size_t firstRow;
+				size_t numRows;
+			};
+
+			const ImageFormat &m_format;
+			bool m_isTopLeft;
+			size_t m_totalByteSize;
+			std::vector<ImageCopy> m_images;
+			std::vector<Band> m_bands;
+		};
+
+		void RunImageCopyTask(ImageCopyTask &task, int numThreads)
+		{
+			if(numThreads == 1 || task.GetTotalByteSize() < MIN_PARALLEL_BYTE_SIZE)
+			{
+				for(int itemIx = 0; itemIx < task.GetNumItems(); ++itemIx)
+					task.Execute(itemIx);
+				return;
+			}
+
+			std::auto_ptr<ThreadPool> pOwnPool;
+			if(numThreads > 0)
+				pOwnPool.reset(new ThreadPool(numThreads));
+
+			ThreadPool &pool = pOwnPool.get() ? *pOwnPool : GetSharedThreadPool();
+			pool.ParallelFor(task, task.GetNumItems());
 		}
 	}
 
 	void ImageCreator::SetImageData( const void *pixelData, bool isTopLeft,
 		int mipmapLevel, int arrayIx, int faceIx )
+	{
+		ImageDataSource image = {pixelData, mipmapLevel, arrayIx, faceIx};
+		SetImageDataBatch(&image, 1, isTopLeft);
+	}
+
+	void ImageCreator::SetImageDataBatch( const ImageDataSource *pImages, int numImages, bool isTopLeft,
+		int numThreads )
 	{
 		if(m_imageData.empty())
 			throw ImageSetAlreadyCreatedException();
 
-		//Check inputs.
-		if((arrayIx < 0) || (m_arrayCount <= arrayIx))
-			throw ArrayOutOfBoundsException();
-
-		if((mipmapLevel < 0) || (m_mipmapCount <= mipmapLevel))
-			throw MipmapLayerOutOfBoundsException();
-
-		if((faceIx < 0) || (m_faceCount <= faceIx))
-			throw FaceIndexOutOfBoundsException();
+		//Check all of the inputs before copying any of them.
+		for(int imageIx = 0; imageIx < numImages; ++imageIx)
+		{
+			const ImageDataSource &image = pImages[imageIx];
+			if((image.arrayIx < 0) || (m_arrayCount <= image.arrayIx))
+				throw ArrayOutOfBoundsException();
 
-		size_t imageOffset = ((arrayIx * m_faceCount) + faceIx) * m_imageSizes[mipmapLevel];
+			if((image.mipmapLevel < 0) || (m_mipmapCount <= image.mipmapLevel))
+				throw MipmapLayerOutOfBoundsException();
 
-		unsigned char *pMipmapData = &m_imageData[mipmapLevel][0];
-		pMipmapData += imageOffset;
-		if(!isTopLeft)
-		{
-			memcpy(pMipmapData, pixelData, m_imageSizes[mipmapLevel]);
+			if((image.faceIx < 0) || (m_faceCount <= image.faceIx))
+				throw FaceIndexOutOfBoundsException();
 		}
-		else
+
+		ImageCopyTask task(m_format, isTopLeft);
+		for(int imageIx = 0; imageIx < numImages; ++imageIx)
 		{
-			CopyImageFlipped(pixelData, pMipmapData, mipmapLevel);
+			const ImageDataSource &image = pImages[imageIx];
+			const size_t imageSize = m_imageSizes[image.mipmapLevel];
+			size_t imageOffset = ((image.arrayIx * m_faceCount) + image.faceIx) * imageSize;
+
+			unsigned char *pMipmapData = &m_imageData[image.mipmapLevel][0];
+			pMipmapData += imageOffset;
+			task.AddImage(image.pixelData, pMipmapData,
+				ModifySizeForMipmap(m_dims, image.mipmapLevel), imageSize);
 		}
+
+		RunImageCopyTask(task, numThreads);
 	}
 
 	void ImageCreator::SetFullMipmapLevel( const void *pixelData, bool isTopLeft, int mipmapLevel )
@@ -253,19 +506,18 @@ namespace glimg
 
 		unsigned char *pMipmapData = &m_imageData[mipmapLevel][0];
 		const unsigned char *pSrcData = static_cast<const unsigned char *>(pixelData);
-		if(!isTopLeft)
-		{
-			memcpy(pMipmapData, pixelData, m_imageSizes[mipmapLevel] * m_arrayCount * m_faceCount);
-		}
-		else
+		const Dimensions mipmapDims = ModifySizeForMipmap(m_dims, mipmapLevel);
+
+		//Flipping is done image by image, so they are copied separately either way.
+		ImageCopyTask task(m_format, isTopLeft);
+		for(int image = 0; image < m_arrayCount * m_faceCount; ++image)
 		{
-			for(int image = 0; image < m_arrayCount * m_faceCount; ++image)
-			{
-				CopyImageFlipped(pSrcData, pMipmapData, mipmapLevel);
-				pSrcData += m_imageSizes[mipmapLevel];
-				pMipmapData += m_imageSizes[mipmapLevel];
-			}
+			task.AddImage(pSrcData, pMipmapData, mipmapDims, m_imageSizes[mipmapLevel]);
+			pSrcData += m_imageSizes[mipmapLevel];
+			pMipmapData += m_imageSizes[mipmapLevel];
 		}
+
+		RunImageCopyTask(task, 0);
 	}
 
 	ImageSet * ImageCreator::CreateImage()
@@ -281,45 +533,10 @@ namespace glimg
 		return pImageSet;
 	}
 
-	void ImageCreator::CopyImageFlipped(const void * pixelData, unsigned char *pDstData, int mipmapLevel)
+	void FlipImageData( const ImageFormat &format, const Dimensions &dims, const void *pixelData,
+		unsigned char *pDstData, size_t imageSize )
 	{
-		Dimensions dims = ModifySizeForMipmap(m_dims, mipmapLevel);
-		if(m_format.Type() < DT_NUM_UNCOMPRESSED_TYPES)
-		{
-			CopyPixelsFlipped(pDstData, dims, m_format, mipmapLevel, pixelData,
-				m_imageSizes[mipmapLevel]);
-		}
-		else
-		{
-			//Have to decode the pixel data and flip it manually.
-			switch(m_format.Type())
-			{
-			case DT_COMPRESSED_BC1:
-				CopyBCFlipped(pDstData, dims, m_format, mipmapLevel, pixelData,
-					m_imageSizes[mipmapLevel], CopyBlockBC1Flipped);
-				break;
-			case DT_COMPRESSED_BC2:
-				CopyBCFlipped(pDstData, dims, m_format, mipmapLevel, pixelData,
-					m_imageSizes[mipmapLevel], CopyBlockBC2Flipped);
-				break;
-			case DT_COMPRESSED_BC3:
-				CopyBCFlipped(pDstData, dims, m_format, mipmapLevel, pixelData,
-					m_imageSizes[mipmapLevel], CopyBlockBC3Flipped);
-				break;
-			case DT_COMPRESSED_UNSIGNED_BC4:
-			case DT_COMPRESSED_SIGNED_BC4:
-				CopyBCFlipped(pDstData, dims, m_format, mipmapLevel, pixelData,
-					m_imageSizes[mipmapLevel], CopyBlockBC4Flipped);
-				break;
-			case DT_COMPRESSED_UNSIGNED_BC5:
-			case DT_COMPRESSED_SIGNED_BC5:
-				CopyBCFlipped(pDstData, dims, m_format, mipmapLevel, pixelData,
-					m_imageSizes[mipmapLevel], CopyBlockBC5Flipped);
-				break;
-			default:
-				memcpy(pDstData, pixelData, m_imageSizes[mipmapLevel]);
-				break;
-			}
-		}
+		FlipImageRows(format, dims, pixelData, pDstData, imageSize, 0,
+			CalcFlipRowCount(format, dims, imageSize));
 	}
 }
@@ -250,6 +250,6 @@ namespace glimg
 
 	size_t ImageFormat::AlignByteCount( size_t byteCount ) const
 	{
-		return (byteCount + (fmt.lineAlignment - 1)) / fmt.lineAlignment;
+		return ((byteCount + (fmt.lineAlignment - 1)) / fmt.lineAlignment) * fmt.lineAlignment;
 	}
 }
@@ -4,6 +4,7 @@
 
 
 #include "ImageSetImpl.h"
+#include "glimg/MappedFile.h"
 #include "Util.h"
 
 namespace glimg
@@ -17,9 +18,39 @@ namespace glimg
 		, m_mipmapCount(mipmapCount)
 		, m_arrayCount(arrayCount)
 		, m_faceCount(faceCount)
+		, m_pMapping(NULL)
 	{
 		m_imageData.swap(imageData);
 		m_imageSizes.swap(imageSizes);
+
+		m_levelData.reserve(m_imageData.size());
+		for(size_t level = 0; level < m_imageData.size(); ++level)
+			m_levelData.push_back(&m_imageData[level][0]);
+	}
+
+	detail::ImageSetImpl::ImageSetImpl( ImageFormat format, Dimensions dimensions,
+		int mipmapCount, int arrayCount, int faceCount,
+		std::vector<const unsigned char *> &levelData,
+		std::vector<size_t> &imageSizes, MappedFile *pMapping )
+		: m_format(format)
+		, m_dimensions(dimensions)
+		, m_mipmapCount(mipmapCount)
+		, m_arrayCount(arrayCount)
+		, m_faceCount(faceCount)
+		, m_pMapping(pMapping)
+	{
+		m_levelData.swap(levelData);
+		m_imageSizes.swap(imageSizes);
+	}
+
+	detail::ImageSetImpl::~ImageSetImpl()
+	{
+		delete m_pMapping;
+	}
+
+	ImageSet * detail::ImageSetImpl::CreateImageSet( ImageSetImpl *pImpl )
+	{
+		return new ImageSet(pImpl);
 	}
 
 	Dimensions detail::ImageSetImpl::GetDimensions( int mipmapLevel ) const
@@ -30,7 +61,7 @@ namespace glimg
 	const void * detail::ImageSetImpl::GetImageData( int mipmapLevel, int arrayIx, int faceIx ) const
 	{
 		size_t imageOffset = ((arrayIx * m_faceCount) + faceIx) * m_imageSizes[mipmapLevel];
-		return &m_imageData[mipmapLevel][0] + imageOffset;
+		return m_levelData[mipmapLevel] + imageOffset;
 	}
 
 	size_t detail::ImageSetImpl::GetImageByteSize( int mipmapLevel ) const
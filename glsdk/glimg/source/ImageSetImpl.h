@@ -12,6 +12,8 @@
 
 namespace glimg
 {
+	class MappedFile;
+
 	namespace detail
 	{
 		class ImageSetImpl
@@ -20,6 +22,17 @@ namespace glimg
 			ImageSetImpl(ImageFormat format, Dimensions dimensions, int mipmapCount, int arrayCount,
 				int faceCount, std::vector<ImageBuffer> &imageData, std::vector<size_t> &imageSizes);
 
+			//The image data stays in pMapping, which this object takes ownership of.
+			//levelData has a pointer into the mapping for each mipmap level.
+			ImageSetImpl(ImageFormat format, Dimensions dimensions, int mipmapCount, int arrayCount,
+				int faceCount, std::vector<const unsigned char *> &levelData, std::vector<size_t> &imageSizes,
+				MappedFile *pMapping);
+
+			~ImageSetImpl();
+
+			//Creates an ImageSet that owns pImpl.
+			static ImageSet *CreateImageSet(ImageSetImpl *pImpl);
+
 			Dimensions GetDimensions() const {return m_dimensions;}
 			Dimensions GetDimensions(int mipmapLevel) const;
 
@@ -45,6 +58,13 @@ namespace glimg
 			//Indexed by mipmap.
 			std::vector<ImageBuffer> m_imageData;
 			std::vector<size_t> m_imageSizes;
+
+			//Indexed by mipmap. Points into m_imageData, or into m_pMapping.
+			std::vector<const unsigned char *> m_levelData;
+			MappedFile *m_pMapping;
+
+			ImageSetImpl(const ImageSetImpl &);
+			ImageSetImpl &operator=(const ImageSetImpl &);
 		};
 	}
 }
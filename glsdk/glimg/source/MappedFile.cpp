@@ -0,0 +1,135 @@
+//Copyright (C) 2011 by Jason L. McKesson
+//This file is licensed by the MIT License.
+
+
+#include <string>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif //WIN32
+
+#ifdef LOAD_X11
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif //LOAD_X11
+
+#include "glimg/MappedFile.h"
+
+namespace glimg
+{
+	MappedFile::MappedFile()
+		: m_pData(NULL)
+		, m_size(0)
+		, m_hFile(NULL)
+		, m_hMapping(NULL)
+	{}
+
+#ifdef WIN32
+	MappedFile *MappedFile::Open( const std::string &filename, bool isSequential )
+	{
+		HANDLE hFile = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | (isSequential ? FILE_FLAG_SEQUENTIAL_SCAN : 0), NULL);
+		if(hFile == INVALID_HANDLE_VALUE)
+			return NULL;
+
+		LARGE_INTEGER fileSize;
+		if(!GetFileSizeEx(hFile, &fileSize) || fileSize.HighPart != 0)
+		{
+			CloseHandle(hFile);
+			return NULL;
+		}
+
+		MappedFile *pMapping = new MappedFile();
+		pMapping->m_hFile = hFile;
+		pMapping->m_size = fileSize.LowPart;
+
+		//Empty files cannot be mapped.
+		if(pMapping->m_size == 0)
+			return pMapping;
+
+		pMapping->m_hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if(pMapping->m_hMapping)
+		{
+			pMapping->m_pData = static_cast<const unsigned char *>(
+				MapViewOfFile(pMapping->m_hMapping, FILE_MAP_READ, 0, 0, 0));
+		}
+
+		if(!pMapping->m_pData)
+		{
+			delete pMapping;
+			return NULL;
+		}
+
+		return pMapping;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if(m_pData)
+			UnmapViewOfFile(m_pData);
+		if(m_hMapping)
+			CloseHandle(m_hMapping);
+		if(m_hFile)
+			CloseHandle(m_hFile);
+	}
+#endif //WIN32
+
+#ifdef LOAD_X11
+	MappedFile *MappedFile::Open( const std::string &filename, bool isSequential )
+	{
+		int fileDesc = open(filename.c_str(), O_RDONLY);
+		if(fileDesc == -1)
+			return NULL;
+
+		struct stat fileInfo;
+		if(fstat(fileDesc, &fileInfo) == -1 || !S_ISREG(fileInfo.st_mode))
+		{
+			close(fileDesc);
+			return NULL;
+		}
+
+		MappedFile *pMapping = new MappedFile();
+		pMapping->m_size = (size_t)fileInfo.st_size;
+
+		//Empty files cannot be mapped.
+		if(pMapping->m_size != 0)
+		{
+			void *pData = mmap(NULL, pMapping->m_size, PROT_READ, MAP_PRIVATE, fileDesc, 0);
+			if(pData == MAP_FAILED)
+			{
+				close(fileDesc);
+				delete pMapping;
+				return NULL;
+			}
+
+			if(isSequential)
+				madvise(pData, pMapping->m_size, MADV_SEQUENTIAL);
+			pMapping->m_pData = static_cast<const unsigned char *>(pData);
+		}
+
+		//The mapping keeps its own reference to the file.
+		close(fileDesc);
+		return pMapping;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if(m_pData)
+			munmap(const_cast<unsigned char *>(m_pData), m_size);
+	}
+#endif //LOAD_X11
+
+#if !defined(WIN32) && !defined(LOAD_X11)
+	MappedFile *MappedFile::Open( const std::string &filename, bool isSequential )
+	{
+		return NULL;
+	}
+
+	MappedFile::~MappedFile()
+	{}
+#endif
+}
@@ -0,0 +1,673 @@
+//Copyright (C) 2011 by Jason L. McKesson
+//This file is licensed by the MIT License.
+
+
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "glimg/ImageSet.h"
+#include "glimg/ImageCreator.h"
+#include "glimg/MipmapGenerator.h"
+#include "Util.h"
+#include "glimg/ThreadPool.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GLIMG_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace glimg
+{
+	namespace
+	{
+		enum ComponentType
+		{
+			COMP_UNORM8,
+			COMP_UNORM16,
+			COMP_FLOAT32,
+		};
+
+		//How the components of a texel are stored. Filtering always works on 4 floats per texel.
+		struct TexelLayout
+		{
+			ComponentType compType;
+			int numComponents;
+			int texelByteSize;
+			int alphaIx;			//The stored component that is alpha (or X), or -1 if there is none.
+			bool isSRGB;			//Alpha is never sRGB.
+		};
+
+		bool IsLittleEndian()
+		{
+			const unsigned int testValue = 1;
+			return *reinterpret_cast<const unsigned char *>(&testValue) == 1;
+		}
+
+		TexelLayout GetTexelLayout(const ImageFormat &format, unsigned int flags)
+		{
+			if(format.Type() >= DT_NUM_UNCOMPRESSED_TYPES)
+				throw MipmapUnsupportedException("Compressed images cannot be filtered.");
+
+			if(format.Components() == FMT_DEPTH || format.Components() == FMT_DEPTH_X)
+				throw MipmapUnsupportedException("Depth images cannot be filtered.");
+
+			TexelLayout layout;
+			layout.numComponents = ComponentCount(format.Components());
+
+			switch(format.Depth())
+			{
+			case BD_PER_COMP_8:
+				layout.compType = COMP_UNORM8;
+				break;
+			case BD_PER_COMP_16:
+				layout.compType = COMP_UNORM16;
+				break;
+			case BD_PER_COMP_32:
+				layout.compType = COMP_FLOAT32;
+				break;
+			case BD_PACKED_32_BIT_8888:
+			case BD_PACKED_32_BIT_8888_REV:
+				layout.compType = COMP_UNORM8;
+				layout.numComponents = 4;
+				break;
+			default:
+				throw MipmapUnsupportedException("Packed formats other than 8888 are not supported.");
+			}
+
+			PixelDataType expectedType = layout.compType == COMP_FLOAT32 ? DT_FLOAT : DT_NORM_UNSIGNED_INTEGER;
+			if(format.Type() != expectedType)
+			{
+				throw MipmapUnsupportedException("Only 8 and 16-bit normalized unsigned integers and "
+					"32-bit floats are supported.");
+			}
+
+			int compByteSize = 1;
+			if(layout.compType == COMP_UNORM16)
+				compByteSize = 2;
+			else if(layout.compType == COMP_FLOAT32)
+				compByteSize = 4;
+			layout.texelByteSize = compByteSize * layout.numComponents;
+
+			//The 4th component of a packed format is in the lowest bits, unless it is _REV.
+			layout.alphaIx = layout.numComponents == 4 ? 3 : -1;
+			if(format.Depth() == BD_PACKED_32_BIT_8888)
+				layout.alphaIx = IsLittleEndian() ? 0 : 3;
+			else if(format.Depth() == BD_PACKED_32_BIT_8888_REV)
+				layout.alphaIx = IsLittleEndian() ? 3 : 0;
+
+			switch(format.Components())
+			{
+			case FMT_COLOR_RGB_sRGB:
+			case FMT_COLOR_RGBX_sRGB:
+			case FMT_COLOR_RGBA_sRGB:
+				layout.isSRGB = true;
+				break;
+			default:
+				layout.isSRGB = false;
+				break;
+			}
+
+			if(flags & MIPMAP_FORCE_SRGB)
+				layout.isSRGB = true;
+			if(flags & MIPMAP_FORCE_LINEAR)
+				layout.isSRGB = false;
+
+			if(layout.isSRGB && layout.compType == COMP_FLOAT32)
+				throw MipmapUnsupportedException("Floating-point images cannot be sRGB.");
+
+			return layout;
+		}
+
+		float SrgbToLinear(float value)
+		{
+			if(value <= 0.04045f)
+				return value / 12.92f;
+			return powf((value + 0.055f) / 1.055f, 2.4f);
+		}
+
+		float LinearToSrgb(float value)
+		{
+			if(value <= 0.0031308f)
+				return value * 12.92f;
+			return 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+		}
+
+		//Indexed by a linear value scaled to [0, 65535]. Fine enough that every sRGB value is reachable.
+		const int g_linearToSrgb8Size = 65536;
+
+		//Filled in by the constructor of g_convTables, during static initialization. So they are
+		//complete before anything can call GenerateMipmaps, on any thread, and are never written again.
+		struct ConversionTables
+		{
+			ConversionTables()
+			{
+				for(int value = 0; value < 256; ++value)
+				{
+					srgb8ToLinear[value] = SrgbToLinear(value / 255.0f);
+					unorm8ToFloat[value] = value / 255.0f;
+				}
+
+				for(int linearIx = 0; linearIx < g_linearToSrgb8Size; ++linearIx)
+				{
+					float srgb = LinearToSrgb(linearIx / (float)(g_linearToSrgb8Size - 1));
+					linearToSrgb8[linearIx] = (unsigned char)(srgb * 255.0f + 0.5f);
+				}
+			}
+
+			float srgb8ToLinear[256];
+			float unorm8ToFloat[256];
+			unsigned char linearToSrgb8[g_linearToSrgb8Size];
+		};
+
+		const ConversionTables g_convTables;
+
+		float Saturate(float value)
+		{
+			return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		}
+
+		bool IsComponentSRGB(const TexelLayout &layout, int compIx)
+		{
+			return layout.isSRGB && compIx != layout.alphaIx;
+		}
+
+		void DecodeRow(const unsigned char *pSrc, int width, const TexelLayout &layout, float *pDst)
+		{
+			const int numComps = layout.numComponents;
+			if(numComps < 4)
+				memset(pDst, 0, width * 4 * sizeof(float));
+
+			switch(layout.compType)
+			{
+			case COMP_UNORM8:
+				{
+					const float *compTables[4];
+					for(int compIx = 0; compIx < numComps; ++compIx)
+						compTables[compIx] = IsComponentSRGB(layout, compIx) ?
+							g_convTables.srgb8ToLinear : g_convTables.unorm8ToFloat;
+
+					for(int texelIx = 0; texelIx < width; ++texelIx, pSrc += numComps, pDst += 4)
+					{
+						for(int compIx = 0; compIx < numComps; ++compIx)
+							pDst[compIx] = compTables[compIx][pSrc[compIx]];
+					}
+				}
+				break;
+			case COMP_UNORM16:
+				{
+					const unsigned short *pSrcComps = reinterpret_cast<const unsigned short *>(pSrc);
+					for(int texelIx = 0; texelIx < width; ++texelIx, pSrcComps += numComps, pDst += 4)
+					{
+						for(int compIx = 0; compIx < numComps; ++compIx)
+						{
+							float value = pSrcComps[compIx] / 65535.0f;
+							pDst[compIx] = IsComponentSRGB(layout, compIx) ? SrgbToLinear(value) : value;
+						}
+					}
+				}
+				break;
+			case COMP_FLOAT32:
+				{
+					const float *pSrcComps = reinterpret_cast<const float *>(pSrc);
+					for(int texelIx = 0; texelIx < width; ++texelIx, pSrcComps += numComps, pDst += 4)
+						memcpy(pDst, pSrcComps, numComps * sizeof(float));
+				}
+				break;
+			}
+		}
+
+		void EncodeRow(const float *pSrc, int width, const TexelLayout &layout, unsigned char *pDst)
+		{
+			const int numComps = layout.numComponents;
+			switch(layout.compType)
+			{
+			case COMP_UNORM8:
+				{
+					//The sRGB table is indexed with a larger scale than 255.
+					float compScales[4];
+					for(int compIx = 0; compIx < numComps; ++compIx)
+						compScales[compIx] = IsComponentSRGB(layout, compIx) ? g_linearToSrgb8Size - 1.0f : 255.0f;
+
+					for(int texelIx = 0; texelIx < width; ++texelIx, pSrc += 4, pDst += numComps)
+					{
+						for(int compIx = 0; compIx < numComps; ++compIx)
+						{
+							int value = (int)(Saturate(pSrc[compIx]) * compScales[compIx] + 0.5f);
+							pDst[compIx] = IsComponentSRGB(layout, compIx) ?
+								g_convTables.linearToSrgb8[value] : (unsigned char)value;
+						}
+					}
+				}
+				break;
+			case COMP_UNORM16:
+				{
+					unsigned short *pDstComps = reinterpret_cast<unsigned short *>(pDst);
+					for(int texelIx = 0; texelIx < width; ++texelIx, pSrc += 4, pDstComps += numComps)
+					{
+						for(int compIx = 0; compIx < numComps; ++compIx)
+						{
+							float value = Saturate(pSrc[compIx]);
+							if(IsComponentSRGB(layout, compIx))
+								value = LinearToSrgb(value);
+							pDstComps[compIx] = (unsigned short)(value * 65535.0f + 0.5f);
+						}
+					}
+				}
+				break;
+			case COMP_FLOAT32:
+				{
+					float *pDstComps = reinterpret_cast<float *>(pDst);
+					for(int texelIx = 0; texelIx < width; ++texelIx, pSrc += 4, pDstComps += numComps)
+						memcpy(pDstComps, pSrc, numComps * sizeof(float));
+				}
+				break;
+			}
+		}
+
+		const double g_pi = 3.14159265358979323846;
+		const double g_kaiserAlpha = 4.0;
+
+		double Sinc(double x)
+		{
+			if(fabs(x) < 1.0e-6)
+				return 1.0;
+
+			x *= g_pi;
+			return sin(x) / x;
+		}
+
+		//Modified Bessel function of the first kind, order 0.
+		double BesselI0(double x)
+		{
+			double sum = 1.0;
+			double term = 1.0;
+			for(int k = 1; k < 50 && term > sum * 1.0e-12; ++k)
+			{
+				double halfXOverK = x / (2.0 * k);
+				term *= halfXOverK * halfXOverK;
+				sum += term;
+			}
+
+			return sum;
+		}
+
+		//The Kaiser window's divisor. Like g_convTables, it is set during static initialization.
+		const double g_besselI0KaiserAlpha = BesselI0(g_kaiserAlpha);
+
+		//In texels of the image being filtered.
+		double GetFilterRadius(MipmapFilter filter)
+		{
+			return filter == MIPMAP_FILTER_BOX ? 0.5 : 3.0;
+		}
+
+		double GetFilterWeight(MipmapFilter filter, double x)
+		{
+			double radius = GetFilterRadius(filter);
+			switch(filter)
+			{
+			case MIPMAP_FILTER_BOX:
+				//Half-open, so that a texel exactly between two destination texels is counted once.
+				return (-radius < x && x <= radius) ? 1.0 : 0.0;
+			case MIPMAP_FILTER_KAISER:
+				{
+					if(fabs(x) >= radius)
+						return 0.0;
+
+					double t = x / radius;
+					return Sinc(x) * BesselI0(g_kaiserAlpha * sqrt(1.0 - t * t)) / g_besselI0KaiserAlpha;
+				}
+			case MIPMAP_FILTER_LANCZOS:
+				if(fabs(x) >= radius)
+					return 0.0;
+				return Sinc(x) * Sinc(x / radius);
+			}
+
+			return 0.0;
+		}
+
+		//For each destination texel along one axis, the source texels that it is made from,
+		//and their weights. Every destination texel has numTaps of them; unused taps have
+		//a weight of 0.
+		struct AxisWeights
+		{
+			int numTaps;
+			std::vector<int> srcIxs;
+			std::vector<float> weights;
+		};
+
+		AxisWeights CalcAxisWeights(MipmapFilter filter, int srcSize, int dstSize)
+		{
+			double scale = srcSize / (double)dstSize;
+			double radius = GetFilterRadius(filter) * scale;
+			int maxTaps = (int)ceil(radius * 2.0) + 1;
+
+			std::vector<int> firstIxs(dstSize);
+			std::vector<double> allWeights(dstSize * maxTaps);
+
+			int numTaps = 1;
+			for(int dstIx = 0; dstIx < dstSize; ++dstIx)
+			{
+				double center = (dstIx + 0.5) * scale - 0.5;
+				int firstIx = (int)floor(center - radius);
+				double *pWeights = &allWeights[dstIx * maxTaps];
+
+				double weightSum = 0.0;
+				int firstUsed = maxTaps;
+				int lastUsed = -1;
+				for(int tapIx = 0; tapIx < maxTaps; ++tapIx)
+				{
+					pWeights[tapIx] = GetFilterWeight(filter, (firstIx + tapIx - center) / scale);
+					weightSum += pWeights[tapIx];
+					if(pWeights[tapIx] != 0.0)
+					{
+						firstUsed = std::min(firstUsed, tapIx);
+						lastUsed = tapIx;
+					}
+				}
+
+				for(int tapIx = 0; tapIx < maxTaps; ++tapIx)
+					pWeights[tapIx] /= weightSum;
+
+				//Drop the unused taps at the start.
+				std::copy(pWeights + firstUsed, pWeights + maxTaps, pWeights);
+				std::fill(pWeights + maxTaps - firstUsed, pWeights + maxTaps, 0.0);
+				firstIxs[dstIx] = firstIx + firstUsed;
+				numTaps = std::max(numTaps, lastUsed - firstUsed + 1);
+			}
+
+			AxisWeights axis;
+			axis.numTaps = numTaps;
+			axis.srcIxs.resize(dstSize * numTaps);
+			axis.weights.resize(dstSize * numTaps);
+			for(int dstIx = 0; dstIx < dstSize; ++dstIx)
+			{
+				for(int tapIx = 0; tapIx < numTaps; ++tapIx)
+				{
+					int srcIx = std::min(std::max(firstIxs[dstIx] + tapIx, 0), srcSize - 1);
+					axis.srcIxs[dstIx * numTaps + tapIx] = srcIx;
+					axis.weights[dstIx * numTaps + tapIx] = (float)allWeights[dstIx * maxTaps + tapIx];
+				}
+			}
+
+			return axis;
+		}
+
+		void FilterRowHorizontal(const float *pSrcRow, const AxisWeights &axis, int dstWidth, float *pDstRow)
+		{
+			const int *pSrcIxs = &axis.srcIxs[0];
+			const float *pWeights = &axis.weights[0];
+			for(int dstIx = 0; dstIx < dstWidth; ++dstIx)
+			{
+#ifdef GLIMG_USE_SSE
+				__m128 sum = _mm_setzero_ps();
+				for(int tapIx = 0; tapIx < axis.numTaps; ++tapIx)
+				{
+					__m128 texel = _mm_loadu_ps(pSrcRow + 4 * pSrcIxs[tapIx]);
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(pWeights[tapIx]), texel));
+				}
+				_mm_storeu_ps(pDstRow, sum);
+#else
+				float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+				for(int tapIx = 0; tapIx < axis.numTaps; ++tapIx)
+				{
+					const float *pTexel = pSrcRow + 4 * pSrcIxs[tapIx];
+					for(int compIx = 0; compIx < 4; ++compIx)
+						sum[compIx] += pWeights[tapIx] * pTexel[compIx];
+				}
+				memcpy(pDstRow, sum, sizeof(sum));
+#endif
+				pSrcIxs += axis.numTaps;
+				pWeights += axis.numTaps;
+				pDstRow += 4;
+			}
+		}
+
+		//Sums numFloats floats from each of numTaps rows, weighted.
+		void FilterRowsVertical(const float *const *ppSrcRows, const float *pWeights, int numTaps,
+			int numFloats, float *pDstRow)
+		{
+			int floatIx = 0;
+#ifdef GLIMG_USE_SSE
+			for(; floatIx + 4 <= numFloats; floatIx += 4)
+			{
+				__m128 sum = _mm_setzero_ps();
+				for(int tapIx = 0; tapIx < numTaps; ++tapIx)
+				{
+					__m128 values = _mm_loadu_ps(ppSrcRows[tapIx] + floatIx);
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(pWeights[tapIx]), values));
+				}
+				_mm_storeu_ps(pDstRow + floatIx, sum);
+			}
+#endif
+			for(; floatIx < numFloats; ++floatIx)
+			{
+				float sum = 0.0f;
+				for(int tapIx = 0; tapIx < numTaps; ++tapIx)
+					sum += pWeights[tapIx] * ppSrcRows[tapIx][floatIx];
+				pDstRow[floatIx] = sum;
+			}
+		}
+
+		//Uninitialized scratch memory; a std::vector would clear it first.
+		class FloatScratch
+		{
+		public:
+			explicit FloatScratch(size_t numFloats) : m_pFloats(numFloats ? new float[numFloats] : NULL) {}
+			~FloatScratch() {delete[] m_pFloats;}
+
+			float *Get() {return m_pFloats;}
+
+		private:
+			float *m_pFloats;
+
+			FloatScratch(const FloatScratch &);
+			FloatScratch &operator=(const FloatScratch &);
+		};
+
+		//Destination rows are filtered in bands. Each band horizontally filters the source
+		//rows it needs into its own scratch memory, so no full-size intermediate is needed.
+		const int g_rowsPerBand = 32;
+
+		//Makes one mipmap level of every image from the level before it.
+		class MipmapLevelTask : public ParallelTask
+		{
+		public:
+			MipmapLevelTask(MipmapFilter filter, const TexelLayout &layout, int numImages,
+				int srcWidth, int srcHeight, int dstWidth, int dstHeight)
+				: m_layout(layout)
+				, m_numImages(numImages)
+				, m_srcWidth(srcWidth)
+				, m_srcHeight(srcHeight)
+				, m_dstWidth(dstWidth)
+				, m_dstHeight(dstHeight)
+				, m_horizWeights(CalcAxisWeights(filter, srcWidth, dstWidth))
+				, m_vertWeights(CalcAxisWeights(filter, srcHeight, dstHeight))
+				, m_pSrcBytes(NULL)
+				, m_srcRowPitch(0)
+				, m_pSrcFloats(NULL)
+				, m_pDstFloats(NULL)
+				, m_pDstBytes(NULL)
+				, m_dstRowPitch(0)
+			{}
+
+			//The level 0 texels, as stored.
+			void SetSrcBytes(const unsigned char *pSrcBytes, size_t rowPitch)
+			{
+				m_pSrcBytes = pSrcBytes;
+				m_srcRowPitch = rowPitch;
+			}
+
+			//A previous level, as linear floats.
+			void SetSrcFloats(const float *pSrcFloats) {m_pSrcFloats = pSrcFloats;}
+
+			//Where to keep this level's floats for the next one. May be NULL.
+			void SetDstFloats(float *pDstFloats) {m_pDstFloats = pDstFloats;}
+
+			void SetDstBytes(unsigned char *pDstBytes, size_t rowPitch)
+			{
+				m_pDstBytes = pDstBytes;
+				m_dstRowPitch = rowPitch;
+			}
+
+			int GetNumItems() const
+			{
+				return m_numImages * GetNumBands();
+			}
+
+			virtual void Execute(int itemIx)
+			{
+				int imageIx = itemIx / GetNumBands();
+				int firstDstRow = (itemIx % GetNumBands()) * g_rowsPerBand;
+				int lastDstRow = std::min(firstDstRow + g_rowsPerBand, m_dstHeight) - 1;
+
+				const int numTaps = m_vertWeights.numTaps;
+				int firstSrcRow = m_vertWeights.srcIxs[firstDstRow * numTaps];
+				int lastSrcRow = firstSrcRow;
+				for(int tapIx = 0; tapIx < numTaps * (lastDstRow - firstDstRow + 1); ++tapIx)
+				{
+					int srcRow = m_vertWeights.srcIxs[firstDstRow * numTaps + tapIx];
+					firstSrcRow = std::min(firstSrcRow, srcRow);
+					lastSrcRow = std::max(lastSrcRow, srcRow);
+				}
+
+				//Horizontally filtered source rows.
+				const int dstRowFloats = m_dstWidth * 4;
+				FloatScratch filteredRows((lastSrcRow - firstSrcRow + 1) * dstRowFloats);
+				FloatScratch decodedRow(m_pSrcFloats ? 0 : m_srcWidth * 4);
+				for(int srcRow = firstSrcRow; srcRow <= lastSrcRow; ++srcRow)
+				{
+					const float *pSrcRow = NULL;
+					if(m_pSrcFloats)
+						pSrcRow = m_pSrcFloats + ((size_t)imageIx * m_srcHeight + srcRow) * m_srcWidth * 4;
+					else
+					{
+						const unsigned char *pSrcBytes =
+							m_pSrcBytes + ((size_t)imageIx * m_srcHeight + srcRow) * m_srcRowPitch;
+						DecodeRow(pSrcBytes, m_srcWidth, m_layout, decodedRow.Get());
+						pSrcRow = decodedRow.Get();
+					}
+
+					FilterRowHorizontal(pSrcRow, m_horizWeights, m_dstWidth,
+						filteredRows.Get() + (srcRow - firstSrcRow) * dstRowFloats);
+				}
+
+				std::vector<const float *> tapRows(numTaps);
+				FloatScratch dstRowScratch(m_pDstFloats ? 0 : dstRowFloats);
+				for(int dstRow = firstDstRow; dstRow <= lastDstRow; ++dstRow)
+				{
+					for(int tapIx = 0; tapIx < numTaps; ++tapIx)
+					{
+						int srcRow = m_vertWeights.srcIxs[dstRow * numTaps + tapIx];
+						tapRows[tapIx] = filteredRows.Get() + (srcRow - firstSrcRow) * dstRowFloats;
+					}
+
+					float *pDstRow = m_pDstFloats ?
+						m_pDstFloats + ((size_t)imageIx * m_dstHeight + dstRow) * dstRowFloats : dstRowScratch.Get();
+					FilterRowsVertical(&tapRows[0], &m_vertWeights.weights[dstRow * numTaps], numTaps,
+						dstRowFloats, pDstRow);
+
+					EncodeRow(pDstRow, m_dstWidth, m_layout,
+						m_pDstBytes + ((size_t)imageIx * m_dstHeight + dstRow) * m_dstRowPitch);
+				}
+			}
+
+		private:
+			const TexelLayout m_layout;
+			const int m_numImages;
+			const int m_srcWidth;
+			const int m_srcHeight;
+			const int m_dstWidth;
+			const int m_dstHeight;
+			const AxisWeights m_horizWeights;
+			const AxisWeights m_vertWeights;
+
+			const unsigned char *m_pSrcBytes;
+			size_t m_srcRowPitch;
+			const float *m_pSrcFloats;
+			float *m_pDstFloats;
+			unsigned char *m_pDstBytes;
+			size_t m_dstRowPitch;
+
+			int GetNumBands() const
+			{
+				return (m_dstHeight + g_rowsPerBand - 1) / g_rowsPerBand;
+			}
+		};
+
+		int GetHeight(const Dimensions &dims)
+		{
+			return dims.numDimensions > 1 ? dims.height : 1;
+		}
+
+		size_t GetLevelFloatCount(const Dimensions &baseDims, int level, int numImages)
+		{
+			Dimensions levelDims = ModifySizeForMipmap(baseDims, level);
+			return (size_t)numImages * GetHeight(levelDims) * levelDims.width * 4;
+		}
+	}
+
+	ImageSet *GenerateMipmaps( const ImageSet &imageSet, MipmapFilter filter,
+		unsigned int flags, int numThreads )
+	{
+		ImageFormat format = imageSet.GetFormat();
+		TexelLayout layout = GetTexelLayout(format, flags);
+
+		Dimensions baseDims = imageSet.GetDimensions();
+		if(baseDims.numDimensions == 3)
+			throw MipmapUnsupportedException("3D images are not supported.");
+
+		int maxSize = std::max(baseDims.width, GetHeight(baseDims));
+		int mipmapCount = 1;
+		while(maxSize >> mipmapCount)
+			++mipmapCount;
+
+		const int arrayCount = imageSet.GetArrayCount();
+		const int faceCount = imageSet.GetFaceCount();
+		const int numImages = arrayCount * faceCount;
+
+		ImageCreator creator(format, baseDims, mipmapCount, arrayCount, faceCount);
+		creator.SetFullMipmapLevel(imageSet.GetImageArray(0), false, 0);
+
+		std::auto_ptr<ThreadPool> pOwnPool;
+		if(numThreads > 0)
+			pOwnPool.reset(new ThreadPool(numThreads));
+		ThreadPool &pool = pOwnPool.get() ? *pOwnPool : GetSharedThreadPool();
+
+		//Odd levels go in the first buffer and even ones in the second; they only get smaller.
+		FloatScratch oddLevelFloats(mipmapCount > 2 ? GetLevelFloatCount(baseDims, 1, numImages) : 0);
+		FloatScratch evenLevelFloats(mipmapCount > 3 ? GetLevelFloatCount(baseDims, 2, numImages) : 0);
+
+		ImageBuffer dstBytes;
+		for(int level = 1; level < mipmapCount; ++level)
+		{
+			Dimensions srcDims = ModifySizeForMipmap(baseDims, level - 1);
+			Dimensions dstDims = ModifySizeForMipmap(baseDims, level);
+			int dstHeight = GetHeight(dstDims);
+
+			MipmapLevelTask task(filter, layout, numImages, srcDims.width, GetHeight(srcDims),
+				dstDims.width, dstHeight);
+
+			if(level == 1)
+				task.SetSrcBytes(static_cast<const unsigned char *>(imageSet.GetImageArray(0)),
+					format.AlignByteCount(layout.texelByteSize * srcDims.width));
+			else
+				task.SetSrcFloats(level % 2 ? evenLevelFloats.Get() : oddLevelFloats.Get());
+
+			if(level + 1 < mipmapCount)
+				task.SetDstFloats(level % 2 ? oddLevelFloats.Get() : evenLevelFloats.Get());
+
+			size_t dstRowPitch = format.AlignByteCount(layout.texelByteSize * dstDims.width);
+			dstBytes.assign((size_t)numImages * dstHeight * dstRowPitch, 0);
+			task.SetDstBytes(&dstBytes[0], dstRowPitch);
+
+			pool.ParallelFor(task, task.GetNumItems());
+
+			creator.SetFullMipmapLevel(&dstBytes[0], false, level);
+		}
+
+		return creator.CreateImage();
+	}
+}
@@ -4,10 +4,13 @@
 
 
 #include <assert.h>
+#include <memory>
 #include <glload/gl_all.hpp>
 #include <glload/gll.hpp>
 #include "glimg/TextureGeneratorExceptions.h"
 #include "glimg/TextureGenerator.h"
+#include "glimg/BlockCompressor.h"
+#include "glimg/FormatConverter.h"
 #include "ImageSetImpl.h"
 #include "Util.h"
 
@@ -42,8 +45,11 @@ namespace glimg
 
 		void ThrowIfBPTCNotSupported()
 		{
-			if(!glext_ARB_texture_compression_bptc)
-				throw ImageFormatUnsupportedException("PBTC not supported.");
+			if(!glload::IsVersionGEQ(4, 2))
+			{
+				if(!glext_ARB_texture_compression_bptc)
+					throw ImageFormatUnsupportedException("BPTC not supported.");
+			}
 		}
 
 		void ThrowIfSRGBNotSupported()
@@ -166,6 +172,22 @@ namespace glimg
 				throw CannotForceRenderTargetException();
 		}
 
+		//The format that CreateTexture converts images to before uploading them.
+		ImageFormat GetRenderTargetFormat(const ImageFormat &format, unsigned int forceConvertBits)
+		{
+			if(!(forceConvertBits & FORCE_COLOR_RENDERABLE_FMT))
+				return format;
+
+			try
+			{
+				return GetColorRenderableFormat(format);
+			}
+			catch(ConversionUnsupportedException &)
+			{
+				throw CannotForceRenderTargetException();
+			}
+		}
+
 		void ThrowIfDepthNotSupported()
 		{
 			if(!glload::IsVersionGEQ(1, 4)) //Yes, really. Depth textures are old.
@@ -508,6 +530,10 @@ namespace glimg
 					if(format.Components() == FMT_DEPTH)
 						ThrowIfDepthFloatNotSupported();
 
+					//RGB float formats cannot be rendered to, so the X component is kept as alpha.
+					if(format.Components() == FMT_COLOR_RGBX && (forceConvertBits & FORCE_COLOR_RENDERABLE_FMT))
+						return offset ? gl::GL_RGBA32F : gl::GL_RGBA16F;
+
 					return ThrowInvalidFormatIfZero(g_floatFormats[(2 * format.Components()) + offset]);
 				}
 				else
@@ -586,7 +612,7 @@ namespace glimg
 
 			case DT_COMPRESSED_SIGNED_BC6H:
 				ThrowIfBPTCNotSupported();
-				return gl::GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB;
+				return gl::GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB;
 
 			case DT_COMPRESSED_BC7:
 				ThrowIfBPTCNotSupported();
@@ -669,10 +695,15 @@ namespace glimg
 	unsigned int GetOpenGLType( const ImageFormat &format, OpenGLPixelTransferParams &ret, PixelDataType eType, GLenum g_packedTypes );
 	unsigned int GetInternalFormat( const ImageFormat &format, unsigned int forceConvertBits )
 	{
-		unsigned int internalFormat = GetStandardOpenGLFormat(format, forceConvertBits);
+		unsigned int internalFormat = GetStandardOpenGLFormat(
+			GetRenderTargetFormat(format, forceConvertBits), forceConvertBits);
 
 		bool bConvertToLA = UseLAInsteadOfRG(forceConvertBits);
 
+		//Luminance formats cannot be rendered to.
+		if(bConvertToLA && ComponentCount(format, forceConvertBits) < 3)
+			ThrowIfForceRendertarget(forceConvertBits);
+
 		//Convert any R or RG formats to L or LA formats.
 		switch(internalFormat)
 		{
@@ -918,6 +949,9 @@ namespace glimg
 		ret.format = 0xFFFFFFFF;
 		ret.blockByteCount = 0;
 
+		//The data is described as it is; this only throws if it cannot be made renderable.
+		GetRenderTargetFormat(format, forceConvertBits);
+
 		PixelDataType eType = GetDataType(format, forceConvertBits);
 		if(eType >= DT_NUM_UNCOMPRESSED_TYPES)
 		{
@@ -935,7 +969,7 @@ namespace glimg
 
 			//Provide reasonable parameters.
 			ret.format = gl::GL_RGBA;
-			if(eType != DT_COMPRESSED_UNSIGNED_BC6H || eType != DT_COMPRESSED_SIGNED_BC6H)
+			if(eType == DT_COMPRESSED_UNSIGNED_BC6H || eType == DT_COMPRESSED_SIGNED_BC6H)
 				ret.type = gl::GL_FLOAT;
 			else
 				ret.type = gl::GL_UNSIGNED_BYTE;
@@ -1125,14 +1159,15 @@ namespace glimg
 						upload.format, upload.type, NULL);
 					break;
 				case 3:
-					gl::TexImage1D(texTarget, mipmap, internalFormat, levelDims.width, 0,
-						upload.format, upload.type, NULL);
+					gl::TexImage3D(texTarget, mipmap, internalFormat, levelDims.width, levelDims.height,
+						levelDims.depth, 0, upload.format, upload.type, NULL);
 					break;
 				}
 			}
 		}
 
-		//For 1D, 2D arrays, and array/cubemap
+		//For 1D, 2D arrays, and array/cubemap. arrayCount is the number of layers, which is
+		//6 per cube for array/cubemaps.
 		//Texture must be bound to the target.
 		void ManTexStorageArray(GLenum texTarget, Dimensions dims, GLuint numMipmaps, GLuint arrayCount,
 			GLenum internalFormat, const OpenGLPixelTransferParams &upload)
@@ -1147,9 +1182,6 @@ namespace glimg
 						upload.format, upload.type, NULL);
 					break;
 				case 2:
-					if(texTarget == gl::GL_TEXTURE_CUBE_MAP_ARRAY)
-						arrayCount *= 6;
-
 					gl::TexImage3D(texTarget, mipmap, internalFormat, levelDims.width, levelDims.height, arrayCount,
 						0, upload.format, upload.type, NULL);
 					break;
@@ -1206,8 +1238,8 @@ namespace glimg
 						upload.format, upload.type, NULL);
 					break;
 				case 3:
-					gl::TextureImage1DEXT(texture, texTarget, mipmap, internalFormat, levelDims.width, 0,
-						upload.format, upload.type, NULL);
+					gl::TextureImage3DEXT(texture, texTarget, mipmap, internalFormat, levelDims.width,
+						levelDims.height, levelDims.depth, 0, upload.format, upload.type, NULL);
 					break;
 				}
 			}
@@ -1312,10 +1344,36 @@ namespace glimg
 			}
 		}
 
+		size_t g_uploadByteCount = 0;
+
+		//Set by CreateTextureFromBuffer. Pixel data pointers are offsets into this buffer.
+		GLuint g_unpackBuffer = 0;
+
+		//The buffer is only bound around the uploads, so that storage allocation with NULL
+		//data does not read from it.
+		class UnpackBufferBinder
+		{
+		public:
+			UnpackBufferBinder()
+			{
+				if(g_unpackBuffer)
+					gl::BindBuffer(gl::GL_PIXEL_UNPACK_BUFFER, g_unpackBuffer);
+			}
+
+			~UnpackBufferBinder()
+			{
+				if(g_unpackBuffer)
+					gl::BindBuffer(gl::GL_PIXEL_UNPACK_BUFFER, 0);
+			}
+		};
+
 		void TexSubImage(GLuint texture, GLenum texTarget, GLuint mipmap, GLuint internalFormat,
 			Dimensions dims, const OpenGLPixelTransferParams &upload,
 			const void *pPixelData, size_t pixelByteSize)
 		{
+			g_uploadByteCount += pixelByteSize;
+			UnpackBufferBinder bindBuffer;
+
 			//Zero means bound, so no DSA.
 			if(texture == 0)
 			{
@@ -1403,6 +1461,36 @@ namespace glimg
 			}
 		}
 
+		//Array textures are stored as one image with an extra dimension: one layer per
+		//array element, or per face for array/cubemaps.
+		Dimensions GetLayeredDimensions(Dimensions dims, int numLayers)
+		{
+			if(dims.numDimensions == 1)
+				dims.height = numLayers;
+			else
+				dims.depth = numLayers;
+
+			dims.numDimensions++;
+			return dims;
+		}
+
+		//Works for 1D/2D arrays and array/cubemaps.
+		void TexStorageArray( GLenum texTarget, unsigned int forceConvertBits, Dimensions dims,
+			const int numMipmaps, const int numLayers, GLuint internalFormat,
+			const OpenGLPixelTransferParams & upload, GLuint textureName )
+		{
+			if(forceConvertBits & USE_TEXTURE_STORAGE)
+			{
+				TexStorage(textureName, texTarget, GetLayeredDimensions(dims, numLayers),
+					numMipmaps, internalFormat);
+			}
+			else
+			{
+				ManTexStorageArray(textureName, texTarget, dims, numMipmaps, numLayers,
+					internalFormat, upload);
+			}
+		}
+
 
 		class TextureBinder
 		{
@@ -1420,11 +1508,43 @@ namespace glimg
 			GLenum texTarget;
 		};
 
+		//Works for 1D/2D arrays and array/cubemaps.
+		void BuildArrayTexture(GLenum texTarget, unsigned int textureName, const detail::ImageSetImpl *pImage,
+			unsigned int forceConvertBits, GLuint internalFormat, const OpenGLPixelTransferParams &upload)
+		{
+			SetupUploadState(pImage->GetFormat(), forceConvertBits);
+			TextureBinder bind;
+			if(!(forceConvertBits & USE_DSA))
+			{
+				bind.Bind(texTarget, textureName);
+				textureName = 0;
+			}
+
+			const int numMipmaps = pImage->GetMipmapCount();
+			const int numLayers = pImage->GetArrayCount() * pImage->GetFaceCount();
+			TexStorageArray(texTarget, forceConvertBits, pImage->GetDimensions(),
+				numMipmaps, numLayers, internalFormat, upload, textureName);
+
+			for(int mipmap = 0; mipmap < numMipmaps; mipmap++)
+			{
+				Dimensions dims = GetLayeredDimensions(pImage->GetDimensions(mipmap), numLayers);
+
+				//The images of a mipmap level are contiguous, in the order OpenGL wants its layers.
+				const void *pPixelData = pImage->GetImageData(mipmap);
+
+				TexSubImage(textureName, texTarget, mipmap, internalFormat, dims, upload,
+					pPixelData, pImage->GetImageByteSize(mipmap) * numLayers);
+			}
+
+			FinalizeTexture(textureName, texTarget, pImage);
+		}
+
 		void Build1DArrayTexture(unsigned int textureName, const detail::ImageSetImpl *pImage,
 			unsigned int forceConvertBits, GLuint internalFormat, const OpenGLPixelTransferParams &upload)
 		{
 			ThrowIfArrayTextureNotSupported();
-			throw TextureUnexpectedException();
+			BuildArrayTexture(gl::GL_TEXTURE_1D_ARRAY, textureName, pImage, forceConvertBits,
+				internalFormat, upload);
 		}
 
 		void Build1DTexture(unsigned int textureName, const detail::ImageSetImpl *pImage,
@@ -1459,14 +1579,16 @@ namespace glimg
 		{
 			ThrowIfArrayTextureNotSupported();
 			ThrowIfCubeArrayTextureNotSupported();
-			throw TextureUnexpectedException();
+			BuildArrayTexture(gl::GL_TEXTURE_CUBE_MAP_ARRAY, textureName, pImage, forceConvertBits,
+				internalFormat, upload);
 		}
 
 		void Build2DArrayTexture(unsigned int textureName, const detail::ImageSetImpl *pImage,
 			unsigned int forceConvertBits, GLuint internalFormat, const OpenGLPixelTransferParams &upload)
 		{
 			ThrowIfArrayTextureNotSupported();
-			throw TextureUnexpectedException();
+			BuildArrayTexture(gl::GL_TEXTURE_2D_ARRAY, textureName, pImage, forceConvertBits,
+				internalFormat, upload);
 		}
 
 		void Build2DCubeTexture(unsigned int textureName, const detail::ImageSetImpl *pImage,
@@ -1627,6 +1749,31 @@ namespace glimg
 
 	void CreateTexture(unsigned int textureName, const ImageSet *pImage, unsigned int forceConvertBits)
 	{
+		if(forceConvertBits & FORCE_BLOCK_COMPRESSED_FMT)
+		{
+			forceConvertBits &= ~FORCE_BLOCK_COMPRESSED_FMT;
+			if(CanCompressImage(*pImage))
+			{
+				std::auto_ptr<ImageSet> pCompressed(CompressImage(*pImage,
+					GetDefaultCompressedType(pImage->GetFormat())));
+				CreateTexture(textureName, pCompressed.get(), forceConvertBits);
+				return;
+			}
+		}
+
+		if(forceConvertBits & FORCE_COLOR_RENDERABLE_FMT)
+		{
+			//Converting to the renderable format never changes it again.
+			const ImageFormat &format = pImage->GetFormat();
+			ImageFormat renderFormat = GetRenderTargetFormat(format, forceConvertBits);
+			if(renderFormat.Components() != format.Components())
+			{
+				std::auto_ptr<ImageSet> pConverted(ConvertImage(*pImage, renderFormat));
+				CreateTexture(textureName, pConverted.get(), forceConvertBits);
+				return;
+			}
+		}
+
 		if(forceConvertBits & FORCE_TEXTURE_STORAGE)
 		{
 			if(!IsTextureStorageSupported())
@@ -1689,4 +1836,30 @@ namespace glimg
 			break;
 		}
 	}
+
+	size_t GetTextureUploadByteCount()
+	{
+		return g_uploadByteCount;
+	}
+
+	void CreateTextureFromBuffer(unsigned int textureName, const ImageSet *pImage,
+		unsigned int forceConvertBits, unsigned int unpackBuffer)
+	{
+		//The image's data is in the buffer, so it cannot be compressed or converted here.
+		//TextureUploadQueue converts images to their renderable format before filling buffers.
+		forceConvertBits &= ~FORCE_BLOCK_COMPRESSED_FMT;
+
+		g_unpackBuffer = unpackBuffer;
+		try
+		{
+			CreateTexture(textureName, pImage, forceConvertBits);
+		}
+		catch(...)
+		{
+			g_unpackBuffer = 0;
+			throw;
+		}
+
+		g_unpackBuffer = 0;
+	}
 }
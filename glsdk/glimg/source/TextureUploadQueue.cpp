@@ -0,0 +1,810 @@
+//Copyright (C) 2011 by Jason L. McKesson
+//This file is licensed by the MIT License.
+
+
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <memory>
+#include <exception>
+#include <string.h>
+#include <glload/gl_all.hpp>
+#include <glload/gll.hpp>
+#include "glimg/TextureUploadQueue.h"
+#include "glimg/TextureGenerator.h"
+#include "glimg/ImageCreator.h"
+#include "glimg/BlockCompressor.h"
+#include "glimg/FormatConverter.h"
+#include "glimg/DdsLoader.h"
+#include "ImageSetImpl.h"
+#include "WorkQueue.h"
+#include "Util.h"
+
+namespace glimg
+{
+	namespace detail
+	{
+		//Shared by the handles and the queue. Only touched on the OpenGL thread.
+		struct TextureUploadState
+		{
+			TextureUploadState()
+				: refCount(0)
+				, isReady(false)
+				, texture(0)
+				, textureType(0)
+			{}
+
+			int refCount;
+			bool isReady;
+			std::string errorMessage;
+			GLuint texture;
+			GLenum textureType;
+		};
+	}
+
+	namespace
+	{
+		void AddRef(detail::TextureUploadState *pState)
+		{
+			if(pState)
+				++pState->refCount;
+		}
+
+		void Release(detail::TextureUploadState *pState)
+		{
+			if(pState && --pState->refCount == 0)
+				delete pState;
+		}
+	}
+
+	TextureUploadHandle::TextureUploadHandle()
+		: m_pState(NULL)
+	{}
+
+	TextureUploadHandle::TextureUploadHandle( detail::TextureUploadState *pState )
+		: m_pState(pState)
+	{
+		AddRef(m_pState);
+	}
+
+	TextureUploadHandle::TextureUploadHandle( const TextureUploadHandle &other )
+		: m_pState(other.m_pState)
+	{
+		AddRef(m_pState);
+	}
+
+	TextureUploadHandle & TextureUploadHandle::operator=( const TextureUploadHandle &other )
+	{
+		AddRef(other.m_pState);
+		Release(m_pState);
+		m_pState = other.m_pState;
+		return *this;
+	}
+
+	TextureUploadHandle::~TextureUploadHandle()
+	{
+		Release(m_pState);
+	}
+
+	bool TextureUploadHandle::IsValid() const
+	{
+		return m_pState != NULL;
+	}
+
+	bool TextureUploadHandle::IsReady() const
+	{
+		return m_pState && m_pState->isReady;
+	}
+
+	bool TextureUploadHandle::HasFailed() const
+	{
+		return IsReady() && !m_pState->errorMessage.empty();
+	}
+
+	unsigned int TextureUploadHandle::GetTexture() const
+	{
+		if(!IsReady())
+			return 0;
+
+		if(HasFailed())
+			throw TextureUploadFailedException(m_pState->errorMessage);
+
+		return m_pState->texture;
+	}
+
+	unsigned int TextureUploadHandle::GetTextureType() const
+	{
+		if(!IsReady())
+			return 0;
+
+		return m_pState->textureType;
+	}
+
+	namespace
+	{
+		//Each mipmap level starts at this alignment in a buffer, which is more than any row alignment.
+		const size_t LEVEL_ALIGNMENT = 16;
+
+		size_t AlignLevelOffset(size_t offset)
+		{
+			return (offset + LEVEL_ALIGNMENT - 1) & ~(LEVEL_ALIGNMENT - 1);
+		}
+
+		//The bytes for all of the images of a mipmap level, as GetImageArray lays them out.
+		size_t GetLevelByteSize(const ImageSet &imageSet, int mipmapLevel)
+		{
+			return imageSet.GetImage(mipmapLevel).GetImageByteSize() *
+				imageSet.GetArrayCount() * imageSet.GetFaceCount();
+		}
+
+		size_t GetBufferByteSize(const ImageSet &imageSet)
+		{
+			size_t byteSize = 0;
+			for(int mipmapLevel = 0; mipmapLevel < imageSet.GetMipmapCount(); ++mipmapLevel)
+				byteSize = AlignLevelOffset(byteSize + GetLevelByteSize(imageSet, mipmapLevel));
+
+			return byteSize;
+		}
+
+		ImageSet *CreateFlippedImage(const ImageSet &topLeftImage)
+		{
+			ImageCreator creator(topLeftImage.GetFormat(), topLeftImage.GetDimensions(),
+				topLeftImage.GetMipmapCount(), topLeftImage.GetArrayCount(), topLeftImage.GetFaceCount());
+
+			std::vector<ImageDataSource> images;
+			for(int mipmapLevel = 0; mipmapLevel < topLeftImage.GetMipmapCount(); ++mipmapLevel)
+			{
+				for(int arrayIx = 0; arrayIx < topLeftImage.GetArrayCount(); ++arrayIx)
+				{
+					for(int faceIx = 0; faceIx < topLeftImage.GetFaceCount(); ++faceIx)
+					{
+						ImageDataSource image = {topLeftImage.GetImage(mipmapLevel, arrayIx, faceIx).GetImageData(),
+							mipmapLevel, arrayIx, faceIx};
+						images.push_back(image);
+					}
+				}
+			}
+
+			creator.SetImageDataBatch(&images[0], (int)images.size(), true);
+			return creator.CreateImage();
+		}
+
+		enum UploadStage
+		{
+			STAGE_LOADING,		//On a worker, loading the file and compressing the image.
+			STAGE_WAITING,		//For room in a buffer.
+			STAGE_COPYING,		//On a worker, copying the images into the buffer.
+			STAGE_COPIED,		//For the rest of the buffer's uploads to be copied.
+			STAGE_UPLOADING,	//For the buffer's fence.
+		};
+
+		class UploadJob : public detail::WorkItem
+		{
+		public:
+			UploadJob(detail::TextureUploadState *pUploadState, unsigned int convertBits, size_t maxByteSize)
+				: pState(pUploadState)
+				, stage(STAGE_WAITING)
+				, pImage(NULL)
+				, isTopLeft(false)
+				, forceConvertBits(convertBits)
+				, bufferByteSize(maxByteSize)
+				, bufferIx(-1)
+				, bufferOffset(0)
+				, pDest(NULL)
+			{
+				AddRef(pState);
+			}
+
+			virtual ~UploadJob()
+			{
+				Release(pState);
+			}
+
+			virtual void Execute()
+			{
+				try
+				{
+					if(stage == STAGE_LOADING)
+						Load();
+					else
+						CopyImages();
+				}
+				catch(std::exception &e)
+				{
+					RecordError(e.what());
+				}
+				catch(...)
+				{
+					RecordError("");
+				}
+			}
+
+			void RecordError(const std::string &message)
+			{
+				errorMessage = message;
+				if(errorMessage.empty())
+					errorMessage = "Unknown exception in a texture upload.";
+			}
+
+			//An ImageSet that describes the images as they are laid out in the buffer.
+			ImageSet *CreateBufferImage() const
+			{
+				std::vector<const unsigned char *> levelData;
+				std::vector<size_t> imageSizes;
+
+				size_t offset = bufferOffset;
+				for(int mipmapLevel = 0; mipmapLevel < pImage->GetMipmapCount(); ++mipmapLevel)
+				{
+					levelData.push_back(reinterpret_cast<const unsigned char *>(offset));
+					imageSizes.push_back(pImage->GetImage(mipmapLevel).GetImageByteSize());
+					offset = AlignLevelOffset(offset + GetLevelByteSize(*pImage, mipmapLevel));
+				}
+
+				std::auto_ptr<detail::ImageSetImpl> pImpl(new detail::ImageSetImpl(pImage->GetFormat(),
+					pImage->GetDimensions(), pImage->GetMipmapCount(), pImage->GetArrayCount(),
+					pImage->GetFaceCount(), levelData, imageSizes, NULL));
+				ImageSet *pBufferImage = detail::ImageSetImpl::CreateImageSet(pImpl.get());
+				pImpl.release();
+				return pBufferImage;
+			}
+
+			detail::TextureUploadState *pState;
+			UploadStage stage;
+
+			std::string filename;
+			const ImageSet *pImage;
+			std::auto_ptr<ImageSet> pOwnedImage;
+			bool isTopLeft;
+			unsigned int forceConvertBits;
+			size_t bufferByteSize;
+
+			int bufferIx;
+			size_t bufferOffset;
+			unsigned char *pDest;
+
+			std::string errorMessage;
+
+		private:
+			void SetOwnedImage(ImageSet *pNewImage)
+			{
+				std::auto_ptr<ImageSet> pNewOwnedImage(pNewImage);
+				pOwnedImage = pNewOwnedImage;
+				pImage = pOwnedImage.get();
+			}
+
+			void Load()
+			{
+				const bool shouldCompress = (forceConvertBits & FORCE_BLOCK_COMPRESSED_FMT) != 0;
+
+				if(!filename.empty())
+				{
+					//Left top-down, it can be flipped straight into the buffer. Compression needs
+					//the rows the right way up.
+					unsigned int ddsFlags = shouldCompress ? 0 : loaders::dds::KEEP_TOP_LEFT_ORIGIN;
+					SetOwnedImage(loaders::dds::LoadFromFile(filename, ddsFlags));
+					isTopLeft = !shouldCompress;
+				}
+
+				if(shouldCompress)
+				{
+					forceConvertBits &= ~FORCE_BLOCK_COMPRESSED_FMT;
+					if(CanCompressImage(*pImage))
+						SetOwnedImage(CompressImage(*pImage, GetDefaultCompressedType(pImage->GetFormat())));
+				}
+
+				//The buffer cannot be converted by CreateTextureFromBuffer. Conversion keeps the
+				//order of the rows, so top-down images stay top-down. Formats that cannot be made
+				//renderable are left for CreateTexture to reject.
+				if(forceConvertBits & FORCE_COLOR_RENDERABLE_FMT)
+				{
+					const ImageFormat &format = pImage->GetFormat();
+					try
+					{
+						ImageFormat renderFormat = GetColorRenderableFormat(format);
+						if(renderFormat.Components() != format.Components())
+							SetOwnedImage(ConvertImage(*pImage, renderFormat));
+					}
+					catch(ConversionUnsupportedException &)
+					{
+					}
+				}
+
+				//Too big for a buffer, so it will go through CreateTexture.
+				if(isTopLeft && GetBufferByteSize(*pImage) > bufferByteSize)
+				{
+					SetOwnedImage(CreateFlippedImage(*pImage));
+					isTopLeft = false;
+				}
+			}
+
+			void CopyImages()
+			{
+				const ImageFormat format = pImage->GetFormat();
+				const int numImages = pImage->GetArrayCount() * pImage->GetFaceCount();
+
+				size_t offset = 0;
+				for(int mipmapLevel = 0; mipmapLevel < pImage->GetMipmapCount(); ++mipmapLevel)
+				{
+					const SingleImage image = pImage->GetImage(mipmapLevel);
+					const size_t imageSize = image.GetImageByteSize();
+					const unsigned char *pSrcLevel =
+						static_cast<const unsigned char *>(pImage->GetImageArray(mipmapLevel));
+					unsigned char *pDstLevel = pDest + offset;
+
+					if(isTopLeft)
+					{
+						for(int imageIx = 0; imageIx < numImages; ++imageIx)
+						{
+							FlipImageData(format, image.GetDimensions(), pSrcLevel + imageIx * imageSize,
+								pDstLevel + imageIx * imageSize, imageSize);
+						}
+					}
+					else
+						memcpy(pDstLevel, pSrcLevel, imageSize * numImages);
+
+					offset = AlignLevelOffset(offset + imageSize * numImages);
+				}
+			}
+		};
+
+		enum BufferState
+		{
+			BUFFER_FREE,
+			BUFFER_MAPPED,
+			BUFFER_IN_FLIGHT,
+		};
+
+		struct UploadBuffer
+		{
+			UploadBuffer()
+				: buffer(0)
+				, state(BUFFER_FREE)
+				, pMapped(NULL)
+				, usedBytes(0)
+				, numCopying(0)
+				, fence(0)
+			{}
+
+			GLuint buffer;
+			BufferState state;
+			unsigned char *pMapped;
+			size_t usedBytes;
+			int numCopying;
+			GLsync fence;
+
+			std::vector<UploadJob *> jobs;
+		};
+	}
+
+	namespace detail
+	{
+		struct TextureUploadQueueData
+		{
+			TextureUploadQueueData()
+				: bufferByteSize(0)
+				, fillIx(-1)
+				, nextIx(0)
+				, numWorking(0)
+			{}
+
+			size_t bufferByteSize;
+			std::vector<UploadBuffer> buffers;
+			int fillIx;		//The mapped buffer that new uploads go into, or -1.
+			int nextIx;		//The buffer to map after that one.
+
+			std::auto_ptr<WorkQueue> pWorkQueue;
+			int numWorking;	//Jobs given to the work queue and not taken back yet.
+
+			std::deque<UploadJob *> waitingJobs;
+			std::set<UploadJob *> activeJobs;
+		};
+	}
+
+	namespace
+	{
+		typedef detail::TextureUploadQueueData QueueData;
+
+		void FinishJob(QueueData &data, UploadJob *pJob)
+		{
+			detail::TextureUploadState *pState = pJob->pState;
+			pState->isReady = true;
+
+			if(!pJob->errorMessage.empty())
+			{
+				pState->errorMessage = pJob->errorMessage;
+				if(pState->texture)
+					gl::DeleteTextures(1, &pState->texture);
+				pState->texture = 0;
+			}
+
+			//No handle is left to give the texture to.
+			if(pState->refCount == 1 && pState->texture)
+			{
+				gl::DeleteTextures(1, &pState->texture);
+				pState->texture = 0;
+			}
+
+			data.activeJobs.erase(pJob);
+			delete pJob;
+		}
+
+		//For uploads that do not fit in a buffer.
+		void UploadDirectly(QueueData &data, UploadJob *pJob)
+		{
+			try
+			{
+				if(pJob->isTopLeft)
+				{
+					std::auto_ptr<ImageSet> pFlipped(CreateFlippedImage(*pJob->pImage));
+					pJob->pOwnedImage = pFlipped;
+					pJob->pImage = pJob->pOwnedImage.get();
+					pJob->isTopLeft = false;
+				}
+
+				detail::TextureUploadState *pState = pJob->pState;
+				pState->textureType = GetTextureType(pJob->pImage, pJob->forceConvertBits);
+				pState->texture = CreateTexture(pJob->pImage, pJob->forceConvertBits);
+			}
+			catch(std::exception &e)
+			{
+				pJob->RecordError(e.what());
+			}
+
+			FinishJob(data, pJob);
+		}
+
+		void ProcessFinishedItems(QueueData &data, const std::vector<detail::WorkItem *> &finishedItems)
+		{
+			for(size_t itemIx = 0; itemIx < finishedItems.size(); ++itemIx)
+			{
+				UploadJob *pJob = static_cast<UploadJob *>(finishedItems[itemIx]);
+				--data.numWorking;
+
+				if(pJob->stage == STAGE_LOADING)
+				{
+					if(pJob->errorMessage.empty())
+					{
+						pJob->stage = STAGE_WAITING;
+						data.waitingJobs.push_back(pJob);
+					}
+					else
+						FinishJob(data, pJob);
+				}
+				else
+				{
+					//Failed copies are finished when the buffer is.
+					pJob->stage = STAGE_COPIED;
+					--data.buffers[pJob->bufferIx].numCopying;
+				}
+			}
+		}
+
+		void SubmitBuffer(QueueData &data, int bufferIx)
+		{
+			UploadBuffer &buffer = data.buffers[bufferIx];
+
+			gl::BindBuffer(gl::GL_PIXEL_UNPACK_BUFFER, buffer.buffer);
+			bool isIntact = gl::UnmapBuffer(gl::GL_PIXEL_UNPACK_BUFFER) == gl::GL_TRUE;
+			gl::BindBuffer(gl::GL_PIXEL_UNPACK_BUFFER, 0);
+			buffer.pMapped = NULL;
+
+			if(data.fillIx == bufferIx)
+				data.fillIx = -1;
+
+			std::vector<UploadJob *> uploadedJobs;
+			for(size_t jobIx = 0; jobIx < buffer.jobs.size(); ++jobIx)
+			{
+				UploadJob *pJob = buffer.jobs[jobIx];
+				if(!isIntact)
+					pJob->errorMessage = "The pixel buffer object's contents were lost while it was mapped.";
+
+				if(pJob->errorMessage.empty())
+				{
+					try
+					{
+						std::auto_ptr<ImageSet> pBufferImage(pJob->CreateBufferImage());
+						pJob->pOwnedImage.reset();
+						pJob->pImage = NULL;
+
+						detail::TextureUploadState *pState = pJob->pState;
+						pState->textureType = GetTextureType(pBufferImage.get(), pJob->forceConvertBits);
+						gl::GenTextures(1, &pState->texture);
+						CreateTextureFromBuffer(pState->texture, pBufferImage.get(), pJob->forceConvertBits,
+							buffer.buffer);
+
+						pJob->stage = STAGE_UPLOADING;
+						uploadedJobs.push_back(pJob);
+						continue;
+					}
+					catch(std::exception &e)
+					{
+						pJob->RecordError(e.what());
+					}
+				}
+
+				FinishJob(data, pJob);
+			}
+
+			buffer.jobs.swap(uploadedJobs);
+			if(buffer.jobs.empty())
+			{
+				buffer.state = BUFFER_FREE;
+				return;
+			}
+
+			buffer.fence = gl::FenceSync(gl::GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			buffer.state = BUFFER_IN_FLIGHT;
+
+			//So that the fence is signaled without anyone waiting on it.
+			gl::Flush();
+		}
+
+		void SubmitFilledBuffers(QueueData &data)
+		{
+			for(int bufferIx = 0; bufferIx < (int)data.buffers.size(); ++bufferIx)
+			{
+				const UploadBuffer &buffer = data.buffers[bufferIx];
+				if(buffer.state == BUFFER_MAPPED && buffer.numCopying == 0 && !buffer.jobs.empty())
+					SubmitBuffer(data, bufferIx);
+			}
+		}
+
+		void RetireBuffer(QueueData &data, UploadBuffer &buffer)
+		{
+			gl::DeleteSync(buffer.fence);
+			buffer.fence = 0;
+			buffer.state = BUFFER_FREE;
+
+			for(size_t jobIx = 0; jobIx < buffer.jobs.size(); ++jobIx)
+				FinishJob(data, buffer.jobs[jobIx]);
+			buffer.jobs.clear();
+		}
+
+		//If shouldWait is true, blocks until the oldest buffer in flight is done.
+		//Returns false if there was nothing in flight.
+		bool RetireBuffers(QueueData &data, bool shouldWait)
+		{
+			bool isAnyInFlight = false;
+			const int numBuffers = (int)data.buffers.size();
+
+			//Buffers are mapped in ring order, so the oldest comes after the one last mapped.
+			for(int ringIx = 0; ringIx < numBuffers; ++ringIx)
+			{
+				UploadBuffer &buffer = data.buffers[(data.nextIx + ringIx) % numBuffers];
+				if(buffer.state != BUFFER_IN_FLIGHT)
+					continue;
+
+				GLenum waitResult = gl::GL_TIMEOUT_EXPIRED;
+				if(shouldWait && !isAnyInFlight)
+				{
+					while(waitResult == gl::GL_TIMEOUT_EXPIRED)
+						waitResult = gl::ClientWaitSync(buffer.fence, gl::GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+				}
+				else
+					waitResult = gl::ClientWaitSync(buffer.fence, 0, 0);
+
+				isAnyInFlight = true;
+				if(waitResult != gl::GL_TIMEOUT_EXPIRED)
+					RetireBuffer(data, buffer);
+			}
+
+			return isAnyInFlight;
+		}
+
+		bool MapNextBuffer(QueueData &data)
+		{
+			UploadBuffer &buffer = data.buffers[data.nextIx];
+
+			gl::BindBuffer(gl::GL_PIXEL_UNPACK_BUFFER, buffer.buffer);
+			void *pMapped = gl::MapBufferRange(gl::GL_PIXEL_UNPACK_BUFFER, 0, data.bufferByteSize,
+				gl::GL_MAP_WRITE_BIT | gl::GL_MAP_INVALIDATE_BUFFER_BIT);
+			gl::BindBuffer(gl::GL_PIXEL_UNPACK_BUFFER, 0);
+
+			if(!pMapped)
+				return false;
+
+			buffer.state = BUFFER_MAPPED;
+			buffer.pMapped = static_cast<unsigned char *>(pMapped);
+			buffer.usedBytes = 0;
+			buffer.numCopying = 0;
+
+			data.fillIx = data.nextIx;
+			data.nextIx = (data.nextIx + 1) % (int)data.buffers.size();
+			return true;
+		}
+
+		void StartWaitingJobs(QueueData &data)
+		{
+			while(!data.waitingJobs.empty())
+			{
+				UploadJob *pJob = data.waitingJobs.front();
+				const size_t byteSize = GetBufferByteSize(*pJob->pImage);
+
+				if(byteSize > data.bufferByteSize)
+				{
+					data.waitingJobs.pop_front();
+					UploadDirectly(data, pJob);
+					continue;
+				}
+
+				//This buffer is full. It will be submitted once its copies are done.
+				if(data.fillIx != -1 && data.buffers[data.fillIx].usedBytes + byteSize > data.bufferByteSize)
+					data.fillIx = -1;
+
+				if(data.fillIx == -1)
+				{
+					if(data.buffers[data.nextIx].state != BUFFER_FREE)
+						break;
+
+					if(!MapNextBuffer(data))
+					{
+						data.waitingJobs.pop_front();
+						UploadDirectly(data, pJob);
+						continue;
+					}
+				}
+
+				UploadBuffer &buffer = data.buffers[data.fillIx];
+				pJob->bufferIx = data.fillIx;
+				pJob->bufferOffset = buffer.usedBytes;
+				pJob->pDest = buffer.pMapped + buffer.usedBytes;
+				pJob->stage = STAGE_COPYING;
+				buffer.usedBytes = AlignLevelOffset(buffer.usedBytes + byteSize);
+				buffer.jobs.push_back(pJob);
+				++buffer.numCopying;
+
+				data.waitingJobs.pop_front();
+				data.pWorkQueue->Add(pJob);
+				++data.numWorking;
+			}
+		}
+
+		void TakeFinishedItems(QueueData &data, bool shouldWait)
+		{
+			std::vector<detail::WorkItem *> finishedItems;
+			data.pWorkQueue->TakeFinished(finishedItems, shouldWait);
+			ProcessFinishedItems(data, finishedItems);
+		}
+
+		//Blocks until something the queue is waiting on has happened. Returns false if it was not waiting on anything.
+		bool WaitForProgress(QueueData &data)
+		{
+			if(data.numWorking != 0)
+			{
+				TakeFinishedItems(data, true);
+				return true;
+			}
+
+			return RetireBuffers(data, true);
+		}
+	}
+
+	TextureUploadQueue::TextureUploadQueue( size_t bufferByteSize, int numBuffers, int numThreads )
+		: m_pData(NULL)
+	{
+		bool hasPixelBuffers = glload::IsVersionGEQ(2, 1) || glext_ARB_pixel_buffer_object;
+		bool hasMapRange = glload::IsVersionGEQ(3, 0) || glext_ARB_map_buffer_range;
+		bool hasSync = glload::IsVersionGEQ(3, 2) || glext_ARB_sync;
+		if(!(hasPixelBuffers && hasMapRange && hasSync))
+			throw UploadQueueUnsupportedException();
+
+		std::auto_ptr<detail::TextureUploadQueueData> pData(new detail::TextureUploadQueueData);
+		pData->bufferByteSize = bufferByteSize;
+		pData->buffers.resize(numBuffers > 0 ? numBuffers : 1);
+		for(size_t bufferIx = 0; bufferIx < pData->buffers.size(); ++bufferIx)
+		{
+			UploadBuffer &buffer = pData->buffers[bufferIx];
+			gl::GenBuffers(1, &buffer.buffer);
+			gl::BindBuffer(gl::GL_PIXEL_UNPACK_BUFFER, buffer.buffer);
+			gl::BufferData(gl::GL_PIXEL_UNPACK_BUFFER, bufferByteSize, NULL, gl::GL_STREAM_DRAW);
+		}
+		gl::BindBuffer(gl::GL_PIXEL_UNPACK_BUFFER, 0);
+
+		pData->pWorkQueue.reset(new detail::WorkQueue(numThreads));
+		m_pData = pData.release();
+	}
+
+	TextureUploadQueue::~TextureUploadQueue()
+	{
+		//The workers must be done with the buffers before they are unmapped.
+		m_pData->pWorkQueue.reset();
+
+		std::vector<UploadJob *> activeJobs(m_pData->activeJobs.begin(), m_pData->activeJobs.end());
+		for(size_t jobIx = 0; jobIx < activeJobs.size(); ++jobIx)
+		{
+			activeJobs[jobIx]->errorMessage = "The upload queue was destroyed before the upload finished.";
+			FinishJob(*m_pData, activeJobs[jobIx]);
+		}
+
+		for(size_t bufferIx = 0; bufferIx < m_pData->buffers.size(); ++bufferIx)
+		{
+			UploadBuffer &buffer = m_pData->buffers[bufferIx];
+			if(buffer.state == BUFFER_MAPPED)
+			{
+				gl::BindBuffer(gl::GL_PIXEL_UNPACK_BUFFER, buffer.buffer);
+				gl::UnmapBuffer(gl::GL_PIXEL_UNPACK_BUFFER);
+				gl::BindBuffer(gl::GL_PIXEL_UNPACK_BUFFER, 0);
+			}
+
+			if(buffer.fence)
+				gl::DeleteSync(buffer.fence);
+
+			gl::DeleteBuffers(1, &buffer.buffer);
+		}
+
+		delete m_pData;
+	}
+
+	TextureUploadHandle TextureUploadQueue::Enqueue( const ImageSet *pImage, unsigned int forceConvertBits )
+	{
+		TextureUploadHandle handle(new detail::TextureUploadState);
+		std::auto_ptr<UploadJob> pJob(new UploadJob(handle.m_pState, forceConvertBits, m_pData->bufferByteSize));
+		pJob->pImage = pImage;
+
+		if(forceConvertBits & (FORCE_BLOCK_COMPRESSED_FMT | FORCE_COLOR_RENDERABLE_FMT))
+		{
+			pJob->stage = STAGE_LOADING;
+			m_pData->pWorkQueue->Add(pJob.get());
+			++m_pData->numWorking;
+		}
+		else
+			m_pData->waitingJobs.push_back(pJob.get());
+
+		m_pData->activeJobs.insert(pJob.release());
+		return handle;
+	}
+
+	TextureUploadHandle TextureUploadQueue::EnqueueDdsFile( const std::string &filename,
+		unsigned int forceConvertBits )
+	{
+		TextureUploadHandle handle(new detail::TextureUploadState);
+		std::auto_ptr<UploadJob> pJob(new UploadJob(handle.m_pState, forceConvertBits, m_pData->bufferByteSize));
+		pJob->filename = filename;
+		pJob->stage = STAGE_LOADING;
+
+		m_pData->pWorkQueue->Add(pJob.get());
+		++m_pData->numWorking;
+		m_pData->activeJobs.insert(pJob.release());
+		return handle;
+	}
+
+	void TextureUploadQueue::Update()
+	{
+		TakeFinishedItems(*m_pData, false);
+		SubmitFilledBuffers(*m_pData);
+		RetireBuffers(*m_pData, false);
+		StartWaitingJobs(*m_pData);
+	}
+
+	void TextureUploadQueue::Wait( const TextureUploadHandle &handle )
+	{
+		Update();
+		while(handle.IsValid() && !handle.IsReady())
+		{
+			//Then the handle is not from this queue.
+			if(!WaitForProgress(*m_pData))
+				break;
+
+			Update();
+		}
+	}
+
+	void TextureUploadQueue::Finish()
+	{
+		Update();
+		while(!m_pData->activeJobs.empty())
+		{
+			if(!WaitForProgress(*m_pData))
+				break;
+
+			Update();
+		}
+	}
+
+	int TextureUploadQueue::GetPendingCount() const
+	{
+		return (int)m_pData->activeJobs.size();
+	}
+}
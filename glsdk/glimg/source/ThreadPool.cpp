@@ -0,0 +1,438 @@
+//Copyright (C) 2011 by Jason L. McKesson
+//This file is licensed by the MIT License.
+
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <exception>
+#include <stdexcept>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <process.h>
+#endif //WIN32
+
+#ifdef LOAD_X11
+#include <pthread.h>
+#include <unistd.h>
+#endif //LOAD_X11
+
+#include "glimg/ThreadPool.h"
+#include "WorkQueue.h"
+
+namespace glimg
+{
+	namespace detail
+	{
+#ifdef WIN32
+		namespace
+		{
+			class Mutex
+			{
+			public:
+				Mutex() {InitializeCriticalSection(&m_cs);}
+				~Mutex() {DeleteCriticalSection(&m_cs);}
+
+				void Lock() {EnterCriticalSection(&m_cs);}
+				void Unlock() {LeaveCriticalSection(&m_cs);}
+
+				CRITICAL_SECTION m_cs;
+			};
+
+			class Condition
+			{
+			public:
+				Condition() {InitializeConditionVariable(&m_cond);}
+
+				void Wait(Mutex &mutex) {SleepConditionVariableCS(&m_cond, &mutex.m_cs, INFINITE);}
+				void WakeAll() {WakeAllConditionVariable(&m_cond);}
+
+			private:
+				CONDITION_VARIABLE m_cond;
+			};
+
+			typedef HANDLE ThreadHandle;
+			typedef unsigned (__stdcall *ThreadFunc)(void *);
+
+			ThreadHandle StartThread(ThreadFunc func, void *pArg)
+			{
+				return (HANDLE)_beginthreadex(NULL, 0, func, pArg, 0, NULL);
+			}
+
+			void JoinThread(ThreadHandle thread)
+			{
+				WaitForSingleObject(thread, INFINITE);
+				CloseHandle(thread);
+			}
+
+#define THREAD_PROC unsigned __stdcall
+#define THREAD_RETURN 0
+		}
+#endif //WIN32
+
+#ifdef LOAD_X11
+		namespace
+		{
+			class Mutex
+			{
+			public:
+				Mutex() {pthread_mutex_init(&m_mutex, NULL);}
+				~Mutex() {pthread_mutex_destroy(&m_mutex);}
+
+				void Lock() {pthread_mutex_lock(&m_mutex);}
+				void Unlock() {pthread_mutex_unlock(&m_mutex);}
+
+				pthread_mutex_t m_mutex;
+			};
+
+			class Condition
+			{
+			public:
+				Condition() {pthread_cond_init(&m_cond, NULL);}
+				~Condition() {pthread_cond_destroy(&m_cond);}
+
+				void Wait(Mutex &mutex) {pthread_cond_wait(&m_cond, &mutex.m_mutex);}
+				void WakeAll() {pthread_cond_broadcast(&m_cond);}
+
+			private:
+				pthread_cond_t m_cond;
+			};
+
+			typedef pthread_t ThreadHandle;
+			typedef void *(*ThreadFunc)(void *);
+
+			ThreadHandle StartThread(ThreadFunc func, void *pArg)
+			{
+				pthread_t thread;
+				pthread_create(&thread, NULL, func, pArg);
+				return thread;
+			}
+
+			void JoinThread(ThreadHandle thread)
+			{
+				pthread_join(thread, NULL);
+			}
+
+#define THREAD_PROC void *
+#define THREAD_RETURN NULL
+		}
+#endif //LOAD_X11
+
+		namespace
+		{
+			class ScopedLock
+			{
+			public:
+				explicit ScopedLock(Mutex &mutex) : m_mutex(mutex) {m_mutex.Lock();}
+				~ScopedLock() {m_mutex.Unlock();}
+
+			private:
+				Mutex &m_mutex;
+			};
+		}
+
+		struct ThreadPoolData
+		{
+			ThreadPoolData()
+				: pTask(NULL)
+				, numItems(0)
+				, nextItem(0)
+				, numFinished(0)
+				, jobId(0)
+				, isShuttingDown(false)
+			{}
+
+			Mutex mutex;
+			Condition jobReady;
+			Condition jobDone;
+
+			std::vector<ThreadHandle> threads;
+
+			ParallelTask *pTask;
+			int numItems;
+			int nextItem;
+			int numFinished;
+			unsigned int jobId;
+			bool isShuttingDown;
+
+			std::string errorMessage;
+
+			//Runs items of the current job until there are none left. Mutex must be locked.
+			void RunItems()
+			{
+				while(nextItem < numItems)
+				{
+					int itemIx = nextItem++;
+					ParallelTask *pCurrTask = pTask;
+
+					mutex.Unlock();
+					std::string error;
+					try
+					{
+						pCurrTask->Execute(itemIx);
+					}
+					catch(std::exception &e)
+					{
+						error = e.what();
+						if(error.empty())
+							error = "Unknown exception in a parallel task.";
+					}
+					catch(...)
+					{
+						error = "Unknown exception in a parallel task.";
+					}
+					mutex.Lock();
+
+					if(!error.empty() && errorMessage.empty())
+						errorMessage = error;
+
+					++numFinished;
+					if(numFinished == numItems)
+						jobDone.WakeAll();
+				}
+			}
+		};
+
+		namespace
+		{
+			THREAD_PROC WorkerProc(void *pArg)
+			{
+				ThreadPoolData &data = *static_cast<ThreadPoolData *>(pArg);
+
+				ScopedLock lock(data.mutex);
+				unsigned int lastJobId = data.jobId;
+				for(;;)
+				{
+					while(!data.isShuttingDown && data.jobId == lastJobId)
+						data.jobReady.Wait(data.mutex);
+
+					if(data.isShuttingDown)
+						break;
+
+					lastJobId = data.jobId;
+					data.RunItems();
+				}
+
+				return THREAD_RETURN;
+			}
+		}
+	}
+
+#ifdef WIN32
+	int GetHardwareThreadCount()
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+	}
+#endif //WIN32
+
+#ifdef LOAD_X11
+	int GetHardwareThreadCount()
+	{
+		long numProcs = sysconf(_SC_NPROCESSORS_ONLN);
+		return numProcs > 0 ? (int)numProcs : 1;
+	}
+#endif //LOAD_X11
+
+	ThreadPool::ThreadPool( int numThreads )
+		: m_pData(new detail::ThreadPoolData)
+	{
+		if(numThreads <= 0)
+			numThreads = GetHardwareThreadCount();
+
+		//The calling thread does work too.
+		for(int threadIx = 1; threadIx < numThreads; ++threadIx)
+			m_pData->threads.push_back(detail::StartThread(detail::WorkerProc, m_pData));
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			detail::ScopedLock lock(m_pData->mutex);
+			m_pData->isShuttingDown = true;
+			m_pData->jobReady.WakeAll();
+		}
+
+		for(size_t threadIx = 0; threadIx < m_pData->threads.size(); ++threadIx)
+			detail::JoinThread(m_pData->threads[threadIx]);
+
+		delete m_pData;
+	}
+
+	int ThreadPool::GetThreadCount() const
+	{
+		return (int)m_pData->threads.size() + 1;
+	}
+
+	void ThreadPool::ParallelFor( ParallelTask &task, int numItems )
+	{
+		if(numItems <= 0)
+			return;
+
+		//Not worth waking anyone up.
+		if(numItems == 1 || m_pData->threads.empty())
+		{
+			for(int itemIx = 0; itemIx < numItems; ++itemIx)
+				task.Execute(itemIx);
+			return;
+		}
+
+		std::string errorMessage;
+		bool isBusy = false;
+		{
+			detail::ScopedLock lock(m_pData->mutex);
+
+			//Another job has the threads, either from another thread or from around this
+			//call. This one makes do with the caller.
+			isBusy = m_pData->pTask != NULL;
+			if(!isBusy)
+			{
+				m_pData->pTask = &task;
+				m_pData->numItems = numItems;
+				m_pData->nextItem = 0;
+				m_pData->numFinished = 0;
+				m_pData->errorMessage.clear();
+				++m_pData->jobId;
+				m_pData->jobReady.WakeAll();
+
+				m_pData->RunItems();
+
+				while(m_pData->numFinished != m_pData->numItems)
+					m_pData->jobDone.Wait(m_pData->mutex);
+
+				m_pData->pTask = NULL;
+				m_pData->numItems = 0;
+				m_pData->nextItem = 0;
+				errorMessage.swap(m_pData->errorMessage);
+			}
+		}
+
+		if(isBusy)
+		{
+			for(int itemIx = 0; itemIx < numItems; ++itemIx)
+				task.Execute(itemIx);
+			return;
+		}
+
+		if(!errorMessage.empty())
+			throw std::runtime_error(errorMessage);
+	}
+
+	ThreadPool &GetSharedThreadPool()
+	{
+		static ThreadPool sharedPool;
+		return sharedPool;
+	}
+
+	namespace detail
+	{
+		struct WorkQueueData
+		{
+			WorkQueueData()
+				: numRunning(0)
+				, isShuttingDown(false)
+			{}
+
+			Mutex mutex;
+			Condition itemAdded;
+			Condition itemFinished;
+
+			std::vector<ThreadHandle> threads;
+
+			std::deque<WorkItem *> queuedItems;
+			std::vector<WorkItem *> finishedItems;
+			int numRunning;
+			bool isShuttingDown;
+		};
+
+		namespace
+		{
+			THREAD_PROC WorkQueueProc(void *pArg)
+			{
+				WorkQueueData &data = *static_cast<WorkQueueData *>(pArg);
+
+				ScopedLock lock(data.mutex);
+				for(;;)
+				{
+					while(!data.isShuttingDown && data.queuedItems.empty())
+						data.itemAdded.Wait(data.mutex);
+
+					if(data.isShuttingDown)
+						break;
+
+					WorkItem *pItem = data.queuedItems.front();
+					data.queuedItems.pop_front();
+					++data.numRunning;
+
+					data.mutex.Unlock();
+					try
+					{
+						pItem->Execute();
+					}
+					catch(...)
+					{
+					}
+					data.mutex.Lock();
+
+					--data.numRunning;
+					data.finishedItems.push_back(pItem);
+					data.itemFinished.WakeAll();
+				}
+
+				return THREAD_RETURN;
+			}
+		}
+
+		WorkQueue::WorkQueue( int numThreads )
+			: m_pData(new WorkQueueData)
+		{
+			if(numThreads <= 0)
+				numThreads = GetHardwareThreadCount();
+
+			for(int threadIx = 0; threadIx < numThreads; ++threadIx)
+				m_pData->threads.push_back(StartThread(WorkQueueProc, m_pData));
+		}
+
+		WorkQueue::~WorkQueue()
+		{
+			{
+				ScopedLock lock(m_pData->mutex);
+				m_pData->queuedItems.clear();
+				m_pData->isShuttingDown = true;
+				m_pData->itemAdded.WakeAll();
+			}
+
+			for(size_t threadIx = 0; threadIx < m_pData->threads.size(); ++threadIx)
+				JoinThread(m_pData->threads[threadIx]);
+
+			delete m_pData;
+		}
+
+		void WorkQueue::Add( WorkItem *pItem )
+		{
+			ScopedLock lock(m_pData->mutex);
+			m_pData->queuedItems.push_back(pItem);
+			m_pData->itemAdded.WakeAll();
+		}
+
+		void WorkQueue::TakeFinished( std::vector<WorkItem *> &finishedItems, bool shouldWait )
+		{
+			ScopedLock lock(m_pData->mutex);
+			if(shouldWait)
+			{
+				while(m_pData->finishedItems.empty() &&
+					(!m_pData->queuedItems.empty() || m_pData->numRunning != 0))
+				{
+					m_pData->itemFinished.Wait(m_pData->mutex);
+				}
+			}
+
+			finishedItems.insert(finishedItems.end(), m_pData->finishedItems.begin(),
+				m_pData->finishedItems.end());
+			m_pData->finishedItems.clear();
+		}
+	}
+}
@@ -27,4 +27,14 @@ namespace glimg
 	size_t CalcImageByteSize(const ImageFormat &fmt, const Dimensions &dims);
 
 	int ComponentCount(PixelComponents eFormat);
+
+	//Copies one image of imageSize bytes, reversing the order of its rows. Compressed blocks
+	//are flipped as well. Flipping twice gives back the original.
+	void FlipImageData(const ImageFormat &format, const Dimensions &dims, const void *pixelData,
+		unsigned char *pDstData, size_t imageSize);
+
+	//As CreateTexture, but the image's data pointers are offsets into the pixel buffer object
+	//unpackBuffer. GL_PIXEL_UNPACK_BUFFER is left with 0 bound.
+	void CreateTextureFromBuffer(unsigned int textureName, const ImageSet *pImage,
+		unsigned int forceConvertBits, unsigned int unpackBuffer);
 }
\ No newline at end of file
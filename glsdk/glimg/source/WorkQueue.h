@@ -0,0 +1,54 @@
+/** Copyright (C) 2011 by Jason L. McKesson **/
+/** This file is licensed by the MIT License. **/
+
+
+
+#ifndef GLIMG_WORK_QUEUE_H
+#define GLIMG_WORK_QUEUE_H
+
+#include <vector>
+
+namespace glimg
+{
+	namespace detail
+	{
+		//A unit of work for a WorkQueue. Exceptions thrown from Execute are swallowed, so items
+		//must record their own failures.
+		class WorkItem
+		{
+		public:
+			virtual ~WorkItem() {}
+
+			virtual void Execute() = 0;
+		};
+
+		struct WorkQueueData;
+
+		//Worker threads that run items in the order they are added, without the adding thread
+		//waiting for them. Unlike ThreadPool, the caller does not take part.
+		class WorkQueue
+		{
+		public:
+			//If numThreads is 0, one thread per hardware thread will be used.
+			explicit WorkQueue(int numThreads = 0);
+
+			//Waits for the items that are running. Items that have not started are dropped.
+			~WorkQueue();
+
+			//The queue does not own pItem. It must stay alive until TakeFinished returns it.
+			void Add(WorkItem *pItem);
+
+			//Appends the items that have finished since the last call to finishedItems. If shouldWait
+			//is true and none have, but some are queued or running, blocks until one finishes.
+			void TakeFinished(std::vector<WorkItem *> &finishedItems, bool shouldWait);
+
+		private:
+			WorkQueueData *m_pData;
+
+			WorkQueue(const WorkQueue &);
+			WorkQueue &operator=(const WorkQueue &);
+		};
+	}
+}
+
+#endif //GLIMG_WORK_QUEUE_H
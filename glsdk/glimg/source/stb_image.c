@@ -1814,7 +1814,7 @@ __forceinline static int bit_reverse(int v, int bits)
    return bitreverse16(v) >> (16-bits);
 }
 
-static int zbuild_huffman(zhuffman *z, uint8 *sizelist, int num)
+static int zbuild_huffman(zhuffman *z, const uint8 *sizelist, int num)
 {
    int i,k=0;
    int code, next_code[16], sizes[17];
@@ -2078,18 +2078,27 @@ static int parse_zlib_header(zbuf *a)
    return 1;
 }
 
-// @TODO: should statically initialize these for optimal thread safety
-static uint8 default_length[288], default_distance[32];
-static void init_defaults(void)
+// statically initialized, so that several threads can decode at once
+#define STBI__REPEAT8(v)   v,v,v,v,v,v,v,v
+static const uint8 default_length[288] =
+{
+   // 0..143 are 8 bits
+   STBI__REPEAT8(8),STBI__REPEAT8(8),STBI__REPEAT8(8),STBI__REPEAT8(8),STBI__REPEAT8(8),STBI__REPEAT8(8),
+   STBI__REPEAT8(8),STBI__REPEAT8(8),STBI__REPEAT8(8),STBI__REPEAT8(8),STBI__REPEAT8(8),STBI__REPEAT8(8),
+   STBI__REPEAT8(8),STBI__REPEAT8(8),STBI__REPEAT8(8),STBI__REPEAT8(8),STBI__REPEAT8(8),STBI__REPEAT8(8),
+   // 144..255 are 9 bits
+   STBI__REPEAT8(9),STBI__REPEAT8(9),STBI__REPEAT8(9),STBI__REPEAT8(9),STBI__REPEAT8(9),STBI__REPEAT8(9),
+   STBI__REPEAT8(9),STBI__REPEAT8(9),STBI__REPEAT8(9),STBI__REPEAT8(9),STBI__REPEAT8(9),STBI__REPEAT8(9),
+   STBI__REPEAT8(9),STBI__REPEAT8(9),
+   // 256..279 are 7 bits, 280..287 are 8 bits
+   STBI__REPEAT8(7),STBI__REPEAT8(7),STBI__REPEAT8(7),
+   STBI__REPEAT8(8),
+};
+static const uint8 default_distance[32] =
 {
-   int i;   // use <= to match clearly with spec
-   for (i=0; i <= 143; ++i)     default_length[i]   = 8;
-   for (   ; i <= 255; ++i)     default_length[i]   = 9;
-   for (   ; i <= 279; ++i)     default_length[i]   = 7;
-   for (   ; i <= 287; ++i)     default_length[i]   = 8;
-
-   for (i=0; i <=  31; ++i)     default_distance[i] = 5;
-}
+   STBI__REPEAT8(5),STBI__REPEAT8(5),STBI__REPEAT8(5),STBI__REPEAT8(5),
+};
+#undef STBI__REPEAT8
 
 int stbi_png_partial; // a quick hack to only allow decoding some of a PNG... I should implement real streaming support instead
 static int parse_zlib(zbuf *a, int parse_header)
@@ -2109,7 +2118,6 @@ static int parse_zlib(zbuf *a, int parse_header)
       } else {
          if (type == 1) {
             // use fixed code lengths
-            if (!default_distance[31]) init_defaults();
             if (!zbuild_huffman(&a->z_length  , default_length  , 288)) return 0;
             if (!zbuild_huffman(&a->z_distance, default_distance,  32)) return 0;
          } else {